@@ -0,0 +1,343 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	H.264 Depacketizer Benchmark
+//
+//	description:
+//		measures frames/s and GB/s of assembling H.264 access units
+//		from RTP packets with RTP::RTPH264Depacketizer
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Poco/NumberParser.h"
+#include "Poco/Stopwatch.h"
+
+#include "RTPPacket.h"
+#include "RTPH264Depacketizer.h"
+
+
+using Poco::NumberParser;
+using Poco::Stopwatch;
+using Poco::UInt8;
+using Poco::UInt32;
+
+using RTP::RTPPacket;
+using RTP::RTPDepacketizer;
+using RTP::RTPH264Depacketizer;
+
+
+namespace {
+
+
+volatile std::size_t sink;
+	// keeps the optimizer from dropping the measured work
+
+
+class Stream
+	/// A packetized H.264 stream resembling a 30 fps camera: a
+	/// key frame every 30 frames, preceded by SPS and PPS in a
+	/// STAP-A packet, and smaller predicted frames in between.
+	/// NAL units larger than the payload size are sent as FU-A.
+{
+public:
+	Stream(std::size_t frames, std::size_t keyFrameSize, std::size_t frameSize):
+		_frames(frames),
+		_bytes(0),
+		_sequence(0)
+	{
+		UInt32 random = 0x2545f491;
+		for (std::size_t i = 0; i < frames; ++i)
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+
+			UInt32 timestamp = (UInt32) (i * 3000);
+			bool key = i % 30 == 0;
+			if (key)
+			{
+				static const UInt8 parameterSets[] =
+				{
+					24,
+					0, 4, 0x67, 0x42, 0xc0, 0x1f,
+					0, 4, 0x68, 0xce, 0x3c, 0x80
+				};
+				addPacket(timestamp, false, parameterSets, sizeof(parameterSets));
+			}
+
+			std::size_t size = (key ? keyFrameSize : frameSize) / 2 + random % (key ? keyFrameSize : frameSize);
+			_bytes += size;
+			std::vector<UInt8> nal(size, 0x5a);
+			nal[0] = key ? 0x65 : 0x41;
+			addNAL(timestamp, &nal[0], size);
+		}
+
+		_views.resize(_offsets.size());
+		for (std::size_t i = 0; i < _offsets.size(); ++i)
+		{
+			_views[i].parse(&_storage[_offsets[i]], _lengths[i]);
+		}
+	}
+
+	std::size_t frames() const
+	{
+		return _frames;
+	}
+
+	std::size_t bytes() const
+	{
+		return _bytes;
+	}
+
+	const std::vector<RTPPacket>& packets() const
+	{
+		return _views;
+	}
+
+private:
+	enum
+	{
+		MAX_PAYLOAD = 1400
+	};
+
+	void addNAL(UInt32 timestamp, const UInt8* nal, std::size_t size)
+	{
+		if (size <= MAX_PAYLOAD)
+		{
+			addPacket(timestamp, true, nal, size);
+			return;
+		}
+
+		UInt8 fragment[MAX_PAYLOAD];
+		fragment[0] = (UInt8) ((nal[0] & 0xe0) | RTPH264Depacketizer::NAL_FU_A);
+		for (std::size_t pos = 1; pos < size; )
+		{
+			std::size_t chunk = size - pos < MAX_PAYLOAD - 2 ? size - pos : MAX_PAYLOAD - 2;
+			fragment[1] = (UInt8) ((pos == 1 ? 0x80 : 0) | (pos + chunk == size ? 0x40 : 0) | (nal[0] & 0x1f));
+			std::memcpy(fragment + 2, nal + pos, chunk);
+			pos += chunk;
+			addPacket(timestamp, pos == size, fragment, chunk + 2);
+		}
+	}
+
+	void addPacket(UInt32 timestamp, bool marker, const UInt8* payload, std::size_t size)
+	{
+		std::size_t offset = _storage.size();
+		_storage.resize(offset + 12 + size);
+		UInt8* p = &_storage[offset];
+		p[0] = 0x80;
+		p[1] = (UInt8) ((marker ? 0x80 : 0) | 96);
+		p[2] = (UInt8) (_sequence >> 8);
+		p[3] = (UInt8) _sequence;
+		p[4] = (UInt8) (timestamp >> 24);
+		p[5] = (UInt8) (timestamp >> 16);
+		p[6] = (UInt8) (timestamp >> 8);
+		p[7] = (UInt8) timestamp;
+		std::memset(p + 8, 0x11, 4);
+		std::memcpy(p + 12, payload, size);
+		++_sequence;
+
+		_offsets.push_back(offset);
+		_lengths.push_back(12 + size);
+	}
+
+	std::size_t              _frames;
+	std::size_t              _bytes;
+	Poco::UInt16             _sequence;
+	std::vector<UInt8>       _storage;
+	std::vector<std::size_t> _offsets;
+	std::vector<std::size_t> _lengths;
+	std::vector<RTPPacket>   _views;
+};
+
+
+class Benchmark: public RTPDepacketizer::Handler
+	/// One measured pass over a Stream.
+{
+public:
+	Benchmark(const std::string& name, const Stream& stream, RTPH264Depacketizer::Format format):
+		_name(name),
+		_stream(stream),
+		_depacketizer(*this, format),
+		_sum(0)
+	{
+	}
+
+	virtual ~Benchmark()
+	{
+	}
+
+	const std::string& name() const
+	{
+		return _name;
+	}
+
+	const Stream& stream() const
+	{
+		return _stream;
+	}
+
+	void run()
+		/// Depacketizes all packets of the stream once.
+	{
+		_sum = 0;
+		const std::vector<RTPPacket>& packets = _stream.packets();
+		for (std::vector<RTPPacket>::const_iterator it = packets.begin(); it != packets.end(); ++it)
+		{
+			_depacketizer.push(*it);
+		}
+		_depacketizer.reset();
+		sink = _sum;
+	}
+
+protected:
+	std::string         _name;
+	const Stream&       _stream;
+	RTPH264Depacketizer _depacketizer;
+	std::size_t         _sum;
+};
+
+
+class Slices: public Benchmark
+	/// Access units as slice lists, as handed to writev().
+{
+public:
+	Slices(const std::string& name, const Stream& stream, RTPH264Depacketizer::Format format):
+		Benchmark(name, stream, format)
+	{
+	}
+
+	void onAccessUnit(const RTPDepacketizer::AccessUnit& unit)
+	{
+		_sum += unit.size + unit.sliceCount;
+	}
+};
+
+
+class Copy: public Benchmark
+	/// Access units copied into one contiguous frame buffer,
+	/// for comparison with the slice lists.
+{
+public:
+	Copy(const std::string& name, const Stream& stream, RTPH264Depacketizer::Format format):
+		Benchmark(name, stream, format)
+	{
+	}
+
+	void onAccessUnit(const RTPDepacketizer::AccessUnit& unit)
+	{
+		_frame.resize(unit.size);
+		UInt8* p = &_frame[0];
+		for (std::size_t i = 0; i < unit.sliceCount; ++i)
+		{
+			std::memcpy(p, unit.slices[i].data, unit.slices[i].size);
+			p += unit.slices[i].size;
+		}
+		_sum += _frame[unit.size - 1];
+	}
+
+private:
+	std::vector<UInt8> _frame;
+};
+
+
+void measure(Benchmark& benchmark, Poco::Timestamp::TimeDiff minTime)
+	/// Doubles the iteration count until a run takes at least
+	/// minTime microseconds, then prints the results of that run.
+{
+	benchmark.run();
+
+	long iterations = 1;
+	for (;;)
+	{
+		Stopwatch sw;
+		sw.start();
+		for (long i = 0; i < iterations; ++i)
+		{
+			benchmark.run();
+		}
+		sw.stop();
+
+		if (sw.elapsed() >= minTime)
+		{
+			double seconds = (double) sw.elapsed() / 1000000.0;
+			double frames = (double) benchmark.stream().frames() * (double) iterations;
+			std::printf("%-24s %10.0f frames/s %8.2f GB/s %8.1f ns/packet\n",
+				benchmark.name().c_str(),
+				frames / seconds,
+				(double) benchmark.stream().bytes() * (double) iterations / seconds / 1000000000.0,
+				seconds * 1000000000.0 / ((double) benchmark.stream().packets().size() * (double) iterations));
+			return;
+		}
+		iterations *= 2;
+	}
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Poco::Timestamp::TimeDiff minTime = (argc > 1 ? NumberParser::parse(argv[1]) : 500) * 1000;
+	std::size_t frames = argc > 2 ? NumberParser::parseUnsigned(argv[2]) : 300;
+
+	try
+	{
+		Stream stream(frames, 60000, 8000);
+		std::printf("%lu frames, %lu packets, %lu bytes\n", (unsigned long) stream.frames(), (unsigned long) stream.packets().size(), (unsigned long) stream.bytes());
+
+		Slices annexB("Annex B slices", stream, RTPH264Depacketizer::FORMAT_ANNEXB);
+		Slices avcc("AVCC slices", stream, RTPH264Depacketizer::FORMAT_AVCC);
+		Copy annexBCopy("Annex B copied", stream, RTPH264Depacketizer::FORMAT_ANNEXB);
+		Copy avccCopy("AVCC copied", stream, RTPH264Depacketizer::FORMAT_AVCC);
+		measure(annexB, minTime);
+		measure(avcc, minTime);
+		measure(annexBCopy, minTime);
+		measure(avccCopy, minTime);
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,394 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	RTSP io_uring Benchmark
+//
+//	description:
+//		compares request throughput of many concurrent sessions using
+//		blocking sockets, the io_uring engine and a raw epoll loop
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/NumberParser.h"
+#include "Poco/Runnable.h"
+#include "Poco/Stopwatch.h"
+#include "Poco/Thread.h"
+
+#include "RTSPClientSession.h"
+#include "RTSPIOUring.h"
+#include "RTSPRequest.h"
+#include "RTSPResponse.h"
+
+
+using Poco::NumberParser;
+using Poco::Runnable;
+using Poco::Stopwatch;
+using Poco::Thread;
+using Poco::Net::ServerSocket;
+using Poco::Net::SocketAddress;
+
+using RTSP::RTSPClientSession;
+using RTSP::RTSPIOUring;
+using RTSP::RTSPRequest;
+using RTSP::RTSPResponse;
+
+
+namespace {
+
+
+const char RESPONSE[] = "RTSP/1.0 200 OK\r\nCSeq: 1\r\n\r\n";
+const char REQUEST[]  = "OPTIONS * RTSP/1.0\r\nCSeq: 1\r\n\r\n";
+
+
+void setNonBlocking(int fd)
+{
+	::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+
+class Responder: public Runnable
+	/// An epoll driven server on the loopback interface, which
+	/// answers every request header it receives with a fixed
+	/// 200 OK response.
+{
+public:
+	Responder():
+		_socket(SocketAddress("127.0.0.1", 0), 1024),
+		_epollFd(::epoll_create1(0)),
+		_stop(false)
+	{
+		setNonBlocking(_socket.impl()->sockfd());
+		struct epoll_event ev;
+		ev.events  = EPOLLIN;
+		ev.data.fd = _socket.impl()->sockfd();
+		::epoll_ctl(_epollFd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+	}
+
+	~Responder()
+	{
+		::close(_epollFd);
+	}
+
+	Poco::UInt16 port() const
+	{
+		return _socket.address().port();
+	}
+
+	void stop()
+	{
+		_stop = true;
+	}
+
+	void run()
+	{
+		const int listenFd = _socket.impl()->sockfd();
+		struct epoll_event events[256];
+		char buffer[4096];
+		while (!_stop)
+		{
+			int n = ::epoll_wait(_epollFd, events, 256, 100);
+			for (int i = 0; i < n; ++i)
+			{
+				int fd = events[i].data.fd;
+				if (fd == listenFd)
+				{
+					int cfd;
+					while ((cfd = ::accept(listenFd, NULL, NULL)) >= 0)
+					{
+						setNonBlocking(cfd);
+						struct epoll_event ev;
+						ev.events  = EPOLLIN;
+						ev.data.fd = cfd;
+						::epoll_ctl(_epollFd, EPOLL_CTL_ADD, cfd, &ev);
+					}
+					continue;
+				}
+
+				int rc = (int) ::recv(fd, buffer, sizeof(buffer), 0);
+				if (rc <= 0)
+				{
+					if (rc < 0 && errno == EAGAIN)
+						continue;
+					::epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+					::close(fd);
+					_pending.erase(fd);
+					continue;
+				}
+
+				std::string& pending = _pending[fd];
+				pending.append(buffer, rc);
+				std::string::size_type pos;
+				std::string response;
+				while ((pos = pending.find("\r\n\r\n")) != std::string::npos)
+				{
+					pending.erase(0, pos + 4);
+					response.append(RESPONSE, sizeof(RESPONSE) - 1);
+				}
+				if (!response.empty())
+				{
+					::send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+				}
+			}
+		}
+		for (std::map<int, std::string>::iterator it = _pending.begin(); it != _pending.end(); ++it)
+		{
+			::close(it->first);
+		}
+	}
+
+private:
+	ServerSocket               _socket;
+	int                        _epollFd;
+	std::map<int, std::string> _pending;
+	volatile bool              _stop;
+};
+
+
+class SessionClient: public Runnable
+	/// Performs a number of OPTIONS round trips over one
+	/// RTSPClientSession.
+{
+public:
+	SessionClient(Poco::UInt16 port, int requests, RTSPIOUring* pIOUring):
+		_session("127.0.0.1", port),
+		_requests(requests),
+		_failed(false)
+	{
+		_session.setIOUring(pIOUring);
+	}
+
+	void run()
+	{
+		try
+		{
+			for (int i = 0; i < _requests; ++i)
+			{
+				RTSPRequest request(RTSPRequest::RTSP_OPTIONS, "*");
+				_session.sendRequest(request);
+				RTSPResponse response;
+				_session.receiveResponse(response);
+			}
+			_session.setIOUring(NULL);
+		}
+		catch (Poco::Exception& exc)
+		{
+			std::cerr << "client: " << exc.displayText() << std::endl;
+			_failed = true;
+		}
+	}
+
+	bool failed() const
+	{
+		return _failed;
+	}
+
+private:
+	RTSPClientSession _session;
+	int               _requests;
+	bool              _failed;
+};
+
+
+double runSessions(Poco::UInt16 port, int sessions, int requests, RTSPIOUring* pIOUring)
+	/// Runs one thread per session and returns the
+	/// achieved requests per second.
+{
+	std::vector<SessionClient*> clients;
+	std::vector<Thread*> threads;
+	for (int i = 0; i < sessions; ++i)
+	{
+		clients.push_back(new SessionClient(port, requests, pIOUring));
+		threads.push_back(new Thread);
+	}
+
+	Stopwatch sw;
+	sw.start();
+	for (int i = 0; i < sessions; ++i)
+	{
+		threads[i]->start(*clients[i]);
+	}
+	for (int i = 0; i < sessions; ++i)
+	{
+		threads[i]->join();
+	}
+	sw.stop();
+
+	int failed = 0;
+	for (int i = 0; i < sessions; ++i)
+	{
+		if (clients[i]->failed())
+			++failed;
+		delete threads[i];
+		delete clients[i];
+	}
+	if (failed > 0)
+	{
+		std::cerr << failed << " sessions failed" << std::endl;
+	}
+	return (double) sessions * requests * 1000000.0 / (double) sw.elapsed();
+}
+
+
+double runEpoll(Poco::UInt16 port, int sessions, int requests)
+	/// Drives all connections from a single thread with
+	/// non-blocking sockets and epoll, without the SDK message
+	/// classes. This is the upper bound the SDK has to compete
+	/// with, and returns the achieved requests per second.
+{
+	int epollFd = ::epoll_create1(0);
+	std::vector<int> fds(sessions);
+	std::vector<int> remaining(sessions, requests);
+	std::vector<std::string> pending(sessions);
+
+	struct sockaddr_in addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family      = AF_INET;
+	addr.sin_port        = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	for (int i = 0; i < sessions; ++i)
+	{
+		fds[i] = ::socket(AF_INET, SOCK_STREAM, 0);
+		::connect(fds[i], (struct sockaddr*) &addr, sizeof(addr));
+		setNonBlocking(fds[i]);
+		struct epoll_event ev;
+		ev.events   = EPOLLIN;
+		ev.data.u32 = i;
+		::epoll_ctl(epollFd, EPOLL_CTL_ADD, fds[i], &ev);
+	}
+
+	Stopwatch sw;
+	sw.start();
+	for (int i = 0; i < sessions; ++i)
+	{
+		::send(fds[i], REQUEST, sizeof(REQUEST) - 1, MSG_NOSIGNAL);
+	}
+
+	int active = sessions;
+	struct epoll_event events[256];
+	char buffer[4096];
+	while (active > 0)
+	{
+		int n = ::epoll_wait(epollFd, events, 256, 1000);
+		if (n <= 0)
+			break;
+		for (int e = 0; e < n; ++e)
+		{
+			int i = (int) events[e].data.u32;
+			int rc = (int) ::recv(fds[i], buffer, sizeof(buffer), 0);
+			if (rc <= 0)
+				continue;
+			pending[i].append(buffer, rc);
+			std::string::size_type pos;
+			while ((pos = pending[i].find("\r\n\r\n")) != std::string::npos)
+			{
+				pending[i].erase(0, pos + 4);
+				if (--remaining[i] > 0)
+					::send(fds[i], REQUEST, sizeof(REQUEST) - 1, MSG_NOSIGNAL);
+				else
+					--active;
+			}
+		}
+	}
+	sw.stop();
+
+	for (int i = 0; i < sessions; ++i)
+	{
+		::close(fds[i]);
+	}
+	::close(epollFd);
+	return (double) (sessions * requests - active * requests) * 1000000.0 / (double) sw.elapsed();
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	int sessions = argc > 1 ? NumberParser::parse(argv[1]) : 256;
+	int requests = argc > 2 ? NumberParser::parse(argv[2]) : 1000;
+
+	try
+	{
+		Responder responder;
+		Thread thread;
+		thread.start(responder);
+
+		std::cout << sessions << " sessions, " << requests << " requests each" << std::endl;
+
+		double blocking = runSessions(responder.port(), sessions, requests, NULL);
+		std::cout << "blocking sockets: " << (long) blocking << " requests/s" << std::endl;
+
+		if (RTSPIOUring::available())
+		{
+			RTSPIOUring ring;
+			double uring = runSessions(responder.port(), sessions, requests, &ring);
+			std::cout << "io_uring engine:  " << (long) uring << " requests/s" << std::endl;
+		}
+		else
+		{
+			std::cout << "io_uring engine:  not available" << std::endl;
+		}
+
+		double epoll = runEpoll(responder.port(), sessions, requests);
+		std::cout << "raw epoll loop:   " << (long) epoll << " requests/s" << std::endl;
+
+		responder.stop();
+		thread.join();
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	return 0;
+}
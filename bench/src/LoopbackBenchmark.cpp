@@ -0,0 +1,251 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	RTSP Loopback Benchmark
+//
+//	description:
+//		runs complete OPTIONS/DESCRIBE/SETUP/PLAY exchanges over an
+//		in-memory pipe with a virtual clock, without sockets
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "Poco/NumberParser.h"
+#include "Poco/Stopwatch.h"
+
+#include "RTSPClientSession.h"
+#include "RTSPPipeTransport.h"
+#include "RTSPRequest.h"
+#include "RTSPResponse.h"
+#include "RTSPVirtualClock.h"
+
+
+using Poco::NumberParser;
+using Poco::Stopwatch;
+using Poco::Timespan;
+
+using RTSP::RTSPClientSession;
+using RTSP::RTSPPipeTransport;
+using RTSP::RTSPRequest;
+using RTSP::RTSPResponse;
+using RTSP::RTSPVirtualClock;
+
+
+namespace {
+
+
+const char URI[] = "rtsp://camera.example/stream";
+
+const char SDP[] =
+	"v=0\r\n"
+	"o=- 1 1 IN IP4 192.0.2.1\r\n"
+	"s=Stream\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"t=0 0\r\n"
+	"a=control:*\r\n"
+	"m=video 0 RTP/AVP 96\r\n"
+	"a=rtpmap:96 H264/90000\r\n"
+	"a=fmtp:96 packetization-mode=1;profile-level-id=42e01f\r\n"
+	"a=control:track1\r\n";
+
+
+class CannedServer: public RTSPPipeTransport::Handler
+	/// Answers every request arriving on its end of the pipe with
+	/// a fixed 200 OK response for the method, echoing the CSeq.
+	/// It runs inside the client's send call, so the response is
+	/// waiting by the time the client reads it.
+{
+public:
+	CannedServer():
+		_requests(0)
+	{
+	}
+
+	void onReceive(RTSPPipeTransport& transport)
+	{
+		char buffer[4096];
+		while (transport.available() > 0)
+		{
+			int n = transport.receiveBytes(buffer, sizeof(buffer), Timespan());
+			_pending.append(buffer, n);
+		}
+
+		std::string::size_type end;
+		while ((end = _pending.find("\r\n\r\n")) != std::string::npos)
+		{
+			respond(transport, end);
+			_pending.erase(0, end + 4);
+			++_requests;
+		}
+	}
+
+	int requests() const
+	{
+		return _requests;
+	}
+
+private:
+	void respond(RTSPPipeTransport& transport, std::string::size_type end)
+	{
+		std::string::size_type pos = _pending.find("CSeq: ");
+		std::string::size_type eol = _pending.find("\r\n", pos);
+		_cSeq.assign(_pending, pos + 6, eol - pos - 6);
+
+		_response.assign("RTSP/1.0 200 OK\r\nCSeq: ");
+		_response.append(_cSeq);
+		if (0 == _pending.compare(0, 7, "OPTIONS"))
+		{
+			_response.append("\r\nPublic: OPTIONS, DESCRIBE, SETUP, PLAY, TEARDOWN\r\n\r\n");
+		}
+		else if (0 == _pending.compare(0, 8, "DESCRIBE"))
+		{
+			char length[32];
+			std::sprintf(length, "%d", (int) sizeof(SDP) - 1);
+			_response.append("\r\nContent-Type: application/sdp\r\nContent-Length: ");
+			_response.append(length);
+			_response.append("\r\n\r\n");
+			_response.append(SDP, sizeof(SDP) - 1);
+		}
+		else if (0 == _pending.compare(0, 5, "SETUP"))
+		{
+			_response.append("\r\nSession: 12345678;timeout=60\r\nTransport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n\r\n");
+		}
+		else
+		{
+			_response.append("\r\nSession: 12345678\r\nRTP-Info: url=rtsp://camera.example/stream/track1;seq=1;rtptime=0\r\n\r\n");
+		}
+		transport.sendBytes(_response.data(), (int) _response.size(), Timespan());
+	}
+
+	std::string _pending;
+	std::string _cSeq;
+	std::string _response;
+	int         _requests;
+};
+
+
+int exchange(RTSPClientSession& session, RTSPRequest& request, RTSPResponse& response)
+	/// Sends the request, reads the response including its
+	/// body and returns the response status.
+{
+	session.sendRequest(request);
+	std::istream& rs = session.receiveResponse(response);
+	rs.ignore(std::numeric_limits<std::streamsize>::max());
+	return response.getStatus();
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	int rounds = argc > 1 ? NumberParser::parse(argv[1]) : 250000;
+
+	try
+	{
+		RTSPVirtualClock clock;
+		RTSPPipeTransport::Ptr pClientEnd;
+		RTSPPipeTransport::Ptr pServerEnd;
+		RTSPPipeTransport::createPair(pClientEnd, pServerEnd, &clock);
+
+		CannedServer server;
+		pServerEnd->setHandler(&server);
+
+		RTSPClientSession session;
+		session.setTransport(pClientEnd);
+		session.setLatencyRecorder(NULL);
+
+		RTSPRequest options(RTSPRequest::RTSP_OPTIONS, URI);
+		RTSPRequest describe(RTSPRequest::RTSP_DESCRIBE, URI);
+		describe.set("Accept", "application/sdp");
+		RTSPRequest setup(RTSPRequest::RTSP_SETUP, std::string(URI) + "/track1");
+		setup.set("Transport", "RTP/AVP/TCP;unicast;interleaved=0-1");
+		RTSPRequest play(RTSPRequest::RTSP_PLAY, URI);
+		play.set("Session", "12345678");
+		play.set("Range", "npt=0.000-");
+		RTSPResponse response;
+
+		std::cout << rounds << " rounds of OPTIONS, DESCRIBE, SETUP and PLAY over an in-memory pipe" << std::endl;
+
+		long failed = 0;
+		Stopwatch sw;
+		sw.start();
+		for (int i = 0; i < rounds; ++i)
+		{
+			failed += exchange(session, options,  response) != RTSPResponse::RTSP_OK;
+			failed += exchange(session, describe, response) != RTSPResponse::RTSP_OK;
+			failed += exchange(session, setup,    response) != RTSPResponse::RTSP_OK;
+			failed += exchange(session, play,     response) != RTSPResponse::RTSP_OK;
+		}
+		sw.stop();
+
+		double exchanges = 4.0 * rounds;
+		std::cout << "exchanges:   " << server.requests() << " (" << failed << " failed)" << std::endl;
+		std::cout << "throughput:  " << (long) (exchanges * 1000000.0 / (double) sw.elapsed()) << " exchanges/s" << std::endl;
+		std::cout << "latency:     " << (long) ((double) sw.elapsed() * 1000.0 / exchanges) << " ns/exchange" << std::endl;
+
+		// without an answer the receive times out on the virtual
+		// clock at once instead of waiting for the session timeout
+		pServerEnd->setHandler(NULL);
+		session.setTimeout(Timespan(30, 0));
+		Stopwatch timeoutWatch;
+		timeoutWatch.start();
+		try
+		{
+			exchange(session, options, response);
+			std::cerr << "expected a timeout" << std::endl;
+			return 1;
+		}
+		catch (Poco::TimeoutException&)
+		{
+		}
+		timeoutWatch.stop();
+		std::cout << "timeout:     " << clock.elapsed(Poco::Timestamp(0)).totalSeconds() << " s on the virtual clock, "
+		          << timeoutWatch.elapsed() << " us real" << std::endl;
+
+		return failed > 0 ? 1 : 0;
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,245 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	Packet Pool Benchmark
+//
+//	description:
+//		compares RTP::RTPPacketPool buffers with a malloc() and copy
+//		per packet, for one receiver and for a fan-out
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Poco/NumberParser.h"
+#include "Poco/Stopwatch.h"
+
+#include "RTPPacketPool.h"
+
+
+using Poco::NumberParser;
+using Poco::Stopwatch;
+using Poco::UInt8;
+
+using RTP::RTPPacketBuffer;
+using RTP::RTPPacketPool;
+
+
+namespace {
+
+
+enum
+{
+	PACKET_SIZE = 1200,
+	BATCH       = 1024,  // packets per run
+	WINDOW      = 256    // packets held at a time, as by a jitter buffer
+};
+
+
+class Benchmark
+	/// Receives BATCH packets into buffers that are handed to
+	/// fanOut holders and released WINDOW packets later, the way
+	/// a jitter buffer and the senders of a relay hold them.
+{
+public:
+	Benchmark(const std::string& name, std::size_t fanOut):
+		_name(name),
+		_fanOut(fanOut),
+		_datagram(PACKET_SIZE, 0x5a)
+	{
+	}
+
+	virtual ~Benchmark()
+	{
+	}
+
+	const std::string& name() const
+	{
+		return _name;
+	}
+
+	virtual void run() = 0;
+
+protected:
+	std::string        _name;
+	std::size_t        _fanOut;
+	std::vector<UInt8> _datagram;  /// stands in for the socket
+};
+
+
+class Copy: public Benchmark
+	/// Every holder gets its own copy of the packet from malloc().
+{
+public:
+	Copy(std::size_t fanOut):
+		Benchmark("malloc() and copy", fanOut),
+		_held(WINDOW * fanOut, 0)
+	{
+	}
+
+	~Copy()
+	{
+		for (std::size_t i = 0; i < _held.size(); ++i)
+		{
+			std::free(_held[i]);
+		}
+	}
+
+	void run()
+	{
+		for (std::size_t i = 0; i < BATCH; ++i)
+		{
+			UInt8* pReceived = static_cast<UInt8*>(std::malloc(PACKET_SIZE));
+			std::memcpy(pReceived, &_datagram[0], PACKET_SIZE);
+			for (std::size_t h = 0; h < _fanOut; ++h)
+			{
+				void*& held = _held[(i % WINDOW) * _fanOut + h];
+				std::free(held);
+				held = std::malloc(PACKET_SIZE);
+				std::memcpy(held, pReceived, PACKET_SIZE);
+			}
+			std::free(pReceived);
+		}
+	}
+
+private:
+	std::vector<void*> _held;
+};
+
+
+class Pooled: public Benchmark
+	/// The packet is received into a pool buffer, which every
+	/// holder references.
+{
+public:
+	Pooled(RTPPacketPool& pool, std::size_t fanOut):
+		Benchmark("RTPPacketPool", fanOut),
+		_pool(pool),
+		_held(WINDOW * fanOut)
+	{
+	}
+
+	void run()
+	{
+		for (std::size_t i = 0; i < BATCH; ++i)
+		{
+			RTPPacketBuffer::Ptr pBuffer = _pool.allocate(PACKET_SIZE);
+			std::memcpy(pBuffer->data(), &_datagram[0], PACKET_SIZE);
+			for (std::size_t h = 0; h < _fanOut; ++h)
+			{
+				_held[(i % WINDOW) * _fanOut + h] = pBuffer;
+			}
+		}
+	}
+
+private:
+	RTPPacketPool&                    _pool;
+	std::vector<RTPPacketBuffer::Ptr> _held;
+};
+
+
+void measure(Benchmark& benchmark, Poco::Timestamp::TimeDiff minTime)
+	/// Doubles the iteration count until a run takes at least
+	/// minTime microseconds, then prints the results of that run.
+{
+	benchmark.run();
+
+	long iterations = 1;
+	for (;;)
+	{
+		Stopwatch sw;
+		sw.start();
+		for (long i = 0; i < iterations; ++i)
+		{
+			benchmark.run();
+		}
+		sw.stop();
+
+		if (sw.elapsed() >= minTime)
+		{
+			double seconds = (double) sw.elapsed() / 1000000.0;
+			double packets = (double) BATCH * (double) iterations;
+			std::printf("%-24s %12.0f packets/s %8.1f ns/packet\n",
+				benchmark.name().c_str(),
+				packets / seconds,
+				seconds * 1000000000.0 / packets);
+			return;
+		}
+		iterations *= 2;
+	}
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Poco::Timestamp::TimeDiff minTime = (argc > 1 ? NumberParser::parse(argv[1]) : 500) * 1000;
+	std::size_t fanOut = argc > 2 ? NumberParser::parseUnsigned(argv[2]) : 4;
+
+	try
+	{
+		RTPPacketPool pool;
+		const std::size_t fanOuts[] = { 1, fanOut };
+		for (std::size_t i = 0; i < sizeof(fanOuts) / sizeof(fanOuts[0]); ++i)
+		{
+			std::printf("%lu byte packets, %lu holders each, one thread\n", (unsigned long) PACKET_SIZE, (unsigned long) fanOuts[i]);
+			Copy copy(fanOuts[i]);
+			measure(copy, minTime);
+			{
+				Pooled pooled(pool, fanOuts[i]);
+				measure(pooled, minTime);
+			}
+		}
+
+		RTPPacketPool::Statistics statistics = pool.statistics();
+		std::printf("pool: %lu slabs, %lu bytes, peak %lu bytes in use\n",
+			(unsigned long) statistics.slabs,
+			(unsigned long) statistics.slabBytes,
+			(unsigned long) statistics.peakBytesInUse);
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	return 0;
+}
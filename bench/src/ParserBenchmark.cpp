@@ -0,0 +1,487 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	RTSP Parser Benchmark
+//
+//	description:
+//		measures ns/op, allocations per operation and throughput of
+//		RTSP message parsing and writing and of SDP parsing
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Poco/CountingStream.h"
+#include "Poco/MemoryStream.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
+#include "Poco/Stopwatch.h"
+
+#include "RTSPRequest.h"
+#include "RTSPResponse.h"
+
+#include "FieldFactory.h"
+#include "SessionDescription.h"
+
+
+using Poco::CountingOutputStream;
+using Poco::MemoryInputStream;
+using Poco::NumberFormatter;
+using Poco::NumberParser;
+using Poco::Stopwatch;
+
+using RTSP::RTSPRequest;
+using RTSP::RTSPResponse;
+
+
+//
+// Every heap allocation of the process is counted,
+// which is what allocs/op is derived from.
+//
+
+namespace {
+
+unsigned long allocations = 0;
+
+}
+
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	void* p = std::malloc(size > 0 ? size : 1);
+	if (NULL == p)
+		throw std::bad_alloc();
+	return p;
+}
+
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+
+void operator delete(void* p) throw()
+{
+	std::free(p);
+}
+
+
+void operator delete[](void* p) throw()
+{
+	std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) throw()
+{
+	std::free(p);
+}
+
+
+void operator delete[](void* p, std::size_t) throw()
+{
+	std::free(p);
+}
+
+
+namespace {
+
+
+const char SESSION_HEADER[] =
+	"v=0\r\n"
+	"o=- 1700000000 1 IN IP4 192.168.1.64\r\n"
+	"s=Media Presentation\r\n"
+	"i=Camera 01\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"b=AS:5100\r\n"
+	"t=0 0\r\n"
+	"a=control:rtsp://192.168.1.64:554/Streaming/Channels/101/\r\n"
+	"a=range:npt=now-\r\n";
+
+const char* const MEDIA_SECTIONS[] =
+{
+	"m=video 0 RTP/AVP 96\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"b=AS:5000\r\n"
+	"a=recvonly\r\n"
+	"a=x-dimensions:1920,1080\r\n"
+	"a=framerate:25.000000\r\n"
+	"a=rtpmap:96 H264/90000\r\n"
+	"a=fmtp:96 profile-level-id=420029; packetization-mode=1; sprop-parameter-sets=Z01AKI2NQDwBE/LCAAAOEAACvyAI,aO44gA==\r\n",
+
+	"m=audio 0 RTP/AVP 0\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"b=AS:50\r\n"
+	"a=recvonly\r\n"
+	"a=rtpmap:0 PCMU/8000\r\n",
+
+	"m=application 0 RTP/AVP 107\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"b=AS:50\r\n"
+	"a=recvonly\r\n"
+	"a=rtpmap:107 vnd.onvif.metadata/90000\r\n",
+
+	"m=video 0 RTP/AVP 98\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"b=AS:1000\r\n"
+	"a=recvonly\r\n"
+	"a=x-dimensions:640,360\r\n"
+	"a=rtpmap:98 H265/90000\r\n"
+	"a=fmtp:98 sprop-vps=QAEMAf//AWAAAAMAAAMAAAMAAAMAlqwJ; sprop-sps=QgEBAWAAAAMAAAMAAAMAAAMAlqAFAgF8WSrkk0; sprop-pps=RAHA8vA8kA==\r\n",
+
+	"m=audio 0 RTP/AVP 97\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"b=AS:64\r\n"
+	"a=recvonly\r\n"
+	"a=rtpmap:97 MPEG4-GENERIC/16000/1\r\n"
+	"a=fmtp:97 streamtype=5; profile-level-id=15; mode=AAC-hbr; config=1408; sizelength=13; indexlength=3; indexdeltalength=3\r\n",
+
+	"m=audio 0 RTP/AVP 0\r\n"
+	"c=IN IP4 0.0.0.0\r\n"
+	"a=sendonly\r\n"
+	"a=rtpmap:0 PCMU/8000\r\n"
+};
+
+const char SETUP_RESPONSE[] =
+	"RTSP/1.0 200 OK\r\n"
+	"CSeq: 4\r\n"
+	"Session: 1273222112;timeout=60\r\n"
+	"Transport: RTP/AVP/TCP;unicast;interleaved=0-1;ssrc=5E2A3B11;mode=\"play\"\r\n"
+	"Date: Mon, 19 Oct 2026 10:15:32 GMT\r\n"
+	"Server: Camera RTSP Server\r\n"
+	"Cache-Control: no-cache\r\n"
+	"\r\n";
+
+const char PLAY_RESPONSE[] =
+	"RTSP/1.0 200 OK\r\n"
+	"CSeq: 5\r\n"
+	"Session: 1273222112\r\n"
+	"RTP-Info: url=rtsp://192.168.1.64:554/Streaming/Channels/101/trackID=1;seq=24321;rtptime=3284617251,"
+	"url=rtsp://192.168.1.64:554/Streaming/Channels/101/trackID=2;seq=1201;rtptime=1911602477\r\n"
+	"Range: npt=now-\r\n"
+	"Date: Mon, 19 Oct 2026 10:15:32 GMT\r\n"
+	"Server: Camera RTSP Server\r\n"
+	"\r\n";
+
+const char DESCRIBE_RESPONSE[] =
+	"RTSP/1.0 200 OK\r\n"
+	"CSeq: 3\r\n"
+	"Content-Type: application/sdp\r\n"
+	"Content-Base: rtsp://192.168.1.64:554/Streaming/Channels/101/\r\n"
+	"Content-Length: 1021\r\n"
+	"Date: Mon, 19 Oct 2026 10:15:32 GMT\r\n"
+	"Server: Camera RTSP Server\r\n"
+	"\r\n";
+
+const char CONTROL_URI[] = "rtsp://192.168.1.64:554/Streaming/Channels/101/";
+const char USER_AGENT[]  = "RTSP SDK parser benchmark";
+
+
+std::string cameraSDP(int media)
+	/// Returns a camera session description with the
+	/// given number of media sections.
+{
+	const int sections = (int) (sizeof(MEDIA_SECTIONS) / sizeof(MEDIA_SECTIONS[0]));
+	std::string sdp(SESSION_HEADER);
+	for (int i = 0; i < media; ++i)
+	{
+		sdp.append(MEDIA_SECTIONS[i % sections]);
+		sdp.append("a=control:trackID=");
+		sdp.append(NumberFormatter::format(i + 1));
+		sdp.append("\r\n");
+	}
+	return sdp;
+}
+
+
+class Benchmark
+	/// One measured operation.
+{
+public:
+	explicit Benchmark(const std::string& name):
+		_name(name)
+	{
+	}
+
+	virtual ~Benchmark()
+	{
+	}
+
+	const std::string& name() const
+	{
+		return _name;
+	}
+
+	virtual std::size_t bytes() const = 0;
+		/// Returns the number of message bytes
+		/// consumed or produced by one operation.
+
+	virtual void run() = 0;
+		/// Performs the operation once.
+
+private:
+	std::string _name;
+};
+
+
+class ResponseRead: public Benchmark
+	/// RTSPResponse::read() of a response header.
+{
+public:
+	ResponseRead(const std::string& name, const std::string& text):
+		Benchmark(name),
+		_text(text)
+	{
+	}
+
+	std::size_t bytes() const
+	{
+		return _text.size();
+	}
+
+	void run()
+	{
+		MemoryInputStream istr(_text.data(), (std::streamsize) _text.size());
+		_response.clear();
+		_response.read(istr);
+	}
+
+private:
+	std::string  _text;
+	RTSPResponse _response;
+};
+
+
+template <class M>
+class MessageWrite: public Benchmark
+	/// RTSPRequest::write() or RTSPResponse::write(), the
+	/// RTSPMessage serialization of a complete header.
+{
+public:
+	MessageWrite(const std::string& name, const M& message):
+		Benchmark(name),
+		_message(message)
+	{
+		_message.write(_ostr);
+		_bytes = _ostr.chars();
+	}
+
+	std::size_t bytes() const
+	{
+		return _bytes;
+	}
+
+	void run()
+	{
+		_ostr.reset();
+		_message.write(_ostr);
+	}
+
+private:
+	const M&             _message;
+	CountingOutputStream _ostr;
+	std::size_t          _bytes;
+};
+
+
+class SDPParse: public Benchmark
+	/// SessionDescription(const std::string&) of a full description.
+{
+public:
+	SDPParse(const std::string& name, const std::string& text):
+		Benchmark(name),
+		_text(text)
+	{
+	}
+
+	std::size_t bytes() const
+	{
+		return _text.size();
+	}
+
+	void run()
+	{
+		SDP::SessionDescription description(_text);
+	}
+
+private:
+	std::string _text;
+};
+
+
+class FieldCreate: public Benchmark
+	/// FieldFactory::CreateInstance() of the lines of a
+	/// description, one line per operation.
+{
+public:
+	FieldCreate(const std::string& name, const std::string& text):
+		Benchmark(name),
+		_next(0),
+		_bytes(0)
+	{
+		std::string::size_type pos = 0;
+		std::string::size_type end;
+		while ((end = text.find("\r\n", pos)) != std::string::npos)
+		{
+			_lines.push_back(text.substr(pos, end - pos));
+			_bytes += end - pos;
+			pos = end + 2;
+		}
+		_bytes /= _lines.size();
+	}
+
+	std::size_t bytes() const
+	{
+		return _bytes;
+	}
+
+	void run()
+	{
+		SDP::Field* pField = SDP::FieldFactory::CreateInstance(_lines[_next]);
+		SDP::FieldFactory::DestroyInstance(pField);
+		if (++_next == _lines.size())
+			_next = 0;
+	}
+
+private:
+	std::vector<std::string> _lines;
+	std::size_t              _next;
+	std::size_t              _bytes;
+};
+
+
+void measure(Benchmark& benchmark, Poco::Timestamp::TimeDiff minTime)
+	/// Doubles the iteration count until a run takes at least
+	/// minTime microseconds, then prints the results of that run.
+{
+	benchmark.run();
+
+	long iterations = 16;
+	for (;;)
+	{
+		unsigned long allocationsBefore = allocations;
+		Stopwatch sw;
+		sw.start();
+		for (long i = 0; i < iterations; ++i)
+		{
+			benchmark.run();
+		}
+		sw.stop();
+		unsigned long runAllocations = allocations - allocationsBefore;
+
+		if (sw.elapsed() >= minTime)
+		{
+			double seconds = (double) sw.elapsed() / 1000000.0;
+			std::printf("%-28s %10.1f ns/op %8.2f allocs/op %9.1f MB/s\n",
+				benchmark.name().c_str(),
+				seconds * 1000000000.0 / (double) iterations,
+				(double) runAllocations / (double) iterations,
+				(double) benchmark.bytes() * (double) iterations / seconds / 1000000.0);
+			return;
+		}
+		iterations *= 2;
+	}
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Poco::Timestamp::TimeDiff minTime = (argc > 1 ? NumberParser::parse(argv[1]) : 500) * 1000;
+
+	std::vector<Benchmark*> benchmarks;
+	try
+	{
+		benchmarks.push_back(new ResponseRead("RTSPResponse::read SETUP", SETUP_RESPONSE));
+		benchmarks.push_back(new ResponseRead("RTSPResponse::read PLAY", PLAY_RESPONSE));
+		benchmarks.push_back(new ResponseRead("RTSPResponse::read DESCRIBE", DESCRIBE_RESPONSE));
+
+		RTSPRequest setup(RTSPRequest::RTSP_SETUP, std::string(CONTROL_URI) + "trackID=1");
+		setup.set("CSeq", "4");
+		setup.set("User-Agent", USER_AGENT);
+		setup.set("Transport", "RTP/AVP/TCP;unicast;interleaved=0-1");
+		RTSPRequest play(RTSPRequest::RTSP_PLAY, CONTROL_URI);
+		play.set("CSeq", "5");
+		play.set("User-Agent", USER_AGENT);
+		play.set("Session", "1273222112");
+		play.set("Range", "npt=0.000-");
+		RTSPResponse setupResponse(RTSPResponse::RTSP_OK);
+		setupResponse.set("CSeq", "4");
+		setupResponse.set("Session", "1273222112;timeout=60");
+		setupResponse.set("Transport", "RTP/AVP/TCP;unicast;interleaved=0-1;ssrc=5E2A3B11;mode=\"play\"");
+		setupResponse.set("Server", "Camera RTSP Server");
+		benchmarks.push_back(new MessageWrite<RTSPRequest>("RTSPRequest::write SETUP", setup));
+		benchmarks.push_back(new MessageWrite<RTSPRequest>("RTSPRequest::write PLAY", play));
+		benchmarks.push_back(new MessageWrite<RTSPResponse>("RTSPResponse::write SETUP", setupResponse));
+
+		for (int media = 2; media <= 8; media *= 2)
+		{
+			benchmarks.push_back(new SDPParse("SessionDescription " + NumberFormatter::format(media) + " media", cameraSDP(media)));
+		}
+		benchmarks.push_back(new FieldCreate("FieldFactory::CreateInstance", cameraSDP(8)));
+
+		for (std::size_t i = 0; i < benchmarks.size(); ++i)
+		{
+			measure(*benchmarks[i], minTime);
+		}
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	catch (Poco::Exception* pExc)
+	{
+		// the SDP parser throws exceptions by pointer
+		std::cerr << pExc->displayText() << std::endl;
+		delete pExc;
+		return 1;
+	}
+
+	for (std::size_t i = 0; i < benchmarks.size(); ++i)
+	{
+		delete benchmarks[i];
+	}
+	return 0;
+}
@@ -0,0 +1,349 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	RTP Packet Benchmark
+//
+//	description:
+//		measures the cost per packet of validating RTP packets
+//		and reading their header fields with RTP::RTPPacket
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Poco/NumberParser.h"
+#include "Poco/Stopwatch.h"
+
+#include "RTPPacket.h"
+
+
+using Poco::NumberParser;
+using Poco::Stopwatch;
+using Poco::UInt8;
+using Poco::UInt32;
+
+using RTP::RTPPacket;
+
+
+namespace {
+
+
+volatile std::size_t sink;
+	// keeps the optimizer from dropping the measured work
+
+
+class PacketSet
+	/// A set of packets resembling the receive queue of a video
+	/// stream: mostly plain packets of MTU size, some with CSRCs,
+	/// header extensions or padding, and a few invalid ones.
+{
+public:
+	explicit PacketSet(std::size_t count):
+		_storage(count * SLOT),
+		_buffers(count),
+		_lengths(count),
+		_bytes(0)
+	{
+		UInt32 random = 0x2545f491;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+
+			UInt8* p = &_storage[i * SLOT];
+			std::size_t payload = 200 + random % 1200;
+			unsigned kind = random % 100;
+			int csrcs = kind >= 80 && kind < 85 ? 2 : 0;
+			bool extension = kind >= 85 && kind < 93;
+			bool padding = kind >= 93 && kind < 97;
+
+			p[0] = (UInt8) (0x80 | (padding ? 0x20 : 0) | (extension ? 0x10 : 0) | csrcs);
+			p[1] = (UInt8) ((i % 8 == 7 ? 0x80 : 0) | 96);
+			p[2] = (UInt8) (i >> 8);
+			p[3] = (UInt8) i;
+			std::memset(p + 4, 0x11, 8);
+			std::size_t length = 12 + 4 * csrcs;
+			if (extension)
+			{
+				// one-byte header extension (RFC 8285) with one word
+				p[length] = 0xbe;
+				p[length + 1] = 0xde;
+				p[length + 2] = 0;
+				p[length + 3] = 1;
+				length += 8;
+			}
+			std::memset(p + length, 0x5a, payload);
+			length += payload;
+			if (padding)
+			{
+				std::memset(p + length, 0, 3);
+				p[length + 3] = 4;
+				length += 4;
+			}
+			if (kind >= 97)
+			{
+				// invalid: version 1 or truncated
+				if (kind == 97)
+					p[0] = (UInt8) ((p[0] & 0x3f) | 0x40);
+				else
+					length = 7;
+			}
+
+			_buffers[i] = p;
+			_lengths[i] = length;
+			_bytes += length;
+		}
+	}
+
+	std::size_t count() const
+	{
+		return _buffers.size();
+	}
+
+	std::size_t bytes() const
+	{
+		return _bytes;
+	}
+
+	const void* const* buffers() const
+	{
+		return &_buffers[0];
+	}
+
+	const std::size_t* lengths() const
+	{
+		return &_lengths[0];
+	}
+
+private:
+	enum
+	{
+		SLOT = 1500
+	};
+
+	std::vector<UInt8>       _storage;
+	std::vector<const void*> _buffers;
+	std::vector<std::size_t> _lengths;
+	std::size_t              _bytes;
+};
+
+
+class Benchmark
+	/// One measured pass over a PacketSet.
+{
+public:
+	Benchmark(const std::string& name, const PacketSet& packets):
+		_name(name),
+		_packets(packets),
+		_views(packets.count())
+	{
+	}
+
+	virtual ~Benchmark()
+	{
+	}
+
+	const std::string& name() const
+	{
+		return _name;
+	}
+
+	const PacketSet& packets() const
+	{
+		return _packets;
+	}
+
+	virtual void run() = 0;
+		/// Processes all packets of the set once.
+
+protected:
+	std::string            _name;
+	const PacketSet&       _packets;
+	std::vector<RTPPacket> _views;
+};
+
+
+class Parse: public Benchmark
+	/// RTPPacket::parse() of every packet.
+{
+public:
+	explicit Parse(const PacketSet& packets):
+		Benchmark("RTPPacket::parse", packets)
+	{
+	}
+
+	void run()
+	{
+		std::size_t valid = 0;
+		for (std::size_t i = 0; i < _packets.count(); ++i)
+		{
+			valid += _views[i].parse(_packets.buffers()[i], _packets.lengths()[i]);
+		}
+		sink = valid;
+	}
+};
+
+
+class ParseBatch: public Benchmark
+	/// RTPPacket::parseBatch() of all packets.
+{
+public:
+	explicit ParseBatch(const PacketSet& packets):
+		Benchmark("RTPPacket::parseBatch", packets)
+	{
+	}
+
+	void run()
+	{
+		sink = RTPPacket::parseBatch(_packets.buffers(), _packets.lengths(), _packets.count(), &_views[0]);
+	}
+};
+
+
+class ParseAndRead: public Benchmark
+	/// parseBatch() followed by reading the fields
+	/// a jitter buffer needs.
+{
+public:
+	explicit ParseAndRead(const PacketSet& packets):
+		Benchmark("parseBatch + header fields", packets)
+	{
+	}
+
+	void run()
+	{
+		RTPPacket::parseBatch(_packets.buffers(), _packets.lengths(), _packets.count(), &_views[0]);
+		std::size_t sum = 0;
+		for (std::size_t i = 0; i < _views.size(); ++i)
+		{
+			const RTPPacket& packet = _views[i];
+			if (packet.valid())
+			{
+				sum += packet.sequenceNumber() + packet.timestamp() + packet.ssrc() + packet.marker() + packet.payloadSize();
+			}
+		}
+		sink = sum;
+	}
+};
+
+
+class Validate: public Benchmark
+	/// RTPPacket::validate(), the diagnostic path.
+{
+public:
+	explicit Validate(const PacketSet& packets):
+		Benchmark("RTPPacket::validate", packets)
+	{
+	}
+
+	void run()
+	{
+		std::size_t valid = 0;
+		for (std::size_t i = 0; i < _packets.count(); ++i)
+		{
+			valid += RTPPacket::validate(_packets.buffers()[i], _packets.lengths()[i]) == RTPPacket::RTP_VALID;
+		}
+		sink = valid;
+	}
+};
+
+
+void measure(Benchmark& benchmark, Poco::Timestamp::TimeDiff minTime)
+	/// Doubles the iteration count until a run takes at least
+	/// minTime microseconds, then prints the results of that run.
+{
+	benchmark.run();
+
+	long iterations = 16;
+	for (;;)
+	{
+		Stopwatch sw;
+		sw.start();
+		for (long i = 0; i < iterations; ++i)
+		{
+			benchmark.run();
+		}
+		sw.stop();
+
+		if (sw.elapsed() >= minTime)
+		{
+			double seconds = (double) sw.elapsed() / 1000000.0;
+			double packets = (double) benchmark.packets().count() * (double) iterations;
+			std::printf("%-28s %8.2f ns/packet %8.1f Mpps %9.1f MB/s\n",
+				benchmark.name().c_str(),
+				seconds * 1000000000.0 / packets,
+				packets / seconds / 1000000.0,
+				(double) benchmark.packets().bytes() * (double) iterations / seconds / 1000000.0);
+			return;
+		}
+		iterations *= 2;
+	}
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Poco::Timestamp::TimeDiff minTime = (argc > 1 ? NumberParser::parse(argv[1]) : 500) * 1000;
+	std::size_t count = argc > 2 ? NumberParser::parseUnsigned(argv[2]) : 1024;
+
+	try
+	{
+		PacketSet packets(count);
+		std::printf("%lu packets, %lu bytes\n", (unsigned long) packets.count(), (unsigned long) packets.bytes());
+
+		Parse parse(packets);
+		ParseBatch parseBatch(packets);
+		ParseAndRead parseAndRead(packets);
+		Validate validate(packets);
+		measure(parse, minTime);
+		measure(parseBatch, minTime);
+		measure(parseAndRead, minTime);
+		measure(validate, minTime);
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,274 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	SRTP Benchmark
+//
+//	description:
+//		measures packets/s on one core of protecting and unprotecting
+//		RTP packets with each RTP::RTPCryptoContext suite
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Poco/NumberParser.h"
+#include "Poco/Stopwatch.h"
+
+#include "RTPCryptoContext.h"
+
+
+using Poco::NumberParser;
+using Poco::Stopwatch;
+using Poco::UInt8;
+
+using RTP::RTPCryptoContext;
+
+
+namespace {
+
+
+enum
+{
+	HEADER_SIZE = 12,
+	BATCH       = 4096,  // packets per run
+	STRIDE      = 1536   // bytes per packet buffer
+};
+
+
+std::string masterKey(RTPCryptoContext::Suite suite)
+{
+	return std::string(suite == RTPCryptoContext::AEAD_AES_256_GCM ? 32 : 16, '\x2b');
+}
+
+
+std::string masterSalt(RTPCryptoContext::Suite suite)
+{
+	bool gcm = suite == RTPCryptoContext::AEAD_AES_128_GCM || suite == RTPCryptoContext::AEAD_AES_256_GCM;
+	return std::string(gcm ? 12 : 14, '\x5a');
+}
+
+
+void makePacket(UInt8* packet, Poco::UInt16 sequenceNumber, std::size_t payloadSize)
+{
+	std::memset(packet, 0xa5, HEADER_SIZE + payloadSize);
+	packet[0] = 0x80;
+	packet[1] = 96;
+	packet[2] = (UInt8) (sequenceNumber >> 8);
+	packet[3] = (UInt8) sequenceNumber;
+	packet[8] = 0xca;
+	packet[9] = 0xfe;
+	packet[10] = 0xba;
+	packet[11] = 0xbe;
+}
+
+
+class Benchmark
+{
+public:
+	Benchmark(RTPCryptoContext::Suite suite, const std::string& direction, std::size_t payloadSize):
+		_name(RTPCryptoContext::suiteName(suite) + " " + direction),
+		_suite(suite),
+		_payloadSize(payloadSize),
+		_buffer(BATCH * STRIDE)
+	{
+	}
+
+	virtual ~Benchmark()
+	{
+	}
+
+	const std::string& name() const
+	{
+		return _name;
+	}
+
+	std::size_t payloadSize() const
+	{
+		return _payloadSize;
+	}
+
+	virtual void run() = 0;
+		/// Processes BATCH packets.
+
+protected:
+	std::string             _name;
+	RTPCryptoContext::Suite _suite;
+	std::size_t             _payloadSize;
+	std::vector<UInt8>      _buffer;
+};
+
+
+class Protect: public Benchmark
+	/// Protects consecutive packets of one stream, as a sender does.
+	/// Each packet is rewritten first, which costs little next to
+	/// the encryption.
+{
+public:
+	Protect(RTPCryptoContext::Suite suite, std::size_t payloadSize):
+		Benchmark(suite, "protect", payloadSize),
+		_context(suite, masterKey(suite), masterSalt(suite)),
+		_sequenceNumber(0)
+	{
+	}
+
+	void run()
+	{
+		for (std::size_t i = 0; i < BATCH; ++i)
+		{
+			UInt8* packet = &_buffer[i * STRIDE];
+			makePacket(packet, _sequenceNumber++, _payloadSize);
+			_context.protectRTP(packet, HEADER_SIZE + _payloadSize, STRIDE);
+		}
+	}
+
+private:
+	RTPCryptoContext _context;
+	Poco::UInt16     _sequenceNumber;
+};
+
+
+class Unprotect: public Benchmark
+	/// Unprotects BATCH packets protected in advance, with a new
+	/// context every run so that the replay window accepts them.
+{
+public:
+	Unprotect(RTPCryptoContext::Suite suite, std::size_t payloadSize):
+		Benchmark(suite, "unprotect", payloadSize),
+		_protected(BATCH * STRIDE),
+		_sizes(BATCH)
+	{
+		RTPCryptoContext sender(suite, masterKey(suite), masterSalt(suite));
+		for (std::size_t i = 0; i < BATCH; ++i)
+		{
+			UInt8* packet = &_protected[i * STRIDE];
+			makePacket(packet, (Poco::UInt16) i, _payloadSize);
+			_sizes[i] = sender.protectRTP(packet, HEADER_SIZE + _payloadSize, STRIDE);
+		}
+	}
+
+	void run()
+	{
+		RTPCryptoContext receiver(_suite, masterKey(_suite), masterSalt(_suite));
+		std::memcpy(&_buffer[0], &_protected[0], _buffer.size());
+		for (std::size_t i = 0; i < BATCH; ++i)
+		{
+			std::size_t size = _sizes[i];
+			if (!receiver.unprotectRTP(&_buffer[i * STRIDE], size))
+			{
+				throw Poco::DataFormatException("packet not authentic", _name);
+			}
+		}
+	}
+
+private:
+	std::vector<UInt8>       _protected;
+	std::vector<std::size_t> _sizes;
+};
+
+
+void measure(Benchmark& benchmark, Poco::Timestamp::TimeDiff minTime)
+	/// Doubles the iteration count until a run takes at least
+	/// minTime microseconds, then prints the results of that run.
+{
+	benchmark.run();
+
+	long iterations = 1;
+	for (;;)
+	{
+		Stopwatch sw;
+		sw.start();
+		for (long i = 0; i < iterations; ++i)
+		{
+			benchmark.run();
+		}
+		sw.stop();
+
+		if (sw.elapsed() >= minTime)
+		{
+			double seconds = (double) sw.elapsed() / 1000000.0;
+			double packets = (double) BATCH * (double) iterations;
+			std::printf("%-36s %12.0f packets/s %8.2f Gbit/s payload\n",
+				benchmark.name().c_str(),
+				packets / seconds,
+				packets * (double) benchmark.payloadSize() * 8.0 / seconds / 1000000000.0);
+			return;
+		}
+		iterations *= 2;
+	}
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Poco::Timestamp::TimeDiff minTime = (argc > 1 ? NumberParser::parse(argv[1]) : 500) * 1000;
+	std::size_t payloadSize = argc > 2 ? NumberParser::parseUnsigned(argv[2]) : 1200;
+
+	try
+	{
+		if (HEADER_SIZE + payloadSize + RTPCryptoContext::MAX_OVERHEAD > STRIDE)
+		{
+			throw Poco::InvalidArgumentException("payload too large", argv[2]);
+		}
+		std::printf("%lu byte payloads, one thread\n", (unsigned long) payloadSize);
+
+		const RTPCryptoContext::Suite suites[] =
+		{
+			RTPCryptoContext::AES_CM_128_HMAC_SHA1_80,
+			RTPCryptoContext::AES_CM_128_HMAC_SHA1_32,
+			RTPCryptoContext::AEAD_AES_128_GCM,
+			RTPCryptoContext::AEAD_AES_256_GCM
+		};
+		for (std::size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); ++i)
+		{
+			Protect protect(suites[i], payloadSize);
+			Unprotect unprotect(suites[i], payloadSize);
+			measure(protect, minTime);
+			measure(unprotect, minTime);
+		}
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,275 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	TLS Handshake Benchmark
+//
+//	description:
+//		compares full and resumed rtsps:// handshakes against
+//		a self-signed loopback server
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include "Poco/Net/NetSSL.h"
+#include "Poco/Net/Context.h"
+#include "Poco/Net/SecureServerSocket.h"
+#include "Poco/Net/SecureStreamSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/NumberParser.h"
+#include "Poco/Runnable.h"
+#include "Poco/Stopwatch.h"
+#include "Poco/TemporaryFile.h"
+#include "Poco/Thread.h"
+
+#include "RTSPSClientSession.h"
+#include "RTSPTLSSessionCache.h"
+#include "RTSPRequest.h"
+#include "RTSPResponse.h"
+
+
+using Poco::NumberParser;
+using Poco::Runnable;
+using Poco::Stopwatch;
+using Poco::TemporaryFile;
+using Poco::Thread;
+using Poco::Net::Context;
+using Poco::Net::SecureServerSocket;
+using Poco::Net::SocketAddress;
+using Poco::Net::StreamSocket;
+
+using RTSP::RTSPRequest;
+using RTSP::RTSPResponse;
+using RTSP::RTSPSClientSession;
+using RTSP::RTSPTLSSessionCache;
+
+
+namespace {
+
+
+void createSelfSignedCertificate(const std::string& keyPath, const std::string& certPath)
+	/// Writes a RSA-2048 key and a self-signed certificate
+	/// for "localhost" to the given files.
+{
+	EVP_PKEY* pKey = NULL;
+	EVP_PKEY_CTX* pKeyCtx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+	EVP_PKEY_keygen_init(pKeyCtx);
+	EVP_PKEY_CTX_set_rsa_keygen_bits(pKeyCtx, 2048);
+	EVP_PKEY_keygen(pKeyCtx, &pKey);
+	EVP_PKEY_CTX_free(pKeyCtx);
+
+	X509* pCert = X509_new();
+	X509_set_version(pCert, 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(pCert), 1);
+	X509_gmtime_adj(X509_getm_notBefore(pCert), 0);
+	X509_gmtime_adj(X509_getm_notAfter(pCert), 86400L);
+	X509_set_pubkey(pCert, pKey);
+	X509_NAME* pName = X509_get_subject_name(pCert);
+	X509_NAME_add_entry_by_txt(pName, "CN", MBSTRING_ASC, (const unsigned char*) "localhost", -1, -1, 0);
+	X509_set_issuer_name(pCert, pName);
+	X509_sign(pCert, pKey, EVP_sha256());
+
+	FILE* pFile = std::fopen(keyPath.c_str(), "wb");
+	PEM_write_PrivateKey(pFile, pKey, NULL, NULL, 0, NULL, NULL);
+	std::fclose(pFile);
+	pFile = std::fopen(certPath.c_str(), "wb");
+	PEM_write_X509(pFile, pCert);
+	std::fclose(pFile);
+
+	X509_free(pCert);
+	EVP_PKEY_free(pKey);
+}
+
+
+class LoopbackServer: public Runnable
+	/// Accepts rtsps connections on the loopback interface and
+	/// answers a single request on each of them with 200 OK.
+{
+public:
+	LoopbackServer(Context::Ptr pContext):
+		_socket(SocketAddress("127.0.0.1", 0), 64, pContext),
+		_stop(false)
+	{
+	}
+
+	Poco::UInt16 port() const
+	{
+		return _socket.address().port();
+	}
+
+	void stop()
+	{
+		_stop = true;
+	}
+
+	void run()
+	{
+		while (!_stop)
+		{
+			if (!_socket.poll(Poco::Timespan(100000), Poco::Net::Socket::SELECT_READ))
+				continue;
+			try
+			{
+				StreamSocket ss = _socket.acceptConnection();
+				answer(ss);
+				ss.close();
+			}
+			catch (Poco::Exception& exc)
+			{
+				std::cerr << "server: " << exc.displayText() << std::endl;
+			}
+		}
+	}
+
+private:
+	void answer(StreamSocket& ss)
+	{
+		std::string request;
+		char buffer[1024];
+		while (request.find("\r\n\r\n") == std::string::npos)
+		{
+			int n = ss.receiveBytes(buffer, sizeof(buffer));
+			if (n <= 0) return;
+			request.append(buffer, n);
+		}
+
+		std::string cSeq("0");
+		std::string::size_type pos = request.find("CSeq: ");
+		if (pos != std::string::npos)
+		{
+			cSeq = request.substr(pos + 6, request.find("\r\n", pos) - pos - 6);
+		}
+		std::string response("RTSP/1.0 200 OK\r\nCSeq: ");
+		response.append(cSeq);
+		response.append("\r\nPublic: OPTIONS, DESCRIBE, SETUP, PLAY, TEARDOWN\r\n\r\n");
+		ss.sendBytes(response.data(), (int) response.size());
+	}
+
+	SecureServerSocket _socket;
+	volatile bool      _stop;
+};
+
+
+Poco::Timestamp::TimeDiff runExchanges(Context::Ptr pContext, Poco::UInt16 port, int count, bool resume, int& reused)
+	/// Performs count connect + OPTIONS exchanges and returns
+	/// the total elapsed time in microseconds.
+{
+	reused = 0;
+	Stopwatch sw;
+	for (int i = 0; i < count; ++i)
+	{
+		if (!resume)
+		{
+			RTSPTLSSessionCache::defaultCache().clear();
+		}
+
+		sw.start();
+		RTSPSClientSession session("127.0.0.1", port, pContext);
+		RTSPRequest request(RTSPRequest::RTSP_OPTIONS, "*");
+		session.sendRequest(request);
+		RTSPResponse response;
+		session.receiveResponse(response);
+		sw.stop();
+
+		if (session.sessionWasReused())
+		{
+			++reused;
+		}
+	}
+	return sw.elapsed();
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	int count = argc > 1 ? NumberParser::parse(argv[1]) : 1000;
+
+	Poco::Net::initializeSSL();
+	try
+	{
+		TemporaryFile keyFile;
+		TemporaryFile certFile;
+		createSelfSignedCertificate(keyFile.path(), certFile.path());
+
+		Context::Ptr pServerContext = new Context(Context::SERVER_USE, keyFile.path(), certFile.path(), "", Context::VERIFY_NONE);
+		pServerContext->enableSessionCache(true, "rtsp_sdk-bench");
+		Context::Ptr pClientContext = new Context(Context::CLIENT_USE, "", "", "", Context::VERIFY_NONE);
+		pClientContext->enableSessionCache(true);
+
+		LoopbackServer server(pServerContext);
+		Thread thread;
+		thread.start(server);
+
+		int reused = 0;
+		runExchanges(pClientContext, server.port(), 10, true, reused);
+
+		Poco::Timestamp::TimeDiff full = runExchanges(pClientContext, server.port(), count, false, reused);
+		std::cout << "full handshake:    " << count << " connects, "
+		          << (double) full / count << " us/connect, "
+		          << reused << " resumed" << std::endl;
+
+		Poco::Timestamp::TimeDiff resumed = runExchanges(pClientContext, server.port(), count, true, reused);
+		std::cout << "resumed handshake: " << count << " connects, "
+		          << (double) resumed / count << " us/connect, "
+		          << reused << " resumed" << std::endl;
+
+		if (resumed > 0)
+		{
+			std::cout << "speedup:           " << (double) full / resumed << "x" << std::endl;
+		}
+
+		server.stop();
+		thread.join();
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		Poco::Net::uninitializeSSL();
+		return 1;
+	}
+	Poco::Net::uninitializeSSL();
+	return 0;
+}
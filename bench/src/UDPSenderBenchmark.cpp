@@ -0,0 +1,242 @@
+/*****************************************************************************
+//	RTSP SDK Benchmarks
+//
+//	UDP Sender Benchmark
+//
+//	description:
+//		measures packets/s on one core of fanning RTP packets out to
+//		many UDP destinations on loopback with RTP::RTPUDPSender
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Poco/NumberParser.h"
+#include "Poco/Stopwatch.h"
+#include "Poco/Net/DatagramSocket.h"
+#include "Poco/Net/SocketAddress.h"
+
+#include "RTPUDPSender.h"
+
+
+using Poco::NumberParser;
+using Poco::Stopwatch;
+using Poco::UInt8;
+using Poco::Net::DatagramSocket;
+using Poco::Net::SocketAddress;
+
+using RTP::RTPUDPSender;
+
+
+namespace {
+
+
+class Benchmark
+	/// Sends a burst of packets, like the packets of one video
+	/// frame, to every destination. The destinations are sockets
+	/// that are never read, so the kernel drops the datagrams once
+	/// their buffers are full; only the sending side is measured.
+{
+public:
+	Benchmark(const std::string& name, const std::vector<SocketAddress>& destinations, const std::vector<RTPUDPSender::Packet>& burst):
+		_name(name),
+		_destinations(destinations),
+		_burst(burst),
+		_socket(SocketAddress("127.0.0.1", 0))
+	{
+	}
+
+	virtual ~Benchmark()
+	{
+	}
+
+	const std::string& name() const
+	{
+		return _name;
+	}
+
+	std::size_t packets() const
+		/// Returns the number of datagrams sent by run().
+	{
+		return _destinations.size() * _burst.size();
+	}
+
+	virtual void run() = 0;
+		/// Sends the burst to all destinations once.
+
+protected:
+	std::string                              _name;
+	const std::vector<SocketAddress>&        _destinations;
+	const std::vector<RTPUDPSender::Packet>& _burst;
+	DatagramSocket                           _socket;
+};
+
+
+class SendTo: public Benchmark
+	/// One sendto() per packet and destination, for comparison.
+{
+public:
+	SendTo(const std::vector<SocketAddress>& destinations, const std::vector<RTPUDPSender::Packet>& burst):
+		Benchmark("sendto()", destinations, burst)
+	{
+	}
+
+	void run()
+	{
+		for (std::vector<SocketAddress>::const_iterator it = _destinations.begin(); it != _destinations.end(); ++it)
+		{
+			for (std::vector<RTPUDPSender::Packet>::const_iterator p = _burst.begin(); p != _burst.end(); ++p)
+			{
+				_socket.sendTo(p->data, (int) p->size, *it);
+			}
+		}
+	}
+};
+
+
+class Batched: public Benchmark
+	/// The burst sent with RTPUDPSender.
+{
+public:
+	Batched(const std::string& name, const std::vector<SocketAddress>& destinations, const std::vector<RTPUDPSender::Packet>& burst, bool gso):
+		Benchmark(name, destinations, burst),
+		_sender(_socket)
+	{
+		for (std::vector<SocketAddress>::const_iterator it = _destinations.begin(); it != _destinations.end(); ++it)
+		{
+			_sender.addDestination(*it);
+		}
+		_sender.setGSO(gso);
+	}
+
+	const RTPUDPSender& sender() const
+	{
+		return _sender;
+	}
+
+	void run()
+	{
+		_sender.send(&_burst[0], _burst.size());
+	}
+
+private:
+	RTPUDPSender _sender;
+};
+
+
+void measure(Benchmark& benchmark, Poco::Timestamp::TimeDiff minTime)
+	/// Doubles the iteration count until a run takes at least
+	/// minTime microseconds, then prints the results of that run.
+{
+	benchmark.run();
+
+	long iterations = 1;
+	for (;;)
+	{
+		Stopwatch sw;
+		sw.start();
+		for (long i = 0; i < iterations; ++i)
+		{
+			benchmark.run();
+		}
+		sw.stop();
+
+		if (sw.elapsed() >= minTime)
+		{
+			double seconds = (double) sw.elapsed() / 1000000.0;
+			double packets = (double) benchmark.packets() * (double) iterations;
+			std::printf("%-24s %12.0f packets/s %8.1f ns/packet\n",
+				benchmark.name().c_str(),
+				packets / seconds,
+				seconds * 1000000000.0 / packets);
+			return;
+		}
+		iterations *= 2;
+	}
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Poco::Timestamp::TimeDiff minTime = (argc > 1 ? NumberParser::parse(argv[1]) : 500) * 1000;
+	std::size_t destinationCount = argc > 2 ? NumberParser::parseUnsigned(argv[2]) : 100;
+
+	try
+	{
+		// a 20 kB frame: 1400 byte packets and a shorter last one
+		std::vector<UInt8> payload(1400, 0x5a);
+		std::vector<RTPUDPSender::Packet> burst(15);
+		for (std::size_t i = 0; i < burst.size(); ++i)
+		{
+			burst[i].data = &payload[0];
+			burst[i].size = i + 1 < burst.size() ? payload.size() : 400;
+		}
+
+		std::vector<DatagramSocket> receivers;
+		std::vector<SocketAddress> destinations;
+		for (std::size_t i = 0; i < destinationCount; ++i)
+		{
+			receivers.push_back(DatagramSocket(SocketAddress("127.0.0.1", 0)));
+			destinations.push_back(receivers.back().address());
+		}
+		std::printf("%lu destinations, %lu packets per burst, one thread\n", (unsigned long) destinations.size(), (unsigned long) burst.size());
+
+		SendTo sendTo(destinations, burst);
+		Batched batched("sendmmsg()", destinations, burst, false);
+		Batched gso("sendmmsg() with GSO", destinations, burst, true);
+		measure(sendTo, minTime);
+		measure(batched, minTime);
+		if (gso.sender().getGSO())
+		{
+			measure(gso, minTime);
+		}
+		else
+		{
+			std::printf("%-24s not supported\n", gso.name().c_str());
+		}
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,266 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTCP Packet Class
+//
+//	description:
+//		view of a RTCP packet and writers for SR, RR, SDES and BYE packets
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTCP_PACKET__H__
+#define __RTCP_PACKET__H__
+
+
+#include "Poco/Foundation.h"
+#include <cstddef>
+#include <string>
+
+#include "rtp.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTCPPacket
+	/// RTCPPacket is a read-only view of one RTCP packet (RFC 3550,
+	/// section 6.4 to 6.6) in a buffer owned by the caller.
+	///
+	/// RTCP packets are sent in compound packets. parse() views the
+	/// first packet in the given buffer; the following packet starts
+	/// size() bytes further:
+	///
+	///     RTCPPacket packet;
+	///     for (std::size_t offset = 0; packet.parse(p + offset, n - offset); offset += packet.size())
+	///     {
+	///         ...
+	///     }
+	///
+	/// validateCompound() performs the header validity checks of
+	/// RFC 3550, appendix A.2 on a whole compound packet.
+	///
+	/// The static write functions serialize the packets a RTCP
+	/// session sends. They return the number of bytes written, or
+	/// 0 if the packet does not fit into the given capacity.
+{
+public:
+	enum Type
+	{
+		RTCP_SR   = 200,
+		RTCP_RR   = 201,
+		RTCP_SDES = 202,
+		RTCP_BYE  = 203,
+		RTCP_APP  = 204
+	};
+
+	enum SDESType
+	{
+		SDES_END   = 0,
+		SDES_CNAME = 1,
+		SDES_NAME  = 2,
+		SDES_EMAIL = 3,
+		SDES_PHONE = 4,
+		SDES_LOC   = 5,
+		SDES_TOOL  = 6,
+		SDES_NOTE  = 7,
+		SDES_PRIV  = 8
+	};
+
+	enum
+	{
+		HEADER_SIZE       = 4,
+		SENDER_INFO_SIZE  = 20,
+		REPORT_BLOCK_SIZE = 24,
+		MAX_REPORT_BLOCKS = 31
+	};
+
+	struct SenderInfo
+		/// The sender information of a sender report.
+	{
+		Poco::UInt32 ssrc;
+		Poco::UInt64 ntpTimestamp;
+		Poco::UInt32 rtpTimestamp;
+		Poco::UInt32 packetCount;
+		Poco::UInt32 octetCount;
+	};
+
+	struct ReportBlock
+		/// A reception report block of a sender or receiver report.
+	{
+		Poco::UInt32 ssrc;
+		Poco::UInt8  fractionLost;
+		Poco::Int32  cumulativeLost;
+		Poco::UInt32 extendedHighestSequence;
+		Poco::UInt32 jitter;
+		Poco::UInt32 lastSR;
+		Poco::UInt32 delaySinceLastSR;
+	};
+
+	struct SDESItem
+		/// An item of a source description chunk. The text
+		/// points into the packet and is not terminated.
+	{
+		Poco::UInt32 ssrc;
+		int          type;
+		const char*  text;
+		std::size_t  length;
+	};
+
+	RTCPPacket();
+		/// Creates an invalid, empty RTCPPacket.
+
+	~RTCPPacket();
+		/// Destroys the RTCPPacket. The buffer is not touched.
+
+	bool parse(const void* buffer, std::size_t length);
+		/// Makes the packet view the first RTCP packet in the given
+		/// buffer. Returns true if the buffer starts with a complete
+		/// RTCP packet of version 2, whose SR, RR or BYE body is
+		/// large enough for its count.
+
+	static bool validateCompound(const void* buffer, std::size_t length);
+		/// Returns true if the buffer holds a valid compound packet:
+		/// all packets are complete, have version 2, only the last
+		/// one has padding, and the first one is a SR or RR.
+
+	bool valid() const;
+		/// Returns true if the packet has been parsed successfully.
+
+	const Poco::UInt8* data() const;
+		/// Returns the start of the packet.
+
+	std::size_t size() const;
+		/// Returns the size of the packet in bytes, including
+		/// the header and any padding.
+
+	int type() const;
+		/// Returns the packet type.
+
+	int count() const;
+		/// Returns the count field of the header: the number of
+		/// report blocks, SDES chunks or BYE sources.
+
+	bool padding() const;
+		/// Returns true if the packet has padding.
+
+	Poco::UInt32 ssrc() const;
+		/// Returns the SSRC following the header, which is the
+		/// sender of a SR or RR, the first SDES chunk or the
+		/// first source of a BYE.
+
+	SenderInfo senderInfo() const;
+		/// Returns the sender information of a SR.
+
+	ReportBlock reportBlock(int index) const;
+		/// Returns the index-th report block of a SR or RR.
+
+	std::size_t sdesItems(SDESItem* items, std::size_t maxItems) const;
+		/// Stores up to maxItems items of a SDES packet in items and
+		/// returns their number. Parsing stops at the first malformed
+		/// chunk.
+
+	Poco::UInt32 byeSource(int index) const;
+		/// Returns the index-th source of a BYE.
+
+	std::string byeReason() const;
+		/// Returns the reason for leaving of a BYE, or an
+		/// empty string.
+
+	static std::size_t writeSenderReport(Poco::UInt8* buffer, std::size_t capacity, const SenderInfo& info, const ReportBlock* blocks, int blockCount);
+		/// Writes a SR with the given sender info and up to
+		/// MAX_REPORT_BLOCKS report blocks.
+
+	static std::size_t writeReceiverReport(Poco::UInt8* buffer, std::size_t capacity, Poco::UInt32 ssrc, const ReportBlock* blocks, int blockCount);
+		/// Writes a RR from ssrc with up to MAX_REPORT_BLOCKS
+		/// report blocks.
+
+	static std::size_t writeSDES(Poco::UInt8* buffer, std::size_t capacity, Poco::UInt32 ssrc, const std::string& cname);
+		/// Writes a SDES packet with a single chunk holding the
+		/// CNAME of ssrc, which is truncated to 255 bytes.
+
+	static std::size_t writeBye(Poco::UInt8* buffer, std::size_t capacity, Poco::UInt32 ssrc, const std::string& reason = "");
+		/// Writes a BYE for ssrc with an optional reason, which
+		/// is truncated to 255 bytes.
+
+private:
+	const Poco::UInt8* _pData;
+	std::size_t        _size;
+	bool               _valid;
+};
+
+
+//
+// inlines
+//
+inline bool RTCPPacket::valid() const
+{
+	return _valid;
+}
+
+
+inline const Poco::UInt8* RTCPPacket::data() const
+{
+	return _pData;
+}
+
+
+inline std::size_t RTCPPacket::size() const
+{
+	return _size;
+}
+
+
+inline int RTCPPacket::type() const
+{
+	return _pData[1];
+}
+
+
+inline int RTCPPacket::count() const
+{
+	return _pData[0] & 0x1f;
+}
+
+
+inline bool RTCPPacket::padding() const
+{
+	return (_pData[0] & 0x20) != 0;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTCP_PACKET__H__
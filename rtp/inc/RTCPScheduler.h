@@ -0,0 +1,140 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTCP Scheduler Class
+//
+//	description:
+//		single timer thread shared by all RTCP sessions
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTCP_SCHEDULER__H__
+#define __RTCP_SCHEDULER__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+#include <map>
+#include <set>
+#include <utility>
+
+#include "rtp.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTCPScheduler: public Poco::Runnable
+	/// RTCPScheduler runs the timers of any number of RTCP sessions
+	/// on a single thread, so an application receiving hundreds of
+	/// streams does not need a thread or a Poco::Timer per stream.
+	///
+	/// Tasks are kept ordered by due time; the thread sleeps until
+	/// the earliest one is due or a task is scheduled before it.
+	/// A task decides on its next due time when it runs, which is
+	/// how RTCP sessions implement the randomized and reconsidered
+	/// report intervals of RFC 3550.
+{
+public:
+	class RTP_API Task
+		/// A Task is run by the scheduler when it is due.
+	{
+	public:
+		virtual ~Task();
+			/// Destroys the Task.
+
+		virtual bool onTimer(const Poco::Timestamp& now, Poco::Timestamp& next) = 0;
+			/// Called on the scheduler thread when the task is due.
+			/// Returns true to be run again at next, which must be
+			/// set then, or false to be removed from the scheduler.
+			/// Must not block and must not throw.
+	};
+
+	RTCPScheduler();
+		/// Creates the RTCPScheduler and starts its thread.
+
+	~RTCPScheduler();
+		/// Stops the thread. All tasks must have been cancelled.
+
+	void schedule(Task* pTask, const Poco::Timestamp& due);
+		/// Schedules the task to be run at the given time. A task
+		/// that is already scheduled is moved to the new time.
+
+	void cancel(Task* pTask);
+		/// Removes the task from the scheduler. If the task is
+		/// running on the scheduler thread, waits until it has
+		/// returned, unless called from the task itself. The task
+		/// will not be run once cancel() has returned.
+
+	std::size_t size() const;
+		/// Returns the number of scheduled tasks.
+
+	void run();
+		/// The scheduler thread. Do not call directly.
+
+	static RTCPScheduler& defaultScheduler();
+		/// Returns the scheduler shared by all RTCP sessions
+		/// that are not given one of their own.
+
+private:
+	typedef std::pair<Poco::Timestamp::TimeVal, Task*> Entry;
+	typedef std::set<Entry>                            Queue;
+	typedef std::map<Task*, Poco::Timestamp::TimeVal>  DueMap;
+
+	void remove(Task* pTask);
+
+	RTCPScheduler(const RTCPScheduler&);
+	RTCPScheduler& operator = (const RTCPScheduler&);
+
+	Queue                 _queue;
+	DueMap                _due;
+	Task*                 _pRunning;
+	bool                  _cancelled;
+	bool                  _stop;
+	Poco::Thread          _thread;
+	mutable Poco::Mutex   _mutex;
+	Poco::Condition       _wakeup;
+	Poco::Condition       _finished;
+};
+
+
+} // namespace RTP
+
+
+#endif // __RTCP_SCHEDULER__H__
@@ -0,0 +1,229 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTCP Session Class
+//
+//	description:
+//		reception statistics and RTCP report scheduling of a RTP session
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTCP_SESSION__H__
+#define __RTCP_SESSION__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Mutex.h"
+#include "Poco/Random.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Timespan.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rtp.h"
+#include "RTPPacket.h"
+#include "RTPSource.h"
+#include "RTCPScheduler.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTCPSession: public RTCPScheduler::Task
+	/// RTCPSession is the RTCP side of one RTP session, usually one
+	/// media track set up with RTSP. It keeps the reception statistics
+	/// of every source heard (see RTPSource), answers them with
+	/// compound receiver reports, or sender reports once RTP has been
+	/// sent, each followed by a SDES packet with the CNAME, and says
+	/// goodbye with a BYE when stopped.
+	///
+	/// Reports are sent at the intervals of RFC 3550, section 6.2 and
+	/// appendix A.7: the interval scales with the number of members
+	/// and the average RTCP packet size so RTCP stays within 5% of
+	/// the session bandwidth, is at least 5 seconds (2.5 seconds
+	/// before the first report), is randomized and is reconsidered
+	/// when the timer expires. Members that have not been heard of
+	/// for five intervals are timed out. When more sources have sent
+	/// than a report has room for, the report blocks go round-robin
+	/// over them (RFC 3550, section 6.4).
+	///
+	/// The timers of all sessions run on a shared RTCPScheduler.
+	/// The session is fed from the receiving threads through onRTP()
+	/// and onRTCP(); all methods are thread-safe.
+{
+public:
+	class RTP_API Transport
+		/// The Transport sends the RTCP packets of a session,
+		/// typically to the RTCP port of the server negotiated
+		/// with SETUP, or on an interleaved channel.
+	{
+	public:
+		virtual ~Transport();
+			/// Destroys the Transport.
+
+		virtual void sendRTCP(const Poco::UInt8* data, std::size_t length) = 0;
+			/// Sends a compound RTCP packet. Called on the scheduler
+			/// thread for reports and on the thread calling stop()
+			/// for the BYE. Must not block and must not throw.
+	};
+
+	enum
+	{
+		MAX_PACKET_SIZE = 1452
+	};
+
+	RTCPSession(Transport& transport, Poco::UInt32 ssrc, const std::string& cname, int clockRate, int sessionBandwidth, RTCPScheduler& scheduler = RTCPScheduler::defaultScheduler());
+		/// Creates a RTCPSession sending through transport for the
+		/// local source ssrc. clockRate is the RTP clock rate of the
+		/// payload format, sessionBandwidth the bandwidth of the
+		/// session in bits per second. The b=AS line of the media
+		/// description gives it in kilobits per second, so its value
+		/// must be multiplied by 1000. If it is 0, reports are sent
+		/// at the minimum interval.
+
+	~RTCPSession();
+		/// Removes the session from the scheduler and destroys it.
+		/// Does not send a BYE.
+
+	void start();
+		/// Schedules the first report.
+
+	void stop(const std::string& reason = "");
+		/// Removes the session from the scheduler and sends a
+		/// final report followed by a BYE with the given reason.
+
+	void onRTP(const RTPPacket& packet, const Poco::Timestamp& arrival);
+		/// Accounts for a received RTP packet.
+
+	void onSentRTP(const RTPPacket& packet, const Poco::Timestamp& time);
+		/// Accounts for a RTP packet sent by the local source,
+		/// which makes the session send sender reports.
+
+	bool onRTCP(const void* buffer, std::size_t length, const Poco::Timestamp& arrival);
+		/// Processes a received compound RTCP packet: sender reports,
+		/// receiver reports about the local source, CNAMEs and BYEs.
+		/// Returns false if the packet is not a valid compound packet.
+
+	bool wallClock(Poco::UInt32 ssrc, Poco::UInt32 rtpTimestamp, Poco::Timestamp& time) const;
+		/// Converts a RTP timestamp of the given source to wall clock
+		/// time using its last sender report. Returns false if the
+		/// source is unknown or has not sent a sender report yet.
+
+	bool source(Poco::UInt32 ssrc, RTPSource& source) const;
+		/// Copies the statistics of the given source and returns
+		/// true, or returns false if the source is unknown.
+
+	std::size_t members() const;
+		/// Returns the number of members of the session,
+		/// including the local source.
+
+	std::size_t senders() const;
+		/// Returns the number of members that have recently
+		/// sent RTP, including the local source.
+
+	Poco::Timespan roundTripTime() const;
+		/// Returns the last round-trip time computed from a report
+		/// block about the local source, or 0 if there has been none.
+
+	Poco::UInt32 ssrc() const;
+		/// Returns the SSRC of the local source.
+
+	const std::string& cname() const;
+		/// Returns the CNAME of the local source.
+
+	bool onTimer(const Poco::Timestamp& now, Poco::Timestamp& next);
+		/// Sends a report if it is due after reconsideration.
+		/// Called by the scheduler.
+
+private:
+	typedef std::map<Poco::UInt32, RTPSource> SourceMap;
+
+	RTPSource& findSource(Poco::UInt32 ssrc);
+	double deterministicInterval(const Poco::Timestamp& now) const;
+	Poco::Timespan interval(const Poco::Timestamp& now);
+	bool weSent(const Poco::Timestamp& now) const;
+	std::size_t countSenders(const Poco::Timestamp& now) const;
+	std::size_t buildReport(const Poco::Timestamp& now, const std::string* pReason);
+	void sendReport(const Poco::Timestamp& now, const std::string* pReason);
+	void timeoutSources(const Poco::Timestamp& now);
+	void updateAverageSize(std::size_t size);
+
+	RTCPSession(const RTCPSession&);
+	RTCPSession& operator = (const RTCPSession&);
+
+	Transport&               _transport;
+	RTCPScheduler&           _scheduler;
+	Poco::UInt32             _ssrc;
+	std::string              _cname;
+	int                      _clockRate;
+	int                      _sessionBandwidth;
+	SourceMap                _sources;
+	RTPSource*               _pLastSource;
+	bool                     _initial;
+	double                   _averageSize;
+	Poco::Timestamp          _lastReport;
+	Poco::Timespan           _lastInterval;
+	Poco::UInt32             _sentPackets;
+	Poco::UInt32             _sentOctets;
+	Poco::UInt32             _lastSentTimestamp;
+	Poco::Timestamp          _lastSent;
+	Poco::Timespan           _roundTripTime;
+	Poco::UInt32             _nextBlockSSRC;  /// the source the report blocks of the next report start at
+	Poco::Random             _random;
+	std::vector<Poco::UInt8> _buffer;
+	mutable Poco::FastMutex  _mutex;
+};
+
+
+//
+// inlines
+//
+inline Poco::UInt32 RTCPSession::ssrc() const
+{
+	return _ssrc;
+}
+
+
+inline const std::string& RTCPSession::cname() const
+{
+	return _cname;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTCP_SESSION__H__
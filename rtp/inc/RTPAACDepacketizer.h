@@ -0,0 +1,237 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP AAC Depacketizer Class
+//
+//	description:
+//		splits AAC access units out of mpeg4-generic (RFC 3640) and MP4A-LATM (RFC 6416) RTP packets
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_AAC_DEPACKETIZER__H__
+#define __RTP_AAC_DEPACKETIZER__H__
+
+
+#include "Poco/Foundation.h"
+#include <string>
+
+#include "rtp.h"
+#include "RTPDepacketizer.h"
+
+
+namespace RTP {
+
+
+class RTPPayloadFormat;
+
+
+class RTP_API RTPAACDepacketizer: public RTPDepacketizer
+	/// RTPAACDepacketizer splits the AAC access units (raw_data_block
+	/// frames) out of RTP packets in the mpeg4-generic format of
+	/// RFC 3640 (AAC-hbr, AAC-lbr and generic AU header layouts) or
+	/// the MP4A-LATM format of RFC 6416, and hands each one to the
+	/// Handler on its own, with its own RTP timestamp.
+	///
+	/// The AU header layout (sizeLength, indexLength, indexDeltaLength,
+	/// CTSDeltaLength, ...) and the AudioSpecificConfig or
+	/// StreamMuxConfig are read from the fmtp attribute. Access units
+	/// fragmented over several packets are assembled as slice lists
+	/// without copying; a fragmented unit with a lost packet is
+	/// discarded. Access units of interleaved streams are delivered
+	/// in transmission order, each with the timestamp computed from
+	/// its AU index or CTS-delta, so a receiver can put them back into
+	/// order by timestamp.
+	///
+	/// MP4A-LATM is only supported with an out-of-band configuration
+	/// (cpresent=0) using one program and one layer.
+	///
+	/// In FORMAT_ADTS, every access unit is preceded by an ADTS header,
+	/// which makes the output a stream that can be recorded as a
+	/// .aac file. Access units too large for the 13-bit frame length
+	/// of the header are dropped.
+{
+public:
+	enum Mode
+	{
+		MODE_GENERIC,  /// mpeg4-generic (RFC 3640)
+		MODE_LATM      /// MP4A-LATM (RFC 6416)
+	};
+
+	enum Format
+	{
+		FORMAT_RAW,   /// raw_data_block as in an MP4 file
+		FORMAT_ADTS   /// raw_data_block preceded by an ADTS header
+	};
+
+	enum
+	{
+		ADTS_HEADER_SIZE    = 7,
+		MAX_ADTS_FRAME_SIZE = 8191  /// largest frame_length, header included
+	};
+
+	RTPAACDepacketizer(Handler& handler, const RTPPayloadFormat& payloadFormat, Format format = FORMAT_RAW);
+		/// Creates a RTPAACDepacketizer for the stream described by
+		/// payloadFormat, which must have the encoding name
+		/// mpeg4-generic or MP4A-LATM and a config parameter.
+		///
+		/// Throws a Poco::InvalidArgumentException for other encoding
+		/// names, a Poco::DataFormatException if the configuration
+		/// cannot be parsed, and a Poco::NotImplementedException if
+		/// the stream uses an unsupported LATM configuration, or if
+		/// FORMAT_ADTS is requested for an audio object type or
+		/// sampling rate that ADTS cannot describe.
+
+	~RTPAACDepacketizer();
+		/// Destroys the RTPAACDepacketizer.
+
+	Mode mode() const;
+		/// Returns the packetization mode.
+
+	Format format() const;
+		/// Returns the output format.
+
+	const std::string& config() const;
+		/// Returns the decoded config parameter: the AudioSpecificConfig
+		/// for mpeg4-generic, the StreamMuxConfig for MP4A-LATM.
+
+	int objectType() const;
+		/// Returns the audio object type of the AudioSpecificConfig
+		/// (2 for AAC LC). For HE-AAC, the type of the core codec.
+
+	int sampleRate() const;
+		/// Returns the sampling rate of the core codec.
+
+	int channelConfiguration() const;
+		/// Returns the channel configuration (1 for mono, 2 for
+		/// stereo, 0 if defined by a program config element).
+
+	Poco::UInt32 frameDuration() const;
+		/// Returns the duration of an access unit in RTP
+		/// timestamp units.
+
+	void reset();
+		/// Discards any partial access unit.
+
+	static void writeADTSHeader(Poco::UInt8* header, int objectType, int sampleRateIndex, int channelConfiguration, std::size_t frameSize);
+		/// Writes the ADTS_HEADER_SIZE bytes of an ADTS header without
+		/// CRC for a raw_data_block of frameSize bytes to header.
+		/// objectType must be 1 to 4, and frameSize at most
+		/// MAX_ADTS_FRAME_SIZE - ADTS_HEADER_SIZE.
+
+protected:
+	void depacketize(const RTPPacket& packet);
+	void onLoss();
+	void completeUnit();
+
+private:
+	void loadGeneric(const RTPPayloadFormat& payloadFormat);
+	void loadLATM(const RTPPayloadFormat& payloadFormat);
+	void depacketizeGeneric(const RTPPacket& packet);
+	void depacketizeLATM(const RTPPacket& packet);
+	void beginUnit(Poco::UInt32 timestamp, std::size_t size);
+
+	Mode         _mode;
+	Format       _format;
+	std::string  _config;
+	int          _objectType;
+	int          _sampleRateIndex;
+	int          _sampleRate;
+	int          _channelConfiguration;
+	Poco::UInt32 _frameDuration;
+	int          _sizeLength;
+	int          _indexLength;
+	int          _indexDeltaLength;
+	int          _ctsDeltaLength;
+	int          _dtsDeltaLength;
+	int          _randomAccessIndication;
+	int          _streamStateIndication;
+	int          _auxiliaryDataSizeLength;
+	std::size_t  _constantSize;
+	std::size_t  _remaining;
+	bool         _atStart;
+	bool         _oversized;  /// the current unit cannot be described by ADTS
+	Poco::UInt32 _unitTimestamp;
+};
+
+
+//
+// inlines
+//
+inline RTPAACDepacketizer::Mode RTPAACDepacketizer::mode() const
+{
+	return _mode;
+}
+
+
+inline RTPAACDepacketizer::Format RTPAACDepacketizer::format() const
+{
+	return _format;
+}
+
+
+inline const std::string& RTPAACDepacketizer::config() const
+{
+	return _config;
+}
+
+
+inline int RTPAACDepacketizer::objectType() const
+{
+	return _objectType;
+}
+
+
+inline int RTPAACDepacketizer::sampleRate() const
+{
+	return _sampleRate;
+}
+
+
+inline int RTPAACDepacketizer::channelConfiguration() const
+{
+	return _channelConfiguration;
+}
+
+
+inline Poco::UInt32 RTPAACDepacketizer::frameDuration() const
+{
+	return _frameDuration;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_AAC_DEPACKETIZER__H__
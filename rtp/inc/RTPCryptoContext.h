@@ -0,0 +1,241 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Crypto Context Class
+//
+//	description:
+//		protects RTP and RTCP packets with SRTP and SRTCP
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_CRYPTO_CONTEXT__H__
+#define __RTP_CRYPTO_CONTEXT__H__
+
+
+#include "Poco/Foundation.h"
+#include <map>
+#include <string>
+
+#include "rtp.h"
+#include "SessionDescription.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPCryptoContext
+	/// RTPCryptoContext protects and unprotects RTP and RTCP packets in
+	/// place with SRTP and SRTCP (RFC 3711), using AES counter mode with
+	/// HMAC-SHA1 or AES-GCM (RFC 7714).
+	///
+	/// The session keys are derived from a master key and salt, given
+	/// directly or taken from an a=crypto attribute (RFC 4568) or the
+	/// k= line of the SDP. The key derivation rate is zero and MKIs are
+	/// not supported.
+	///
+	/// The ciphers are those of OpenSSL, which uses AES-NI, and
+	/// PCLMULQDQ for GCM, when the processor has them. The key
+	/// schedules and the HMAC pads are set up once per context.
+	///
+	/// The context keeps the rollover counter, the SRTCP index and the
+	/// replay windows of every SSRC it has seen. Use one context to
+	/// send and another to receive. A RTPCryptoContext is not
+	/// thread-safe.
+{
+public:
+	enum Suite
+	{
+		AES_CM_128_HMAC_SHA1_80,
+		AES_CM_128_HMAC_SHA1_32,
+		AEAD_AES_128_GCM,
+		AEAD_AES_256_GCM
+	};
+
+	enum
+	{
+		REPLAY_WINDOW = 64,  /// packets below the highest index accepted once
+		MAX_OVERHEAD  = 20   /// bytes protection adds to a packet at most
+	};
+
+	struct Statistics
+		/// Counters of a context.
+	{
+		Poco::UInt64 encrypted;     /// packets protected
+		Poco::UInt64 decrypted;     /// packets unprotected
+		Poco::UInt64 malformed;     /// packets rejected as too short or not RTP/RTCP
+		Poco::UInt64 replayed;      /// packets rejected by the replay window
+		Poco::UInt64 authFailures;  /// packets rejected by authentication
+	};
+
+	RTPCryptoContext(Suite suite, const std::string& masterKey, const std::string& masterSalt);
+		/// Creates a RTPCryptoContext from the master key (16 bytes,
+		/// or 32 for AEAD_AES_256_GCM) and master salt (14 bytes for
+		/// the AES-CM suites, 12 for AES-GCM).
+		///
+		/// Throws a Poco::InvalidArgumentException for wrong lengths.
+
+	RTPCryptoContext(const SDP::SessionDescription& session, const SDP::MediaDescription& media);
+		/// Creates a RTPCryptoContext from the first a=crypto attribute
+		/// of the media description with a supported suite. Without
+		/// a=crypto, the k= line of the media, or else of the session,
+		/// must hold the master key and salt for AES_CM_128_HMAC_SHA1_80,
+		/// with the clear or base64 method.
+		///
+		/// Throws a Poco::NotFoundException if there is no key, a
+		/// Poco::NotImplementedException if no a=crypto attribute is
+		/// supported and a Poco::DataFormatException if one is invalid.
+
+	~RTPCryptoContext();
+		/// Destroys the RTPCryptoContext, clearing the keys.
+
+	Suite suite() const;
+		/// Returns the crypto suite.
+
+	std::size_t rtpOverhead() const;
+		/// Returns the number of bytes protectRTP() adds.
+
+	std::size_t rtcpOverhead() const;
+		/// Returns the number of bytes protectRTCP() adds.
+
+	std::size_t protectRTP(Poco::UInt8* packet, std::size_t size, std::size_t capacity);
+		/// Encrypts the payload of the RTP packet of size bytes and
+		/// appends the authentication tag. Returns the new size.
+		///
+		/// Throws a Poco::InvalidArgumentException if the packet is
+		/// not a RTP packet or capacity is less than size + rtpOverhead().
+
+	bool unprotectRTP(Poco::UInt8* packet, std::size_t& size);
+		/// Authenticates and decrypts the SRTP packet of size bytes,
+		/// and sets size to the size of the RTP packet. Returns false,
+		/// leaving the contents undefined, if the packet is malformed,
+		/// replayed or not authentic.
+
+	std::size_t protectRTCP(Poco::UInt8* packet, std::size_t size, std::size_t capacity);
+		/// Encrypts the compound RTCP packet of size bytes behind the
+		/// sender SSRC and appends the SRTCP index and authentication
+		/// tag. Returns the new size.
+		///
+		/// Throws a Poco::InvalidArgumentException if the packet is
+		/// not a RTCP packet or capacity is less than size + rtcpOverhead().
+
+	bool unprotectRTCP(Poco::UInt8* packet, std::size_t& size);
+		/// Authenticates and decrypts the SRTCP packet of size bytes,
+		/// and sets size to the size of the RTCP packet. Returns false,
+		/// leaving the contents undefined, if the packet is malformed,
+		/// replayed or not authentic.
+
+	const Statistics& statistics() const;
+		/// Returns the counters.
+
+	static Suite parseSuite(const std::string& name);
+		/// Returns the suite with the given RFC 4568 name.
+		///
+		/// Throws a Poco::NotImplementedException for other names.
+
+	static std::string suiteName(Suite suite);
+		/// Returns the RFC 4568 name of the suite.
+
+private:
+	struct Window
+		/// The highest index received and the indices received
+		/// below it, bit n standing for highest - n.
+	{
+		bool         started;
+		Poco::UInt64 highest;
+		Poco::UInt64 bits;
+	};
+
+	struct Stream
+	{
+		Window       rtp;
+		Window       rtcp;
+		Poco::UInt32 rtcpIndex;  /// next SRTCP index to send
+	};
+
+	struct Keys;
+
+	typedef std::map<Poco::UInt32, Stream> StreamMap;
+
+	void init(const std::string& masterKey, const std::string& masterSalt);
+	void destroy();
+
+	static bool estimateIndex(const Window& window, Poco::UInt16 sequenceNumber, Poco::UInt64& index);
+	static bool isReplay(const Window& window, Poco::UInt64 index);
+	static void update(Window& window, Poco::UInt64 index);
+
+	RTPCryptoContext(const RTPCryptoContext&);
+	RTPCryptoContext& operator = (const RTPCryptoContext&);
+
+	Suite       _suite;
+	bool        _gcm;
+	std::size_t _rtpTagSize;
+	std::size_t _rtcpTagSize;
+	Keys*       _pKeys;
+	StreamMap   _streams;
+	Statistics  _statistics;
+};
+
+
+//
+// inlines
+//
+inline RTPCryptoContext::Suite RTPCryptoContext::suite() const
+{
+	return _suite;
+}
+
+
+inline std::size_t RTPCryptoContext::rtpOverhead() const
+{
+	return _rtpTagSize;
+}
+
+
+inline std::size_t RTPCryptoContext::rtcpOverhead() const
+{
+	return _rtcpTagSize + 4;
+}
+
+
+inline const RTPCryptoContext::Statistics& RTPCryptoContext::statistics() const
+{
+	return _statistics;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_CRYPTO_CONTEXT__H__
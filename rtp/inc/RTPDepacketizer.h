@@ -0,0 +1,271 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Depacketizer Class
+//
+//	description:
+//		base class assembling access units from RTP packets as buffer slices
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_DEPACKETIZER__H__
+#define __RTP_DEPACKETIZER__H__
+
+
+#include "Poco/Foundation.h"
+#include <vector>
+
+#include "rtp.h"
+#include "RTPPacket.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPDepacketizer
+	/// RTPDepacketizer is the base class of the payload format
+	/// specific depacketizers. It takes the packets of a stream in
+	/// sequence order, as released by a RTPJitterBuffer, and hands
+	/// each complete access unit (a video frame or audio frame) to
+	/// a Handler.
+	///
+	/// An access unit is not copied into a frame buffer. It is a
+	/// list of slices that point into the packets themselves, with
+	/// the few bytes that do not appear in the packets (start codes,
+	/// length prefixes, reconstructed headers) kept in a small arena
+	/// owned by the depacketizer. A recorder can pass the slices to
+	/// writev() as they are. The packets of an access unit must
+	/// therefore stay unchanged until the handler has returned.
+	///
+	/// A gap in sequence numbers marks the access unit it falls
+	/// into as incomplete; subclasses discard the partial units
+	/// they cannot repair. After warm-up, the slice list and the
+	/// arena are reused and no memory is allocated per packet.
+	///
+	/// A RTPDepacketizer is not thread-safe.
+{
+public:
+	struct Slice
+		/// A contiguous piece of an access unit.
+	{
+		const Poco::UInt8* data;
+		std::size_t        size;
+	};
+
+	struct AccessUnit
+		/// An access unit as the sequence of its slices.
+	{
+		const Slice* slices;
+		std::size_t  sliceCount;
+		std::size_t  size;        /// total size of all slices in bytes
+		Poco::UInt32 timestamp;   /// RTP timestamp
+		bool         keyFrame;    /// can be decoded on its own
+		bool         complete;    /// no packet of the unit has been lost
+	};
+
+	class RTP_API Handler
+		/// A Handler receives the access units of a depacketizer.
+	{
+	public:
+		virtual ~Handler();
+			/// Destroys the Handler.
+
+		virtual void onAccessUnit(const AccessUnit& unit) = 0;
+			/// Called for every access unit. The slices are only
+			/// valid until the handler returns. Must not throw.
+	};
+
+	struct Statistics
+		/// Counters of a depacketizer.
+	{
+		Poco::UInt64 packets;          /// packets pushed
+		Poco::UInt64 accessUnits;      /// access units handed to the handler
+		Poco::UInt64 incompleteUnits;  /// access units with lost packets
+		Poco::UInt64 droppedPackets;   /// packets that could not be used
+	};
+
+	explicit RTPDepacketizer(Handler& handler);
+		/// Creates a RTPDepacketizer delivering to handler.
+
+	virtual ~RTPDepacketizer();
+		/// Destroys the RTPDepacketizer.
+
+	void push(const RTPPacket& packet);
+		/// Feeds the next packet of the stream. The current access
+		/// unit is delivered when a packet has the marker bit set or
+		/// when the RTP timestamp changes.
+
+	void flush();
+		/// Delivers the current access unit, if there is one.
+
+	virtual void reset();
+		/// Discards the current access unit and forgets the
+		/// last sequence number.
+
+	const Statistics& statistics() const;
+		/// Returns the counters.
+
+protected:
+	virtual void depacketize(const RTPPacket& packet) = 0;
+		/// Appends the payload of packet to the current unit.
+
+	virtual void onLoss();
+		/// Called before depacketize() if packets have been lost
+		/// since the previous one. The current unit has been marked
+		/// as incomplete unless the packet starts it, see
+		/// startsUnit(). Does nothing by default.
+
+	virtual bool startsUnit(const RTPPacket& packet) const;
+		/// Returns true if packet certainly carries the beginning of
+		/// an access unit, so that packets lost right before it
+		/// cannot have belonged to its unit. Returns false by default.
+
+	virtual void completeUnit();
+		/// Called before the current unit is delivered, to finish
+		/// or discard partial data. Does nothing by default.
+
+	void appendSlice(const Poco::UInt8* data, std::size_t size);
+		/// Appends a slice pointing into a packet or into
+		/// static storage.
+
+	std::size_t appendOwned(const void* data, std::size_t size);
+		/// Copies size bytes into the arena, appends a slice for
+		/// them and returns its index.
+
+	Poco::UInt8* ownedData(std::size_t index);
+		/// Returns the arena bytes of the owned slice with the given
+		/// index, for patching. Valid until the next append.
+
+	void insertSlice(std::size_t index, const Poco::UInt8* data, std::size_t size);
+		/// Inserts a slice before the slice with the given index.
+
+	void truncate(std::size_t count);
+		/// Discards all slices from the given index on.
+
+	std::size_t sliceCount() const;
+		/// Returns the number of slices of the current unit.
+
+	void setTimestamp(Poco::UInt32 timestamp);
+		/// Sets the RTP timestamp of the current unit.
+
+	void setKeyFrame();
+		/// Marks the current unit as a key frame.
+
+	void setIncomplete();
+		/// Marks the current unit as incomplete.
+
+	void dropPacket();
+		/// Counts a packet that could not be used.
+
+	void discardUnit();
+		/// Discards the current unit, including its
+		/// incomplete mark.
+
+	void deliver();
+		/// Calls completeUnit() and hands the current unit to the
+		/// handler, unless it is empty. Starts a new unit.
+
+private:
+	void clearUnit();
+
+	RTPDepacketizer(const RTPDepacketizer&);
+	RTPDepacketizer& operator = (const RTPDepacketizer&);
+
+	Handler&                 _handler;
+	std::vector<Slice>       _slices;
+	std::vector<std::size_t> _owned;
+	std::vector<Poco::UInt8> _arena;
+	std::size_t              _size;
+	Poco::UInt32             _timestamp;
+	bool                     _keyFrame;
+	bool                     _incomplete;
+	bool                     _hasSequence;
+	Poco::UInt16             _lastSequence;
+	Statistics               _statistics;
+};
+
+
+//
+// inlines
+//
+inline const RTPDepacketizer::Statistics& RTPDepacketizer::statistics() const
+{
+	return _statistics;
+}
+
+
+inline void RTPDepacketizer::appendSlice(const Poco::UInt8* data, std::size_t size)
+{
+	Slice slice = { data, size };
+	_slices.push_back(slice);
+	_owned.push_back(std::size_t(-1));
+	_size += size;
+}
+
+
+inline std::size_t RTPDepacketizer::sliceCount() const
+{
+	return _slices.size();
+}
+
+
+inline void RTPDepacketizer::setTimestamp(Poco::UInt32 timestamp)
+{
+	_timestamp = timestamp;
+}
+
+
+inline void RTPDepacketizer::setKeyFrame()
+{
+	_keyFrame = true;
+}
+
+
+inline void RTPDepacketizer::setIncomplete()
+{
+	_incomplete = true;
+}
+
+
+inline void RTPDepacketizer::dropPacket()
+{
+	++_statistics.droppedPackets;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_DEPACKETIZER__H__
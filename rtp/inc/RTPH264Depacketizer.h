@@ -0,0 +1,210 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP H.264 Depacketizer Class
+//
+//	description:
+//		assembles H.264 access units from RTP packets (RFC 6184)
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_H264_DEPACKETIZER__H__
+#define __RTP_H264_DEPACKETIZER__H__
+
+
+#include "Poco/Foundation.h"
+#include <string>
+#include <vector>
+
+#include "rtp.h"
+#include "RTPDepacketizer.h"
+
+
+namespace RTP {
+
+
+class RTPPayloadFormat;
+
+
+class RTP_API RTPH264Depacketizer: public RTPDepacketizer
+	/// RTPH264Depacketizer assembles H.264 access units from RTP
+	/// packets in single NAL unit and non-interleaved packetization
+	/// mode (RFC 6184): single NAL unit packets, STAP-A aggregation
+	/// packets and FU-A fragmentation units. The interleaved mode
+	/// packet types (STAP-B, MTAP, FU-B) are dropped.
+	///
+	/// Access units are delivered in Annex B byte stream format,
+	/// with a four-byte start code before each NAL unit, or in AVCC
+	/// format, with a four-byte big-endian length instead. The NAL
+	/// units of single NAL unit packets and STAP-A packets, and the
+	/// fragments of FU-A packets, are referenced in place; only the
+	/// prefixes and the NAL unit header of fragmented NAL units are
+	/// stored in the arena.
+	///
+	/// If the sprop-parameter-sets of the fmtp attribute are known,
+	/// or the stream has carried SPS and PPS in band, they are put
+	/// in front of every IDR access unit that does not have them,
+	/// so each key frame can be decoded on its own.
+	///
+	/// A fragmented NAL unit with a lost fragment is discarded and
+	/// its access unit delivered as incomplete.
+{
+public:
+	enum Format
+	{
+		FORMAT_ANNEXB,  /// start code prefixed NAL units (ITU-T H.264, Annex B)
+		FORMAT_AVCC     /// length prefixed NAL units (ISO/IEC 14496-15)
+	};
+
+	enum NALType
+	{
+		NAL_SLICE  = 1,
+		NAL_IDR    = 5,
+		NAL_SEI    = 6,
+		NAL_SPS    = 7,
+		NAL_PPS    = 8,
+		NAL_AUD    = 9,
+		NAL_STAP_A = 24,
+		NAL_STAP_B = 25,
+		NAL_MTAP16 = 26,
+		NAL_MTAP24 = 27,
+		NAL_FU_A   = 28,
+		NAL_FU_B   = 29
+	};
+
+	RTPH264Depacketizer(Handler& handler, Format format = FORMAT_ANNEXB);
+		/// Creates a RTPH264Depacketizer delivering to handler
+		/// in the given format.
+
+	RTPH264Depacketizer(Handler& handler, const RTPPayloadFormat& payloadFormat, Format format = FORMAT_ANNEXB);
+		/// Creates a RTPH264Depacketizer for the stream described by
+		/// payloadFormat, taking the parameter sets from its
+		/// sprop-parameter-sets parameter.
+		///
+		/// Throws a Poco::NotImplementedException if the stream uses
+		/// the interleaved packetization mode, and a
+		/// Poco::DataFormatException if the parameter sets
+		/// cannot be decoded.
+
+	~RTPH264Depacketizer();
+		/// Destroys the RTPH264Depacketizer.
+
+	void setParameterSets(const std::string& spropParameterSets);
+		/// Sets SPS and PPS from the comma separated, base64 encoded
+		/// NAL units of a sprop-parameter-sets parameter.
+		///
+		/// Throws a Poco::DataFormatException if they cannot
+		/// be decoded.
+
+	const std::string& sps() const;
+		/// Returns the current sequence parameter set NAL unit,
+		/// or an empty string.
+
+	const std::string& pps() const;
+		/// Returns the current picture parameter set NAL unit,
+		/// or an empty string.
+
+	void setInsertParameterSets(bool insert);
+		/// Sets whether SPS and PPS are put in front of IDR
+		/// access units lacking them. The default is true.
+
+	bool getInsertParameterSets() const;
+		/// Returns whether parameter sets are inserted.
+
+	Format format() const;
+		/// Returns the output format.
+
+	void reset();
+		/// Discards the current access unit and any
+		/// partial NAL unit.
+
+protected:
+	void depacketize(const RTPPacket& packet);
+	void onLoss();
+	void completeUnit();
+	bool startsUnit(const RTPPacket& packet) const;
+
+private:
+	void appendNAL(const Poco::UInt8* nal, std::size_t size);
+	void appendPrefix(std::size_t size);
+	void noteNAL(const Poco::UInt8* nal, std::size_t size);
+	void abortFragment();
+	void updateParameterSets();
+
+	Format                   _format;
+	bool                     _insertParameterSets;
+	std::string              _sps;
+	std::string              _pps;
+	std::vector<Poco::UInt8> _parameterSets;
+	bool                     _unitHasIDR;
+	bool                     _unitHasSPS;
+	bool                     _unitHasPPS;
+	bool                     _inFragment;
+	std::size_t              _fragmentStart;
+	std::size_t              _fragmentSize;
+};
+
+
+//
+// inlines
+//
+inline const std::string& RTPH264Depacketizer::sps() const
+{
+	return _sps;
+}
+
+
+inline const std::string& RTPH264Depacketizer::pps() const
+{
+	return _pps;
+}
+
+
+inline bool RTPH264Depacketizer::getInsertParameterSets() const
+{
+	return _insertParameterSets;
+}
+
+
+inline RTPH264Depacketizer::Format RTPH264Depacketizer::format() const
+{
+	return _format;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_H264_DEPACKETIZER__H__
@@ -0,0 +1,234 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP H.265 Depacketizer Class
+//
+//	description:
+//		assembles H.265 access units from RTP packets (RFC 7798)
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_H265_DEPACKETIZER__H__
+#define __RTP_H265_DEPACKETIZER__H__
+
+
+#include "Poco/Foundation.h"
+#include <string>
+#include <vector>
+
+#include "rtp.h"
+#include "RTPDepacketizer.h"
+
+
+namespace RTP {
+
+
+class RTPPayloadFormat;
+
+
+class RTP_API RTPH265Depacketizer: public RTPDepacketizer
+	/// RTPH265Depacketizer assembles H.265 (HEVC) access units from
+	/// RTP packets (RFC 7798): single NAL unit packets, aggregation
+	/// packets (AP) and fragmentation units (FU). PACI packets
+	/// are dropped.
+	///
+	/// If the stream carries decoding order numbers, as signalled by
+	/// a sprop-max-don-diff greater than 0, the DONL and DOND fields
+	/// are skipped. NAL units are delivered in transmission order;
+	/// streams that need to be reordered by decoding order number
+	/// are not supported.
+	///
+	/// Access units are delivered in Annex B byte stream format or
+	/// with four-byte length prefixes (ISO/IEC 14496-15, hvcC), and
+	/// reference the packets in place like RTPH264Depacketizer.
+	///
+	/// VPS, SPS and PPS from the sprop-vps, sprop-sps and sprop-pps
+	/// parameters, or from the stream, are put in front of every
+	/// IRAP access unit that does not have them.
+	///
+	/// A fragmented NAL unit with a lost fragment is discarded and
+	/// its access unit delivered as incomplete.
+{
+public:
+	enum Format
+	{
+		FORMAT_ANNEXB,  /// start code prefixed NAL units (ITU-T H.265, Annex B)
+		FORMAT_HVCC     /// length prefixed NAL units (ISO/IEC 14496-15)
+	};
+
+	enum NALType
+	{
+		NAL_IRAP_FIRST = 16,  /// BLA_W_LP
+		NAL_IRAP_LAST  = 23,  /// RSV_IRAP_VCL23
+		NAL_VPS        = 32,
+		NAL_SPS        = 33,
+		NAL_PPS        = 34,
+		NAL_AUD        = 35,
+		NAL_PREFIX_SEI = 39,
+		NAL_AP         = 48,
+		NAL_FU         = 49,
+		NAL_PACI       = 50
+	};
+
+	RTPH265Depacketizer(Handler& handler, Format format = FORMAT_ANNEXB, bool donl = false);
+		/// Creates a RTPH265Depacketizer delivering to handler in the
+		/// given format. If donl is true, the packets carry decoding
+		/// order numbers.
+
+	RTPH265Depacketizer(Handler& handler, const RTPPayloadFormat& payloadFormat, Format format = FORMAT_ANNEXB);
+		/// Creates a RTPH265Depacketizer for the stream described by
+		/// payloadFormat, taking the parameter sets from its sprop-vps,
+		/// sprop-sps and sprop-pps parameters and the presence of
+		/// decoding order numbers from sprop-max-don-diff.
+		///
+		/// Throws a Poco::DataFormatException if the parameter sets
+		/// cannot be decoded.
+
+	~RTPH265Depacketizer();
+		/// Destroys the RTPH265Depacketizer.
+
+	void setParameterSets(const std::string& spropVPS, const std::string& spropSPS, const std::string& spropPPS);
+		/// Sets VPS, SPS and PPS from the comma separated, base64
+		/// encoded NAL units of the sprop-vps, sprop-sps and sprop-pps
+		/// parameters. Empty arguments leave the respective
+		/// parameter set unchanged.
+		///
+		/// Throws a Poco::DataFormatException if they cannot
+		/// be decoded.
+
+	const std::string& vps() const;
+		/// Returns the current video parameter set NAL unit,
+		/// or an empty string.
+
+	const std::string& sps() const;
+		/// Returns the current sequence parameter set NAL unit,
+		/// or an empty string.
+
+	const std::string& pps() const;
+		/// Returns the current picture parameter set NAL unit,
+		/// or an empty string.
+
+	void setInsertParameterSets(bool insert);
+		/// Sets whether VPS, SPS and PPS are put in front of IRAP
+		/// access units lacking them. The default is true.
+
+	bool getInsertParameterSets() const;
+		/// Returns whether parameter sets are inserted.
+
+	Format format() const;
+		/// Returns the output format.
+
+	bool donl() const;
+		/// Returns true if the packets carry decoding order numbers.
+
+	void reset();
+		/// Discards the current access unit and any
+		/// partial NAL unit.
+
+protected:
+	void depacketize(const RTPPacket& packet);
+	void onLoss();
+	void completeUnit();
+	bool startsUnit(const RTPPacket& packet) const;
+
+private:
+	void depacketizeAP(const Poco::UInt8* p, std::size_t size);
+	void depacketizeFU(const Poco::UInt8* p, std::size_t size);
+	void appendNAL(const Poco::UInt8* nal, std::size_t size);
+	void appendPrefix(std::size_t size);
+	void noteNAL(const Poco::UInt8* nal, std::size_t size);
+	void abortFragment();
+	void updateParameterSets();
+
+	Format                   _format;
+	bool                     _donl;
+	bool                     _insertParameterSets;
+	std::string              _vps;
+	std::string              _sps;
+	std::string              _pps;
+	std::vector<Poco::UInt8> _parameterSets;
+	bool                     _unitHasIRAP;
+	bool                     _unitHasVPS;
+	bool                     _unitHasSPS;
+	bool                     _unitHasPPS;
+	bool                     _inFragment;
+	std::size_t              _fragmentStart;
+	std::size_t              _fragmentSize;
+};
+
+
+//
+// inlines
+//
+inline const std::string& RTPH265Depacketizer::vps() const
+{
+	return _vps;
+}
+
+
+inline const std::string& RTPH265Depacketizer::sps() const
+{
+	return _sps;
+}
+
+
+inline const std::string& RTPH265Depacketizer::pps() const
+{
+	return _pps;
+}
+
+
+inline bool RTPH265Depacketizer::getInsertParameterSets() const
+{
+	return _insertParameterSets;
+}
+
+
+inline RTPH265Depacketizer::Format RTPH265Depacketizer::format() const
+{
+	return _format;
+}
+
+
+inline bool RTPH265Depacketizer::donl() const
+{
+	return _donl;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_H265_DEPACKETIZER__H__
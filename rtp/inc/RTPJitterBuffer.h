@@ -0,0 +1,338 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Jitter Buffer Class
+//
+//	description:
+//		fixed-capacity reorder buffer releasing the packets of a RTP stream in sequence
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_JITTER_BUFFER__H__
+#define __RTP_JITTER_BUFFER__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Timespan.h"
+#include <vector>
+
+#include "rtp.h"
+#include "RTPPacket.h"
+#include "RTPPacketPool.h"
+
+
+namespace RTP {
+
+
+class RTPPayloadFormat;
+
+
+class RTP_API RTPJitterBuffer
+	/// RTPJitterBuffer sits between the socket and the depacketizer
+	/// of one media track. It takes the packets of a RTP stream in
+	/// the order they arrive and releases them in sequence number
+	/// order, smoothing out network jitter.
+	///
+	/// Packets are kept in a ring of power-of-two capacity, indexed
+	/// by the extended sequence number (RFC 3550, appendix A.1), so
+	/// sequence number wrap needs no special handling. The ring and
+	/// the storage for the packets are allocated once: insert()
+	/// copies the packet into its slot and never allocates memory.
+	/// A packet received into a RTPPacketBuffer is not copied;
+	/// the slot keeps a reference to the buffer instead.
+	///
+	/// Every packet is given a playout time: the time it would have
+	/// arrived without jitter, computed from its RTP timestamp and
+	/// the clock rate of the payload format, plus the configured
+	/// latency. The time without jitter is taken from the packet
+	/// that arrived fastest. It is lowered as soon as a packet
+	/// arrives faster, and raised step by step when even the
+	/// fastest packet of a two-second window arrived later, so that
+	/// a sender clock running slower than the local one does not
+	/// make the latency grow.
+	///
+	/// next() releases a packet once its playout time has come.
+	/// A missing packet is waited for until the packet after it
+	/// is due; it is then counted as lost and skipped.
+	///
+	/// Packets that arrive after their sequence number has been
+	/// released or skipped are counted as late, packets already in
+	/// the buffer as duplicates. A jump in sequence numbers larger
+	/// than MAX_DROPOUT forward or maxMisorder backward is taken as
+	/// a restart of the source if the next packet confirms it; the
+	/// buffer then resynchronizes, as it does when the SSRC changes.
+	///
+	/// A RTPJitterBuffer is not thread-safe.
+{
+public:
+	enum
+	{
+		DEFAULT_CAPACITY        = 512,
+		DEFAULT_MAX_MISORDER    = 100,
+		DEFAULT_MAX_PACKET_SIZE = 1500,
+		MAX_DROPOUT             = 3000
+	};
+
+	struct Statistics
+		/// Counters of a RTPJitterBuffer. They are kept
+		/// across resets.
+	{
+		Poco::UInt64 received;    /// packets accepted into the buffer
+		Poco::UInt64 released;    /// packets returned by next()
+		Poco::UInt64 reordered;   /// accepted packets that arrived after a later one
+		Poco::UInt64 lost;        /// sequence numbers skipped because their packet did not arrive in time
+		Poco::UInt64 late;        /// packets that arrived after their sequence number was released or skipped
+		Poco::UInt64 duplicates;  /// packets whose sequence number was already in the buffer
+		Poco::UInt64 dropped;     /// packets discarded because they were too large, overflowed the ring or jumped in sequence
+		Poco::UInt64 resets;      /// times the buffer resynchronized on a new sequence or SSRC
+	};
+
+	RTPJitterBuffer(int clockRate, const Poco::Timespan& latency, std::size_t capacity = DEFAULT_CAPACITY, int maxMisorder = DEFAULT_MAX_MISORDER, std::size_t maxPacketSize = DEFAULT_MAX_PACKET_SIZE);
+		/// Creates a RTPJitterBuffer for a stream with the given
+		/// RTP clock rate. The capacity is rounded up to the next
+		/// power of two and should hold all packets received during
+		/// the latency; packets larger than maxPacketSize are dropped.
+		///
+		/// Throws a Poco::InvalidArgumentException if clockRate,
+		/// capacity or maxPacketSize is not positive, or if
+		/// maxMisorder is negative or not below MAX_DROPOUT.
+
+	RTPJitterBuffer(const RTPPayloadFormat& format, const Poco::Timespan& latency, std::size_t capacity = DEFAULT_CAPACITY, int maxMisorder = DEFAULT_MAX_MISORDER, std::size_t maxPacketSize = DEFAULT_MAX_PACKET_SIZE);
+		/// Creates a RTPJitterBuffer for a stream with the
+		/// clock rate of the given payload format.
+
+	~RTPJitterBuffer();
+		/// Destroys the RTPJitterBuffer.
+
+	bool insert(const RTPPacket& packet, const Poco::Timestamp& arrival);
+		/// Copies a valid packet that arrived at the given time into
+		/// the buffer. Returns false if the packet has been discarded
+		/// as late, duplicate or dropped.
+		///
+		/// If the packet lies more than the capacity ahead of the
+		/// next packet to release, older packets are dropped and
+		/// missing ones counted as lost to make room for it.
+
+	bool insert(const RTPPacket& packet, RTPPacketBuffer* pBuffer, const Poco::Timestamp& arrival);
+		/// Inserts a valid packet held in pBuffer like the insert()
+		/// above, but keeps a reference to the buffer instead of
+		/// copying the packet. The reference is released when the
+		/// slot is reused or the jitter buffer is reset. The packet is
+		/// copied if pBuffer is NULL.
+
+	const RTPPacket* next(const Poco::Timestamp& now);
+		/// Returns the next packet in sequence if its playout time
+		/// is not after now, or NULL. Missing packets are skipped
+		/// as described above. The returned packet and its data stay
+		/// valid until a packet capacity() sequence numbers later is
+		/// inserted, or until reset(), so a depacketizer may refer to
+		/// the packets of an access unit until it has delivered it.
+
+	bool nextDue(Poco::Timestamp& due) const;
+		/// Stores the time at which next() will return a packet
+		/// in due and returns true, or returns false if the
+		/// buffer is empty.
+
+	void reset();
+		/// Discards all buffered packets. The next packet
+		/// inserted starts a new sequence.
+
+	std::size_t size() const;
+		/// Returns the number of buffered packets.
+
+	bool empty() const;
+		/// Returns true if no packets are buffered.
+
+	std::size_t capacity() const;
+		/// Returns the number of packets the ring can hold.
+
+	int clockRate() const;
+		/// Returns the RTP clock rate in Hz.
+
+	const Poco::Timespan& latency() const;
+		/// Returns the latency.
+
+	void setLatency(const Poco::Timespan& latency);
+		/// Sets the latency. Packets already buffered keep
+		/// their playout time.
+
+	int maxMisorder() const;
+		/// Returns the largest backward jump in sequence numbers
+		/// that is taken for reordering rather than a restart.
+
+	Poco::UInt32 ssrc() const;
+		/// Returns the SSRC of the current sequence.
+
+	Poco::Int64 highestSequence() const;
+		/// Returns the highest extended sequence number received
+		/// in the current sequence.
+
+	Poco::Int64 expected() const;
+		/// Returns the number of packets expected in the current
+		/// sequence: the highest extended sequence number received
+		/// minus the first one plus one.
+
+	Poco::UInt32 jitter() const;
+		/// Returns the interarrival jitter of the current sequence
+		/// in timestamp units (RFC 3550, appendix A.8).
+
+	const Statistics& statistics() const;
+		/// Returns the counters.
+
+private:
+	struct Slot
+	{
+		Poco::Int64              sequence;
+		Poco::Timestamp::TimeVal playout;
+		RTPPacket                packet;
+		RTPPacketBuffer::Ptr     buffer;  /// holds the packet if it was not copied
+	};
+
+	void init(std::size_t capacity, std::size_t maxPacketSize);
+	void start(const RTPPacket& packet, Poco::Timestamp::TimeVal arrival);
+	void skipTo(Poco::Int64 sequence);
+	const Slot& firstPending() const;
+	Poco::Timestamp::TimeVal playoutTime(Poco::UInt32 timestamp, Poco::Timestamp::TimeVal arrival);
+	void updateJitter(Poco::UInt32 timestamp, Poco::Timestamp::TimeVal arrival);
+	std::size_t index(Poco::Int64 sequence) const;
+
+	RTPJitterBuffer(const RTPJitterBuffer&);
+	RTPJitterBuffer& operator = (const RTPJitterBuffer&);
+
+	std::vector<Slot>         _slots;
+	std::vector<Poco::UInt8>  _storage;
+	std::size_t               _mask;
+	std::size_t               _maxPacketSize;
+	int                       _clockRate;
+	Poco::Timespan            _latency;
+	int                       _maxMisorder;
+	std::size_t               _pending;
+	bool                      _started;
+	Poco::UInt32              _ssrc;
+	Poco::UInt32              _badSequence;
+	Poco::Int64               _baseSequence;
+	Poco::Int64               _highest;
+	Poco::Int64               _nextOut;
+	Poco::UInt32              _baseTimestamp;
+	Poco::Timestamp::TimeVal  _baseTime;
+	Poco::Timestamp::TimeVal  _windowStart;  /// arrival of the first packet of the skew window
+	Poco::Timestamp::TimeVal  _windowMin;    /// smallest transit time in the skew window
+	Poco::Timestamp::TimeVal  _startTime;
+	Poco::Int64               _lastTransit;
+	Poco::UInt32              _jitter;
+	Statistics                _statistics;
+};
+
+
+//
+// inlines
+//
+inline std::size_t RTPJitterBuffer::size() const
+{
+	return _pending;
+}
+
+
+inline bool RTPJitterBuffer::empty() const
+{
+	return _pending == 0;
+}
+
+
+inline std::size_t RTPJitterBuffer::capacity() const
+{
+	return _slots.size();
+}
+
+
+inline int RTPJitterBuffer::clockRate() const
+{
+	return _clockRate;
+}
+
+
+inline const Poco::Timespan& RTPJitterBuffer::latency() const
+{
+	return _latency;
+}
+
+
+inline int RTPJitterBuffer::maxMisorder() const
+{
+	return _maxMisorder;
+}
+
+
+inline Poco::UInt32 RTPJitterBuffer::ssrc() const
+{
+	return _ssrc;
+}
+
+
+inline Poco::Int64 RTPJitterBuffer::highestSequence() const
+{
+	return _highest;
+}
+
+
+inline Poco::Int64 RTPJitterBuffer::expected() const
+{
+	return _started ? _highest - _baseSequence + 1 : 0;
+}
+
+
+inline Poco::UInt32 RTPJitterBuffer::jitter() const
+{
+	return _jitter >> 4;
+}
+
+
+inline const RTPJitterBuffer::Statistics& RTPJitterBuffer::statistics() const
+{
+	return _statistics;
+}
+
+
+inline std::size_t RTPJitterBuffer::index(Poco::Int64 sequence) const
+{
+	return (std::size_t) sequence & _mask;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_JITTER_BUFFER__H__
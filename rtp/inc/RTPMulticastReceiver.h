@@ -0,0 +1,203 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Multicast Receiver Class
+//
+//	description:
+//		receives RTP and RTCP multicast streams described by SDP on shared sockets
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_MULTICAST_RECEIVER__H__
+#define __RTP_MULTICAST_RECEIVER__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/AtomicCounter.h"
+#include "Poco/Mutex.h"
+#include "Poco/Net/IPAddress.h"
+#include "Poco/Net/MulticastSocket.h"
+#include "Poco/Net/NetworkInterface.h"
+#include "Poco/Net/SocketAddress.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rtp.h"
+#include "RTPUDPReceiver.h"
+#include "SessionDescription.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPMulticastReceiver: private RTPUDPReceiver::Consumer
+	/// RTPMulticastReceiver joins multicast groups and hands the
+	/// datagrams arriving for them to consumers. The sockets are
+	/// served by a RTPUDPReceiver, so any number of feeds is
+	/// received on the single thread of the receiver.
+	///
+	/// There is one socket per group and port, bound to the group
+	/// address, no matter how many streams are sent to it. The
+	/// datagrams of such a socket are demultiplexed by SSRC: a
+	/// datagram goes to the consumer subscribed to its SSRC or,
+	/// if there is none, to every consumer subscribed to any SSRC.
+	/// RTCP packets are told from RTP packets by their packet type
+	/// (RFC 5761) and routed by the SSRC of their sender.
+	///
+	/// The groups and ports of a media stream are taken from the
+	/// c= line of the media description, or of the session if the
+	/// media has none, and from the ports of the m= line. With a
+	/// range of addresses or ports, as used for layered encodings,
+	/// each layer gets one RTP/RTCP port pair (RFC 4566).
+	///
+	/// Consumers are called on the receiver thread, with no lock of
+	/// the RTPMulticastReceiver held, so they may subscribe and
+	/// unsubscribe. All member functions may be called from any
+	/// thread.
+{
+public:
+	struct Endpoint
+		/// The RTP and RTCP destination of one layer of a stream.
+	{
+		Poco::Net::SocketAddress rtp;
+		Poco::Net::SocketAddress rtcp;
+	};
+
+	typedef std::vector<Endpoint> EndpointVec;
+
+	explicit RTPMulticastReceiver(RTPUDPReceiver& receiver);
+		/// Creates a RTPMulticastReceiver that joins groups on the
+		/// default interface.
+
+	RTPMulticastReceiver(RTPUDPReceiver& receiver, const Poco::Net::NetworkInterface& interfc);
+		/// Creates a RTPMulticastReceiver that joins groups on the
+		/// given interface.
+
+	~RTPMulticastReceiver();
+		/// Leaves all groups.
+
+	void subscribe(const Poco::Net::SocketAddress& group, RTPUDPReceiver::Consumer& consumer);
+		/// Subscribes the consumer to the datagrams of any SSRC sent
+		/// to the group address and port, joining the group if needed.
+		///
+		/// Throws a Poco::InvalidArgumentException if the address is
+		/// not a multicast address.
+
+	void subscribe(const Poco::Net::SocketAddress& group, Poco::UInt32 ssrc, RTPUDPReceiver::Consumer& consumer);
+		/// Subscribes the consumer to the datagrams of the given SSRC
+		/// sent to the group address and port.
+
+	void subscribe(const SDP::SessionDescription& session, const SDP::MediaDescription& media, RTPUDPReceiver::Consumer& rtpConsumer, RTPUDPReceiver::Consumer& rtcpConsumer);
+		/// Subscribes the consumers to the RTP and RTCP datagrams of
+		/// all layers of the media stream. See endpoints().
+
+	void unsubscribe(RTPUDPReceiver::Consumer& consumer);
+		/// Removes all subscriptions of the consumer, leaving the
+		/// groups that are no longer needed. Once unsubscribe()
+		/// has returned, the consumer will not be called any more.
+
+	std::size_t sockets() const;
+		/// Returns the number of sockets, one per group and port.
+
+	std::size_t subscriptions() const;
+		/// Returns the number of subscriptions.
+
+	static EndpointVec endpoints(const SDP::SessionDescription& session, const SDP::MediaDescription& media);
+		/// Returns the RTP and RTCP destinations of each layer of
+		/// the media stream.
+		///
+		/// Throws a Poco::DataFormatException if there is no c= line,
+		/// the address is not a multicast address, the port is zero
+		/// or the numbers of addresses and ports do not match.
+
+private:
+	struct Subscription
+	{
+		Poco::UInt32              ssrc;
+		bool                      anySSRC;
+		RTPUDPReceiver::Consumer* pConsumer;
+	};
+
+	typedef std::vector<Subscription> SubscriptionVec;
+
+	struct Port
+	{
+		Port(const Poco::Net::SocketAddress& group, const Poco::Net::SocketAddress& bindAddress);
+
+		Poco::Net::SocketAddress   address;
+		Poco::Net::MulticastSocket socket;
+		SubscriptionVec            subscriptions;
+		std::size_t                filtered;  /// subscriptions to a single SSRC
+	};
+
+	typedef std::map<std::string, Port*>   PortMap;
+	typedef std::map<poco_socket_t, Port*> SocketMap;
+
+	struct Target
+		/// A run of datagrams to hand to a consumer.
+	{
+		RTPUDPReceiver::Consumer* pConsumer;
+		std::size_t               first;
+		std::size_t               count;
+	};
+
+	typedef std::vector<Target> TargetVec;
+
+	void add(const Poco::Net::SocketAddress& group, const Subscription& subscription);
+	void release(Port* pPort);
+	void onDatagrams(const Poco::Net::DatagramSocket& socket, const RTPUDPReceiver::Datagram* datagrams, std::size_t count);
+	void route(const Port& port, int route, std::size_t first, std::size_t count);
+	bool subscribed(const Poco::Net::DatagramSocket& socket, const RTPUDPReceiver::Consumer* pConsumer) const;
+
+	RTPMulticastReceiver(const RTPMulticastReceiver&);
+	RTPMulticastReceiver& operator = (const RTPMulticastReceiver&);
+
+	RTPUDPReceiver&             _receiver;
+	Poco::Net::NetworkInterface _interface;
+	PortMap                     _ports;
+	SocketMap                   _sockets;
+	std::size_t                 _subscriptions;
+	Poco::AtomicCounter         _generation;     /// counts unsubscribe() calls
+	TargetVec                   _targets;        /// the deliveries of the current batch
+	Poco::Mutex                 _deliveryMutex;  /// held while consumers are called
+	mutable Poco::FastMutex     _mutex;          /// guards the maps against the receiver thread
+};
+
+
+} // namespace RTP
+
+
+#endif // __RTP_MULTICAST_RECEIVER__H__
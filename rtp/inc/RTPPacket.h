@@ -0,0 +1,324 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Packet Class
+//
+//	description:
+//		zero-copy view of a RTP packet
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_PACKET__H__
+#define __RTP_PACKET__H__
+
+
+#include "Poco/Foundation.h"
+#include <cstddef>
+
+#include "rtp.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPPacket
+	/// RTPPacket is a read-only view of a RTP packet (RFC 3550,
+	/// section 5.1) in a buffer owned by the caller.
+	///
+	/// Nothing is copied or converted when a packet is parsed:
+	/// parse() validates the packet and records where its payload
+	/// is, and the accessors decode the header fields from the
+	/// buffer on demand. The buffer must stay valid and unchanged
+	/// for as long as the view is used.
+	///
+	/// A packet is valid if it is at least as long as the header
+	/// it announces, has version 2, its CSRC list and header
+	/// extension fit into the buffer, and its padding count is
+	/// neither zero nor larger than what follows the header.
+	/// The accessors must only be called on valid packets.
+	///
+	/// parse() is written for throughput: the usual packet without
+	/// extension or padding is validated with a single branch, and
+	/// parseBatch() parses the packets returned by one vectored
+	/// receive in a tight loop.
+{
+public:
+	enum
+	{
+		VERSION           = 2,
+		FIXED_HEADER_SIZE = 12,
+		MAX_CSRC_COUNT    = 15
+	};
+
+	enum Status
+		/// The result of validate().
+	{
+		RTP_VALID = 0,
+		RTP_TRUNCATED_HEADER,     /// shorter than the fixed header
+		RTP_BAD_VERSION,          /// version is not 2
+		RTP_TRUNCATED_CSRC,       /// CSRC list exceeds the buffer
+		RTP_TRUNCATED_EXTENSION,  /// header extension exceeds the buffer
+		RTP_BAD_PADDING           /// padding count is 0 or too large
+	};
+
+	RTPPacket();
+		/// Creates an invalid, empty RTPPacket.
+
+	RTPPacket(const void* buffer, std::size_t length);
+		/// Creates a RTPPacket viewing the given buffer and parses it.
+
+	~RTPPacket();
+		/// Destroys the RTPPacket. The buffer is not touched.
+
+	bool parse(const void* buffer, std::size_t length);
+		/// Makes the packet view the given buffer and validates it.
+		/// Returns true if the buffer holds a valid RTP packet.
+
+	static std::size_t parseBatch(const void* const* buffers, const std::size_t* lengths, std::size_t count, RTPPacket* packets);
+		/// Parses count buffers into the corresponding packets and
+		/// returns the number of valid packets among them.
+
+	static Status validate(const void* buffer, std::size_t length);
+		/// Returns why the given buffer does or does not hold a
+		/// valid RTP packet. Meant for diagnostics; parse() is
+		/// faster when only validity matters.
+
+	bool valid() const;
+		/// Returns true if the packet has been parsed successfully.
+
+	const Poco::UInt8* data() const;
+		/// Returns the start of the packet.
+
+	std::size_t size() const;
+		/// Returns the size of the packet in bytes.
+
+	int version() const;
+		/// Returns the RTP version, which is always 2
+		/// for a valid packet.
+
+	bool padding() const;
+		/// Returns true if the packet has padding.
+
+	bool extension() const;
+		/// Returns true if the packet has a header extension.
+
+	int csrcCount() const;
+		/// Returns the number of CSRC identifiers.
+
+	bool marker() const;
+		/// Returns the marker bit.
+
+	int payloadType() const;
+		/// Returns the payload type.
+
+	Poco::UInt16 sequenceNumber() const;
+		/// Returns the sequence number.
+
+	Poco::UInt32 timestamp() const;
+		/// Returns the RTP timestamp.
+
+	Poco::UInt32 ssrc() const;
+		/// Returns the synchronization source identifier.
+
+	Poco::UInt32 csrc(int index) const;
+		/// Returns the index-th contributing source identifier.
+
+	Poco::UInt16 extensionProfile() const;
+		/// Returns the profile specific identifier of the
+		/// header extension, if there is one.
+
+	const Poco::UInt8* extensionData() const;
+		/// Returns the data of the header extension, following
+		/// the profile identifier and length fields.
+
+	std::size_t extensionSize() const;
+		/// Returns the size of the extension data in bytes,
+		/// or 0 if there is no header extension.
+
+	const Poco::UInt8* payload() const;
+		/// Returns the start of the payload.
+
+	std::size_t payloadSize() const;
+		/// Returns the size of the payload in bytes,
+		/// excluding any padding.
+
+	std::size_t paddingSize() const;
+		/// Returns the number of padding bytes, including
+		/// the count byte at the end of the packet.
+
+private:
+	std::size_t csrcEnd() const;
+
+	const Poco::UInt8* _pData;
+	std::size_t        _size;
+	std::size_t        _payloadOffset;
+	std::size_t        _payloadSize;
+	bool               _valid;
+};
+
+
+//
+// inlines
+//
+inline bool RTPPacket::valid() const
+{
+	return _valid;
+}
+
+
+inline const Poco::UInt8* RTPPacket::data() const
+{
+	return _pData;
+}
+
+
+inline std::size_t RTPPacket::size() const
+{
+	return _size;
+}
+
+
+inline int RTPPacket::version() const
+{
+	return _pData[0] >> 6;
+}
+
+
+inline bool RTPPacket::padding() const
+{
+	return (_pData[0] & 0x20) != 0;
+}
+
+
+inline bool RTPPacket::extension() const
+{
+	return (_pData[0] & 0x10) != 0;
+}
+
+
+inline int RTPPacket::csrcCount() const
+{
+	return _pData[0] & 0x0f;
+}
+
+
+inline bool RTPPacket::marker() const
+{
+	return (_pData[1] & 0x80) != 0;
+}
+
+
+inline int RTPPacket::payloadType() const
+{
+	return _pData[1] & 0x7f;
+}
+
+
+inline Poco::UInt16 RTPPacket::sequenceNumber() const
+{
+	return (Poco::UInt16) ((_pData[2] << 8) | _pData[3]);
+}
+
+
+inline Poco::UInt32 RTPPacket::timestamp() const
+{
+	return ((Poco::UInt32) _pData[4] << 24) | ((Poco::UInt32) _pData[5] << 16) | ((Poco::UInt32) _pData[6] << 8) | _pData[7];
+}
+
+
+inline Poco::UInt32 RTPPacket::ssrc() const
+{
+	return ((Poco::UInt32) _pData[8] << 24) | ((Poco::UInt32) _pData[9] << 16) | ((Poco::UInt32) _pData[10] << 8) | _pData[11];
+}
+
+
+inline Poco::UInt32 RTPPacket::csrc(int index) const
+{
+	poco_assert_dbg (index >= 0 && index < csrcCount());
+
+	const Poco::UInt8* p = _pData + FIXED_HEADER_SIZE + 4 * index;
+	return ((Poco::UInt32) p[0] << 24) | ((Poco::UInt32) p[1] << 16) | ((Poco::UInt32) p[2] << 8) | p[3];
+}
+
+
+inline std::size_t RTPPacket::csrcEnd() const
+{
+	return FIXED_HEADER_SIZE + 4 * csrcCount();
+}
+
+
+inline Poco::UInt16 RTPPacket::extensionProfile() const
+{
+	poco_assert_dbg (extension());
+
+	const Poco::UInt8* p = _pData + csrcEnd();
+	return (Poco::UInt16) ((p[0] << 8) | p[1]);
+}
+
+
+inline const Poco::UInt8* RTPPacket::extensionData() const
+{
+	return _pData + csrcEnd() + 4;
+}
+
+
+inline std::size_t RTPPacket::extensionSize() const
+{
+	return extension() ? _payloadOffset - csrcEnd() - 4 : 0;
+}
+
+
+inline const Poco::UInt8* RTPPacket::payload() const
+{
+	return _pData + _payloadOffset;
+}
+
+
+inline std::size_t RTPPacket::payloadSize() const
+{
+	return _payloadSize;
+}
+
+
+inline std::size_t RTPPacket::paddingSize() const
+{
+	return _valid ? _size - _payloadOffset - _payloadSize : 0;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_PACKET__H__
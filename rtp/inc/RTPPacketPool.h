@@ -0,0 +1,323 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Packet Pool Class
+//
+//	description:
+//		slab-allocated, reference-counted buffers for media packets
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_PACKET_POOL__H__
+#define __RTP_PACKET_POOL__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/Mutex.h"
+#include "Poco/AtomicCounter.h"
+#include <vector>
+
+#include "rtp.h"
+
+#if !defined(RTP_HAVE_THREAD_LOCAL)
+#include "Poco/ThreadLocal.h"
+#endif
+
+
+namespace RTP {
+
+
+class RTPPacketPool;
+
+
+class RTP_API RTPPacketBuffer
+	/// RTPPacketBuffer is a fixed-size buffer holding one packet,
+	/// taken from a RTPPacketPool.
+	///
+	/// The buffer is reference counted, so the receive path, the
+	/// jitter buffer and the senders of a fan-out can all hold the
+	/// same packet without copying it: whoever keeps the buffer
+	/// beyond the call that handed it over calls duplicate(), and
+	/// release() when done. The last release() returns the buffer
+	/// to its pool. Poco::AutoPtr does both.
+	///
+	/// The reference count is atomic, so a buffer may be passed
+	/// between threads; access to the data is not synchronized.
+{
+public:
+	typedef Poco::AutoPtr<RTPPacketBuffer> Ptr;
+
+	Poco::UInt8* data();
+		/// Returns the start of the buffer.
+
+	const Poco::UInt8* data() const;
+		/// Returns the start of the buffer.
+
+	std::size_t capacity() const;
+		/// Returns the size of the buffer in bytes.
+
+	std::size_t size() const;
+		/// Returns the number of bytes used.
+
+	void setSize(std::size_t size);
+		/// Sets the number of bytes used, at most capacity().
+
+	void duplicate() const;
+		/// Increments the reference count.
+
+	void release() const;
+		/// Decrements the reference count and returns the buffer
+		/// to its pool when it drops to zero.
+
+	int referenceCount() const;
+		/// Returns the reference count.
+
+private:
+	RTPPacketBuffer(RTPPacketPool& pool, int sizeClass, Poco::UInt8* data, std::size_t capacity);
+	~RTPPacketBuffer();
+
+	RTPPacketBuffer(const RTPPacketBuffer&);
+	RTPPacketBuffer& operator = (const RTPPacketBuffer&);
+
+	mutable Poco::AtomicCounter _counter;
+	RTPPacketPool*              _pPool;
+	Poco::UInt8*                _pData;
+	std::size_t                 _capacity;
+	std::size_t                 _size;
+	int                         _sizeClass;
+	RTPPacketBuffer*            _pNext;  /// next free buffer
+
+	friend class RTPPacketPool;
+};
+
+
+class RTP_API RTPPacketPool
+	/// RTPPacketPool hands out RTPPacketBuffers in two sizes: MTU
+	/// sized for UDP datagrams, and jumbo for GSO batches and
+	/// interleaved frames of up to 64 kB.
+	///
+	/// Buffers are carved out of slabs of SLAB_SIZE bytes, which
+	/// are allocated as needed and kept until the pool is
+	/// destroyed; once the pool has grown to its working set, no
+	/// memory is allocated per packet.
+	///
+	/// Free buffers are kept in a cache per thread and a central
+	/// list, and move between them in batches, so that allocating
+	/// and releasing a buffer takes no lock as a rule. Buffers may
+	/// be released on another thread than the one that allocated
+	/// them. A thread keeps caches for the few pools it used last, so
+	/// a thread serving streams of several pools does not flush its
+	/// cache on every switch; still, an application should rather
+	/// share one pool between its streams than create one per
+	/// stream. Compilers without thread_local keep caches for
+	/// Poco::Threads only; other threads use the central list.
+	///
+	/// The pool counts the buffers in use and the bytes they hold,
+	/// for monitoring and admission control.
+	///
+	/// All member functions are thread-safe.
+{
+public:
+	enum SizeClass
+	{
+		SIZE_MTU,
+		SIZE_JUMBO,
+		SIZE_CLASS_COUNT
+	};
+
+	enum
+	{
+		MTU_SIZE   = 2048,        /// capacity of a MTU sized buffer
+		JUMBO_SIZE = 65536,       /// capacity of a jumbo buffer
+		SLAB_SIZE  = 1024 * 1024  /// bytes allocated at a time
+	};
+
+	struct Statistics
+		/// Counters of a pool.
+	{
+		Poco::UInt64 slabs;           /// slabs allocated
+		Poco::UInt64 slabBytes;       /// bytes of all slabs
+		Poco::UInt64 buffersInUse;    /// buffers allocated and not released
+		Poco::UInt64 bytesInUse;      /// capacity of the buffers in use
+		Poco::UInt64 peakBytesInUse;  /// highest bytesInUse so far
+	};
+
+	RTPPacketPool();
+		/// Creates an empty RTPPacketPool.
+
+	~RTPPacketPool();
+		/// Destroys the RTPPacketPool and frees its slabs. All
+		/// buffers must have been released.
+
+	RTPPacketBuffer::Ptr allocate(std::size_t size);
+		/// Returns a buffer of at least size bytes, with its size
+		/// set to size and a reference count of one.
+		///
+		/// Throws a Poco::InvalidArgumentException if size is
+		/// larger than JUMBO_SIZE.
+
+	std::size_t bytesInUse() const;
+		/// Returns the capacity of the buffers in use.
+
+	Statistics statistics() const;
+		/// Returns a copy of the counters.
+
+	static SizeClass sizeClass(std::size_t size);
+		/// Returns the class of the buffers of at least size bytes.
+		///
+		/// Throws a Poco::InvalidArgumentException if size is
+		/// larger than JUMBO_SIZE.
+
+	static std::size_t classCapacity(SizeClass sizeClass);
+		/// Returns the capacity of the buffers of the given class.
+
+private:
+	struct Slab
+	{
+		Poco::UInt8*     pMemory;
+		RTPPacketBuffer* pBuffers;
+		std::size_t      count;
+	};
+
+	struct FreeList
+	{
+		RTPPacketBuffer* pFirst;
+		std::size_t      count;
+	};
+
+	struct ThreadCache;
+	struct ThreadCaches;
+
+	void recycle(RTPPacketBuffer* pBuffer);
+	RTPPacketBuffer* take(ThreadCache* pCache, int sizeClass);
+	void give(ThreadCache& cache, int sizeClass);
+	void addSlab(int sizeClass);
+	void updatePeak();
+	ThreadCache* threadCache();
+
+	RTPPacketPool(const RTPPacketPool&);
+	RTPPacketPool& operator = (const RTPPacketPool&);
+
+	Poco::UInt64               _serial;  /// tells apart pools at the same address
+	FreeList                   _free[SIZE_CLASS_COUNT];
+	std::vector<Slab>          _slabs;
+	Poco::AtomicCounter        _inUse[SIZE_CLASS_COUNT];
+	Poco::AtomicCounter        _peakUnitsInUse;  /// highest bytes in use so far, in units of MTU_SIZE
+	Poco::FastMutex            _peakMutex;
+	mutable Poco::FastMutex    _mutex;
+
+#if !defined(RTP_HAVE_THREAD_LOCAL)
+	static Poco::ThreadLocal<ThreadCaches> _threadCaches;
+#endif
+
+	friend class RTPPacketBuffer;
+};
+
+
+//
+// inlines
+//
+inline Poco::UInt8* RTPPacketBuffer::data()
+{
+	return _pData;
+}
+
+
+inline const Poco::UInt8* RTPPacketBuffer::data() const
+{
+	return _pData;
+}
+
+
+inline std::size_t RTPPacketBuffer::capacity() const
+{
+	return _capacity;
+}
+
+
+inline std::size_t RTPPacketBuffer::size() const
+{
+	return _size;
+}
+
+
+inline void RTPPacketBuffer::setSize(std::size_t size)
+{
+	poco_assert_dbg (size <= _capacity);
+
+	_size = size;
+}
+
+
+inline void RTPPacketBuffer::duplicate() const
+{
+	++_counter;
+}
+
+
+inline void RTPPacketBuffer::release() const
+{
+	// a sole owner cannot race with anyone, which spares the
+	// atomic decrement for most packets
+	if (_counter.value() == 1 || --_counter == 0)
+	{
+		_pPool->recycle(const_cast<RTPPacketBuffer*>(this));
+	}
+}
+
+
+inline int RTPPacketBuffer::referenceCount() const
+{
+	return _counter.value();
+}
+
+
+inline std::size_t RTPPacketPool::bytesInUse() const
+{
+	return (std::size_t) ((Poco::UInt64) _inUse[SIZE_MTU].value() * MTU_SIZE + (Poco::UInt64) _inUse[SIZE_JUMBO].value() * JUMBO_SIZE);
+}
+
+
+inline std::size_t RTPPacketPool::classCapacity(SizeClass sizeClass)
+{
+	return sizeClass == SIZE_MTU ? MTU_SIZE : JUMBO_SIZE;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_PACKET_POOL__H__
@@ -0,0 +1,178 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Payload Format Class
+//
+//	description:
+//		payload type, clock rate and format parameters of a RTP stream
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_PAYLOAD_FORMAT__H__
+#define __RTP_PAYLOAD_FORMAT__H__
+
+
+#include "Poco/Foundation.h"
+#include <string>
+
+#include "rtp.h"
+#include "MediaDescription.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPPayloadFormat
+	/// RTPPayloadFormat describes how the payload of a RTP stream
+	/// is encoded, as announced by the media description of the
+	/// stream (RFC 4566, section 6): payload type, encoding name,
+	/// clock rate, number of channels and format parameters.
+	///
+	/// The values are taken from the a=rtpmap and a=fmtp attributes
+	/// of the payload type. Static payload types that come without
+	/// a=rtpmap take their encoding name, clock rate and channels
+	/// from SDP::RtpAvpConstants.
+{
+public:
+	RTPPayloadFormat();
+		/// Creates an empty RTPPayloadFormat with payload type -1
+		/// and clock rate 0.
+
+	RTPPayloadFormat(int payloadType, const std::string& encodingName, int clockRate, int channels = 1, const std::string& parameters = "");
+		/// Creates a RTPPayloadFormat from the given values.
+
+	explicit RTPPayloadFormat(const SDP::MediaDescription& media);
+		/// Creates the RTPPayloadFormat of the first payload type
+		/// listed in the m= line of media.
+		///
+		/// Throws a Poco::DataFormatException if media has no
+		/// RTP payload type, or if no clock rate is known for it.
+
+	RTPPayloadFormat(const SDP::MediaDescription& media, int payloadType);
+		/// Creates the RTPPayloadFormat of the given payload type.
+		///
+		/// Throws a Poco::NotFoundException if the m= line of media
+		/// does not list payloadType, and a Poco::DataFormatException
+		/// if no clock rate is known for it.
+
+	~RTPPayloadFormat();
+		/// Destroys the RTPPayloadFormat.
+
+	int payloadType() const;
+		/// Returns the payload type.
+
+	const std::string& encodingName() const;
+		/// Returns the encoding name, e.g. "H264".
+
+	int clockRate() const;
+		/// Returns the RTP clock rate in Hz.
+
+	int channels() const;
+		/// Returns the number of audio channels, which is 1
+		/// unless the a=rtpmap attribute says otherwise.
+
+	const std::string& parameters() const;
+		/// Returns the format parameters of the a=fmtp attribute,
+		/// without the payload type, or an empty string.
+
+	bool hasParameter(const std::string& name) const;
+		/// Returns true if the format parameters contain
+		/// the given parameter. Names are not case sensitive.
+
+	std::string parameter(const std::string& name, const std::string& deflt = "") const;
+		/// Returns the value of the given format parameter,
+		/// or deflt if there is no such parameter.
+
+	static int staticClockRate(int payloadType);
+		/// Returns the clock rate of a static RTP/AVP payload type
+		/// (RFC 3551, section 6), or -1 if payloadType is not a
+		/// static payload type with a known clock rate.
+
+	static std::string decodeBase64(const std::string& encoded);
+		/// Decodes a base64 encoded parameter value, such as the
+		/// NAL units of a sprop-parameter-sets parameter.
+		///
+		/// Throws a Poco::DataFormatException if encoded is not
+		/// valid base64.
+
+private:
+	void load(const SDP::MediaDescription& media, int payloadType);
+	bool findParameter(const std::string& name, std::string::size_type& valuePos, std::string::size_type& valueEnd) const;
+
+	int         _payloadType;
+	std::string _encodingName;
+	int         _clockRate;
+	int         _channels;
+	std::string _parameters;
+};
+
+
+//
+// inlines
+//
+inline int RTPPayloadFormat::payloadType() const
+{
+	return _payloadType;
+}
+
+
+inline const std::string& RTPPayloadFormat::encodingName() const
+{
+	return _encodingName;
+}
+
+
+inline int RTPPayloadFormat::clockRate() const
+{
+	return _clockRate;
+}
+
+
+inline int RTPPayloadFormat::channels() const
+{
+	return _channels;
+}
+
+
+inline const std::string& RTPPayloadFormat::parameters() const
+{
+	return _parameters;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_PAYLOAD_FORMAT__H__
@@ -0,0 +1,191 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Port Allocator Class
+//
+//	description:
+//		hands out bound RTP/RTCP port pairs from a configured range
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_PORT_ALLOCATOR__H__
+#define __RTP_PORT_ALLOCATOR__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Mutex.h"
+#include "Poco/Net/DatagramSocket.h"
+#include "Poco/Net/IPAddress.h"
+#include <deque>
+#include <vector>
+
+#include "rtp.h"
+#include "PortRange.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPPortAllocator
+	/// RTPPortAllocator hands out the even/odd UDP port pairs for the
+	/// RTP and RTCP sockets of SETUP requests from a configured range,
+	/// with both sockets bound, ready for the client_port parameter
+	/// of the Transport header.
+	///
+	/// The free pairs are kept in a two-level bitmap, searched from
+	/// where the previous search stopped, so a free pair is found with
+	/// a few word operations and released ports are the last to be
+	/// handed out again, so late datagrams of a torn down stream do
+	/// not reach the next one. Up to reserve() pairs are bound in
+	/// advance, and topped up from the search when a pair is
+	/// released, so that SETUP usually takes a pair without any
+	/// system call.
+	///
+	/// A pair whose ports cannot be bound, because another process
+	/// holds one of them, is skipped until the search comes round
+	/// again.
+	///
+	/// All member functions are thread-safe.
+{
+public:
+	struct Pair
+		/// A bound RTP/RTCP socket pair.
+	{
+		Poco::UInt16              rtpPort;  /// even; the RTCP port is rtpPort + 1
+		Poco::Net::DatagramSocket rtp;
+		Poco::Net::DatagramSocket rtcp;
+	};
+
+	explicit RTPPortAllocator(const SDP::PortRange& range, std::size_t reserve = 0, const Poco::Net::IPAddress& address = Poco::Net::IPAddress());
+		/// Creates a RTPPortAllocator for the pairs within range, whose
+		/// first port is rounded up to an even number, binding sockets
+		/// to the given address. Binds reserve pairs in advance.
+		///
+		/// Throws a Poco::InvalidArgumentException if the range holds
+		/// no pair.
+
+	~RTPPortAllocator();
+		/// Closes the sockets of the pairs bound in advance.
+
+	Pair acquire();
+		/// Returns a bound pair.
+		///
+		/// Throws a Poco::NotFoundException if no pair can be bound.
+
+	void release(const Pair& pair);
+		/// Returns a pair, typically on TEARDOWN. Its sockets are
+		/// closed and its ports are handed out again once the search
+		/// has come round the range to them. If fewer than reserve()
+		/// pairs are bound in advance, the next free pair is bound in
+		/// its place.
+		///
+		/// Throws a Poco::InvalidArgumentException if the pair was not
+		/// acquired from this allocator or has already been released.
+
+	void refill();
+		/// Binds pairs in advance until there are reserve() of them,
+		/// for example from a timer after a burst of SETUP requests.
+
+	Poco::UInt16 firstPort() const;
+		/// Returns the RTP port of the first pair.
+
+	std::size_t capacity() const;
+		/// Returns the number of pairs in the range.
+
+	std::size_t reserve() const;
+		/// Returns the number of pairs kept bound in advance.
+
+	std::size_t available() const;
+		/// Returns the number of pairs not acquired.
+
+	std::size_t reserved() const;
+		/// Returns the number of pairs currently bound in advance.
+
+private:
+	enum
+	{
+		WORD_BITS = 64
+	};
+
+	typedef std::deque<Pair> PairQueue;
+
+	bool allocate(Pair& pair);
+	bool bind(std::size_t index, Pair& pair) const;
+	std::size_t findFree(std::size_t from) const;
+	void take(std::size_t index);
+	void give(std::size_t index);
+	bool isFree(std::size_t index) const;
+
+	RTPPortAllocator(const RTPPortAllocator&);
+	RTPPortAllocator& operator = (const RTPPortAllocator&);
+
+	Poco::Net::IPAddress      _address;
+	Poco::UInt16              _firstPort;
+	std::size_t               _capacity;
+	std::size_t               _reserve;
+	std::size_t               _free;     /// pairs neither acquired nor bound in advance
+	std::size_t               _cursor;
+	std::vector<Poco::UInt64> _bitmap;   /// a set bit for every free pair
+	std::vector<Poco::UInt64> _summary;  /// a set bit for every bitmap word with a free pair
+	PairQueue                 _pool;
+	mutable Poco::FastMutex   _mutex;
+};
+
+
+//
+// inlines
+//
+inline Poco::UInt16 RTPPortAllocator::firstPort() const
+{
+	return _firstPort;
+}
+
+
+inline std::size_t RTPPortAllocator::capacity() const
+{
+	return _capacity;
+}
+
+
+inline std::size_t RTPPortAllocator::reserve() const
+{
+	return _reserve;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_PORT_ALLOCATOR__H__
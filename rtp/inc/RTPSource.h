@@ -0,0 +1,246 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Source Class
+//
+//	description:
+//		reception statistics of a synchronization source
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_SOURCE__H__
+#define __RTP_SOURCE__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Timestamp.h"
+#include <string>
+
+#include "rtp.h"
+#include "RTPPacket.h"
+#include "RTCPPacket.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPSource
+	/// RTPSource keeps the reception statistics of one
+	/// synchronization source as RFC 3550 prescribes for
+	/// reception reports: sequence number tracking with
+	/// probation (appendix A.1), packet loss (A.3) and
+	/// interarrival jitter (A.8).
+	///
+	/// It also remembers the last sender report of the source,
+	/// which maps RTP timestamps to wall clock time and provides
+	/// the LSR and DLSR fields of the report block.
+{
+public:
+	enum
+	{
+		MIN_SEQUENTIAL = 2,
+		MAX_DROPOUT    = 3000,
+		MAX_MISORDER   = 100
+	};
+
+	RTPSource(Poco::UInt32 ssrc, int clockRate);
+		/// Creates a RTPSource for the given SSRC, whose RTP
+		/// timestamps run at clockRate Hz.
+
+	~RTPSource();
+		/// Destroys the RTPSource.
+
+	bool update(const RTPPacket& packet, const Poco::Timestamp& arrival);
+		/// Accounts for a RTP packet of the source. Returns false
+		/// while the source is on probation or if the packet has
+		/// been discarded for a large jump in sequence numbers.
+
+	void updateSenderReport(const RTCPPacket::SenderInfo& info, const Poco::Timestamp& arrival);
+		/// Remembers a sender report of the source.
+
+	void updateActivity(const Poco::Timestamp& time);
+		/// Records that a RTCP packet of the source has been
+		/// received at the given time.
+
+	RTCPPacket::ReportBlock reportBlock(const Poco::Timestamp& now);
+		/// Returns the report block for the source and starts
+		/// a new reporting interval.
+
+	bool wallClock(Poco::UInt32 rtpTimestamp, Poco::Timestamp& time) const;
+		/// Converts a RTP timestamp of the source to wall clock time
+		/// using its last sender report. Returns false if no sender
+		/// report has been received.
+
+	Poco::UInt32 ssrc() const;
+		/// Returns the SSRC.
+
+	const std::string& cname() const;
+		/// Returns the canonical name of the source, or an
+		/// empty string if it has not been received.
+
+	void setCName(const std::string& cname);
+		/// Sets the canonical name of the source.
+
+	bool valid() const;
+		/// Returns true once the source has left probation.
+
+	bool hasSenderReport() const;
+		/// Returns true if a sender report has been received.
+
+	Poco::UInt32 extendedHighestSequence() const;
+		/// Returns the extended highest sequence number received.
+
+	Poco::UInt32 received() const;
+		/// Returns the number of packets received.
+
+	Poco::UInt32 receivedSinceReport() const;
+		/// Returns the number of packets received since
+		/// the last report block.
+
+	Poco::Int64 lost() const;
+		/// Returns the cumulative number of packets lost, which
+		/// is negative if duplicates have been received.
+
+	Poco::UInt32 jitter() const;
+		/// Returns the interarrival jitter in timestamp units.
+
+	const Poco::Timestamp& lastRTP() const;
+		/// Returns the time the last RTP packet was received.
+
+	const Poco::Timestamp& lastActivity() const;
+		/// Returns the time the last RTP or RTCP packet
+		/// was received.
+
+private:
+	void initSequence(Poco::UInt16 seq);
+	bool updateSequence(Poco::UInt16 seq);
+
+	Poco::UInt32    _ssrc;
+	int             _clockRate;
+	std::string     _cname;
+	Poco::UInt16    _maxSeq;
+	Poco::UInt32    _cycles;
+	Poco::UInt32    _baseSeq;
+	Poco::UInt32    _badSeq;
+	Poco::UInt32    _probation;
+	Poco::UInt32    _received;
+	Poco::UInt32    _expectedPrior;
+	Poco::UInt32    _receivedPrior;
+	Poco::Int64     _transit;
+	Poco::UInt32    _jitter;
+	bool            _hasTransit;
+	bool            _hasSenderReport;
+	Poco::UInt64    _srNTPTimestamp;
+	Poco::UInt32    _srRTPTimestamp;
+	Poco::Timestamp _srArrival;
+	Poco::Timestamp _firstArrival;
+	Poco::Timestamp _lastRTP;
+	Poco::Timestamp _lastActivity;
+};
+
+
+//
+// inlines
+//
+inline Poco::UInt32 RTPSource::ssrc() const
+{
+	return _ssrc;
+}
+
+
+inline const std::string& RTPSource::cname() const
+{
+	return _cname;
+}
+
+
+inline bool RTPSource::valid() const
+{
+	return _probation == 0;
+}
+
+
+inline bool RTPSource::hasSenderReport() const
+{
+	return _hasSenderReport;
+}
+
+
+inline Poco::UInt32 RTPSource::extendedHighestSequence() const
+{
+	return _cycles + _maxSeq;
+}
+
+
+inline Poco::UInt32 RTPSource::received() const
+{
+	return _received;
+}
+
+
+inline Poco::UInt32 RTPSource::receivedSinceReport() const
+{
+	return _received - _receivedPrior;
+}
+
+
+inline Poco::Int64 RTPSource::lost() const
+{
+	return (Poco::Int64) extendedHighestSequence() - _baseSeq + 1 - _received;
+}
+
+
+inline Poco::UInt32 RTPSource::jitter() const
+{
+	return _jitter >> 4;
+}
+
+
+inline const Poco::Timestamp& RTPSource::lastRTP() const
+{
+	return _lastRTP;
+}
+
+
+inline const Poco::Timestamp& RTPSource::lastActivity() const
+{
+	return _lastActivity;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_SOURCE__H__
@@ -0,0 +1,238 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP UDP Receiver Class
+//
+//	description:
+//		receives the RTP and RTCP datagrams of many tracks in batches
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_UDP_RECEIVER__H__
+#define __RTP_UDP_RECEIVER__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Mutex.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Net/DatagramSocket.h"
+#include <map>
+#include <vector>
+
+#include "rtp.h"
+#include "RTPPacketPool.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPUDPReceiver: public Poco::Runnable
+	/// RTPUDPReceiver receives the datagrams arriving at the UDP
+	/// sockets of any number of tracks on a single thread, and
+	/// hands them to the Consumer registered for each socket, in
+	/// batches of up to batchSize() datagrams.
+	///
+	/// A track registers the sockets bound to the client ports it
+	/// negotiated in SETUP, usually one for RTP and one for RTCP.
+	///
+	/// On Linux, the sockets are watched with epoll and read with
+	/// recvmmsg(), so a batch costs one system call instead of
+	/// one per datagram. Each ready socket gets one batch per
+	/// wakeup, so a busy stream cannot starve the others.
+	/// Elsewhere, Socket::select() and receiveBytes() are used.
+	///
+	/// The datagrams are received into buffers owned by the
+	/// receiver, which are reused for every batch; no memory is
+	/// allocated per datagram. With a RTPPacketPool, the buffers
+	/// are pool buffers, which a consumer may keep, for a jitter
+	/// buffer or a relay, instead of copying the datagram; the
+	/// receiver then takes a new buffer from the pool in its place.
+	///
+	/// With timestamping enabled, the arrival time of a datagram is
+	/// taken by the kernel (SO_TIMESTAMPNS) when it is available;
+	/// otherwise it is the time the batch was received.
+	///
+	/// Consumers are called with no lock of the receiver held, so
+	/// they may add and remove sockets. All member functions may be
+	/// called from any thread.
+{
+public:
+	enum
+	{
+		MAX_BATCH_SIZE        = 64,
+		DEFAULT_DATAGRAM_SIZE = 2048
+	};
+
+	struct Datagram
+		/// A received datagram.
+	{
+		const Poco::UInt8* data;
+		std::size_t        size;
+		Poco::Timestamp    arrival;
+		bool               kernelTimestamp;  /// arrival was taken by the kernel
+		RTPPacketBuffer*   pBuffer;          /// the pool buffer holding data, or NULL without a pool
+	};
+
+	class RTP_API Consumer
+		/// A Consumer receives the datagrams of one or more sockets.
+	{
+	public:
+		virtual ~Consumer();
+			/// Destroys the Consumer.
+
+		virtual void onDatagrams(const Poco::Net::DatagramSocket& socket, const Datagram* datagrams, std::size_t count) = 0;
+			/// Called on the receiver thread with the datagrams received
+			/// on socket. The data is only valid until the consumer
+			/// returns, unless the consumer calls duplicate() on the
+			/// pool buffer of a datagram to keep it. Must not block
+			/// and must not throw.
+	};
+
+	struct Statistics
+		/// Counters of a receiver.
+	{
+		Poco::UInt64 wakeups;    /// returns from waiting for sockets
+		Poco::UInt64 batches;    /// non-empty batches handed to consumers
+		Poco::UInt64 datagrams;  /// datagrams handed to consumers
+		Poco::UInt64 bytes;      /// bytes handed to consumers
+		Poco::UInt64 truncated;  /// datagrams dropped for exceeding datagramSize()
+	};
+
+	RTPUDPReceiver(std::size_t batchSize = MAX_BATCH_SIZE, std::size_t datagramSize = DEFAULT_DATAGRAM_SIZE, bool timestamping = false, RTPPacketPool* pPool = 0);
+		/// Creates the RTPUDPReceiver and starts its thread. Batches
+		/// hold up to batchSize datagrams (at most MAX_BATCH_SIZE) of
+		/// up to datagramSize bytes each. If pPool is given, the
+		/// datagrams are received into buffers from the pool, which
+		/// must outlive the receiver.
+		///
+		/// Throws a Poco::InvalidArgumentException for invalid sizes
+		/// and a Poco::SystemException if the event queue cannot
+		/// be created.
+
+	~RTPUDPReceiver();
+		/// Stops the thread. All sockets should have been removed.
+
+	void add(const Poco::Net::DatagramSocket& socket, Consumer& consumer);
+		/// Registers a bound socket, which is made non-blocking,
+		/// and the consumer for its datagrams.
+
+	void remove(const Poco::Net::DatagramSocket& socket);
+		/// Unregisters the socket. Once remove() has returned, the
+		/// consumer of the socket will not be called any more. May be
+		/// called from the consumer itself.
+
+	std::size_t size() const;
+		/// Returns the number of registered sockets.
+
+	std::size_t batchSize() const;
+		/// Returns the maximum number of datagrams in a batch.
+
+	std::size_t datagramSize() const;
+		/// Returns the maximum size of a datagram.
+
+	bool timestamping() const;
+		/// Returns true if kernel timestamps are requested.
+
+	Statistics statistics() const;
+		/// Returns a copy of the counters.
+
+	void run();
+		/// The receiver thread. Do not call directly.
+
+private:
+	struct Entry
+	{
+		Poco::Net::DatagramSocket socket;
+		Consumer*                 pConsumer;
+	};
+
+	struct Batch;
+
+	typedef std::map<poco_socket_t, Entry> EntryMap;
+
+	void init();
+	void dispatch(poco_socket_t fd);
+	void awaitDelivery();
+	std::size_t receive(Entry& entry);
+	Poco::UInt8* slot(std::size_t index);
+
+	RTPUDPReceiver(const RTPUDPReceiver&);
+	RTPUDPReceiver& operator = (const RTPUDPReceiver&);
+
+	std::size_t                       _batchSize;
+	std::size_t                       _datagramSize;
+	bool                              _timestamping;
+	std::vector<Poco::UInt8>          _buffer;
+	RTPPacketPool*                    _pPool;
+	std::vector<RTPPacketBuffer::Ptr> _slots;  /// the pool buffers of the batch
+	std::vector<Datagram>             _datagrams;
+	Batch*                            _pBatch;
+	int                               _queue;
+	EntryMap                          _entries;
+	Statistics                        _statistics;
+	bool                              _stop;
+	Poco::Thread                      _thread;
+	Poco::Mutex                       _deliveryMutex;  /// held while consumers are called
+	mutable Poco::Mutex               _mutex;          /// guards the entries and counters
+};
+
+
+//
+// inlines
+//
+inline std::size_t RTPUDPReceiver::batchSize() const
+{
+	return _batchSize;
+}
+
+
+inline std::size_t RTPUDPReceiver::datagramSize() const
+{
+	return _datagramSize;
+}
+
+
+inline bool RTPUDPReceiver::timestamping() const
+{
+	return _timestamping;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_UDP_RECEIVER__H__
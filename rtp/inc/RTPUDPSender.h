@@ -0,0 +1,191 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP UDP Sender Class
+//
+//	description:
+//		sends RTP packets to many UDP destinations in batches
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP_UDP_SENDER__H__
+#define __RTP_UDP_SENDER__H__
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Net/DatagramSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include <vector>
+
+#include "rtp.h"
+
+
+namespace RTP {
+
+
+class RTP_API RTPUDPSender
+	/// RTPUDPSender sends bursts of RTP packets, such as the packets
+	/// of a video frame, from one UDP socket to a list of
+	/// destinations, as a server fanning a camera out to many
+	/// viewers does.
+	///
+	/// On Linux, the datagrams for all destinations are handed to
+	/// the kernel with sendmmsg(), up to MAX_MESSAGES at a time. If
+	/// the kernel supports UDP generic segmentation offload
+	/// (UDP_SEGMENT, Linux 4.18), each run of equal-sized packets
+	/// (the last one may be shorter) goes to a destination as a
+	/// single message, which the kernel splits into datagrams after
+	/// routing and filtering it once. If the device turns out not
+	/// to support segmentation, GSO is given up and the packets of
+	/// the burst are sent again as plain datagrams. Elsewhere, the
+	/// packets are sent one by one with sendTo().
+	///
+	/// The message headers are reused, so no memory is allocated
+	/// per packet once the largest burst has been sent.
+	///
+	/// A RTPUDPSender is not thread-safe.
+{
+public:
+	enum
+	{
+		MAX_MESSAGES = 256,  /// messages per sendmmsg() call
+		MAX_SEGMENTS = 64    /// datagrams per GSO message
+	};
+
+	struct Packet
+		/// A packet to send. The data is not copied, so it may be
+		/// the RTPPacketBuffer a packet was received into.
+	{
+		const Poco::UInt8* data;
+		std::size_t        size;
+	};
+
+	struct Statistics
+		/// Counters of a sender.
+	{
+		Poco::UInt64 calls;     /// system calls
+		Poco::UInt64 messages;  /// messages handed to the kernel
+		Poco::UInt64 packets;   /// datagrams sent
+		Poco::UInt64 bytes;     /// bytes sent
+		Poco::UInt64 errors;    /// datagrams that could not be sent
+	};
+
+	explicit RTPUDPSender(const Poco::Net::DatagramSocket& socket);
+		/// Creates a RTPUDPSender sending from socket, which
+		/// should not be connected. GSO is used if the
+		/// kernel supports it.
+
+	~RTPUDPSender();
+		/// Destroys the RTPUDPSender.
+
+	void addDestination(const Poco::Net::SocketAddress& destination);
+		/// Adds a destination for send(), unless it is already there.
+
+	void removeDestination(const Poco::Net::SocketAddress& destination);
+		/// Removes a destination.
+
+	std::size_t destinations() const;
+		/// Returns the number of destinations.
+
+	void send(const Packet* packets, std::size_t count);
+		/// Sends the packets to all destinations.
+
+	void sendTo(const Poco::Net::SocketAddress& destination, const Packet* packets, std::size_t count);
+		/// Sends the packets to the given destination only.
+
+	bool gsoSupported() const;
+		/// Returns true if the kernel supports UDP segmentation
+		/// offload on the socket.
+
+	void setGSO(bool enable);
+		/// Enables or disables the use of UDP segmentation offload,
+		/// if it is supported. It is enabled by default.
+
+	bool getGSO() const;
+		/// Returns true if UDP segmentation offload is used.
+
+	const Statistics& statistics() const;
+		/// Returns the counters.
+
+private:
+	struct Batch;
+
+	void transmit(const Poco::Net::SocketAddress* destinations, std::size_t destinationCount, const Packet* packets, std::size_t count);
+	void flush(std::size_t count);
+	void resend(std::size_t first, std::size_t count);
+
+	RTPUDPSender(const RTPUDPSender&);
+	RTPUDPSender& operator = (const RTPUDPSender&);
+
+	Poco::Net::DatagramSocket              _socket;
+	std::vector<Poco::Net::SocketAddress>  _destinations;
+	bool                                   _gsoSupported;
+	bool                                   _gso;
+	Batch*                                 _pBatch;
+	Statistics                             _statistics;
+};
+
+
+//
+// inlines
+//
+inline std::size_t RTPUDPSender::destinations() const
+{
+	return _destinations.size();
+}
+
+
+inline bool RTPUDPSender::gsoSupported() const
+{
+	return _gsoSupported;
+}
+
+
+inline bool RTPUDPSender::getGSO() const
+{
+	return _gso;
+}
+
+
+inline const RTPUDPSender::Statistics& RTPUDPSender::statistics() const
+{
+	return _statistics;
+}
+
+
+} // namespace RTP
+
+
+#endif // __RTP_UDP_SENDER__H__
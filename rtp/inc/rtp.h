@@ -0,0 +1,111 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	Base Definitions Header
+//
+//	description:
+//		contains basic definitions and preprocessor conditions
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTP__H__
+#define __RTP__H__
+
+//
+// Ensure that RTP_DLL is default unless RTP_STATIC is defined
+//
+#if defined(_WIN32) && defined(_DLL)
+	#if !defined(RTP_DLL) && !defined(RTP_STATIC)
+		#define RTP_DLL
+	#endif
+#endif
+
+//
+// The following block is the standard way of creating macros which make exporting
+// from a DLL simpler. All files within this DLL are compiled with the RTP_EXPORTS
+// symbol defined on the command line. this symbol should not be defined on any project
+// that uses this DLL. This way any other project whose source files include this file see
+// RTP_API functions as being imported from a DLL, wheras this DLL sees symbols
+// defined with this macro as being exported.
+//
+#if defined(_WIN32) && defined(RTP_DLL)
+	#if defined(RTP_EXPORTS)
+		#define RTP_API __declspec(dllexport)
+	#else
+		#define RTP_API __declspec(dllimport)
+	#endif
+#endif
+
+
+#if !defined(RTP_API)
+	#define RTP_API
+#endif
+
+
+//
+// RTP_HAVE_THREAD_LOCAL is defined when the compiler supports
+// thread_local. Visual C++ 2005 does not; code using it keeps a
+// fallback for it.
+//
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+	#define RTP_HAVE_THREAD_LOCAL
+#endif
+
+
+//
+// Automatically link RTP library.
+//
+#if defined(_MSC_VER)
+	#if !defined(POCO_NO_AUTOMATIC_LIBS) && !defined(RTP_EXPORTS)
+		#if defined(RTP_DLL)
+			#if defined(_DEBUG)
+				#pragma comment(lib, "rtpd.lib")
+			#else
+				#pragma comment(lib, "rtp.lib")
+			#endif
+/*
+		#else
+			#if defined(_DEBUG)
+				#pragma comment(lib, "PocoNetmtd.lib")
+			#else
+				#pragma comment(lib, "PocoNetmt.lib")
+			#endif
+			*/
+		#endif
+	#endif
+#endif
+
+
+#endif // __RTP__H__
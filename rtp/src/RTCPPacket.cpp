@@ -0,0 +1,336 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTCP Packet Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTCPPacket.h"
+#include <cstring>
+
+
+using Poco::UInt8;
+using Poco::UInt32;
+using Poco::UInt64;
+using Poco::Int32;
+
+
+namespace RTP {
+
+
+namespace
+{
+	inline UInt32 get32(const UInt8* p)
+	{
+		return ((UInt32) p[0] << 24) | ((UInt32) p[1] << 16) | ((UInt32) p[2] << 8) | p[3];
+	}
+
+	inline void put32(UInt8* p, UInt32 value)
+	{
+		p[0] = (UInt8) (value >> 24);
+		p[1] = (UInt8) (value >> 16);
+		p[2] = (UInt8) (value >> 8);
+		p[3] = (UInt8) value;
+	}
+
+	inline void putHeader(UInt8* p, int count, int type, std::size_t size)
+	{
+		std::size_t words = size / 4 - 1;
+		p[0] = (UInt8) (0x80 | count);
+		p[1] = (UInt8) type;
+		p[2] = (UInt8) (words >> 8);
+		p[3] = (UInt8) words;
+	}
+
+	std::size_t writeReport(UInt8* buffer, std::size_t capacity, int type, std::size_t headerSize, const RTCPPacket::ReportBlock* blocks, int blockCount)
+	{
+		if (blockCount > RTCPPacket::MAX_REPORT_BLOCKS) blockCount = RTCPPacket::MAX_REPORT_BLOCKS;
+		std::size_t size = headerSize + RTCPPacket::REPORT_BLOCK_SIZE * blockCount;
+		if (size > capacity) return 0;
+
+		putHeader(buffer, blockCount, type, size);
+		UInt8* p = buffer + headerSize;
+		for (int i = 0; i < blockCount; ++i, p += RTCPPacket::REPORT_BLOCK_SIZE)
+		{
+			const RTCPPacket::ReportBlock& block = blocks[i];
+			put32(p, block.ssrc);
+			put32(p + 4, ((UInt32) block.cumulativeLost & 0x00FFFFFF) | ((UInt32) block.fractionLost << 24));
+			put32(p + 8, block.extendedHighestSequence);
+			put32(p + 12, block.jitter);
+			put32(p + 16, block.lastSR);
+			put32(p + 20, block.delaySinceLastSR);
+		}
+		return size;
+	}
+}
+
+
+RTCPPacket::RTCPPacket():
+	_pData(0),
+	_size(0),
+	_valid(false)
+{
+}
+
+
+RTCPPacket::~RTCPPacket()
+{
+}
+
+
+bool RTCPPacket::parse(const void* buffer, std::size_t length)
+{
+	const UInt8* p = static_cast<const UInt8*>(buffer);
+	_pData = p;
+	_size  = 0;
+	_valid = false;
+	if (length < HEADER_SIZE || (p[0] >> 6) != 2) return false;
+
+	std::size_t size = 4 * ((std::size_t) ((p[2] << 8) | p[3]) + 1);
+	if (size > length) return false;
+	_size = size;
+
+	std::size_t body = size;
+	if (padding())
+	{
+		std::size_t pad = p[size - 1];
+		if (pad == 0 || pad > size - HEADER_SIZE) return false;
+		body -= pad;
+	}
+
+	std::size_t count = p[0] & 0x1f;
+	switch (p[1])
+	{
+	case RTCP_SR:
+		_valid = body >= HEADER_SIZE + 4 + SENDER_INFO_SIZE + REPORT_BLOCK_SIZE * count;
+		break;
+	case RTCP_RR:
+		_valid = body >= HEADER_SIZE + 4 + REPORT_BLOCK_SIZE * count;
+		break;
+	case RTCP_BYE:
+		_valid = body >= HEADER_SIZE + 4 * count;
+		break;
+	default:
+		_valid = true;
+		break;
+	}
+	return _valid;
+}
+
+
+bool RTCPPacket::validateCompound(const void* buffer, std::size_t length)
+{
+	const UInt8* p = static_cast<const UInt8*>(buffer);
+	if (length < HEADER_SIZE) return false;
+
+	// the first packet is a SR or RR without padding (RFC 3550, A.2)
+	if ((p[0] & 0xe0) != 0x80 || (p[1] != RTCP_SR && p[1] != RTCP_RR)) return false;
+
+	std::size_t offset = 0;
+	while (offset + HEADER_SIZE <= length)
+	{
+		const UInt8* q = p + offset;
+		if ((q[0] >> 6) != 2) return false;
+
+		offset += 4 * ((std::size_t) ((q[2] << 8) | q[3]) + 1);
+		if ((q[0] & 0x20) && offset != length) return false;
+	}
+	return offset == length;
+}
+
+
+UInt32 RTCPPacket::ssrc() const
+{
+	poco_assert_dbg (_size >= HEADER_SIZE + 4);
+
+	return get32(_pData + HEADER_SIZE);
+}
+
+
+RTCPPacket::SenderInfo RTCPPacket::senderInfo() const
+{
+	poco_assert_dbg (type() == RTCP_SR);
+
+	const UInt8* p = _pData + HEADER_SIZE;
+	SenderInfo info;
+	info.ssrc         = get32(p);
+	info.ntpTimestamp = ((UInt64) get32(p + 4) << 32) | get32(p + 8);
+	info.rtpTimestamp = get32(p + 12);
+	info.packetCount  = get32(p + 16);
+	info.octetCount   = get32(p + 20);
+	return info;
+}
+
+
+RTCPPacket::ReportBlock RTCPPacket::reportBlock(int index) const
+{
+	poco_assert_dbg ((type() == RTCP_SR || type() == RTCP_RR) && index >= 0 && index < count());
+
+	const UInt8* p = _pData + HEADER_SIZE + 4 + (type() == RTCP_SR ? SENDER_INFO_SIZE : 0) + REPORT_BLOCK_SIZE * index;
+	ReportBlock block;
+	block.ssrc         = get32(p);
+	block.fractionLost = p[4];
+
+	// sign-extend the 24-bit cumulative number of packets lost
+	UInt32 lost = get32(p + 4) & 0x00FFFFFF;
+	block.cumulativeLost          = (lost & 0x00800000) ? (Int32) (lost | 0xFF000000) : (Int32) lost;
+	block.extendedHighestSequence = get32(p + 8);
+	block.jitter                  = get32(p + 12);
+	block.lastSR                  = get32(p + 16);
+	block.delaySinceLastSR        = get32(p + 20);
+	return block;
+}
+
+
+std::size_t RTCPPacket::sdesItems(SDESItem* items, std::size_t maxItems) const
+{
+	poco_assert_dbg (type() == RTCP_SDES);
+
+	std::size_t n   = 0;
+	std::size_t pos = HEADER_SIZE;
+	std::size_t end = padding() ? _size - _pData[_size - 1] : _size;
+	for (int chunk = 0; chunk < count() && pos + 4 <= end; ++chunk)
+	{
+		UInt32 source = get32(_pData + pos);
+		pos += 4;
+		while (pos < end && _pData[pos] != SDES_END)
+		{
+			if (pos + 2 > end || pos + 2 + _pData[pos + 1] > end) return n;
+
+			if (n < maxItems)
+			{
+				items[n].ssrc   = source;
+				items[n].type   = _pData[pos];
+				items[n].text   = reinterpret_cast<const char*>(_pData + pos + 2);
+				items[n].length = _pData[pos + 1];
+				++n;
+			}
+			pos += 2 + _pData[pos + 1];
+		}
+
+		// the item list ends with a null octet and is
+		// padded to the next 32-bit boundary
+		pos = (pos + 4) & ~(std::size_t) 3;
+	}
+	return n;
+}
+
+
+UInt32 RTCPPacket::byeSource(int index) const
+{
+	poco_assert_dbg (type() == RTCP_BYE && index >= 0 && index < count());
+
+	return get32(_pData + HEADER_SIZE + 4 * index);
+}
+
+
+std::string RTCPPacket::byeReason() const
+{
+	poco_assert_dbg (type() == RTCP_BYE);
+
+	std::size_t pos = HEADER_SIZE + 4 * count();
+	std::size_t end = padding() ? _size - _pData[_size - 1] : _size;
+	if (pos >= end || pos + 1 + _pData[pos] > end) return std::string();
+
+	return std::string(reinterpret_cast<const char*>(_pData + pos + 1), _pData[pos]);
+}
+
+
+std::size_t RTCPPacket::writeSenderReport(UInt8* buffer, std::size_t capacity, const SenderInfo& info, const ReportBlock* blocks, int blockCount)
+{
+	std::size_t size = writeReport(buffer, capacity, RTCP_SR, HEADER_SIZE + 4 + SENDER_INFO_SIZE, blocks, blockCount);
+	if (size == 0) return 0;
+
+	UInt8* p = buffer + HEADER_SIZE;
+	put32(p, info.ssrc);
+	put32(p + 4, (UInt32) (info.ntpTimestamp >> 32));
+	put32(p + 8, (UInt32) info.ntpTimestamp);
+	put32(p + 12, info.rtpTimestamp);
+	put32(p + 16, info.packetCount);
+	put32(p + 20, info.octetCount);
+	return size;
+}
+
+
+std::size_t RTCPPacket::writeReceiverReport(UInt8* buffer, std::size_t capacity, UInt32 ssrc, const ReportBlock* blocks, int blockCount)
+{
+	std::size_t size = writeReport(buffer, capacity, RTCP_RR, HEADER_SIZE + 4, blocks, blockCount);
+	if (size == 0) return 0;
+
+	put32(buffer + HEADER_SIZE, ssrc);
+	return size;
+}
+
+
+std::size_t RTCPPacket::writeSDES(UInt8* buffer, std::size_t capacity, UInt32 ssrc, const std::string& cname)
+{
+	std::size_t length = cname.size() > 255 ? 255 : cname.size();
+
+	// header, SSRC, CNAME item and at least one null
+	// octet, padded to the next 32-bit boundary
+	std::size_t size = (HEADER_SIZE + 4 + 2 + length + 4) & ~(std::size_t) 3;
+	if (size > capacity) return 0;
+
+	putHeader(buffer, 1, RTCP_SDES, size);
+	put32(buffer + HEADER_SIZE, ssrc);
+	UInt8* p = buffer + HEADER_SIZE + 4;
+	p[0] = SDES_CNAME;
+	p[1] = (UInt8) length;
+	std::memcpy(p + 2, cname.data(), length);
+	std::memset(p + 2 + length, 0, buffer + size - (p + 2 + length));
+	return size;
+}
+
+
+std::size_t RTCPPacket::writeBye(UInt8* buffer, std::size_t capacity, UInt32 ssrc, const std::string& reason)
+{
+	std::size_t length = reason.size() > 255 ? 255 : reason.size();
+	std::size_t size = HEADER_SIZE + 4 + (length > 0 ? (1 + length + 3) & ~(std::size_t) 3 : 0);
+	if (size > capacity) return 0;
+
+	putHeader(buffer, 1, RTCP_BYE, size);
+	put32(buffer + HEADER_SIZE, ssrc);
+	if (length > 0)
+	{
+		UInt8* p = buffer + HEADER_SIZE + 4;
+		p[0] = (UInt8) length;
+		std::memcpy(p + 1, reason.data(), length);
+		std::memset(p + 1 + length, 0, buffer + size - (p + 1 + length));
+	}
+	return size;
+}
+
+
+} // namespace RTP
@@ -0,0 +1,189 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTCP Scheduler Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTCPScheduler.h"
+#include "Poco/ScopedUnlock.h"
+#include "Poco/SingletonHolder.h"
+
+
+using Poco::Mutex;
+using Poco::Timestamp;
+using Poco::SingletonHolder;
+
+
+namespace RTP {
+
+
+RTCPScheduler::Task::~Task()
+{
+}
+
+
+RTCPScheduler::RTCPScheduler():
+	_pRunning(0),
+	_cancelled(false),
+	_stop(false)
+{
+	_thread.setName("RTCPScheduler");
+	_thread.start(*this);
+}
+
+
+RTCPScheduler::~RTCPScheduler()
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+		_stop = true;
+		_wakeup.signal();
+	}
+	_thread.join();
+
+	poco_assert_dbg (_queue.empty());
+}
+
+
+void RTCPScheduler::schedule(Task* pTask, const Timestamp& due)
+{
+	poco_check_ptr (pTask);
+
+	Mutex::ScopedLock lock(_mutex);
+
+	remove(pTask);
+	Entry entry(due.epochMicroseconds(), pTask);
+	_queue.insert(entry);
+	_due[pTask] = entry.first;
+
+	// only a new earliest task changes the time to sleep
+	if (_queue.begin()->second == pTask) _wakeup.signal();
+}
+
+
+void RTCPScheduler::cancel(Task* pTask)
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	remove(pTask);
+	if (_pRunning == pTask)
+	{
+		_cancelled = true;
+	}
+	if (Poco::Thread::current() != &_thread)
+	{
+		while (_pRunning == pTask)
+		{
+			_finished.wait(_mutex);
+		}
+	}
+}
+
+
+std::size_t RTCPScheduler::size() const
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	return _queue.size();
+}
+
+
+void RTCPScheduler::remove(Task* pTask)
+{
+	DueMap::iterator it = _due.find(pTask);
+	if (it != _due.end())
+	{
+		_queue.erase(Entry(it->second, pTask));
+		_due.erase(it);
+	}
+}
+
+
+void RTCPScheduler::run()
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	while (!_stop)
+	{
+		if (_queue.empty())
+		{
+			_wakeup.wait(_mutex);
+			continue;
+		}
+
+		Timestamp now;
+		Timestamp::TimeVal wait = _queue.begin()->first - now.epochMicroseconds();
+		if (wait > 0)
+		{
+			// round up, so the task is due when we wake up
+			_wakeup.tryWait(_mutex, (long) ((wait + 999) / 1000));
+			continue;
+		}
+
+		Task* pTask = _queue.begin()->second;
+		remove(pTask);
+		_pRunning  = pTask;
+		_cancelled = false;
+
+		Timestamp next;
+		bool again;
+		{
+			Poco::ScopedUnlock<Mutex> unlock(_mutex);
+			again = pTask->onTimer(now, next);
+		}
+
+		// the task may have been cancelled or
+		// rescheduled while it was running
+		if (again && !_cancelled && _due.find(pTask) == _due.end())
+		{
+			Entry entry(next.epochMicroseconds(), pTask);
+			_queue.insert(entry);
+			_due[pTask] = entry.first;
+		}
+		_pRunning = 0;
+		_finished.broadcast();
+	}
+}
+
+
+RTCPScheduler& RTCPScheduler::defaultScheduler()
+{
+	static SingletonHolder<RTCPScheduler> singleton;
+	return *singleton.get();
+}
+
+
+} // namespace RTP
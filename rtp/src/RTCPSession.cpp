@@ -0,0 +1,441 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTCP Session Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTCPSession.h"
+#include "RTCPPacket.h"
+#include "NTPTime.h"
+
+
+using Poco::UInt8;
+using Poco::UInt32;
+using Poco::Int32;
+using Poco::Int64;
+using Poco::FastMutex;
+using Poco::Timestamp;
+using Poco::Timespan;
+using SDP::NTPTime;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const double RTCP_MIN_TIME         = 5.0;
+	const double RTCP_BANDWIDTH_SHARE  = 0.05;
+	const double RTCP_SENDER_SHARE     = 0.25;
+	const double COMPENSATION          = 2.71828 - 1.5;
+	const int    UDP_IP_OVERHEAD       = 28;
+	const int    MEMBER_TIMEOUT_FACTOR = 5;
+	const int    MAX_SDES_ITEMS        = 32;
+}
+
+
+RTCPSession::Transport::~Transport()
+{
+}
+
+
+RTCPSession::RTCPSession(Transport& transport, UInt32 ssrc, const std::string& cname, int clockRate, int sessionBandwidth, RTCPScheduler& scheduler):
+	_transport(transport),
+	_scheduler(scheduler),
+	_ssrc(ssrc),
+	_cname(cname),
+	_clockRate(clockRate),
+	_sessionBandwidth(sessionBandwidth),
+	_pLastSource(0),
+	_initial(true),
+	_averageSize(RTCPPacket::HEADER_SIZE + 4 + RTCPPacket::REPORT_BLOCK_SIZE + 16 + cname.size() + UDP_IP_OVERHEAD),
+	_lastReport(0),
+	_sentPackets(0),
+	_sentOctets(0),
+	_lastSentTimestamp(0),
+	_lastSent(0),
+	_nextBlockSSRC(0),
+	_buffer(MAX_PACKET_SIZE)
+{
+	poco_assert (clockRate > 0 && sessionBandwidth >= 0);
+
+	_random.seed();
+}
+
+
+RTCPSession::~RTCPSession()
+{
+	_scheduler.cancel(this);
+}
+
+
+void RTCPSession::start()
+{
+	Timestamp now;
+	Timespan first;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		_initial    = true;
+		_lastReport = now;
+		first       = interval(now);
+	}
+	_scheduler.schedule(this, now + first.totalMicroseconds());
+}
+
+
+void RTCPSession::stop(const std::string& reason)
+{
+	_scheduler.cancel(this);
+
+	FastMutex::ScopedLock lock(_mutex);
+
+	// RFC 3550, section 6.3.7 allows sessions with fewer
+	// than 50 members to send the BYE at once
+	sendReport(Timestamp(), &reason);
+}
+
+
+void RTCPSession::onRTP(const RTPPacket& packet, const Timestamp& arrival)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	RTPSource* pSource = _pLastSource;
+	if (!pSource || pSource->ssrc() != packet.ssrc())
+	{
+		pSource = &findSource(packet.ssrc());
+		_pLastSource = pSource;
+	}
+	pSource->update(packet, arrival);
+}
+
+
+void RTCPSession::onSentRTP(const RTPPacket& packet, const Timestamp& time)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_sentPackets++;
+	_sentOctets += (UInt32) packet.payloadSize();
+	_lastSentTimestamp = packet.timestamp();
+	_lastSent = time;
+}
+
+
+bool RTCPSession::onRTCP(const void* buffer, std::size_t length, const Timestamp& arrival)
+{
+	if (!RTCPPacket::validateCompound(buffer, length)) return false;
+
+	FastMutex::ScopedLock lock(_mutex);
+
+	updateAverageSize(length);
+
+	const UInt8* p = static_cast<const UInt8*>(buffer);
+	RTCPPacket packet;
+	for (std::size_t offset = 0; offset < length && packet.parse(p + offset, length - offset); offset += packet.size())
+	{
+		switch (packet.type())
+		{
+		case RTCPPacket::RTCP_SR:
+		case RTCPPacket::RTCP_RR:
+			{
+				RTPSource& source = findSource(packet.ssrc());
+				if (packet.type() == RTCPPacket::RTCP_SR)
+					source.updateSenderReport(packet.senderInfo(), arrival);
+				else
+					source.updateActivity(arrival);
+
+				for (int i = 0; i < packet.count(); ++i)
+				{
+					RTCPPacket::ReportBlock block = packet.reportBlock(i);
+					if (block.ssrc != _ssrc || block.lastSR == 0) continue;
+
+					// A - LSR - DLSR, in units of 1/65536 seconds
+					UInt32 now = NTPTime::getCompactNTPTimestamp(NTPTime::getNTPTimestamp(arrival));
+					Int32 rtt = (Int32) (now - block.lastSR - block.delaySinceLastSR);
+					if (rtt >= 0) _roundTripTime = Timespan((Int64) rtt * Timespan::SECONDS / 65536);
+				}
+			}
+			break;
+		case RTCPPacket::RTCP_SDES:
+			{
+				RTCPPacket::SDESItem items[MAX_SDES_ITEMS];
+				std::size_t n = packet.sdesItems(items, MAX_SDES_ITEMS);
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					if (items[i].type != RTCPPacket::SDES_CNAME) continue;
+
+					RTPSource& source = findSource(items[i].ssrc);
+					source.setCName(std::string(items[i].text, items[i].length));
+					source.updateActivity(arrival);
+				}
+			}
+			break;
+		case RTCPPacket::RTCP_BYE:
+			for (int i = 0; i < packet.count(); ++i)
+			{
+				_sources.erase(packet.byeSource(i));
+			}
+			_pLastSource = 0;
+			break;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+
+
+bool RTCPSession::wallClock(UInt32 ssrc, UInt32 rtpTimestamp, Timestamp& time) const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	SourceMap::const_iterator it = _sources.find(ssrc);
+	return it != _sources.end() && it->second.wallClock(rtpTimestamp, time);
+}
+
+
+bool RTCPSession::source(UInt32 ssrc, RTPSource& source) const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	SourceMap::const_iterator it = _sources.find(ssrc);
+	if (it == _sources.end()) return false;
+
+	source = it->second;
+	return true;
+}
+
+
+std::size_t RTCPSession::members() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _sources.size() + 1;
+}
+
+
+std::size_t RTCPSession::senders() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return countSenders(Timestamp());
+}
+
+
+Timespan RTCPSession::roundTripTime() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _roundTripTime;
+}
+
+
+bool RTCPSession::onTimer(const Timestamp& now, Timestamp& next)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	// reconsideration (RFC 3550, section 6.3.6): the interval
+	// is recomputed with the current number of members, and the
+	// report is deferred if it has become longer
+	Timespan span = interval(now);
+	Timestamp due = _lastReport + span.totalMicroseconds();
+	if (due > now)
+	{
+		next = due;
+		return true;
+	}
+
+	timeoutSources(now);
+	sendReport(now, 0);
+	_lastReport = now;
+	_initial    = false;
+	next = now + interval(now).totalMicroseconds();
+	return true;
+}
+
+
+RTPSource& RTCPSession::findSource(UInt32 ssrc)
+{
+	SourceMap::iterator it = _sources.find(ssrc);
+	if (it == _sources.end())
+	{
+		it = _sources.insert(SourceMap::value_type(ssrc, RTPSource(ssrc, _clockRate))).first;
+	}
+	return it->second;
+}
+
+
+double RTCPSession::deterministicInterval(const Timestamp& now) const
+{
+	double minTime   = _initial ? RTCP_MIN_TIME / 2 : RTCP_MIN_TIME;
+	double bandwidth = _sessionBandwidth / 8.0 * RTCP_BANDWIDTH_SHARE;
+	double members   = (double) (_sources.size() + 1);
+
+	// senders share a quarter of the RTCP bandwidth
+	// while they are at most a quarter of the members
+	double senders = (double) countSenders(now);
+	if (senders > 0 && senders <= members * RTCP_SENDER_SHARE)
+	{
+		if (weSent(now))
+		{
+			bandwidth *= RTCP_SENDER_SHARE;
+			members    = senders;
+		}
+		else
+		{
+			bandwidth *= 1 - RTCP_SENDER_SHARE;
+			members   -= senders;
+		}
+	}
+
+	double t = bandwidth > 0 ? _averageSize * members / bandwidth : minTime;
+	return t < minTime ? minTime : t;
+}
+
+
+Timespan RTCPSession::interval(const Timestamp& now)
+{
+	// randomize to [0.5, 1.5] times the deterministic interval
+	// and compensate for the bias of timer reconsideration
+	double t = deterministicInterval(now) * (_random.nextDouble() + 0.5) / COMPENSATION;
+	_lastInterval = Timespan((Int64) (t * Timespan::SECONDS));
+	return _lastInterval;
+}
+
+
+bool RTCPSession::weSent(const Timestamp& now) const
+{
+	return _sentPackets > 0 && now - _lastSent < 2 * _lastInterval.totalMicroseconds();
+}
+
+
+std::size_t RTCPSession::countSenders(const Timestamp& now) const
+{
+	Timestamp::TimeDiff timeout = 2 * _lastInterval.totalMicroseconds();
+	std::size_t senders = weSent(now) ? 1 : 0;
+	for (SourceMap::const_iterator it = _sources.begin(); it != _sources.end(); ++it)
+	{
+		if (it->second.received() > 0 && now - it->second.lastRTP() < timeout) ++senders;
+	}
+	return senders;
+}
+
+
+void RTCPSession::timeoutSources(const Timestamp& now)
+{
+	// members time out after five deterministic
+	// intervals computed with the minimum of 5 seconds
+	bool initial = _initial;
+	_initial = false;
+	Timestamp::TimeDiff timeout = (Timestamp::TimeDiff) (MEMBER_TIMEOUT_FACTOR * deterministicInterval(now) * Timespan::SECONDS);
+	_initial = initial;
+
+	for (SourceMap::iterator it = _sources.begin(); it != _sources.end();)
+	{
+		if (now - it->second.lastActivity() > timeout)
+			_sources.erase(it++);
+		else
+			++it;
+	}
+	_pLastSource = 0;
+}
+
+
+std::size_t RTCPSession::buildReport(const Timestamp& now, const std::string* pReason)
+{
+	// the sources that have sent since their last report block, in
+	// SSRC order starting where the previous report left off, so
+	// that every one gets its turn if they do not all fit
+	RTCPPacket::ReportBlock blocks[RTCPPacket::MAX_REPORT_BLOCKS];
+	int blockCount = 0;
+	SourceMap::iterator it = _sources.lower_bound(_nextBlockSSRC);
+	for (std::size_t i = 0; i < _sources.size(); ++i, ++it)
+	{
+		if (it == _sources.end()) it = _sources.begin();
+		if (it->second.valid() && it->second.receivedSinceReport() > 0)
+		{
+			if (blockCount == RTCPPacket::MAX_REPORT_BLOCKS)
+			{
+				_nextBlockSSRC = it->first;
+				break;
+			}
+			blocks[blockCount++] = it->second.reportBlock(now);
+		}
+	}
+
+	UInt8* p = &_buffer[0];
+	std::size_t capacity = _buffer.size();
+	std::size_t size;
+	if (weSent(now))
+	{
+		// the RTP timestamp of the report corresponds to its NTP
+		// timestamp, extrapolated from the last packet sent
+		RTCPPacket::SenderInfo info;
+		info.ssrc         = _ssrc;
+		info.ntpTimestamp = NTPTime::getNTPTimestamp(now);
+		info.rtpTimestamp = _lastSentTimestamp + (UInt32) ((now - _lastSent) * _clockRate / Timespan::SECONDS);
+		info.packetCount  = _sentPackets;
+		info.octetCount   = _sentOctets;
+		size = RTCPPacket::writeSenderReport(p, capacity, info, blocks, blockCount);
+	}
+	else
+	{
+		size = RTCPPacket::writeReceiverReport(p, capacity, _ssrc, blocks, blockCount);
+	}
+	size += RTCPPacket::writeSDES(p + size, capacity - size, _ssrc, _cname);
+	if (pReason)
+	{
+		size += RTCPPacket::writeBye(p + size, capacity - size, _ssrc, *pReason);
+	}
+	return size;
+}
+
+
+void RTCPSession::sendReport(const Timestamp& now, const std::string* pReason)
+{
+	std::size_t size = buildReport(now, pReason);
+	_transport.sendRTCP(&_buffer[0], size);
+	updateAverageSize(size);
+}
+
+
+void RTCPSession::updateAverageSize(std::size_t size)
+{
+	_averageSize += ((double) (size + UDP_IP_OVERHEAD) - _averageSize) / 16;
+}
+
+
+} // namespace RTP
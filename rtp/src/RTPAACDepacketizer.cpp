@@ -0,0 +1,568 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP AAC Depacketizer Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPAACDepacketizer.h"
+#include "RTPPayloadFormat.h"
+#include "Poco/Exception.h"
+#include "Poco/NumberParser.h"
+#include "Poco/String.h"
+
+
+using Poco::UInt8;
+using Poco::UInt32;
+using Poco::UInt64;
+using Poco::Int32;
+using Poco::NumberParser;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const int SAMPLE_RATES[] =
+	{
+		96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350
+	};
+
+	const int SAMPLE_RATE_COUNT = sizeof(SAMPLE_RATES) / sizeof(SAMPLE_RATES[0]);
+	const int EXPLICIT_SAMPLE_RATE = 15;
+
+
+	class BitReader
+		/// Reads big-endian bit fields. Reading past the end
+		/// yields zeros and sets the overrun flag.
+	{
+	public:
+		BitReader(const UInt8* data, std::size_t size):
+			_data(data),
+			_bits(size * 8),
+			_position(0),
+			_overrun(false)
+		{
+		}
+
+		UInt32 read(int count)
+		{
+			UInt32 value = 0;
+			for (int i = 0; i < count; ++i, ++_position)
+			{
+				value <<= 1;
+				if (_position < _bits)
+					value |= (_data[_position >> 3] >> (7 - (_position & 7))) & 1;
+				else
+					_overrun = true;
+			}
+			return value;
+		}
+
+		std::size_t position() const
+		{
+			return _position;
+		}
+
+		bool overrun() const
+		{
+			return _overrun;
+		}
+
+	private:
+		const UInt8* _data;
+		std::size_t  _bits;
+		std::size_t  _position;
+		bool         _overrun;
+	};
+
+
+	std::string decodeHex(const std::string& hex)
+	{
+		if (hex.size() % 2) throw Poco::DataFormatException("odd number of hex digits", hex);
+
+		std::string result;
+		for (std::string::size_type i = 0; i < hex.size(); i += 2)
+		{
+			unsigned value;
+			if (!NumberParser::tryParseHex(hex.substr(i, 2), value))
+				throw Poco::DataFormatException("invalid hex digits", hex);
+			result += (char) value;
+		}
+		return result;
+	}
+
+
+	int intParameter(const RTPPayloadFormat& payloadFormat, const std::string& name, int deflt)
+	{
+		if (!payloadFormat.hasParameter(name)) return deflt;
+
+		std::string value = payloadFormat.parameter(name);
+		int result;
+		if (!NumberParser::tryParse(value, result) || result < 0)
+			throw Poco::DataFormatException("invalid " + name, value);
+		return result;
+	}
+
+
+	int readObjectType(BitReader& reader)
+	{
+		int objectType = (int) reader.read(5);
+		if (objectType == 31) objectType = 32 + (int) reader.read(6);
+		return objectType;
+	}
+
+
+	void readSampleRate(BitReader& reader, int& sampleRateIndex, int& sampleRate)
+	{
+		sampleRateIndex = (int) reader.read(4);
+		if (sampleRateIndex == EXPLICIT_SAMPLE_RATE)
+			sampleRate = (int) reader.read(24);
+		else if (sampleRateIndex < SAMPLE_RATE_COUNT)
+			sampleRate = SAMPLE_RATES[sampleRateIndex];
+		else
+			sampleRate = 0;
+	}
+
+
+	int readAudioSpecificConfig(BitReader& reader, int& objectType, int& sampleRateIndex, int& sampleRate, int& channelConfiguration)
+		/// Reads an AudioSpecificConfig (ISO/IEC 14496-3, 1.6.2.1)
+		/// up to the frame length flag and returns the number of
+		/// samples per frame.
+	{
+		objectType = readObjectType(reader);
+		readSampleRate(reader, sampleRateIndex, sampleRate);
+		channelConfiguration = (int) reader.read(4);
+
+		// explicit SBR or PS signalling: the core codec follows
+		if (objectType == 5 || objectType == 29)
+		{
+			int extensionIndex;
+			int extensionRate;
+			readSampleRate(reader, extensionIndex, extensionRate);
+			objectType = readObjectType(reader);
+		}
+
+		switch (objectType)
+		{
+		case 1: case 2: case 3: case 4: case 6: case 7:
+		case 17: case 19: case 20: case 21: case 22: case 23:
+			// GASpecificConfig: frameLengthFlag
+			return reader.read(1) ? 960 : 1024;
+		default:
+			return 1024;
+		}
+	}
+
+
+	Int32 signExtend(UInt32 value, int bits)
+	{
+		UInt32 sign = 1u << (bits - 1);
+		return (Int32) ((value ^ sign) - sign);
+	}
+}
+
+
+RTPAACDepacketizer::RTPAACDepacketizer(Handler& handler, const RTPPayloadFormat& payloadFormat, Format format):
+	RTPDepacketizer(handler),
+	_mode(MODE_GENERIC),
+	_format(format),
+	_objectType(0),
+	_sampleRateIndex(0),
+	_sampleRate(0),
+	_channelConfiguration(0),
+	_frameDuration(0),
+	_sizeLength(0),
+	_indexLength(0),
+	_indexDeltaLength(0),
+	_ctsDeltaLength(0),
+	_dtsDeltaLength(0),
+	_randomAccessIndication(0),
+	_streamStateIndication(0),
+	_auxiliaryDataSizeLength(0),
+	_constantSize(0),
+	_remaining(0),
+	_atStart(true),
+	_oversized(false),
+	_unitTimestamp(0)
+{
+	if (Poco::icompare(payloadFormat.encodingName(), "mpeg4-generic") == 0)
+	{
+		_mode = MODE_GENERIC;
+		loadGeneric(payloadFormat);
+	}
+	else if (Poco::icompare(payloadFormat.encodingName(), "MP4A-LATM") == 0)
+	{
+		_mode = MODE_LATM;
+		loadLATM(payloadFormat);
+	}
+	else
+	{
+		throw Poco::InvalidArgumentException("not an AAC payload format", payloadFormat.encodingName());
+	}
+
+	if (_sampleRate <= 0) throw Poco::DataFormatException("invalid sampling rate in AAC config", payloadFormat.parameter("config"));
+
+	int frameLength = (int) _frameDuration;
+	int clockRate = payloadFormat.clockRate() > 0 ? payloadFormat.clockRate() : _sampleRate;
+	_frameDuration = (UInt32) ((UInt64) frameLength * clockRate / _sampleRate);
+	_frameDuration = (UInt32) intParameter(payloadFormat, "constantDuration", (int) _frameDuration);
+
+	if (_format == FORMAT_ADTS && (_objectType < 1 || _objectType > 4 || _sampleRateIndex >= SAMPLE_RATE_COUNT || _channelConfiguration > 7))
+		throw Poco::NotImplementedException("AAC configuration cannot be described by ADTS");
+}
+
+
+RTPAACDepacketizer::~RTPAACDepacketizer()
+{
+}
+
+
+void RTPAACDepacketizer::loadGeneric(const RTPPayloadFormat& payloadFormat)
+{
+	_config = decodeHex(payloadFormat.parameter("config"));
+	if (_config.empty()) throw Poco::DataFormatException("missing AAC config");
+
+	BitReader reader(reinterpret_cast<const UInt8*>(_config.data()), _config.size());
+	_frameDuration = (UInt32) readAudioSpecificConfig(reader, _objectType, _sampleRateIndex, _sampleRate, _channelConfiguration);
+	if (reader.overrun()) throw Poco::DataFormatException("truncated AudioSpecificConfig", payloadFormat.parameter("config"));
+
+	// the modes of RFC 3640, 3.3 imply the AU header layout
+	std::string mode = payloadFormat.parameter("mode");
+	if (Poco::icompare(mode, "AAC-hbr") == 0)
+	{
+		_sizeLength       = 13;
+		_indexLength      = 3;
+		_indexDeltaLength = 3;
+	}
+	else if (Poco::icompare(mode, "AAC-lbr") == 0)
+	{
+		_sizeLength       = 6;
+		_indexLength      = 2;
+		_indexDeltaLength = 2;
+	}
+	_sizeLength              = intParameter(payloadFormat, "sizeLength", _sizeLength);
+	_indexLength             = intParameter(payloadFormat, "indexLength", _indexLength);
+	_indexDeltaLength        = intParameter(payloadFormat, "indexDeltaLength", _indexDeltaLength);
+	_ctsDeltaLength          = intParameter(payloadFormat, "CTSDeltaLength", 0);
+	_dtsDeltaLength          = intParameter(payloadFormat, "DTSDeltaLength", 0);
+	_randomAccessIndication  = intParameter(payloadFormat, "randomAccessIndication", 0) ? 1 : 0;
+	_streamStateIndication   = intParameter(payloadFormat, "streamStateIndication", 0);
+	_auxiliaryDataSizeLength = intParameter(payloadFormat, "auxiliaryDataSizeLength", 0);
+	_constantSize            = (std::size_t) intParameter(payloadFormat, "constantSize", 0);
+
+	if (_sizeLength > 32 || _indexLength > 32 || _indexDeltaLength > 32 || _ctsDeltaLength > 32 || _dtsDeltaLength > 32 || _streamStateIndication > 32 || _auxiliaryDataSizeLength > 32)
+		throw Poco::DataFormatException("AU header field too long", payloadFormat.parameters());
+}
+
+
+void RTPAACDepacketizer::loadLATM(const RTPPayloadFormat& payloadFormat)
+{
+	if (payloadFormat.parameter("cpresent", "1") != "0")
+		throw Poco::NotImplementedException("MP4A-LATM with in-band StreamMuxConfig");
+
+	_config = decodeHex(payloadFormat.parameter("config"));
+	if (_config.empty()) throw Poco::DataFormatException("missing StreamMuxConfig");
+
+	// StreamMuxConfig (ISO/IEC 14496-3, 1.7.3.1)
+	BitReader reader(reinterpret_cast<const UInt8*>(_config.data()), _config.size());
+	if (reader.read(1) != 0) throw Poco::NotImplementedException("LATM audioMuxVersion 1");
+	reader.read(1);  // allStreamsSameTimeFraming
+	reader.read(6);  // numSubFrames
+	int numProgram = (int) reader.read(4);
+	int numLayer   = (int) reader.read(3);
+	if (numProgram != 0 || numLayer != 0) throw Poco::NotImplementedException("LATM with several programs or layers");
+
+	_frameDuration = (UInt32) readAudioSpecificConfig(reader, _objectType, _sampleRateIndex, _sampleRate, _channelConfiguration);
+	if (reader.read(3) != 0) throw Poco::NotImplementedException("LATM frameLengthType other than 0");
+	if (reader.overrun()) throw Poco::DataFormatException("truncated StreamMuxConfig", payloadFormat.parameter("config"));
+}
+
+
+void RTPAACDepacketizer::reset()
+{
+	RTPDepacketizer::reset();
+	_remaining = 0;
+	_atStart   = true;
+	_oversized = false;
+}
+
+
+void RTPAACDepacketizer::writeADTSHeader(UInt8* header, int objectType, int sampleRateIndex, int channelConfiguration, std::size_t frameSize)
+{
+	poco_assert_dbg (objectType >= 1 && objectType <= 4 && sampleRateIndex < SAMPLE_RATE_COUNT && channelConfiguration <= 7);
+	poco_assert_dbg (frameSize + ADTS_HEADER_SIZE <= MAX_ADTS_FRAME_SIZE);
+
+	std::size_t length = frameSize + ADTS_HEADER_SIZE;
+	header[0] = 0xff;
+	header[1] = 0xf1;  // MPEG-4, layer 0, no CRC
+	header[2] = (UInt8) (((objectType - 1) << 6) | (sampleRateIndex << 2) | (channelConfiguration >> 2));
+	header[3] = (UInt8) (((channelConfiguration & 3) << 6) | ((length >> 11) & 3));
+	header[4] = (UInt8) (length >> 3);
+	header[5] = (UInt8) (((length & 7) << 5) | 0x1f);  // buffer fullness 0x7ff: variable rate
+	header[6] = 0xfc;
+}
+
+
+void RTPAACDepacketizer::depacketize(const RTPPacket& packet)
+{
+	if (_mode == MODE_GENERIC)
+		depacketizeGeneric(packet);
+	else
+		depacketizeLATM(packet);
+
+	// a fragmented access unit may only start after the
+	// packet that carried the end of the previous one
+	_atStart = packet.marker();
+}
+
+
+void RTPAACDepacketizer::depacketizeGeneric(const RTPPacket& packet)
+{
+	const UInt8* p = packet.payload();
+	std::size_t size = packet.payloadSize();
+
+	// the AU header section: a 16-bit length in bits and the AU headers
+	std::size_t pos = 0;
+	std::size_t headerBits = 0;
+	const UInt8* pHeaders = p;
+	bool hasHeaders = _sizeLength || _indexLength || _indexDeltaLength || _ctsDeltaLength || _dtsDeltaLength || _randomAccessIndication || _streamStateIndication;
+	if (hasHeaders)
+	{
+		if (size < 2)
+		{
+			dropPacket();
+			return;
+		}
+		headerBits = (p[0] << 8) | p[1];
+		pHeaders = p + 2;
+		pos = 2 + (headerBits + 7) / 8;
+	}
+
+	// the auxiliary section is skipped
+	if (_auxiliaryDataSizeLength && pos < size)
+	{
+		BitReader aux(p + pos, size - pos);
+		std::size_t auxBits = aux.read(_auxiliaryDataSizeLength);
+		pos += (_auxiliaryDataSizeLength + auxBits + 7) / 8;
+	}
+	if (pos > size)
+	{
+		dropPacket();
+		return;
+	}
+
+	BitReader headers(pHeaders, (headerBits + 7) / 8);
+	if (_remaining > 0)
+	{
+		// a further fragment of the current access unit,
+		// with an AU header that repeats the size
+		std::size_t count = size - pos < _remaining ? size - pos : _remaining;
+		appendSlice(p + pos, count);
+		_remaining -= count;
+		if (_remaining == 0) deliver();
+		return;
+	}
+
+	UInt32 timestamp = packet.timestamp();
+	UInt32 firstIndex = 0;
+	UInt32 index = 0;
+	bool first = true;
+	while (pos < size && (!hasHeaders || headers.position() < headerBits))
+	{
+		std::size_t start = headers.position();
+		std::size_t auSize = _sizeLength ? headers.read(_sizeLength) : (_constantSize ? _constantSize : size - pos);
+		if (first)
+			firstIndex = index = headers.read(_indexLength);
+		else
+			index += headers.read(_indexDeltaLength) + 1;
+
+		bool hasCTS = false;
+		Int32 ctsDelta = 0;
+		if (_ctsDeltaLength && headers.read(1))
+		{
+			hasCTS   = true;
+			ctsDelta = signExtend(headers.read(_ctsDeltaLength), _ctsDeltaLength);
+		}
+		if (_dtsDeltaLength && headers.read(1)) headers.read(_dtsDeltaLength);
+		headers.read(_randomAccessIndication + _streamStateIndication);
+
+		if (headers.position() > headerBits || (hasHeaders && headers.position() == start) || auSize == 0)
+		{
+			dropPacket();
+			return;
+		}
+
+		// the RTP timestamp is that of the first access unit; the
+		// others follow by their index or their CTS-delta (RFC 3640, 3.2.1.1)
+		UInt32 auTimestamp = hasCTS && !first ? timestamp + ctsDelta : timestamp + (index - firstIndex) * _frameDuration;
+		std::size_t available = size - pos;
+		if (auSize <= available)
+		{
+			beginUnit(auTimestamp, auSize);
+			appendSlice(p + pos, auSize);
+			deliver();
+			pos += auSize;
+		}
+		else if (first && _atStart)
+		{
+			// the first fragment of an access unit
+			beginUnit(auTimestamp, auSize);
+			appendSlice(p + pos, available);
+			_remaining = auSize - available;
+			return;
+		}
+		else
+		{
+			dropPacket();
+			return;
+		}
+		first = false;
+	}
+}
+
+
+void RTPAACDepacketizer::depacketizeLATM(const RTPPacket& packet)
+{
+	const UInt8* p = packet.payload();
+	std::size_t size = packet.payloadSize();
+	std::size_t pos = 0;
+	bool first = true;
+
+	if (_remaining > 0)
+	{
+		// a further fragment of the current audioMuxElement
+		std::size_t count = size < _remaining ? size : _remaining;
+		appendSlice(p, count);
+		_remaining -= count;
+		if (_remaining > 0) return;
+
+		deliver();
+		pos = count;
+		first = false;
+	}
+
+	// PayloadLengthInfo and PayloadMux of each subframe (RFC 6416, 6.1)
+	while (pos < size)
+	{
+		std::size_t auSize = 0;
+		UInt8 byte;
+		do
+		{
+			if (pos == size)
+			{
+				dropPacket();
+				return;
+			}
+			byte = p[pos++];
+			auSize += byte;
+		}
+		while (byte == 0xff);
+
+		if (auSize == 0) break;
+
+		UInt32 auTimestamp = first ? packet.timestamp() : _unitTimestamp + _frameDuration;
+		std::size_t available = size - pos;
+		if (auSize <= available)
+		{
+			beginUnit(auTimestamp, auSize);
+			appendSlice(p + pos, auSize);
+			deliver();
+			pos += auSize;
+		}
+		else if (first && _atStart)
+		{
+			beginUnit(auTimestamp, auSize);
+			appendSlice(p + pos, available);
+			_remaining = auSize - available;
+			return;
+		}
+		else
+		{
+			dropPacket();
+			return;
+		}
+		first = false;
+	}
+}
+
+
+void RTPAACDepacketizer::onLoss()
+{
+	// partial access units cannot be decoded, and the
+	// units that follow are not affected by the loss
+	discardUnit();
+	_remaining = 0;
+	_atStart   = false;
+	_oversized = false;
+}
+
+
+void RTPAACDepacketizer::completeUnit()
+{
+	if (_remaining > 0 || _oversized)
+	{
+		// the end of a fragmented access unit is missing,
+		// or its length does not fit into the ADTS header
+		truncate(0);
+		_remaining = 0;
+		_oversized = false;
+	}
+}
+
+
+void RTPAACDepacketizer::beginUnit(UInt32 timestamp, std::size_t size)
+{
+	setTimestamp(timestamp);
+	setKeyFrame();
+	_unitTimestamp = timestamp;
+	if (_format == FORMAT_ADTS && size + ADTS_HEADER_SIZE > MAX_ADTS_FRAME_SIZE)
+	{
+		// the data of the unit is still taken in, fragments included,
+		// and discarded by completeUnit()
+		_oversized = true;
+		dropPacket();
+	}
+	else if (_format == FORMAT_ADTS)
+	{
+		UInt8 header[ADTS_HEADER_SIZE];
+		writeADTSHeader(header, _objectType, _sampleRateIndex, _channelConfiguration, size);
+		appendOwned(header, sizeof(header));
+	}
+}
+
+
+} // namespace RTP
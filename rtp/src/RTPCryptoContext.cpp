@@ -0,0 +1,714 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Crypto Context Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPCryptoContext.h"
+#include "RTPPayloadFormat.h"
+#include "Poco/Exception.h"
+#include "Poco/StringTokenizer.h"
+#include <cstring>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+
+using Poco::UInt8;
+using Poco::UInt16;
+using Poco::UInt32;
+using Poco::UInt64;
+using Poco::StringTokenizer;
+using SDP::SessionDescription;
+using SDP::MediaDescription;
+using SDP::AttributeVec;
+using SDP::KeyField;
+
+
+namespace RTP {
+
+
+namespace
+{
+	enum Label
+		/// The key derivation labels of RFC 3711, 4.3.2.
+	{
+		LABEL_RTP_ENCRYPTION  = 0,
+		LABEL_RTP_AUTH        = 1,
+		LABEL_RTP_SALT        = 2,
+		LABEL_RTCP_ENCRYPTION = 3,
+		LABEL_RTCP_AUTH       = 4,
+		LABEL_RTCP_SALT       = 5
+	};
+
+	enum
+	{
+		AUTH_KEY_SIZE = 20,  // HMAC-SHA1
+		SHA1_BLOCK    = 64,
+		SALT_SIZE     = 14,  // the key derivation works on 112 bits
+		GCM_TAG_SIZE  = 16,
+		GCM_IV_SIZE   = 12
+	};
+
+	const char* const SUITE_NAMES[] =
+	{
+		"AES_CM_128_HMAC_SHA1_80",
+		"AES_CM_128_HMAC_SHA1_32",
+		"AEAD_AES_128_GCM",
+		"AEAD_AES_256_GCM"
+	};
+
+	bool findSuite(const std::string& name, RTPCryptoContext::Suite& suite)
+	{
+		for (int i = 0; i < (int) (sizeof(SUITE_NAMES) / sizeof(SUITE_NAMES[0])); ++i)
+		{
+			if (name == SUITE_NAMES[i])
+			{
+				suite = (RTPCryptoContext::Suite) i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	UInt32 read32(const UInt8* p)
+	{
+		return ((UInt32) p[0] << 24) | ((UInt32) p[1] << 16) | ((UInt32) p[2] << 8) | p[3];
+	}
+
+	void write32(UInt8* p, UInt32 value)
+	{
+		p[0] = (UInt8) (value >> 24);
+		p[1] = (UInt8) (value >> 16);
+		p[2] = (UInt8) (value >> 8);
+		p[3] = (UInt8) value;
+	}
+
+	std::size_t rtpHeaderSize(const UInt8* packet, std::size_t size)
+		/// Returns the size of the RTP header with CSRCs and header
+		/// extension, or 0 if the packet is not a RTP packet.
+	{
+		if (size < 12 || (packet[0] & 0xc0) != 0x80) return 0;
+
+		std::size_t header = 12 + 4 * (packet[0] & 0x0f);
+		if (packet[0] & 0x10)
+		{
+			if (size < header + 4) return 0;
+			header += 4 + 4 * (((std::size_t) packet[header + 2] << 8) | packet[header + 3]);
+		}
+		return header <= size ? header : 0;
+	}
+
+	void counterIV(UInt8* iv, const UInt8* salt, UInt32 ssrc, UInt64 index)
+		/// (salt * 2^16) XOR (SSRC * 2^64) XOR (index * 2^16), the IV of
+		/// AES counter mode for SRTP and SRTCP (RFC 3711, 4.1.1).
+	{
+		std::memcpy(iv, salt, SALT_SIZE);
+		iv[14] = 0;
+		iv[15] = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			iv[4 + i] ^= (UInt8) (ssrc >> (24 - 8 * i));
+		}
+		for (int i = 0; i < 6; ++i)
+		{
+			iv[8 + i] ^= (UInt8) (index >> (40 - 8 * i));
+		}
+	}
+
+	void gcmIV(UInt8* iv, const UInt8* salt, UInt32 ssrc, UInt64 index)
+		/// 0x0000 || SSRC || 48 bit index, XOR salt: the IV of AES-GCM,
+		/// where the index is ROC || SEQ for SRTP and the SRTCP index
+		/// (RFC 7714, 8.1 and 9.1).
+	{
+		std::memcpy(iv, salt, GCM_IV_SIZE);
+		for (int i = 0; i < 4; ++i)
+		{
+			iv[2 + i] ^= (UInt8) (ssrc >> (24 - 8 * i));
+		}
+		for (int i = 0; i < 6; ++i)
+		{
+			iv[6 + i] ^= (UInt8) (index >> (40 - 8 * i));
+		}
+	}
+
+	void derive(const EVP_CIPHER* pPRF, const std::string& masterKey, const UInt8* masterSalt, Label label, UInt8* key, std::size_t size)
+		/// The AES-CM key derivation function with a key derivation
+		/// rate of zero (RFC 3711, 4.3.1 and 4.3.3).
+	{
+		UInt8 iv[16];
+		std::memcpy(iv, masterSalt, SALT_SIZE);
+		iv[7] ^= (UInt8) label;
+		iv[14] = 0;
+		iv[15] = 0;
+		std::memset(key, 0, size);
+
+		EVP_CIPHER_CTX* pContext = EVP_CIPHER_CTX_new();
+		int length = 0;
+		bool ok = pContext
+			&& EVP_EncryptInit_ex(pContext, pPRF, 0, reinterpret_cast<const unsigned char*>(masterKey.data()), iv)
+			&& EVP_EncryptUpdate(pContext, key, &length, key, (int) size);
+		EVP_CIPHER_CTX_free(pContext);
+		if (!ok) throw Poco::SystemException("SRTP key derivation failed");
+	}
+
+	EVP_CIPHER_CTX* createCipher(const EVP_CIPHER* pCipher, const UInt8* key)
+	{
+		EVP_CIPHER_CTX* pContext = EVP_CIPHER_CTX_new();
+		if (!pContext || !EVP_CipherInit_ex(pContext, pCipher, 0, key, 0, 1))
+		{
+			EVP_CIPHER_CTX_free(pContext);
+			throw Poco::SystemException("cannot set up SRTP cipher");
+		}
+		return pContext;
+	}
+
+	EVP_MD_CTX* createPad(const UInt8* key, UInt8 pad)
+		/// Returns SHA-1 after hashing the key XOR the HMAC pad, the
+		/// state every HMAC with the key starts from.
+	{
+		UInt8 block[SHA1_BLOCK];
+		std::memset(block, pad, sizeof(block));
+		for (int i = 0; i < AUTH_KEY_SIZE; ++i)
+		{
+			block[i] ^= key[i];
+		}
+
+		EVP_MD_CTX* pContext = EVP_MD_CTX_new();
+		bool ok = pContext
+			&& EVP_DigestInit_ex(pContext, EVP_sha1(), 0)
+			&& EVP_DigestUpdate(pContext, block, sizeof(block));
+		OPENSSL_cleanse(block, sizeof(block));
+		if (!ok)
+		{
+			EVP_MD_CTX_free(pContext);
+			throw Poco::SystemException("cannot set up SRTP authentication");
+		}
+		return pContext;
+	}
+
+	void crypt(EVP_CIPHER_CTX* pContext, const UInt8* iv, UInt8* data, std::size_t size)
+		/// Encrypts or decrypts in counter mode.
+	{
+		int length = 0;
+		EVP_EncryptInit_ex(pContext, 0, 0, 0, iv);
+		if (size > 0) EVP_EncryptUpdate(pContext, data, &length, data, (int) size);
+	}
+
+	bool seal(EVP_CIPHER_CTX* pContext, int encrypt, const UInt8* iv, const UInt8* aad, std::size_t aadSize, const UInt8* trailer, std::size_t trailerSize, UInt8* data, std::size_t size, UInt8* tag)
+		/// Encrypts data and computes the tag, or decrypts data and
+		/// verifies the tag, with AES-GCM. The associated data is aad
+		/// followed by trailer.
+	{
+		int length = 0;
+		UInt8 final[16];
+		if (!EVP_CipherInit_ex(pContext, 0, 0, 0, iv, encrypt)) return false;
+		if (!EVP_CipherUpdate(pContext, 0, &length, aad, (int) aadSize)) return false;
+		if (trailerSize > 0 && !EVP_CipherUpdate(pContext, 0, &length, trailer, (int) trailerSize)) return false;
+		if (size > 0 && !EVP_CipherUpdate(pContext, data, &length, data, (int) size)) return false;
+		if (!encrypt && !EVP_CIPHER_CTX_ctrl(pContext, EVP_CTRL_GCM_SET_TAG, GCM_TAG_SIZE, tag)) return false;
+		if (EVP_CipherFinal_ex(pContext, final, &length) <= 0) return false;
+		return !encrypt || EVP_CIPHER_CTX_ctrl(pContext, EVP_CTRL_GCM_GET_TAG, GCM_TAG_SIZE, tag);
+	}
+
+	void authenticate(EVP_MD_CTX* pDigest, EVP_MD_CTX* pInner, EVP_MD_CTX* pOuter, const UInt8* data, std::size_t size, const UInt8* suffix, std::size_t suffixSize, UInt8* mac)
+		/// Computes the HMAC-SHA1 of data followed by suffix.
+	{
+		unsigned length = 0;
+		EVP_MD_CTX_copy_ex(pDigest, pInner);
+		EVP_DigestUpdate(pDigest, data, size);
+		if (suffixSize > 0) EVP_DigestUpdate(pDigest, suffix, suffixSize);
+		EVP_DigestFinal_ex(pDigest, mac, &length);
+		EVP_MD_CTX_copy_ex(pDigest, pOuter);
+		EVP_DigestUpdate(pDigest, mac, AUTH_KEY_SIZE);
+		EVP_DigestFinal_ex(pDigest, mac, &length);
+	}
+
+	bool parseCrypto(const std::string& value, RTPCryptoContext::Suite& suite, std::string& keyAndSalt)
+		/// Parses <tag> <suite> inline:<key||salt>[|<lifetime>][|<MKI>:<length>]
+		/// of an a=crypto attribute. Returns false for unsupported
+		/// suites, MKIs and session parameters.
+	{
+		StringTokenizer tokens(value, " ", StringTokenizer::TOK_IGNORE_EMPTY | StringTokenizer::TOK_TRIM);
+		if (tokens.count() < 3 || tokens[2].compare(0, 7, "inline:") != 0) throw Poco::DataFormatException("invalid a=crypto attribute", value);
+		if (tokens.count() > 3 || !findSuite(tokens[1], suite)) return false;
+
+		// the first of the keys separated by semicolons
+		std::string key = tokens[2].substr(7, tokens[2].find(';') - 7);
+		std::string::size_type bar = key.find('|');
+		if (bar != std::string::npos)
+		{
+			if (key.find(':', bar) != std::string::npos) return false;
+			key.erase(bar);
+		}
+		keyAndSalt = RTPPayloadFormat::decodeBase64(key);
+		return true;
+	}
+}
+
+
+struct RTPCryptoContext::Keys
+	/// The OpenSSL contexts, set up with the session keys, and the
+	/// session salts.
+{
+	EVP_CIPHER_CTX* pRTPCipher;
+	EVP_CIPHER_CTX* pRTCPCipher;
+	EVP_MD_CTX*     pRTPInner;
+	EVP_MD_CTX*     pRTPOuter;
+	EVP_MD_CTX*     pRTCPInner;
+	EVP_MD_CTX*     pRTCPOuter;
+	EVP_MD_CTX*     pDigest;
+	UInt8           rtpSalt[SALT_SIZE];
+	UInt8           rtcpSalt[SALT_SIZE];
+};
+
+
+RTPCryptoContext::RTPCryptoContext(Suite suite, const std::string& masterKey, const std::string& masterSalt):
+	_suite(suite),
+	_gcm(false),
+	_rtpTagSize(0),
+	_rtcpTagSize(0),
+	_pKeys(0)
+{
+	init(masterKey, masterSalt);
+}
+
+
+RTPCryptoContext::RTPCryptoContext(const SessionDescription& session, const MediaDescription& media):
+	_suite(AES_CM_128_HMAC_SHA1_80),
+	_gcm(false),
+	_rtpTagSize(0),
+	_rtcpTagSize(0),
+	_pKeys(0)
+{
+	std::string keyAndSalt;
+	bool found = false;
+	bool unsupported = false;
+	AttributeVec attributes = media.getAttributes();
+	for (AttributeVec::const_iterator it = attributes.begin(); it != attributes.end() && !found; ++it)
+	{
+		if (it->getName() != "crypto") continue;
+
+		// the attribute splits its value at colons, which
+		// inline:<key> has, so take the whole field value
+		std::string value = it->Field::getValue();
+		value.erase(0, value.find(':') + 1);
+		found = parseCrypto(value, _suite, keyAndSalt);
+		unsupported = !found;
+	}
+
+	if (!found)
+	{
+		if (unsupported) throw Poco::NotImplementedException("no supported a=crypto attribute", media.getMediaField().getValue());
+
+		KeyField key = media.getEncryptionKey();
+		if (!key.hasKey()) key = session.getEncryptionKey();
+		if (!key.hasKey()) throw Poco::NotFoundException("no SRTP key for media", media.getMediaField().getValue());
+
+		if (key.getMethod() == "base64")
+			keyAndSalt = RTPPayloadFormat::decodeBase64(key.getKey());
+		else if (key.getMethod() == "clear")
+			keyAndSalt = key.getKey();
+		else
+			throw Poco::NotImplementedException("key method", key.getMethod());
+	}
+
+	std::size_t keySize = _suite == AEAD_AES_256_GCM ? 32 : 16;
+	if (keyAndSalt.size() <= keySize) throw Poco::DataFormatException("SRTP key too short", suiteName(_suite));
+	try
+	{
+		init(keyAndSalt.substr(0, keySize), keyAndSalt.substr(keySize));
+	}
+	catch (Poco::InvalidArgumentException& exc)
+	{
+		throw Poco::DataFormatException(exc.message());
+	}
+	OPENSSL_cleanse(&keyAndSalt[0], keyAndSalt.size());
+}
+
+
+RTPCryptoContext::~RTPCryptoContext()
+{
+	destroy();
+}
+
+
+void RTPCryptoContext::init(const std::string& masterKey, const std::string& masterSalt)
+{
+	_gcm = _suite == AEAD_AES_128_GCM || _suite == AEAD_AES_256_GCM;
+	std::size_t keySize = _suite == AEAD_AES_256_GCM ? 32 : 16;
+	std::size_t saltSize = _gcm ? GCM_IV_SIZE : SALT_SIZE;
+	if (masterKey.size() != keySize || masterSalt.size() != saltSize)
+	{
+		throw Poco::InvalidArgumentException("invalid master key or salt length for " + suiteName(_suite));
+	}
+
+	_rtpTagSize  = _gcm ? GCM_TAG_SIZE : (_suite == AES_CM_128_HMAC_SHA1_32 ? 4 : 10);
+	_rtcpTagSize = _gcm ? GCM_TAG_SIZE : 10;
+	std::memset(&_statistics, 0, sizeof(_statistics));
+
+	_pKeys = new Keys;
+	std::memset(_pKeys, 0, sizeof(Keys));
+	try
+	{
+		// the 96 bit salt of AES-GCM is padded for the key derivation
+		UInt8 salt[SALT_SIZE] = { 0 };
+		std::memcpy(salt, masterSalt.data(), saltSize);
+
+		const EVP_CIPHER* pPRF = keySize == 32 ? EVP_aes_256_ctr() : EVP_aes_128_ctr();
+		const EVP_CIPHER* pCipher = _gcm ? (keySize == 32 ? EVP_aes_256_gcm() : EVP_aes_128_gcm()) : EVP_aes_128_ctr();
+		UInt8 key[32];
+
+		derive(pPRF, masterKey, salt, LABEL_RTP_ENCRYPTION, key, keySize);
+		_pKeys->pRTPCipher = createCipher(pCipher, key);
+		derive(pPRF, masterKey, salt, LABEL_RTCP_ENCRYPTION, key, keySize);
+		_pKeys->pRTCPCipher = createCipher(pCipher, key);
+		derive(pPRF, masterKey, salt, LABEL_RTP_SALT, _pKeys->rtpSalt, saltSize);
+		derive(pPRF, masterKey, salt, LABEL_RTCP_SALT, _pKeys->rtcpSalt, saltSize);
+
+		if (!_gcm)
+		{
+			derive(pPRF, masterKey, salt, LABEL_RTP_AUTH, key, AUTH_KEY_SIZE);
+			_pKeys->pRTPInner = createPad(key, 0x36);
+			_pKeys->pRTPOuter = createPad(key, 0x5c);
+			derive(pPRF, masterKey, salt, LABEL_RTCP_AUTH, key, AUTH_KEY_SIZE);
+			_pKeys->pRTCPInner = createPad(key, 0x36);
+			_pKeys->pRTCPOuter = createPad(key, 0x5c);
+			_pKeys->pDigest = EVP_MD_CTX_new();
+			if (!_pKeys->pDigest) throw Poco::SystemException("cannot set up SRTP authentication");
+		}
+		OPENSSL_cleanse(key, sizeof(key));
+	}
+	catch (...)
+	{
+		destroy();
+		throw;
+	}
+}
+
+
+void RTPCryptoContext::destroy()
+{
+	if (!_pKeys) return;
+
+	EVP_CIPHER_CTX_free(_pKeys->pRTPCipher);
+	EVP_CIPHER_CTX_free(_pKeys->pRTCPCipher);
+	EVP_MD_CTX_free(_pKeys->pRTPInner);
+	EVP_MD_CTX_free(_pKeys->pRTPOuter);
+	EVP_MD_CTX_free(_pKeys->pRTCPInner);
+	EVP_MD_CTX_free(_pKeys->pRTCPOuter);
+	EVP_MD_CTX_free(_pKeys->pDigest);
+	OPENSSL_cleanse(_pKeys, sizeof(Keys));
+	delete _pKeys;
+	_pKeys = 0;
+}
+
+
+std::size_t RTPCryptoContext::protectRTP(UInt8* packet, std::size_t size, std::size_t capacity)
+{
+	std::size_t header = rtpHeaderSize(packet, size);
+	if (header == 0) throw Poco::InvalidArgumentException("not a RTP packet");
+	if (capacity < size + _rtpTagSize) throw Poco::InvalidArgumentException("no room for the SRTP authentication tag");
+
+	UInt16 sequenceNumber = (UInt16) ((packet[2] << 8) | packet[3]);
+	UInt32 ssrc = read32(packet + 8);
+	Stream& stream = _streams[ssrc];
+
+	// a sender's index only moves backwards for retransmissions
+	UInt64 index;
+	if (!estimateIndex(stream.rtp, sequenceNumber, index)) index = sequenceNumber;
+
+	if (_gcm)
+	{
+		UInt8 iv[GCM_IV_SIZE];
+		gcmIV(iv, _pKeys->rtpSalt, ssrc, index);
+		if (!seal(_pKeys->pRTPCipher, 1, iv, packet, header, 0, 0, packet + header, size - header, packet + size))
+		{
+			throw Poco::SystemException("SRTP encryption failed");
+		}
+	}
+	else
+	{
+		UInt8 iv[16];
+		counterIV(iv, _pKeys->rtpSalt, ssrc, index);
+		crypt(_pKeys->pRTPCipher, iv, packet + header, size - header);
+
+		UInt8 roc[4];
+		UInt8 mac[AUTH_KEY_SIZE];
+		write32(roc, (UInt32) (index >> 16));
+		authenticate(_pKeys->pDigest, _pKeys->pRTPInner, _pKeys->pRTPOuter, packet, size, roc, sizeof(roc), mac);
+		std::memcpy(packet + size, mac, _rtpTagSize);
+	}
+
+	update(stream.rtp, index);
+	++_statistics.encrypted;
+	return size + _rtpTagSize;
+}
+
+
+bool RTPCryptoContext::unprotectRTP(UInt8* packet, std::size_t& size)
+{
+	std::size_t header = rtpHeaderSize(packet, size);
+	if (header == 0 || size < header + _rtpTagSize)
+	{
+		++_statistics.malformed;
+		return false;
+	}
+
+	UInt16 sequenceNumber = (UInt16) ((packet[2] << 8) | packet[3]);
+	UInt32 ssrc = read32(packet + 8);
+
+	// the state of a new SSRC is only kept once a packet is authentic
+	StreamMap::iterator it = _streams.find(ssrc);
+	Stream fresh = { { false, 0, 0 }, { false, 0, 0 }, 0 };
+	const Window& window = it != _streams.end() ? it->second.rtp : fresh.rtp;
+
+	UInt64 index;
+	if (!estimateIndex(window, sequenceNumber, index) || isReplay(window, index))
+	{
+		++_statistics.replayed;
+		return false;
+	}
+
+	std::size_t length = size - _rtpTagSize;
+	if (_gcm)
+	{
+		UInt8 iv[GCM_IV_SIZE];
+		gcmIV(iv, _pKeys->rtpSalt, ssrc, index);
+		if (!seal(_pKeys->pRTPCipher, 0, iv, packet, header, 0, 0, packet + header, length - header, packet + length))
+		{
+			++_statistics.authFailures;
+			return false;
+		}
+	}
+	else
+	{
+		UInt8 roc[4];
+		UInt8 mac[AUTH_KEY_SIZE];
+		write32(roc, (UInt32) (index >> 16));
+		authenticate(_pKeys->pDigest, _pKeys->pRTPInner, _pKeys->pRTPOuter, packet, length, roc, sizeof(roc), mac);
+		if (CRYPTO_memcmp(mac, packet + length, _rtpTagSize) != 0)
+		{
+			++_statistics.authFailures;
+			return false;
+		}
+
+		UInt8 iv[16];
+		counterIV(iv, _pKeys->rtpSalt, ssrc, index);
+		crypt(_pKeys->pRTPCipher, iv, packet + header, length - header);
+	}
+
+	update(it != _streams.end() ? it->second.rtp : _streams[ssrc].rtp, index);
+	size = length;
+	++_statistics.decrypted;
+	return true;
+}
+
+
+std::size_t RTPCryptoContext::protectRTCP(UInt8* packet, std::size_t size, std::size_t capacity)
+{
+	if (size < 8 || (packet[0] & 0xc0) != 0x80) throw Poco::InvalidArgumentException("not a RTCP packet");
+	if (capacity < size + rtcpOverhead()) throw Poco::InvalidArgumentException("no room for the SRTCP index and authentication tag");
+
+	UInt32 ssrc = read32(packet + 4);
+	Stream& stream = _streams[ssrc];
+	UInt32 index = stream.rtcpIndex;
+	stream.rtcpIndex = (index + 1) & 0x7fffffff;
+
+	// the E flag: the packet is encrypted
+	UInt8 trailer[4];
+	write32(trailer, 0x80000000 | index);
+
+	if (_gcm)
+	{
+		// RFC 7714: the tag comes before the index
+		UInt8 iv[GCM_IV_SIZE];
+		gcmIV(iv, _pKeys->rtcpSalt, ssrc, index);
+		if (!seal(_pKeys->pRTCPCipher, 1, iv, packet, 8, trailer, sizeof(trailer), packet + 8, size - 8, packet + size))
+		{
+			throw Poco::SystemException("SRTCP encryption failed");
+		}
+		std::memcpy(packet + size + _rtcpTagSize, trailer, sizeof(trailer));
+	}
+	else
+	{
+		UInt8 iv[16];
+		counterIV(iv, _pKeys->rtcpSalt, ssrc, index);
+		crypt(_pKeys->pRTCPCipher, iv, packet + 8, size - 8);
+		std::memcpy(packet + size, trailer, sizeof(trailer));
+
+		UInt8 mac[AUTH_KEY_SIZE];
+		authenticate(_pKeys->pDigest, _pKeys->pRTCPInner, _pKeys->pRTCPOuter, packet, size + sizeof(trailer), 0, 0, mac);
+		std::memcpy(packet + size + sizeof(trailer), mac, _rtcpTagSize);
+	}
+
+	++_statistics.encrypted;
+	return size + rtcpOverhead();
+}
+
+
+bool RTPCryptoContext::unprotectRTCP(UInt8* packet, std::size_t& size)
+{
+	if (size < 8 + rtcpOverhead() || (packet[0] & 0xc0) != 0x80)
+	{
+		++_statistics.malformed;
+		return false;
+	}
+
+	std::size_t length = size - rtcpOverhead();
+	const UInt8* trailer = packet + (_gcm ? length + _rtcpTagSize : length);
+	bool encrypted = (trailer[0] & 0x80) != 0;
+	UInt32 index = read32(trailer) & 0x7fffffff;
+	UInt32 ssrc = read32(packet + 4);
+
+	StreamMap::iterator it = _streams.find(ssrc);
+	if (it != _streams.end() && isReplay(it->second.rtcp, index))
+	{
+		++_statistics.replayed;
+		return false;
+	}
+
+	if (_gcm)
+	{
+		// without the E flag, the whole packet is associated data
+		UInt8 iv[GCM_IV_SIZE];
+		gcmIV(iv, _pKeys->rtcpSalt, ssrc, index);
+		std::size_t associated = encrypted ? 8 : length;
+		if (!seal(_pKeys->pRTCPCipher, 0, iv, packet, associated, trailer, 4, packet + associated, length - associated, packet + length))
+		{
+			++_statistics.authFailures;
+			return false;
+		}
+	}
+	else
+	{
+		UInt8 mac[AUTH_KEY_SIZE];
+		authenticate(_pKeys->pDigest, _pKeys->pRTCPInner, _pKeys->pRTCPOuter, packet, length + 4, 0, 0, mac);
+		if (CRYPTO_memcmp(mac, packet + length + 4, _rtcpTagSize) != 0)
+		{
+			++_statistics.authFailures;
+			return false;
+		}
+		if (encrypted)
+		{
+			UInt8 iv[16];
+			counterIV(iv, _pKeys->rtcpSalt, ssrc, index);
+			crypt(_pKeys->pRTCPCipher, iv, packet + 8, length - 8);
+		}
+	}
+
+	update(it != _streams.end() ? it->second.rtcp : _streams[ssrc].rtcp, index);
+	size = length;
+	++_statistics.decrypted;
+	return true;
+}
+
+
+bool RTPCryptoContext::estimateIndex(const Window& window, UInt16 sequenceNumber, UInt64& index)
+{
+	// RFC 3711, appendix A: the rollover counter that puts the
+	// sequence number closest to the highest one received
+	if (!window.started)
+	{
+		index = sequenceNumber;
+		return true;
+	}
+
+	UInt64 roc = window.highest >> 16;
+	UInt16 highest = (UInt16) window.highest;
+	if (highest < 32768)
+	{
+		if (sequenceNumber > highest + 32768)
+		{
+			if (roc == 0) return false;
+			--roc;
+		}
+	}
+	else if (sequenceNumber < highest - 32768)
+	{
+		if (roc == 0xffffffff) return false;
+		++roc;
+	}
+	index = (roc << 16) | sequenceNumber;
+	return true;
+}
+
+
+bool RTPCryptoContext::isReplay(const Window& window, UInt64 index)
+{
+	if (!window.started || index > window.highest) return false;
+
+	UInt64 delta = window.highest - index;
+	return delta >= REPLAY_WINDOW || ((window.bits >> delta) & 1) != 0;
+}
+
+
+void RTPCryptoContext::update(Window& window, UInt64 index)
+{
+	if (!window.started)
+	{
+		window.started = true;
+		window.highest = index;
+		window.bits    = 1;
+	}
+	else if (index > window.highest)
+	{
+		UInt64 delta = index - window.highest;
+		window.bits    = delta < REPLAY_WINDOW ? (window.bits << delta) | 1 : 1;
+		window.highest = index;
+	}
+	else if (window.highest - index < REPLAY_WINDOW)
+	{
+		window.bits |= (UInt64) 1 << (window.highest - index);
+	}
+}
+
+
+RTPCryptoContext::Suite RTPCryptoContext::parseSuite(const std::string& name)
+{
+	Suite suite;
+	if (!findSuite(name, suite)) throw Poco::NotImplementedException("SRTP crypto suite", name);
+	return suite;
+}
+
+
+std::string RTPCryptoContext::suiteName(Suite suite)
+{
+	return SUITE_NAMES[suite];
+}
+
+
+} // namespace RTP
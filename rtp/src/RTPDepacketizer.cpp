@@ -0,0 +1,244 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Depacketizer Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPDepacketizer.h"
+#include <cstring>
+
+
+using Poco::UInt8;
+using Poco::UInt16;
+using Poco::UInt32;
+
+
+namespace RTP {
+
+
+RTPDepacketizer::Handler::~Handler()
+{
+}
+
+
+RTPDepacketizer::RTPDepacketizer(Handler& handler):
+	_handler(handler),
+	_size(0),
+	_timestamp(0),
+	_keyFrame(false),
+	_incomplete(false),
+	_hasSequence(false),
+	_lastSequence(0)
+{
+	std::memset(&_statistics, 0, sizeof(_statistics));
+}
+
+
+RTPDepacketizer::~RTPDepacketizer()
+{
+}
+
+
+void RTPDepacketizer::push(const RTPPacket& packet)
+{
+	poco_assert_dbg (packet.valid());
+
+	++_statistics.packets;
+
+	UInt16 sequence = packet.sequenceNumber();
+	bool lost = _hasSequence && sequence != (UInt16) (_lastSequence + 1);
+	_hasSequence  = true;
+	_lastSequence = sequence;
+
+	// the lost packets may have been the tail of the current unit
+	if (lost && !_slices.empty())
+	{
+		setIncomplete();
+	}
+
+	// a new timestamp starts a new unit even if the
+	// sender did not set the marker bit on the last one
+	if (!_slices.empty() && packet.timestamp() != _timestamp)
+	{
+		deliver();
+	}
+	if (lost)
+	{
+		// the gap only reaches into a new unit
+		// that started before this packet
+		if (!_slices.empty() || !startsUnit(packet))
+		{
+			setIncomplete();
+		}
+		onLoss();
+	}
+	if (_slices.empty())
+	{
+		_timestamp = packet.timestamp();
+	}
+
+	depacketize(packet);
+
+	if (packet.marker())
+	{
+		deliver();
+	}
+}
+
+
+void RTPDepacketizer::flush()
+{
+	deliver();
+}
+
+
+void RTPDepacketizer::reset()
+{
+	clearUnit();
+	_hasSequence = false;
+}
+
+
+void RTPDepacketizer::onLoss()
+{
+}
+
+
+void RTPDepacketizer::completeUnit()
+{
+}
+
+
+bool RTPDepacketizer::startsUnit(const RTPPacket& packet) const
+{
+	return false;
+}
+
+
+std::size_t RTPDepacketizer::appendOwned(const void* data, std::size_t size)
+{
+	std::size_t offset = _arena.size();
+	_arena.insert(_arena.end(), static_cast<const UInt8*>(data), static_cast<const UInt8*>(data) + size);
+
+	// the arena may move while the unit grows, so owned
+	// slices are resolved to pointers on delivery
+	Slice slice = { 0, size };
+	_slices.push_back(slice);
+	_owned.push_back(offset);
+	_size += size;
+	return _slices.size() - 1;
+}
+
+
+UInt8* RTPDepacketizer::ownedData(std::size_t index)
+{
+	poco_assert_dbg (index < _owned.size() && _owned[index] != std::size_t(-1));
+
+	return &_arena[_owned[index]];
+}
+
+
+void RTPDepacketizer::insertSlice(std::size_t index, const UInt8* data, std::size_t size)
+{
+	poco_assert_dbg (index <= _slices.size());
+
+	Slice slice = { data, size };
+	_slices.insert(_slices.begin() + index, slice);
+	_owned.insert(_owned.begin() + index, std::size_t(-1));
+	_size += size;
+}
+
+
+void RTPDepacketizer::truncate(std::size_t count)
+{
+	while (_slices.size() > count)
+	{
+		_size -= _slices.back().size;
+		if (_owned.back() != std::size_t(-1)) _arena.resize(_owned.back());
+		_slices.pop_back();
+		_owned.pop_back();
+	}
+}
+
+
+void RTPDepacketizer::discardUnit()
+{
+	clearUnit();
+}
+
+
+void RTPDepacketizer::deliver()
+{
+	completeUnit();
+	if (_slices.empty())
+	{
+		clearUnit();
+		return;
+	}
+
+	for (std::size_t i = 0; i < _slices.size(); ++i)
+	{
+		if (_owned[i] != std::size_t(-1)) _slices[i].data = &_arena[_owned[i]];
+	}
+
+	AccessUnit unit;
+	unit.slices     = &_slices[0];
+	unit.sliceCount = _slices.size();
+	unit.size       = _size;
+	unit.timestamp  = _timestamp;
+	unit.keyFrame   = _keyFrame;
+	unit.complete   = !_incomplete;
+
+	++_statistics.accessUnits;
+	if (_incomplete) ++_statistics.incompleteUnits;
+
+	_handler.onAccessUnit(unit);
+	clearUnit();
+}
+
+
+void RTPDepacketizer::clearUnit()
+{
+	_slices.clear();
+	_owned.clear();
+	_arena.clear();
+	_size       = 0;
+	_keyFrame   = false;
+	_incomplete = false;
+}
+
+
+} // namespace RTP
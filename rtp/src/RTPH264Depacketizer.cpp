@@ -0,0 +1,378 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP H.264 Depacketizer Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPH264Depacketizer.h"
+#include "RTPPayloadFormat.h"
+#include "Poco/Exception.h"
+#include "Poco/StringTokenizer.h"
+
+
+using Poco::UInt8;
+using Poco::StringTokenizer;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const UInt8 START_CODE[4] = { 0, 0, 0, 1 };
+
+	const UInt8 FU_START = 0x80;
+	const UInt8 FU_END   = 0x40;
+
+	bool firstOfUnit(int type, const UInt8* payload, std::size_t size)
+		/// Returns true if a NAL unit of the given type, with the
+		/// given payload after its header, can only appear at the
+		/// start of an access unit: an access unit delimiter, a
+		/// SPS, or a slice with first_mb_in_slice 0, whose ue(v)
+		/// code is a single 1 bit.
+	{
+		switch (type)
+		{
+		case RTPH264Depacketizer::NAL_AUD:
+		case RTPH264Depacketizer::NAL_SPS:
+			return true;
+		case RTPH264Depacketizer::NAL_SLICE:
+		case RTPH264Depacketizer::NAL_IDR:
+			return size > 0 && (payload[0] & 0x80);
+		default:
+			return false;
+		}
+	}
+}
+
+
+RTPH264Depacketizer::RTPH264Depacketizer(Handler& handler, Format format):
+	RTPDepacketizer(handler),
+	_format(format),
+	_insertParameterSets(true),
+	_unitHasIDR(false),
+	_unitHasSPS(false),
+	_unitHasPPS(false),
+	_inFragment(false),
+	_fragmentStart(0),
+	_fragmentSize(0)
+{
+}
+
+
+RTPH264Depacketizer::RTPH264Depacketizer(Handler& handler, const RTPPayloadFormat& payloadFormat, Format format):
+	RTPDepacketizer(handler),
+	_format(format),
+	_insertParameterSets(true),
+	_unitHasIDR(false),
+	_unitHasSPS(false),
+	_unitHasPPS(false),
+	_inFragment(false),
+	_fragmentStart(0),
+	_fragmentSize(0)
+{
+	if (payloadFormat.parameter("packetization-mode", "0") == "2")
+		throw Poco::NotImplementedException("H.264 interleaved packetization mode");
+
+	std::string sprop = payloadFormat.parameter("sprop-parameter-sets");
+	if (!sprop.empty()) setParameterSets(sprop);
+}
+
+
+RTPH264Depacketizer::~RTPH264Depacketizer()
+{
+}
+
+
+void RTPH264Depacketizer::setParameterSets(const std::string& spropParameterSets)
+{
+	StringTokenizer tokens(spropParameterSets, ",", StringTokenizer::TOK_IGNORE_EMPTY | StringTokenizer::TOK_TRIM);
+	for (StringTokenizer::Iterator it = tokens.begin(); it != tokens.end(); ++it)
+	{
+		std::string nal = RTPPayloadFormat::decodeBase64(*it);
+		if (nal.empty()) throw Poco::DataFormatException("empty parameter set", spropParameterSets);
+
+		int type = nal[0] & 0x1f;
+		if (type == NAL_SPS)
+			_sps = nal;
+		else if (type == NAL_PPS)
+			_pps = nal;
+	}
+	updateParameterSets();
+}
+
+
+void RTPH264Depacketizer::setInsertParameterSets(bool insert)
+{
+	_insertParameterSets = insert;
+}
+
+
+void RTPH264Depacketizer::reset()
+{
+	RTPDepacketizer::reset();
+	_unitHasIDR = false;
+	_unitHasSPS = false;
+	_unitHasPPS = false;
+	_inFragment = false;
+}
+
+
+void RTPH264Depacketizer::depacketize(const RTPPacket& packet)
+{
+	const UInt8* p = packet.payload();
+	std::size_t size = packet.payloadSize();
+	if (size == 0)
+	{
+		dropPacket();
+		return;
+	}
+
+	int type = p[0] & 0x1f;
+	if (_inFragment && type != NAL_FU_A)
+	{
+		// the end of the fragmented NAL unit was lost
+		abortFragment();
+		setIncomplete();
+	}
+
+	if (type >= NAL_SLICE && type < NAL_STAP_A)
+	{
+		appendNAL(p, size);
+	}
+	else if (type == NAL_STAP_A)
+	{
+		// STAP-A: a sequence of 16-bit sizes and NAL units
+		std::size_t pos = 1;
+		while (pos + 2 < size)
+		{
+			std::size_t nalSize = (p[pos] << 8) | p[pos + 1];
+			pos += 2;
+			if (nalSize == 0 || nalSize > size - pos)
+			{
+				dropPacket();
+				setIncomplete();
+				break;
+			}
+			appendNAL(p + pos, nalSize);
+			pos += nalSize;
+		}
+	}
+	else if (type == NAL_FU_A && size > 2)
+	{
+		UInt8 header = p[1];
+		if (header & FU_START)
+		{
+			if (_inFragment)
+			{
+				abortFragment();
+				setIncomplete();
+			}
+
+			// the NAL unit header is rebuilt from the F and NRI
+			// bits of the FU indicator and the type of the FU header
+			UInt8 nalHeader = (UInt8) ((p[0] & 0xe0) | (header & 0x1f));
+			_fragmentStart = sliceCount();
+			appendPrefix(0);
+			appendOwned(&nalHeader, 1);
+			_inFragment   = true;
+			_fragmentSize = 1;
+		}
+		else if (!_inFragment)
+		{
+			// the start of the fragmented NAL unit was lost
+			dropPacket();
+			return;
+		}
+
+		appendSlice(p + 2, size - 2);
+		_fragmentSize += size - 2;
+
+		if (header & FU_END)
+		{
+			if (_format == FORMAT_AVCC)
+			{
+				UInt8* length = ownedData(_fragmentStart);
+				length[0] = (UInt8) (_fragmentSize >> 24);
+				length[1] = (UInt8) (_fragmentSize >> 16);
+				length[2] = (UInt8) (_fragmentSize >> 8);
+				length[3] = (UInt8) _fragmentSize;
+			}
+
+			// the NAL unit only counts once it is complete
+			UInt8 nalHeader = (UInt8) ((p[0] & 0xe0) | (header & 0x1f));
+			noteNAL(&nalHeader, 1);
+			_inFragment = false;
+		}
+	}
+	else
+	{
+		dropPacket();
+	}
+}
+
+
+void RTPH264Depacketizer::onLoss()
+{
+	if (_inFragment) abortFragment();
+}
+
+
+bool RTPH264Depacketizer::startsUnit(const RTPPacket& packet) const
+{
+	const UInt8* p = packet.payload();
+	std::size_t size = packet.payloadSize();
+	if (size < 2) return false;
+
+	int type = p[0] & 0x1f;
+	if (type == NAL_STAP_A)
+	{
+		// the first aggregated NAL unit follows its 16-bit size
+		return size > 4 && firstOfUnit(p[3] & 0x1f, p + 4, size - 4);
+	}
+	else if (type == NAL_FU_A)
+	{
+		return size > 2 && (p[1] & FU_START) && firstOfUnit(p[1] & 0x1f, p + 2, size - 2);
+	}
+	return firstOfUnit(type, p + 1, size - 1);
+}
+
+
+void RTPH264Depacketizer::completeUnit()
+{
+	if (_inFragment)
+	{
+		abortFragment();
+		setIncomplete();
+	}
+
+	// an IDR access unit lacking parameter sets gets the
+	// last known ones, so that it can be decoded on its own
+	if (_insertParameterSets && _unitHasIDR && !_parameterSets.empty() && !(_unitHasSPS && _unitHasPPS))
+	{
+		insertSlice(0, &_parameterSets[0], _parameterSets.size());
+	}
+	_unitHasSPS = false;
+	_unitHasPPS = false;
+	_unitHasIDR = false;
+}
+
+
+void RTPH264Depacketizer::appendNAL(const UInt8* nal, std::size_t size)
+{
+	appendPrefix(size);
+	appendSlice(nal, size);
+	noteNAL(nal, size);
+}
+
+
+void RTPH264Depacketizer::appendPrefix(std::size_t size)
+{
+	if (_format == FORMAT_ANNEXB)
+	{
+		appendSlice(START_CODE, sizeof(START_CODE));
+	}
+	else
+	{
+		UInt8 length[4] = { (UInt8) (size >> 24), (UInt8) (size >> 16), (UInt8) (size >> 8), (UInt8) size };
+		appendOwned(length, sizeof(length));
+	}
+}
+
+
+void RTPH264Depacketizer::noteNAL(const UInt8* nal, std::size_t size)
+{
+	switch (nal[0] & 0x1f)
+	{
+	case NAL_IDR:
+		setKeyFrame();
+		_unitHasIDR = true;
+		break;
+	case NAL_SPS:
+		_unitHasSPS = true;
+		if (size > 1 && _sps.compare(0, std::string::npos, reinterpret_cast<const char*>(nal), size) != 0)
+		{
+			_sps.assign(reinterpret_cast<const char*>(nal), size);
+			updateParameterSets();
+		}
+		break;
+	case NAL_PPS:
+		_unitHasPPS = true;
+		if (size > 1 && _pps.compare(0, std::string::npos, reinterpret_cast<const char*>(nal), size) != 0)
+		{
+			_pps.assign(reinterpret_cast<const char*>(nal), size);
+			updateParameterSets();
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+
+void RTPH264Depacketizer::abortFragment()
+{
+	truncate(_fragmentStart);
+	_inFragment = false;
+}
+
+
+void RTPH264Depacketizer::updateParameterSets()
+{
+	_parameterSets.clear();
+	if (_sps.empty() || _pps.empty()) return;
+
+	const std::string* sets[2] = { &_sps, &_pps };
+	for (int i = 0; i < 2; ++i)
+	{
+		std::size_t size = sets[i]->size();
+		if (_format == FORMAT_ANNEXB)
+		{
+			_parameterSets.insert(_parameterSets.end(), START_CODE, START_CODE + sizeof(START_CODE));
+		}
+		else
+		{
+			_parameterSets.push_back((UInt8) (size >> 24));
+			_parameterSets.push_back((UInt8) (size >> 16));
+			_parameterSets.push_back((UInt8) (size >> 8));
+			_parameterSets.push_back((UInt8) size);
+		}
+		_parameterSets.insert(_parameterSets.end(), sets[i]->begin(), sets[i]->end());
+	}
+}
+
+
+} // namespace RTP
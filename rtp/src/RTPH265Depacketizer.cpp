@@ -0,0 +1,471 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP H.265 Depacketizer Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPH265Depacketizer.h"
+#include "RTPPayloadFormat.h"
+#include "Poco/Exception.h"
+#include "Poco/NumberParser.h"
+#include "Poco/StringTokenizer.h"
+
+
+using Poco::UInt8;
+using Poco::NumberParser;
+using Poco::StringTokenizer;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const UInt8 START_CODE[4] = { 0, 0, 0, 1 };
+
+	const std::size_t PAYLOAD_HEADER_SIZE = 2;
+	const std::size_t DONL_SIZE = 2;
+	const std::size_t DOND_SIZE = 1;
+
+	const UInt8 FU_START = 0x80;
+	const UInt8 FU_END   = 0x40;
+
+	inline int nalType(const UInt8* nal)
+	{
+		return (nal[0] >> 1) & 0x3f;
+	}
+
+	bool firstOfUnit(int type, const UInt8* payload, std::size_t size)
+		/// Returns true if a NAL unit of the given type, with the
+		/// given payload after its header, can only appear at the
+		/// start of an access unit: an access unit delimiter, a
+		/// VPS, or a VCL NAL unit with first_slice_segment_in_pic_flag.
+	{
+		if (type == RTPH265Depacketizer::NAL_AUD || type == RTPH265Depacketizer::NAL_VPS)
+			return true;
+
+		// VCL NAL unit types are those below the VPS
+		return type < RTPH265Depacketizer::NAL_VPS && size > 0 && (payload[0] & 0x80);
+	}
+
+	std::string decodeParameterSet(const std::string& sprop, int type)
+		/// Returns the last NAL unit of the given type in a
+		/// sprop-vps, sprop-sps or sprop-pps parameter.
+	{
+		std::string result;
+		StringTokenizer tokens(sprop, ",", StringTokenizer::TOK_IGNORE_EMPTY | StringTokenizer::TOK_TRIM);
+		for (StringTokenizer::Iterator it = tokens.begin(); it != tokens.end(); ++it)
+		{
+			std::string nal = RTPPayloadFormat::decodeBase64(*it);
+			if (nal.size() < PAYLOAD_HEADER_SIZE || nalType(reinterpret_cast<const UInt8*>(nal.data())) != type)
+				throw Poco::DataFormatException("invalid parameter set", sprop);
+
+			result = nal;
+		}
+		return result;
+	}
+}
+
+
+RTPH265Depacketizer::RTPH265Depacketizer(Handler& handler, Format format, bool donl):
+	RTPDepacketizer(handler),
+	_format(format),
+	_donl(donl),
+	_insertParameterSets(true),
+	_unitHasIRAP(false),
+	_unitHasVPS(false),
+	_unitHasSPS(false),
+	_unitHasPPS(false),
+	_inFragment(false),
+	_fragmentStart(0),
+	_fragmentSize(0)
+{
+}
+
+
+RTPH265Depacketizer::RTPH265Depacketizer(Handler& handler, const RTPPayloadFormat& payloadFormat, Format format):
+	RTPDepacketizer(handler),
+	_format(format),
+	_donl(false),
+	_insertParameterSets(true),
+	_unitHasIRAP(false),
+	_unitHasVPS(false),
+	_unitHasSPS(false),
+	_unitHasPPS(false),
+	_inFragment(false),
+	_fragmentStart(0),
+	_fragmentSize(0)
+{
+	// DONL and DOND fields are present if sprop-max-don-diff > 0 (RFC 7798, 7.1)
+	int maxDonDiff;
+	_donl = NumberParser::tryParse(payloadFormat.parameter("sprop-max-don-diff", "0"), maxDonDiff) && maxDonDiff > 0;
+
+	setParameterSets(payloadFormat.parameter("sprop-vps"), payloadFormat.parameter("sprop-sps"), payloadFormat.parameter("sprop-pps"));
+}
+
+
+RTPH265Depacketizer::~RTPH265Depacketizer()
+{
+}
+
+
+void RTPH265Depacketizer::setParameterSets(const std::string& spropVPS, const std::string& spropSPS, const std::string& spropPPS)
+{
+	std::string vps = decodeParameterSet(spropVPS, NAL_VPS);
+	std::string sps = decodeParameterSet(spropSPS, NAL_SPS);
+	std::string pps = decodeParameterSet(spropPPS, NAL_PPS);
+	if (!vps.empty()) _vps = vps;
+	if (!sps.empty()) _sps = sps;
+	if (!pps.empty()) _pps = pps;
+	updateParameterSets();
+}
+
+
+void RTPH265Depacketizer::setInsertParameterSets(bool insert)
+{
+	_insertParameterSets = insert;
+}
+
+
+void RTPH265Depacketizer::reset()
+{
+	RTPDepacketizer::reset();
+	_unitHasIRAP = false;
+	_unitHasVPS  = false;
+	_unitHasSPS  = false;
+	_unitHasPPS  = false;
+	_inFragment  = false;
+}
+
+
+void RTPH265Depacketizer::depacketize(const RTPPacket& packet)
+{
+	const UInt8* p = packet.payload();
+	std::size_t size = packet.payloadSize();
+	if (size <= PAYLOAD_HEADER_SIZE)
+	{
+		dropPacket();
+		return;
+	}
+
+	int type = nalType(p);
+	if (_inFragment && type != NAL_FU)
+	{
+		// the end of the fragmented NAL unit was lost
+		abortFragment();
+		setIncomplete();
+	}
+
+	if (type < NAL_AP)
+	{
+		if (!_donl)
+		{
+			appendNAL(p, size);
+		}
+		else if (size > PAYLOAD_HEADER_SIZE + DONL_SIZE)
+		{
+			// the NAL unit header is followed by the DONL field,
+			// so the header has to be moved in front of the payload
+			appendPrefix(size - DONL_SIZE);
+			appendOwned(p, PAYLOAD_HEADER_SIZE);
+			appendSlice(p + PAYLOAD_HEADER_SIZE + DONL_SIZE, size - PAYLOAD_HEADER_SIZE - DONL_SIZE);
+			if (type >= NAL_VPS && type <= NAL_PPS)
+			{
+				std::string nal(reinterpret_cast<const char*>(p), PAYLOAD_HEADER_SIZE);
+				nal.append(reinterpret_cast<const char*>(p) + PAYLOAD_HEADER_SIZE + DONL_SIZE, size - PAYLOAD_HEADER_SIZE - DONL_SIZE);
+				noteNAL(reinterpret_cast<const UInt8*>(nal.data()), nal.size());
+			}
+			else
+			{
+				noteNAL(p, PAYLOAD_HEADER_SIZE);
+			}
+		}
+		else
+		{
+			dropPacket();
+		}
+	}
+	else if (type == NAL_AP)
+	{
+		depacketizeAP(p, size);
+	}
+	else if (type == NAL_FU)
+	{
+		depacketizeFU(p, size);
+	}
+	else
+	{
+		dropPacket();
+	}
+}
+
+
+void RTPH265Depacketizer::depacketizeAP(const UInt8* p, std::size_t size)
+{
+	// AP: payload header, then for each aggregation unit an optional
+	// DONL (first) or DOND (others), a 16-bit size and the NAL unit
+	std::size_t pos = PAYLOAD_HEADER_SIZE;
+	bool first = true;
+	while (pos < size)
+	{
+		if (_donl) pos += first ? DONL_SIZE : DOND_SIZE;
+		first = false;
+		if (pos + 2 > size)
+		{
+			dropPacket();
+			setIncomplete();
+			return;
+		}
+
+		std::size_t nalSize = (p[pos] << 8) | p[pos + 1];
+		pos += 2;
+		if (nalSize < PAYLOAD_HEADER_SIZE || nalSize > size - pos)
+		{
+			dropPacket();
+			setIncomplete();
+			return;
+		}
+		appendNAL(p + pos, nalSize);
+		pos += nalSize;
+	}
+}
+
+
+void RTPH265Depacketizer::depacketizeFU(const UInt8* p, std::size_t size)
+{
+	// FU: payload header, FU header, DONL in the first fragment only
+	std::size_t headerSize = PAYLOAD_HEADER_SIZE + 1;
+	UInt8 header = p[PAYLOAD_HEADER_SIZE];
+	if ((header & FU_START) && _donl) headerSize += DONL_SIZE;
+	if (size <= headerSize)
+	{
+		dropPacket();
+		return;
+	}
+
+	// the NAL unit header is the payload header with
+	// the type replaced by the type of the FU header
+	UInt8 nalHeader[2] = { (UInt8) ((p[0] & 0x81) | ((header & 0x3f) << 1)), p[1] };
+
+	if (header & FU_START)
+	{
+		if (_inFragment)
+		{
+			abortFragment();
+			setIncomplete();
+		}
+
+		_fragmentStart = sliceCount();
+		appendPrefix(0);
+		appendOwned(nalHeader, sizeof(nalHeader));
+		_inFragment   = true;
+		_fragmentSize = sizeof(nalHeader);
+	}
+	else if (!_inFragment)
+	{
+		// the start of the fragmented NAL unit was lost
+		dropPacket();
+		return;
+	}
+
+	appendSlice(p + headerSize, size - headerSize);
+	_fragmentSize += size - headerSize;
+
+	if (header & FU_END)
+	{
+		if (_format == FORMAT_HVCC)
+		{
+			UInt8* length = ownedData(_fragmentStart);
+			length[0] = (UInt8) (_fragmentSize >> 24);
+			length[1] = (UInt8) (_fragmentSize >> 16);
+			length[2] = (UInt8) (_fragmentSize >> 8);
+			length[3] = (UInt8) _fragmentSize;
+		}
+		_inFragment = false;
+
+		// the NAL unit only counts once it is complete
+		noteNAL(nalHeader, sizeof(nalHeader));
+	}
+}
+
+
+void RTPH265Depacketizer::onLoss()
+{
+	if (_inFragment) abortFragment();
+}
+
+
+bool RTPH265Depacketizer::startsUnit(const RTPPacket& packet) const
+{
+	const UInt8* p = packet.payload();
+	std::size_t size = packet.payloadSize();
+	std::size_t donl = _donl ? DONL_SIZE : 0;
+	if (size <= PAYLOAD_HEADER_SIZE) return false;
+
+	int type = nalType(p);
+	if (type == NAL_AP)
+	{
+		// the first aggregation unit: DONL, 16-bit size, NAL unit
+		std::size_t pos = PAYLOAD_HEADER_SIZE + donl + 2;
+		return size > pos + PAYLOAD_HEADER_SIZE && firstOfUnit(nalType(p + pos), p + pos + PAYLOAD_HEADER_SIZE, size - pos - PAYLOAD_HEADER_SIZE);
+	}
+	else if (type == NAL_FU)
+	{
+		UInt8 header = p[PAYLOAD_HEADER_SIZE];
+		std::size_t pos = PAYLOAD_HEADER_SIZE + 1 + donl;
+		return (header & FU_START) && size > pos && firstOfUnit(header & 0x3f, p + pos, size - pos);
+	}
+	else if (type < NAL_AP && size > PAYLOAD_HEADER_SIZE + donl)
+	{
+		return firstOfUnit(type, p + PAYLOAD_HEADER_SIZE + donl, size - PAYLOAD_HEADER_SIZE - donl);
+	}
+	return false;
+}
+
+
+void RTPH265Depacketizer::completeUnit()
+{
+	if (_inFragment)
+	{
+		abortFragment();
+		setIncomplete();
+	}
+
+	// an IRAP access unit lacking parameter sets gets the
+	// last known ones, so that it can be decoded on its own
+	if (_insertParameterSets && _unitHasIRAP && !_parameterSets.empty() && !(_unitHasVPS && _unitHasSPS && _unitHasPPS))
+	{
+		insertSlice(0, &_parameterSets[0], _parameterSets.size());
+	}
+	_unitHasIRAP = false;
+	_unitHasVPS  = false;
+	_unitHasSPS  = false;
+	_unitHasPPS  = false;
+}
+
+
+void RTPH265Depacketizer::appendNAL(const UInt8* nal, std::size_t size)
+{
+	appendPrefix(size);
+	appendSlice(nal, size);
+	noteNAL(nal, size);
+}
+
+
+void RTPH265Depacketizer::appendPrefix(std::size_t size)
+{
+	if (_format == FORMAT_ANNEXB)
+	{
+		appendSlice(START_CODE, sizeof(START_CODE));
+	}
+	else
+	{
+		UInt8 length[4] = { (UInt8) (size >> 24), (UInt8) (size >> 16), (UInt8) (size >> 8), (UInt8) size };
+		appendOwned(length, sizeof(length));
+	}
+}
+
+
+void RTPH265Depacketizer::noteNAL(const UInt8* nal, std::size_t size)
+{
+	int type = nalType(nal);
+	if (type >= NAL_IRAP_FIRST && type <= NAL_IRAP_LAST)
+	{
+		setKeyFrame();
+		_unitHasIRAP = true;
+		return;
+	}
+
+	std::string* pSet = 0;
+	switch (type)
+	{
+	case NAL_VPS:
+		_unitHasVPS = true;
+		pSet = &_vps;
+		break;
+	case NAL_SPS:
+		_unitHasSPS = true;
+		pSet = &_sps;
+		break;
+	case NAL_PPS:
+		_unitHasPPS = true;
+		pSet = &_pps;
+		break;
+	default:
+		return;
+	}
+
+	if (size > PAYLOAD_HEADER_SIZE && pSet->compare(0, std::string::npos, reinterpret_cast<const char*>(nal), size) != 0)
+	{
+		pSet->assign(reinterpret_cast<const char*>(nal), size);
+		updateParameterSets();
+	}
+}
+
+
+void RTPH265Depacketizer::abortFragment()
+{
+	truncate(_fragmentStart);
+	_inFragment = false;
+}
+
+
+void RTPH265Depacketizer::updateParameterSets()
+{
+	_parameterSets.clear();
+	if (_vps.empty() || _sps.empty() || _pps.empty()) return;
+
+	const std::string* sets[3] = { &_vps, &_sps, &_pps };
+	for (int i = 0; i < 3; ++i)
+	{
+		std::size_t size = sets[i]->size();
+		if (_format == FORMAT_ANNEXB)
+		{
+			_parameterSets.insert(_parameterSets.end(), START_CODE, START_CODE + sizeof(START_CODE));
+		}
+		else
+		{
+			_parameterSets.push_back((UInt8) (size >> 24));
+			_parameterSets.push_back((UInt8) (size >> 16));
+			_parameterSets.push_back((UInt8) (size >> 8));
+			_parameterSets.push_back((UInt8) size);
+		}
+		_parameterSets.insert(_parameterSets.end(), sets[i]->begin(), sets[i]->end());
+	}
+}
+
+
+} // namespace RTP
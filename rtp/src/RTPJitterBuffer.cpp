@@ -0,0 +1,409 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Jitter Buffer Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPJitterBuffer.h"
+#include "RTPPayloadFormat.h"
+#include "Poco/Exception.h"
+#include <algorithm>
+#include <cstring>
+
+
+using Poco::UInt8;
+using Poco::UInt16;
+using Poco::UInt32;
+using Poco::Int32;
+using Poco::Int64;
+using Poco::Timestamp;
+using Poco::Timespan;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const Int64 EMPTY       = -(Int64(1) << 62);
+	const int   RTP_SEQ_MOD = 1 << 16;
+	const Int64 SKEW_WINDOW = 2 * Timespan::SECONDS;  // arrival time over which the smallest transit is taken
+	const Int64 SKEW_STEPS  = 8;                      // the base time rises by at most latency/SKEW_STEPS per window
+}
+
+
+RTPJitterBuffer::RTPJitterBuffer(int clockRate, const Timespan& latency, std::size_t capacity, int maxMisorder, std::size_t maxPacketSize):
+	_clockRate(clockRate),
+	_latency(latency),
+	_maxMisorder(maxMisorder)
+{
+	init(capacity, maxPacketSize);
+}
+
+
+RTPJitterBuffer::RTPJitterBuffer(const RTPPayloadFormat& format, const Timespan& latency, std::size_t capacity, int maxMisorder, std::size_t maxPacketSize):
+	_clockRate(format.clockRate()),
+	_latency(latency),
+	_maxMisorder(maxMisorder)
+{
+	init(capacity, maxPacketSize);
+}
+
+
+RTPJitterBuffer::~RTPJitterBuffer()
+{
+}
+
+
+void RTPJitterBuffer::init(std::size_t capacity, std::size_t maxPacketSize)
+{
+	if (_clockRate <= 0) throw Poco::InvalidArgumentException("clock rate must be positive");
+	if (capacity == 0 || maxPacketSize == 0) throw Poco::InvalidArgumentException("capacity and packet size must be positive");
+	if (_maxMisorder < 0 || _maxMisorder >= MAX_DROPOUT) throw Poco::InvalidArgumentException("max misorder out of range");
+
+	std::size_t size = 1;
+	while (size < capacity) size <<= 1;
+
+	Slot empty;
+	empty.sequence = EMPTY;
+	empty.playout  = 0;
+	_slots.assign(size, empty);
+	_storage.resize(size * maxPacketSize);
+	_mask          = size - 1;
+	_maxPacketSize = maxPacketSize;
+	std::memset(&_statistics, 0, sizeof(_statistics));
+	reset();
+}
+
+
+void RTPJitterBuffer::reset()
+{
+	for (std::vector<Slot>::iterator it = _slots.begin(); it != _slots.end(); ++it)
+	{
+		it->sequence = EMPTY;
+		it->buffer   = 0;
+	}
+	_pending       = 0;
+	_started       = false;
+	_ssrc          = 0;
+	_badSequence   = RTP_SEQ_MOD + 1;
+	_baseSequence  = 0;
+	_highest       = 0;
+	_nextOut       = 0;
+	_baseTimestamp = 0;
+	_baseTime      = 0;
+	_windowStart   = 0;
+	_windowMin     = 0;
+	_startTime     = 0;
+	_lastTransit   = 0;
+	_jitter        = 0;
+}
+
+
+void RTPJitterBuffer::start(const RTPPacket& packet, Timestamp::TimeVal arrival)
+{
+	_started       = true;
+	_ssrc          = packet.ssrc();
+	_badSequence   = RTP_SEQ_MOD + 1;
+	_baseSequence  = packet.sequenceNumber();
+	_highest       = _baseSequence;
+	_nextOut       = _baseSequence;
+	_baseTimestamp = packet.timestamp();
+	_baseTime      = arrival;
+	_windowStart   = arrival;
+	_windowMin     = arrival;
+	_startTime     = arrival;
+	_lastTransit   = EMPTY;
+	_jitter        = 0;
+}
+
+
+bool RTPJitterBuffer::insert(const RTPPacket& packet, const Timestamp& arrival)
+{
+	return insert(packet, 0, arrival);
+}
+
+
+bool RTPJitterBuffer::insert(const RTPPacket& packet, RTPPacketBuffer* pBuffer, const Timestamp& arrival)
+{
+	poco_assert (packet.valid());
+	poco_assert_dbg (!pBuffer || (packet.data() >= pBuffer->data() && packet.data() + packet.size() <= pBuffer->data() + pBuffer->capacity()));
+
+	if (!pBuffer && packet.size() > _maxPacketSize)
+	{
+		++_statistics.dropped;
+		return false;
+	}
+
+	Timestamp::TimeVal time = arrival.epochMicroseconds();
+	UInt16 seq = packet.sequenceNumber();
+	if (!_started)
+	{
+		start(packet, time);
+	}
+	else if (packet.ssrc() != _ssrc)
+	{
+		reset();
+		start(packet, time);
+		++_statistics.resets;
+	}
+
+	// classify the sequence number against the highest one
+	// received, following RFC 3550, appendix A.1
+	UInt16 udelta = (UInt16) (seq - (UInt16) _highest);
+	Int64 sequence;
+	if (udelta < MAX_DROPOUT)
+	{
+		sequence = _highest + udelta;
+	}
+	else if (udelta <= RTP_SEQ_MOD - _maxMisorder)
+	{
+		// a very large jump: the source has restarted
+		// if the next packet continues from this one
+		if (seq != _badSequence)
+		{
+			_badSequence = (seq + 1) & (RTP_SEQ_MOD - 1);
+			++_statistics.dropped;
+			return false;
+		}
+		reset();
+		start(packet, time);
+		++_statistics.resets;
+		sequence = _highest;
+	}
+	else
+	{
+		sequence = _highest - (RTP_SEQ_MOD - udelta);
+	}
+
+	if (sequence < _nextOut)
+	{
+		// until the first packet has been released, a packet it
+		// overtook can still be played out in order
+		if (_nextOut != _baseSequence || _highest - sequence >= (Int64) _slots.size())
+		{
+			++_statistics.late;
+			return false;
+		}
+		_nextOut      = sequence;
+		_baseSequence = sequence;
+	}
+
+	Slot& slot = _slots[index(sequence)];
+	if (slot.sequence == sequence)
+	{
+		++_statistics.duplicates;
+		return false;
+	}
+
+	if (sequence - _nextOut >= (Int64) _slots.size())
+	{
+		skipTo(sequence - (Int64) _slots.size() + 1);
+	}
+
+	if (pBuffer)
+	{
+		slot.buffer = RTPPacketBuffer::Ptr(pBuffer, true);
+		slot.packet = packet;
+	}
+	else
+	{
+		UInt8* pData = &_storage[index(sequence) * _maxPacketSize];
+		std::memcpy(pData, packet.data(), packet.size());
+		slot.packet.parse(pData, packet.size());
+		slot.buffer = 0;
+	}
+	slot.sequence = sequence;
+	slot.playout  = playoutTime(packet.timestamp(), time);
+	updateJitter(packet.timestamp(), time);
+
+	if (sequence > _highest)
+		_highest = sequence;
+	else if (sequence < _highest)
+		++_statistics.reordered;
+	++_pending;
+	++_statistics.received;
+	_badSequence = RTP_SEQ_MOD + 1;
+	return true;
+}
+
+
+void RTPJitterBuffer::skipTo(Int64 sequence)
+{
+	while (_nextOut < sequence && _pending > 0)
+	{
+		Slot& slot = _slots[index(_nextOut)];
+		if (slot.sequence == _nextOut)
+		{
+			slot.sequence = EMPTY;
+			--_pending;
+			++_statistics.dropped;
+		}
+		else
+		{
+			++_statistics.lost;
+		}
+		++_nextOut;
+	}
+	if (_nextOut < sequence)
+	{
+		_statistics.lost += sequence - _nextOut;
+		_nextOut = sequence;
+	}
+}
+
+
+const RTPPacket* RTPJitterBuffer::next(const Timestamp& now)
+{
+	Timestamp::TimeVal time = now.epochMicroseconds();
+	while (_pending > 0)
+	{
+		Slot& slot = _slots[index(_nextOut)];
+		if (slot.sequence != _nextOut)
+		{
+			// give up on the missing packets once
+			// the first packet behind them is due
+			const Slot& first = firstPending();
+			if (first.playout > time) return 0;
+
+			_statistics.lost += first.sequence - _nextOut;
+			_nextOut = first.sequence;
+			continue;
+		}
+		if (slot.playout > time) return 0;
+
+		slot.sequence = EMPTY;
+		--_pending;
+		++_nextOut;
+		++_statistics.released;
+		return &slot.packet;
+	}
+	return 0;
+}
+
+
+bool RTPJitterBuffer::nextDue(Timestamp& due) const
+{
+	if (_pending == 0) return false;
+
+	const Slot& slot = _slots[index(_nextOut)];
+	due = Timestamp(slot.sequence == _nextOut ? slot.playout : firstPending().playout);
+	return true;
+}
+
+
+const RTPJitterBuffer::Slot& RTPJitterBuffer::firstPending() const
+{
+	poco_assert_dbg (_pending > 0);
+
+	Int64 sequence = _nextOut;
+	while (_slots[index(sequence)].sequence != sequence) ++sequence;
+	return _slots[index(sequence)];
+}
+
+
+Timestamp::TimeVal RTPJitterBuffer::playoutTime(UInt32 timestamp, Timestamp::TimeVal arrival)
+{
+	// the base time tracks the smallest transit time seen, so
+	// the packet that arrived fastest is played out after
+	// exactly the latency and all others are measured against it
+	Int64 ticks = (Int32) (timestamp - _baseTimestamp);
+	Timestamp::TimeVal media = ticks * Timespan::SECONDS / _clockRate;
+	Timestamp::TimeVal transit = arrival - media;
+	if (transit < _baseTime) _baseTime = transit;
+
+	// if the sender clock runs slower than ours, transit times only
+	// grow and the latency would grow with them. When even the
+	// fastest packet of a window arrived later than the base time,
+	// the base time follows it, in small steps so that playout
+	// does not jump. If it arrived later than the latency, as after
+	// a pause or a timestamp jump back, every packet of the window
+	// has been late and the base time is set anew.
+	if (arrival - _windowStart >= SKEW_WINDOW)
+	{
+		if (_windowMin - _baseTime > _latency.totalMicroseconds())
+		{
+			_baseTime = _windowMin;
+		}
+		else if (_windowMin > _baseTime)
+		{
+			Timestamp::TimeVal step = std::min<Timestamp::TimeVal>(_windowMin - _baseTime, _latency.totalMicroseconds() / SKEW_STEPS);
+			_baseTime += step;
+		}
+		_windowStart = arrival;
+		_windowMin   = transit;
+	}
+	else if (transit < _windowMin)
+	{
+		_windowMin = transit;
+	}
+
+	Timestamp::TimeVal playout = _baseTime + media + _latency.totalMicroseconds();
+
+	// keep the timestamp difference far from overflowing
+	if (ticks > (Int64(1) << 30))
+	{
+		_baseTimestamp = timestamp;
+		_baseTime     += media;
+		_windowMin    += media;
+	}
+	return playout;
+}
+
+
+void RTPJitterBuffer::updateJitter(UInt32 timestamp, Timestamp::TimeVal arrival)
+{
+	// J(i) = J(i-1) + (|D(i-1,i)| - J(i-1))/16, kept scaled
+	// by 16 like the reference implementation does
+	Int64 arrivalTicks = (arrival - _startTime) * _clockRate / Timespan::SECONDS;
+	Int64 transit = (Int32) ((UInt32) arrivalTicks - timestamp);
+	if (_lastTransit != EMPTY)
+	{
+		Int64 d = transit - _lastTransit;
+		if (d < 0) d = -d;
+		_jitter += (UInt32) d - ((_jitter + 8) >> 4);
+	}
+	_lastTransit = transit;
+}
+
+
+void RTPJitterBuffer::setLatency(const Timespan& latency)
+{
+	_latency = latency;
+}
+
+
+} // namespace RTP
@@ -0,0 +1,447 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Multicast Receiver Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPMulticastReceiver.h"
+#include "Poco/Exception.h"
+#include <cstring>
+
+
+using Poco::UInt8;
+using Poco::UInt16;
+using Poco::UInt32;
+using Poco::Mutex;
+using Poco::FastMutex;
+using Poco::Net::IPAddress;
+using Poco::Net::SocketAddress;
+using Poco::Net::DatagramSocket;
+using Poco::Net::NetworkInterface;
+using SDP::SessionDescription;
+using SDP::MediaDescription;
+using SDP::ConnectionField;
+using SDP::AddressRange;
+using SDP::PortRange;
+
+
+namespace RTP {
+
+
+namespace
+{
+	IPAddress offsetAddress(const IPAddress& address, unsigned offset)
+		/// Returns the address offset addresses after the given one.
+	{
+		UInt8 bytes[16];
+		int length = (int) address.length();
+		std::memcpy(bytes, address.addr(), length);
+		for (int i = length - 1; i >= 0 && offset > 0; --i)
+		{
+			unsigned sum = bytes[i] + (offset & 0xff);
+			bytes[i] = (UInt8) sum;
+			offset = (offset >> 8) + (sum >> 8);
+		}
+		return IPAddress(bytes, length);
+	}
+
+	bool extractSSRC(const RTPUDPReceiver::Datagram& datagram, UInt32& ssrc)
+		/// Takes the SSRC of a RTP packet, or the sender SSRC of
+		/// the first packet of a RTCP compound packet, whose packet
+		/// types 192 to 223 cannot be RTP payload types (RFC 5761).
+	{
+		if (datagram.size < 8 || (datagram.data[0] & 0xc0) != 0x80) return false;
+
+		std::size_t offset = datagram.data[1] >= 192 && datagram.data[1] <= 223 ? 4 : 8;
+		if (datagram.size < offset + 4) return false;
+
+		const UInt8* p = datagram.data + offset;
+		ssrc = ((UInt32) p[0] << 24) | ((UInt32) p[1] << 16) | ((UInt32) p[2] << 8) | p[3];
+		return true;
+	}
+}
+
+
+RTPMulticastReceiver::Port::Port(const SocketAddress& group, const SocketAddress& bindAddress):
+	address(group),
+	socket(bindAddress, true),
+	filtered(0)
+{
+}
+
+
+RTPMulticastReceiver::RTPMulticastReceiver(RTPUDPReceiver& receiver):
+	_receiver(receiver),
+	_subscriptions(0),
+	_generation(0)
+{
+}
+
+
+RTPMulticastReceiver::RTPMulticastReceiver(RTPUDPReceiver& receiver, const NetworkInterface& interfc):
+	_receiver(receiver),
+	_interface(interfc),
+	_subscriptions(0),
+	_generation(0)
+{
+}
+
+
+RTPMulticastReceiver::~RTPMulticastReceiver()
+{
+	for (PortMap::iterator it = _ports.begin(); it != _ports.end(); ++it)
+	{
+		_receiver.remove(it->second->socket);
+		try
+		{
+			it->second->socket.leaveGroup(it->second->address.host(), _interface);
+		}
+		catch (Poco::Exception&)
+		{
+		}
+		delete it->second;
+	}
+}
+
+
+void RTPMulticastReceiver::subscribe(const SocketAddress& group, RTPUDPReceiver::Consumer& consumer)
+{
+	Subscription subscription = { 0, true, &consumer };
+	add(group, subscription);
+}
+
+
+void RTPMulticastReceiver::subscribe(const SocketAddress& group, UInt32 ssrc, RTPUDPReceiver::Consumer& consumer)
+{
+	Subscription subscription = { ssrc, false, &consumer };
+	add(group, subscription);
+}
+
+
+void RTPMulticastReceiver::subscribe(const SessionDescription& session, const MediaDescription& media, RTPUDPReceiver::Consumer& rtpConsumer, RTPUDPReceiver::Consumer& rtcpConsumer)
+{
+	EndpointVec layers = endpoints(session, media);
+	for (EndpointVec::const_iterator it = layers.begin(); it != layers.end(); ++it)
+	{
+		subscribe(it->rtp, rtpConsumer);
+		subscribe(it->rtcp, rtcpConsumer);
+	}
+}
+
+
+void RTPMulticastReceiver::add(const SocketAddress& group, const Subscription& subscription)
+{
+	if (!group.host().isMulticast()) throw Poco::InvalidArgumentException("not a multicast address", group.toString());
+
+	std::string key = group.toString();
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		PortMap::iterator it = _ports.find(key);
+		if (it != _ports.end())
+		{
+			it->second->subscriptions.push_back(subscription);
+			if (!subscription.anySSRC) ++it->second->filtered;
+			++_subscriptions;
+			return;
+		}
+	}
+
+	// bound to the group address, the socket only gets the datagrams
+	// of its own group, even if other sockets on the host join other
+	// groups on the same port. Windows cannot bind to a group address.
+#if defined(_WIN32)
+	SocketAddress bindAddress(IPAddress(group.host().family()), group.port());
+#else
+	SocketAddress bindAddress(group);
+#endif
+	Port* pPort = new Port(group, bindAddress);
+	try
+	{
+		pPort->socket.joinGroup(group.host(), _interface);
+	}
+	catch (...)
+	{
+		delete pPort;
+		throw;
+	}
+	pPort->subscriptions.push_back(subscription);
+	if (!subscription.anySSRC) ++pPort->filtered;
+
+	// not under _mutex, which the receiver thread takes while
+	// holding its own lock. Datagrams arriving before the port
+	// is in the maps are dropped by onDatagrams().
+	_receiver.add(pPort->socket, *this);
+
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		PortMap::iterator it = _ports.find(key);
+		if (it == _ports.end())
+		{
+			_ports[key] = pPort;
+			_sockets[pPort->socket.impl()->sockfd()] = pPort;
+			++_subscriptions;
+			return;
+		}
+
+		// another thread has joined the group meanwhile
+		it->second->subscriptions.push_back(subscription);
+		if (!subscription.anySSRC) ++it->second->filtered;
+		++_subscriptions;
+	}
+	release(pPort);
+}
+
+
+void RTPMulticastReceiver::unsubscribe(RTPUDPReceiver::Consumer& consumer)
+{
+	std::vector<Port*> unused;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		++_generation;
+		PortMap::iterator it = _ports.begin();
+		while (it != _ports.end())
+		{
+			Port* pPort = it->second;
+			SubscriptionVec::iterator sub = pPort->subscriptions.begin();
+			while (sub != pPort->subscriptions.end())
+			{
+				if (sub->pConsumer == &consumer)
+				{
+					if (!sub->anySSRC) --pPort->filtered;
+					sub = pPort->subscriptions.erase(sub);
+					--_subscriptions;
+				}
+				else ++sub;
+			}
+
+			if (pPort->subscriptions.empty())
+			{
+				unused.push_back(pPort);
+				_sockets.erase(pPort->socket.impl()->sockfd());
+				_ports.erase(it++);
+			}
+			else ++it;
+		}
+	}
+
+	// wait for consumers being called on the receiver thread; if
+	// this is the receiver thread, the lock is held already and
+	// onDatagrams() skips the consumer from now on
+	{
+		Mutex::ScopedLock delivery(_deliveryMutex);
+	}
+
+	for (std::vector<Port*>::iterator it = unused.begin(); it != unused.end(); ++it)
+	{
+		release(*it);
+	}
+}
+
+
+void RTPMulticastReceiver::release(Port* pPort)
+{
+	_receiver.remove(pPort->socket);
+	try
+	{
+		pPort->socket.leaveGroup(pPort->address.host(), _interface);
+	}
+	catch (Poco::Exception&)
+	{
+	}
+	delete pPort;
+}
+
+
+std::size_t RTPMulticastReceiver::sockets() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _ports.size();
+}
+
+
+std::size_t RTPMulticastReceiver::subscriptions() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _subscriptions;
+}
+
+
+void RTPMulticastReceiver::onDatagrams(const DatagramSocket& socket, const RTPUDPReceiver::Datagram* datagrams, std::size_t count)
+{
+	// the consumers are called without _mutex, so that they can
+	// unsubscribe; unsubscribe() on another thread waits for
+	// the delivery lock until they have returned
+	Mutex::ScopedLock delivery(_deliveryMutex);
+
+	int generation;
+	_targets.clear();
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		SocketMap::const_iterator it = _sockets.find(socket.impl()->sockfd());
+		if (it == _sockets.end()) return;  // being unsubscribed or subscribed
+
+		generation = _generation.value();
+		const Port& port = *it->second;
+		if (port.filtered == 0)
+		{
+			route(port, -1, 0, count);
+		}
+		else
+		{
+			// consecutive datagrams for the same consumer are delivered together
+			std::size_t first = 0;
+			int current = -1;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				int target = -1;
+				UInt32 ssrc;
+				if (extractSSRC(datagrams[i], ssrc))
+				{
+					for (std::size_t s = 0; s < port.subscriptions.size(); ++s)
+					{
+						if (!port.subscriptions[s].anySSRC && port.subscriptions[s].ssrc == ssrc)
+						{
+							target = (int) s;
+							break;
+						}
+					}
+				}
+				if (target != current)
+				{
+					if (i > first) route(port, current, first, i - first);
+					first = i;
+					current = target;
+				}
+			}
+			if (count > first) route(port, current, first, count - first);
+		}
+	}
+
+	for (TargetVec::const_iterator it = _targets.begin(); it != _targets.end(); ++it)
+	{
+		// a consumer called before may have unsubscribed itself or another one
+		if (_generation.value() != generation && !subscribed(socket, it->pConsumer)) continue;
+
+		it->pConsumer->onDatagrams(socket, datagrams + it->first, it->count);
+	}
+}
+
+
+void RTPMulticastReceiver::route(const Port& port, int route, std::size_t first, std::size_t count)
+{
+	// called with _mutex held
+	if (route >= 0)
+	{
+		Target target = { port.subscriptions[route].pConsumer, first, count };
+		_targets.push_back(target);
+		return;
+	}
+
+	for (SubscriptionVec::const_iterator it = port.subscriptions.begin(); it != port.subscriptions.end(); ++it)
+	{
+		if (it->anySSRC)
+		{
+			Target target = { it->pConsumer, first, count };
+			_targets.push_back(target);
+		}
+	}
+}
+
+
+bool RTPMulticastReceiver::subscribed(const DatagramSocket& socket, const RTPUDPReceiver::Consumer* pConsumer) const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	SocketMap::const_iterator it = _sockets.find(socket.impl()->sockfd());
+	if (it == _sockets.end()) return false;
+
+	const SubscriptionVec& subscriptions = it->second->subscriptions;
+	for (SubscriptionVec::const_iterator sub = subscriptions.begin(); sub != subscriptions.end(); ++sub)
+	{
+		if (sub->pConsumer == pConsumer) return true;
+	}
+	return false;
+}
+
+
+RTPMulticastReceiver::EndpointVec RTPMulticastReceiver::endpoints(const SessionDescription& session, const MediaDescription& media)
+{
+	ConnectionField connection = media.getConnectionInfo();
+	if (connection.getNetworkType().empty()) connection = session.getConnectionInfo();
+	if (connection.getNetworkType().empty()) throw Poco::DataFormatException("no connection information for media", media.getMediaField().getValue());
+
+	AddressRange range = connection.getAddress();
+	IPAddress first = range.getAddress();
+	if (!first.isMulticast()) throw Poco::DataFormatException("not a multicast address", connection.getValue());
+
+	unsigned addresses = range.getNumberOfAddresses();
+	if (first.family() == IPAddress::IPv6 && addresses == 1 && range.getTTL() > 1)
+	{
+		// IPv6 has no TTL: the parser takes the number of
+		// addresses of c=IN IP6 ff15::101/3 for one
+		addresses = range.getTTL();
+	}
+
+	PortRange portRange = media.getMediaField().getMediaPorts();
+	unsigned firstPort = portRange.getFirstPort();
+	unsigned ports = portRange.getNumberOfPorts() > 0 ? portRange.getNumberOfPorts() : 1;
+	if (firstPort == 0) throw Poco::DataFormatException("media stream is disabled", media.getMediaField().getValue());
+	if (addresses > 1 && ports > 1 && addresses != ports) throw Poco::DataFormatException("numbers of addresses and ports do not match", connection.getValue() + " " + portRange.toString());
+
+	// each layer has its own address and RTP/RTCP port pair,
+	// or shares the address or the ports with the others
+	unsigned layers = addresses > ports ? addresses : ports;
+	if (firstPort + (ports > 1 ? 2 * (ports - 1) : 0) + 1 > 65535) throw Poco::DataFormatException("port out of range", portRange.toString());
+
+	EndpointVec result;
+	for (unsigned i = 0; i < layers; ++i)
+	{
+		IPAddress group = addresses > 1 ? offsetAddress(first, i) : first;
+		UInt16 port = (UInt16) (firstPort + (ports > 1 ? 2 * i : 0));
+		Endpoint endpoint = { SocketAddress(group, port), SocketAddress(group, (UInt16) (port + 1)) };
+		result.push_back(endpoint);
+	}
+	return result;
+}
+
+
+} // namespace RTP
@@ -0,0 +1,148 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Packet Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPPacket.h"
+
+
+using Poco::UInt8;
+
+
+namespace RTP {
+
+
+RTPPacket::RTPPacket():
+	_pData(0),
+	_size(0),
+	_payloadOffset(0),
+	_payloadSize(0),
+	_valid(false)
+{
+}
+
+
+RTPPacket::RTPPacket(const void* buffer, std::size_t length)
+{
+	parse(buffer, length);
+}
+
+
+RTPPacket::~RTPPacket()
+{
+}
+
+
+bool RTPPacket::parse(const void* buffer, std::size_t length)
+{
+	const UInt8* p = static_cast<const UInt8*>(buffer);
+	_pData = p;
+	_size  = length;
+
+	// a zero first byte fails the version check, so
+	// short buffers need no branch of their own
+	unsigned first = length >= FIXED_HEADER_SIZE ? p[0] : 0;
+	std::size_t offset = FIXED_HEADER_SIZE + 4 * (first & 0x0f);
+	std::size_t padding = 0;
+	bool ok = ((first >> 6) == VERSION) & (offset <= length);
+
+	if (first & 0x30)
+	{
+		if ((first & 0x10) && ok)
+		{
+			ok = offset + 4 <= length;
+			if (ok)
+			{
+				offset += 4 + 4 * ((p[offset + 2] << 8) | p[offset + 3]);
+				ok = offset <= length;
+			}
+		}
+		if ((first & 0x20) && ok)
+		{
+			padding = p[length - 1];
+			ok = (padding != 0) & (offset + padding <= length);
+		}
+	}
+
+	_valid         = ok;
+	_payloadOffset = ok ? offset : 0;
+	_payloadSize   = ok ? length - offset - padding : 0;
+	return ok;
+}
+
+
+std::size_t RTPPacket::parseBatch(const void* const* buffers, const std::size_t* lengths, std::size_t count, RTPPacket* packets)
+{
+	std::size_t valid = 0;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		valid += packets[i].parse(buffers[i], lengths[i]);
+	}
+	return valid;
+}
+
+
+RTPPacket::Status RTPPacket::validate(const void* buffer, std::size_t length)
+{
+	const UInt8* p = static_cast<const UInt8*>(buffer);
+	if (length < FIXED_HEADER_SIZE)
+		return RTP_TRUNCATED_HEADER;
+	if ((p[0] >> 6) != VERSION)
+		return RTP_BAD_VERSION;
+
+	std::size_t offset = FIXED_HEADER_SIZE + 4 * (p[0] & 0x0f);
+	if (offset > length)
+		return RTP_TRUNCATED_CSRC;
+	if (p[0] & 0x10)
+	{
+		if (offset + 4 > length)
+			return RTP_TRUNCATED_EXTENSION;
+		offset += 4 + 4 * ((p[offset + 2] << 8) | p[offset + 3]);
+		if (offset > length)
+			return RTP_TRUNCATED_EXTENSION;
+	}
+	if (p[0] & 0x20)
+	{
+		std::size_t padding = p[length - 1];
+		if (padding == 0 || offset + padding > length)
+			return RTP_BAD_PADDING;
+	}
+	return RTP_VALID;
+}
+
+
+} // namespace RTP
@@ -0,0 +1,450 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Packet Pool Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPPacketPool.h"
+#include "Poco/Exception.h"
+#include "Poco/NumberFormatter.h"
+#if !defined(RTP_HAVE_THREAD_LOCAL)
+#include "Poco/Thread.h"
+#endif
+#include <new>
+#include <set>
+
+
+using Poco::UInt8;
+using Poco::UInt64;
+using Poco::FastMutex;
+using Poco::NumberFormatter;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const std::size_t CACHE_LINE = 64;
+
+	const int CACHED_POOLS = 4;
+		// pools a thread keeps a cache for
+
+	const std::size_t BATCH[RTPPacketPool::SIZE_CLASS_COUNT] =
+		// buffers moved between a thread cache and the central
+		// list at a time; a cache holds up to twice as many
+	{
+		32,
+		4
+	};
+
+	struct Registry
+		/// The serial numbers of the live pools, so that a thread
+		/// cache does not return buffers to a destroyed pool.
+	{
+		FastMutex        mutex;
+		std::set<UInt64> live;
+		UInt64           next;
+
+		Registry():
+			next(0)
+		{
+		}
+	};
+
+	Registry& registry()
+	{
+		static Registry r;
+		return r;
+	}
+}
+
+
+//
+// RTPPacketBuffer
+//
+
+
+RTPPacketBuffer::RTPPacketBuffer(RTPPacketPool& pool, int sizeClass, UInt8* data, std::size_t capacity):
+	_counter(0),
+	_pPool(&pool),
+	_pData(data),
+	_capacity(capacity),
+	_size(0),
+	_sizeClass(sizeClass),
+	_pNext(0)
+{
+}
+
+
+RTPPacketBuffer::~RTPPacketBuffer()
+{
+}
+
+
+//
+// RTPPacketPool
+//
+
+
+struct RTPPacketPool::ThreadCache
+	/// The free buffers a thread keeps of one pool.
+{
+	RTPPacketPool* pPool;
+	UInt64         serial;
+	UInt64         lastUse;
+	FreeList       lists[SIZE_CLASS_COUNT];
+
+	ThreadCache():
+		pPool(0),
+		serial(0),
+		lastUse(0)
+	{
+		clear();
+	}
+
+	~ThreadCache()
+	{
+		flush();
+	}
+
+	void clear()
+	{
+		for (int c = 0; c < SIZE_CLASS_COUNT; ++c)
+		{
+			lists[c].pFirst = 0;
+			lists[c].count  = 0;
+		}
+	}
+
+	void flush()
+		/// Returns the cached buffers to their pool, if it still
+		/// exists, on thread exit or when the cache is taken over
+		/// for another pool.
+	{
+		if (!pPool) return;
+
+		Registry& r = registry();
+		FastMutex::ScopedLock lock(r.mutex);
+
+		if (r.live.count(serial))
+		{
+			FastMutex::ScopedLock poolLock(pPool->_mutex);
+
+			for (int c = 0; c < SIZE_CLASS_COUNT; ++c)
+			{
+				RTPPacketBuffer* pLast = lists[c].pFirst;
+				if (!pLast) continue;
+				while (pLast->_pNext) pLast = pLast->_pNext;
+				pLast->_pNext = pPool->_free[c].pFirst;
+				pPool->_free[c].pFirst = lists[c].pFirst;
+				pPool->_free[c].count += lists[c].count;
+			}
+		}
+		clear();
+		pPool = 0;
+	}
+};
+
+
+struct RTPPacketPool::ThreadCaches
+	/// The caches of a thread for the pools it used last.
+{
+	ThreadCache caches[CACHED_POOLS];
+	UInt64      uses;
+
+	ThreadCaches():
+		uses(0)
+	{
+	}
+
+	ThreadCache& find(RTPPacketPool* pPool, UInt64 serial)
+		/// Returns the cache of the given pool, taking over the
+		/// least recently used one if there is none.
+	{
+		ThreadCache* pCache = &caches[0];
+		for (int i = 0; i < CACHED_POOLS; ++i)
+		{
+			if (caches[i].pPool == pPool && caches[i].serial == serial)
+			{
+				pCache = &caches[i];
+				break;
+			}
+			if (caches[i].lastUse < pCache->lastUse) pCache = &caches[i];
+		}
+		if (pCache->pPool != pPool || pCache->serial != serial)
+		{
+			pCache->flush();
+			pCache->pPool  = pPool;
+			pCache->serial = serial;
+		}
+		pCache->lastUse = ++uses;
+		return *pCache;
+	}
+};
+
+
+RTPPacketPool::RTPPacketPool():
+	_serial(0)
+{
+	for (int c = 0; c < SIZE_CLASS_COUNT; ++c)
+	{
+		_free[c].pFirst = 0;
+		_free[c].count  = 0;
+	}
+
+	Registry& r = registry();
+	FastMutex::ScopedLock lock(r.mutex);
+
+	_serial = ++r.next;
+	r.live.insert(_serial);
+}
+
+
+RTPPacketPool::~RTPPacketPool()
+{
+	{
+		Registry& r = registry();
+		FastMutex::ScopedLock lock(r.mutex);
+
+		r.live.erase(_serial);
+	}
+
+	poco_assert_dbg (_inUse[SIZE_MTU].value() == 0 && _inUse[SIZE_JUMBO].value() == 0);
+
+	// buffers still in thread caches are dropped with their slab
+	for (std::vector<Slab>::iterator it = _slabs.begin(); it != _slabs.end(); ++it)
+	{
+		for (std::size_t i = 0; i < it->count; ++i)
+		{
+			it->pBuffers[i].~RTPPacketBuffer();
+		}
+		::operator delete(it->pBuffers);
+		delete [] it->pMemory;
+	}
+}
+
+
+RTPPacketBuffer::Ptr RTPPacketPool::allocate(std::size_t size)
+{
+	int c = sizeClass(size);
+	RTPPacketBuffer* pBuffer = take(threadCache(), c);
+	pBuffer->_counter = 1;
+	pBuffer->_size    = size;
+	pBuffer->_pNext   = 0;
+
+	++_inUse[c];
+	updatePeak();
+
+	// the reference count of one is handed to the AutoPtr
+	return RTPPacketBuffer::Ptr(pBuffer);
+}
+
+
+RTPPacketPool::Statistics RTPPacketPool::statistics() const
+{
+	Statistics statistics;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		statistics.slabs     = _slabs.size();
+		statistics.slabBytes = _slabs.size() * (UInt64) SLAB_SIZE;
+	}
+	statistics.buffersInUse   = _inUse[SIZE_MTU].value() + _inUse[SIZE_JUMBO].value();
+	statistics.bytesInUse     = bytesInUse();
+	statistics.peakBytesInUse = (UInt64) _peakUnitsInUse.value() * MTU_SIZE;
+	return statistics;
+}
+
+
+RTPPacketPool::SizeClass RTPPacketPool::sizeClass(std::size_t size)
+{
+	if (size <= MTU_SIZE) return SIZE_MTU;
+	if (size <= JUMBO_SIZE) return SIZE_JUMBO;
+	throw Poco::InvalidArgumentException("packet buffer too large", NumberFormatter::format(size));
+}
+
+
+void RTPPacketPool::recycle(RTPPacketBuffer* pBuffer)
+{
+	int c = pBuffer->_sizeClass;
+	--_inUse[c];
+
+	ThreadCache* pCache = threadCache();
+	if (!pCache)
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		pBuffer->_pNext = _free[c].pFirst;
+		_free[c].pFirst = pBuffer;
+		++_free[c].count;
+		return;
+	}
+
+	ThreadCache& cache = *pCache;
+	pBuffer->_pNext = cache.lists[c].pFirst;
+	cache.lists[c].pFirst = pBuffer;
+	if (++cache.lists[c].count > 2 * BATCH[c])
+	{
+		give(cache, c);
+	}
+}
+
+
+RTPPacketBuffer* RTPPacketPool::take(ThreadCache* pCache, int sizeClass)
+{
+	if (!pCache)
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		if (_free[sizeClass].count == 0) addSlab(sizeClass);
+		FreeList& central = _free[sizeClass];
+		RTPPacketBuffer* pBuffer = central.pFirst;
+		central.pFirst = pBuffer->_pNext;
+		--central.count;
+		return pBuffer;
+	}
+
+	FreeList& list = pCache->lists[sizeClass];
+	if (list.count == 0)
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		if (_free[sizeClass].count == 0) addSlab(sizeClass);
+		FreeList& central = _free[sizeClass];
+		while (list.count < BATCH[sizeClass] && central.count > 0)
+		{
+			RTPPacketBuffer* pBuffer = central.pFirst;
+			central.pFirst = pBuffer->_pNext;
+			--central.count;
+			pBuffer->_pNext = list.pFirst;
+			list.pFirst = pBuffer;
+			++list.count;
+		}
+	}
+
+	RTPPacketBuffer* pBuffer = list.pFirst;
+	list.pFirst = pBuffer->_pNext;
+	--list.count;
+	return pBuffer;
+}
+
+
+void RTPPacketPool::give(ThreadCache& cache, int sizeClass)
+{
+	// detach a batch from the cache before taking the lock
+	FreeList& list = cache.lists[sizeClass];
+	RTPPacketBuffer* pFirst = list.pFirst;
+	RTPPacketBuffer* pLast = pFirst;
+	for (std::size_t i = 1; i < BATCH[sizeClass]; ++i)
+	{
+		pLast = pLast->_pNext;
+	}
+	list.pFirst = pLast->_pNext;
+	list.count -= BATCH[sizeClass];
+
+	FastMutex::ScopedLock lock(_mutex);
+
+	FreeList& central = _free[sizeClass];
+	pLast->_pNext = central.pFirst;
+	central.pFirst = pFirst;
+	central.count += BATCH[sizeClass];
+}
+
+
+void RTPPacketPool::addSlab(int sizeClass)
+{
+	std::size_t capacity = classCapacity((SizeClass) sizeClass);
+	Slab slab;
+	slab.count    = SLAB_SIZE / capacity;
+	slab.pMemory  = new UInt8[SLAB_SIZE + CACHE_LINE];
+	slab.pBuffers = static_cast<RTPPacketBuffer*>(::operator new(slab.count * sizeof(RTPPacketBuffer), std::nothrow));
+	if (!slab.pBuffers)
+	{
+		delete [] slab.pMemory;
+		throw Poco::OutOfMemoryException("cannot allocate packet buffer slab");
+	}
+
+	// the buffers start on cache line boundaries
+	UInt8* pData = slab.pMemory + (CACHE_LINE - (std::size_t) slab.pMemory % CACHE_LINE) % CACHE_LINE;
+	FreeList& central = _free[sizeClass];
+	for (std::size_t i = slab.count; i-- > 0;)
+	{
+		RTPPacketBuffer* pBuffer = new (&slab.pBuffers[i]) RTPPacketBuffer(*this, sizeClass, pData + i * capacity, capacity);
+		pBuffer->_pNext = central.pFirst;
+		central.pFirst = pBuffer;
+		++central.count;
+	}
+	_slabs.push_back(slab);
+}
+
+
+void RTPPacketPool::updatePeak()
+{
+	// the peak only grows under _peakMutex, so a thread that finds
+	// it lower there can raise it
+	int units = _inUse[SIZE_MTU].value() + _inUse[SIZE_JUMBO].value() * (JUMBO_SIZE / MTU_SIZE);
+	if (units > _peakUnitsInUse.value())
+	{
+		FastMutex::ScopedLock lock(_peakMutex);
+
+		if (units > _peakUnitsInUse.value()) _peakUnitsInUse = units;
+	}
+}
+
+
+#if !defined(RTP_HAVE_THREAD_LOCAL)
+Poco::ThreadLocal<RTPPacketPool::ThreadCaches> RTPPacketPool::_threadCaches;
+#endif
+
+
+RTPPacketPool::ThreadCache* RTPPacketPool::threadCache()
+{
+#if defined(RTP_HAVE_THREAD_LOCAL)
+	static thread_local ThreadCaches caches;
+#else
+	// Poco::ThreadLocal gives a slot of its own to Poco::Threads
+	// only; other threads would share one, so they use the central
+	// list
+	if (!Poco::Thread::current()) return 0;
+	ThreadCaches& caches = _threadCaches.get();
+#endif
+
+	return &caches.find(this, _serial);
+}
+
+
+} // namespace RTP
@@ -0,0 +1,225 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Payload Format Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPPayloadFormat.h"
+#include "RtpAvpConstants.h"
+#include "Poco/Exception.h"
+#include "Poco/NumberParser.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/String.h"
+#include "Poco/Base64Decoder.h"
+#include <sstream>
+#include <iterator>
+#include <cctype>
+
+
+using SDP::MediaDescription;
+using SDP::AttributeVec;
+using SDP::RtpAvpConstants;
+using Poco::NumberParser;
+using Poco::NumberFormatter;
+
+
+namespace RTP {
+
+
+RTPPayloadFormat::RTPPayloadFormat():
+	_payloadType(-1),
+	_clockRate(0),
+	_channels(1)
+{
+}
+
+
+RTPPayloadFormat::RTPPayloadFormat(int payloadType, const std::string& encodingName, int clockRate, int channels, const std::string& parameters):
+	_payloadType(payloadType),
+	_encodingName(encodingName),
+	_clockRate(clockRate),
+	_channels(channels),
+	_parameters(parameters)
+{
+}
+
+
+RTPPayloadFormat::RTPPayloadFormat(const MediaDescription& media):
+	_payloadType(-1),
+	_clockRate(0),
+	_channels(1)
+{
+	SDP::StringVec formats = media.getMediaField().getMediaFormats();
+	int payloadType;
+	if (formats.empty() || !NumberParser::tryParse(formats[0], payloadType))
+		throw Poco::DataFormatException("media description has no RTP payload type", media.getMediaField().getValue());
+
+	load(media, payloadType);
+}
+
+
+RTPPayloadFormat::RTPPayloadFormat(const MediaDescription& media, int payloadType):
+	_payloadType(-1),
+	_clockRate(0),
+	_channels(1)
+{
+	SDP::StringVec formats = media.getMediaField().getMediaFormats();
+	SDP::StringVec::const_iterator it = formats.begin();
+	int format;
+	while (it != formats.end() && !(NumberParser::tryParse(*it, format) && format == payloadType)) ++it;
+	if (it == formats.end())
+		throw Poco::NotFoundException("payload type not in media description", NumberFormatter::format(payloadType));
+
+	load(media, payloadType);
+}
+
+
+RTPPayloadFormat::~RTPPayloadFormat()
+{
+}
+
+
+void RTPPayloadFormat::load(const MediaDescription& media, int payloadType)
+{
+	_payloadType = payloadType;
+	if (payloadType >= 0 && payloadType < RtpAvpConstants::AVP_DEFINED_STATIC_MAX)
+	{
+		_encodingName = RtpAvpConstants::avpTypeNames[payloadType];
+		_clockRate    = staticClockRate(payloadType);
+		_channels     = payloadType == RtpAvpConstants::L16_2CH ? 2 : 1;
+	}
+
+	// a=rtpmap:<payload type> <encoding name>/<clock rate>[/<channels>]
+	// a=fmtp:<payload type> <format parameters>
+	AttributeVec attributes = media.getAttributes();
+	for (AttributeVec::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+	{
+		const std::string name = it->getName();
+		if (name != RtpAvpConstants::RTPMAP && name != RtpAvpConstants::FMTP) continue;
+
+		const std::string value = it->getAttributeValue();
+		std::string::size_type space = value.find(' ');
+		int format;
+		if (space == std::string::npos || !NumberParser::tryParse(value.substr(0, space), format) || format != payloadType) continue;
+
+		std::string rest = Poco::trim(value.substr(space + 1));
+		if (name == RtpAvpConstants::FMTP)
+		{
+			_parameters = rest;
+			continue;
+		}
+
+		std::string::size_type slash = rest.find('/');
+		_encodingName = rest.substr(0, slash);
+		if (slash == std::string::npos) continue;
+
+		std::string::size_type slash2 = rest.find('/', slash + 1);
+		int clockRate;
+		if (NumberParser::tryParse(rest.substr(slash + 1, slash2 == std::string::npos ? std::string::npos : slash2 - slash - 1), clockRate) && clockRate > 0)
+			_clockRate = clockRate;
+		int channels;
+		if (slash2 != std::string::npos && NumberParser::tryParse(rest.substr(slash2 + 1), channels) && channels > 0)
+			_channels = channels;
+	}
+
+	if (_clockRate <= 0)
+		throw Poco::DataFormatException("unknown clock rate for payload type", NumberFormatter::format(payloadType));
+}
+
+
+bool RTPPayloadFormat::findParameter(const std::string& name, std::string::size_type& valuePos, std::string::size_type& valueEnd) const
+{
+	// parameters are separated by semicolons; values may contain
+	// '=' (base64 padding), so only the first one splits a pair
+	std::string::size_type pos = 0;
+	while (pos < _parameters.size())
+	{
+		std::string::size_type end = _parameters.find(';', pos);
+		if (end == std::string::npos) end = _parameters.size();
+
+		std::string::size_type begin = pos;
+		while (begin < end && std::isspace((unsigned char) _parameters[begin])) ++begin;
+		std::string::size_type eq = _parameters.find('=', begin);
+		std::string::size_type keyEnd = eq < end ? eq : end;
+		while (keyEnd > begin && std::isspace((unsigned char) _parameters[keyEnd - 1])) --keyEnd;
+
+		if (keyEnd - begin == name.size() && Poco::icompare(_parameters, begin, name.size(), name) == 0)
+		{
+			valuePos = eq < end ? eq + 1 : end;
+			valueEnd = end;
+			return true;
+		}
+		pos = end + 1;
+	}
+	return false;
+}
+
+
+bool RTPPayloadFormat::hasParameter(const std::string& name) const
+{
+	std::string::size_type valuePos;
+	std::string::size_type valueEnd;
+	return findParameter(name, valuePos, valueEnd);
+}
+
+
+std::string RTPPayloadFormat::parameter(const std::string& name, const std::string& deflt) const
+{
+	std::string::size_type valuePos;
+	std::string::size_type valueEnd;
+	if (!findParameter(name, valuePos, valueEnd)) return deflt;
+
+	return Poco::trim(_parameters.substr(valuePos, valueEnd - valuePos));
+}
+
+
+int RTPPayloadFormat::staticClockRate(int payloadType)
+{
+	if (payloadType < 0 || payloadType >= RtpAvpConstants::AVP_DEFINED_STATIC_MAX) return -1;
+
+	return RtpAvpConstants::avpClockRates[payloadType];
+}
+
+
+std::string RTPPayloadFormat::decodeBase64(const std::string& encoded)
+{
+	std::istringstream istr(encoded);
+	Poco::Base64Decoder decoder(istr);
+	return std::string(std::istreambuf_iterator<char>(decoder), std::istreambuf_iterator<char>());
+}
+
+
+} // namespace RTP
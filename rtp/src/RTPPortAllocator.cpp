@@ -0,0 +1,281 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Port Allocator Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPPortAllocator.h"
+#include "Poco/Exception.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Net/SocketAddress.h"
+
+
+using Poco::UInt16;
+using Poco::UInt64;
+using Poco::FastMutex;
+using Poco::NumberFormatter;
+using Poco::Net::DatagramSocket;
+using Poco::Net::IPAddress;
+using Poco::Net::SocketAddress;
+using SDP::PortRange;
+
+
+namespace RTP {
+
+
+namespace
+{
+	int lowestBit(UInt64 value)
+	{
+	#if defined(__GNUC__)
+		return __builtin_ctzll(value);
+	#else
+		int bit = 0;
+		while (!(value & 1))
+		{
+			value >>= 1;
+			++bit;
+		}
+		return bit;
+	#endif
+	}
+}
+
+
+RTPPortAllocator::RTPPortAllocator(const PortRange& range, std::size_t reserve, const IPAddress& address):
+	_address(address),
+	_firstPort(0),
+	_capacity(0),
+	_reserve(reserve),
+	_free(0),
+	_cursor(0)
+{
+	unsigned first = range.getFirstPort();
+	unsigned end = first + range.getNumberOfPorts();
+	if (first % 2) ++first;
+	if (first == 0 || end > 65536 || first + 2 > end) throw Poco::InvalidArgumentException("port range holds no RTP/RTCP pair", range.toString());
+
+	_firstPort = (UInt16) first;
+	_capacity = (end - first) / 2;
+	if (_reserve > _capacity) _reserve = _capacity;
+
+	std::size_t words = (_capacity + WORD_BITS - 1) / WORD_BITS;
+	_bitmap.resize(words, 0);
+	_summary.resize((words + WORD_BITS - 1) / WORD_BITS, 0);
+	for (std::size_t i = 0; i < _capacity; ++i)
+	{
+		give(i);
+	}
+
+	refill();
+}
+
+
+RTPPortAllocator::~RTPPortAllocator()
+{
+	for (PairQueue::iterator it = _pool.begin(); it != _pool.end(); ++it)
+	{
+		it->rtp.close();
+		it->rtcp.close();
+	}
+}
+
+
+RTPPortAllocator::Pair RTPPortAllocator::acquire()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	Pair pair;
+	if (!_pool.empty())
+	{
+		pair = _pool.front();
+		_pool.pop_front();
+	}
+	else if (!allocate(pair))
+	{
+		throw Poco::NotFoundException("no free RTP/RTCP port pair");
+	}
+	return pair;
+}
+
+
+void RTPPortAllocator::release(const Pair& pair)
+{
+	if (pair.rtpPort < _firstPort || (pair.rtpPort - _firstPort) % 2 || (std::size_t) (pair.rtpPort - _firstPort) / 2 >= _capacity)
+	{
+		throw Poco::InvalidArgumentException("port pair not from this allocator", NumberFormatter::format(pair.rtpPort));
+	}
+	std::size_t index = (pair.rtpPort - _firstPort) / 2;
+
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		bool pooled = false;
+		for (PairQueue::const_iterator it = _pool.begin(); it != _pool.end() && !pooled; ++it)
+		{
+			pooled = it->rtpPort == pair.rtpPort;
+		}
+		if (pooled || isFree(index)) throw Poco::InvalidArgumentException("port pair released twice", NumberFormatter::format(pair.rtpPort));
+
+		// the pair lies behind the cursor, so the search reaches
+		// it again only after going round the range
+		give(index);
+	}
+
+	DatagramSocket rtp(pair.rtp);
+	DatagramSocket rtcp(pair.rtcp);
+	rtp.close();
+	rtcp.close();
+
+	refill();
+}
+
+
+void RTPPortAllocator::refill()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	while (_pool.size() < _reserve)
+	{
+		Pair pair;
+		if (!allocate(pair)) break;
+		_pool.push_back(pair);
+	}
+}
+
+
+std::size_t RTPPortAllocator::available() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _free + _pool.size();
+}
+
+
+std::size_t RTPPortAllocator::reserved() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _pool.size();
+}
+
+
+bool RTPPortAllocator::allocate(Pair& pair)
+{
+	// each free pair is tried at most once: one that cannot be
+	// bound is freed again behind the cursor
+	for (std::size_t attempts = _free; attempts > 0; --attempts)
+	{
+		std::size_t index = findFree(_cursor);
+		take(index);
+		_cursor = index + 1 < _capacity ? index + 1 : 0;
+		if (bind(index, pair)) return true;
+		give(index);
+	}
+	return false;
+}
+
+
+bool RTPPortAllocator::bind(std::size_t index, Pair& pair) const
+{
+	UInt16 port = (UInt16) (_firstPort + 2 * index);
+	try
+	{
+		DatagramSocket rtp(SocketAddress(_address, port));
+		DatagramSocket rtcp(SocketAddress(_address, (UInt16) (port + 1)));
+		pair.rtpPort = port;
+		pair.rtp     = rtp;
+		pair.rtcp    = rtcp;
+		return true;
+	}
+	catch (Poco::IOException&)
+	{
+		return false;
+	}
+}
+
+
+std::size_t RTPPortAllocator::findFree(std::size_t from) const
+{
+	std::size_t word = from / WORD_BITS;
+	UInt64 bits = _bitmap[word] & (~(UInt64) 0 << (from % WORD_BITS));
+	if (bits) return word * WORD_BITS + lowestBit(bits);
+
+	// the next word with a free pair, from the summary, wrapping
+	// around to the words before the cursor
+	std::size_t next = word + 1 < _bitmap.size() ? word + 1 : 0;
+	std::size_t group = next / WORD_BITS;
+	UInt64 summary = _summary[group] & (~(UInt64) 0 << (next % WORD_BITS));
+	for (std::size_t i = 0; i <= _summary.size(); ++i)
+	{
+		if (summary)
+		{
+			word = group * WORD_BITS + lowestBit(summary);
+			return word * WORD_BITS + lowestBit(_bitmap[word]);
+		}
+		group = group + 1 < _summary.size() ? group + 1 : 0;
+		summary = _summary[group];
+	}
+	poco_bugcheck();
+	return _capacity;
+}
+
+
+void RTPPortAllocator::take(std::size_t index)
+{
+	std::size_t word = index / WORD_BITS;
+	_bitmap[word] &= ~((UInt64) 1 << (index % WORD_BITS));
+	if (_bitmap[word] == 0) _summary[word / WORD_BITS] &= ~((UInt64) 1 << (word % WORD_BITS));
+	--_free;
+}
+
+
+void RTPPortAllocator::give(std::size_t index)
+{
+	std::size_t word = index / WORD_BITS;
+	_bitmap[word] |= (UInt64) 1 << (index % WORD_BITS);
+	_summary[word / WORD_BITS] |= (UInt64) 1 << (word % WORD_BITS);
+	++_free;
+}
+
+
+bool RTPPortAllocator::isFree(std::size_t index) const
+{
+	return (_bitmap[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+
+} // namespace RTP
@@ -0,0 +1,257 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP Source Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPSource.h"
+#include "NTPTime.h"
+#include "Poco/Timespan.h"
+
+
+using Poco::UInt16;
+using Poco::UInt32;
+using Poco::Int32;
+using Poco::Int64;
+using Poco::Timestamp;
+using Poco::Timespan;
+using SDP::NTPTime;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const UInt32 RTP_SEQ_MOD = 1 << 16;
+}
+
+
+RTPSource::RTPSource(UInt32 ssrc, int clockRate):
+	_ssrc(ssrc),
+	_clockRate(clockRate),
+	_maxSeq(0),
+	_cycles(0),
+	_baseSeq(0),
+	_badSeq(RTP_SEQ_MOD + 1),
+	_probation(MIN_SEQUENTIAL),
+	_received(0),
+	_expectedPrior(0),
+	_receivedPrior(0),
+	_transit(0),
+	_jitter(0),
+	_hasTransit(false),
+	_hasSenderReport(false),
+	_srNTPTimestamp(0),
+	_srRTPTimestamp(0),
+	_srArrival(0),
+	_firstArrival(0),
+	_lastRTP(0),
+	_lastActivity(0)
+{
+	poco_assert (clockRate > 0);
+}
+
+
+RTPSource::~RTPSource()
+{
+}
+
+
+void RTPSource::initSequence(UInt16 seq)
+{
+	_baseSeq       = seq;
+	_maxSeq        = seq;
+	_badSeq        = RTP_SEQ_MOD + 1;
+	_cycles        = 0;
+	_received      = 0;
+	_receivedPrior = 0;
+	_expectedPrior = 0;
+}
+
+
+bool RTPSource::updateSequence(UInt16 seq)
+{
+	UInt16 udelta = (UInt16) (seq - _maxSeq);
+
+	// a source is valid once MIN_SEQUENTIAL packets
+	// with consecutive sequence numbers have arrived
+	if (_probation)
+	{
+		if (seq == (UInt16) (_maxSeq + 1))
+		{
+			_probation--;
+			_maxSeq = seq;
+			if (_probation == 0)
+			{
+				initSequence(seq);
+				_received++;
+				return true;
+			}
+		}
+		else
+		{
+			_probation = MIN_SEQUENTIAL - 1;
+			_maxSeq = seq;
+		}
+		return false;
+	}
+	else if (udelta < MAX_DROPOUT)
+	{
+		// in order, with permissible gap
+		if (seq < _maxSeq) _cycles += RTP_SEQ_MOD;
+		_maxSeq = seq;
+	}
+	else if (udelta <= RTP_SEQ_MOD - MAX_MISORDER)
+	{
+		// the sequence number made a very large jump
+		if (seq == _badSeq)
+		{
+			// two sequential packets: assume the other
+			// side restarted without telling us
+			initSequence(seq);
+		}
+		else
+		{
+			_badSeq = (seq + 1) & (RTP_SEQ_MOD - 1);
+			return false;
+		}
+	}
+	// otherwise a duplicate or reordered packet
+	_received++;
+	return true;
+}
+
+
+bool RTPSource::update(const RTPPacket& packet, const Timestamp& arrival)
+{
+	if (_lastRTP == Timestamp(0))
+	{
+		// probation starts from the first packet
+		_maxSeq       = (UInt16) (packet.sequenceNumber() - 1);
+		_firstArrival = arrival;
+	}
+	_lastRTP      = arrival;
+	_lastActivity = arrival;
+
+	if (!updateSequence(packet.sequenceNumber())) return false;
+
+	// interarrival jitter, kept scaled by 16 (RFC 3550, A.8)
+	Int64 arrivalTicks = (arrival - _firstArrival) * _clockRate / Timespan::SECONDS;
+	Int64 transit = (Int32) ((UInt32) arrivalTicks - packet.timestamp());
+	if (_hasTransit)
+	{
+		Int64 d = transit - _transit;
+		if (d < 0) d = -d;
+		_jitter += (UInt32) d - ((_jitter + 8) >> 4);
+	}
+	_transit    = transit;
+	_hasTransit = true;
+	return true;
+}
+
+
+void RTPSource::updateSenderReport(const RTCPPacket::SenderInfo& info, const Timestamp& arrival)
+{
+	_hasSenderReport = true;
+	_srNTPTimestamp  = info.ntpTimestamp;
+	_srRTPTimestamp  = info.rtpTimestamp;
+	_srArrival       = arrival;
+	_lastActivity    = arrival;
+}
+
+
+void RTPSource::updateActivity(const Timestamp& time)
+{
+	_lastActivity = time;
+}
+
+
+RTCPPacket::ReportBlock RTPSource::reportBlock(const Timestamp& now)
+{
+	RTCPPacket::ReportBlock block;
+	block.ssrc = _ssrc;
+
+	// packet loss (RFC 3550, A.3); the cumulative number
+	// is clamped to the 24-bit signed field
+	UInt32 extendedMax = extendedHighestSequence();
+	UInt32 expected = extendedMax - _baseSeq + 1;
+	Int64 lost = (Int64) expected - _received;
+	if (lost > 0x7FFFFF) lost = 0x7FFFFF;
+	else if (lost < -0x800000) lost = -0x800000;
+
+	UInt32 expectedInterval = expected - _expectedPrior;
+	UInt32 receivedInterval = _received - _receivedPrior;
+	Int64 lostInterval = (Int64) expectedInterval - receivedInterval;
+	_expectedPrior = expected;
+	_receivedPrior = _received;
+
+	block.fractionLost            = (expectedInterval == 0 || lostInterval <= 0) ? 0 : (Poco::UInt8) ((lostInterval << 8) / expectedInterval);
+	block.cumulativeLost          = (Int32) lost;
+	block.extendedHighestSequence = extendedMax;
+	block.jitter                  = jitter();
+	if (_hasSenderReport)
+	{
+		// the delay is expressed in units of 1/65536 seconds
+		block.lastSR           = NTPTime::getCompactNTPTimestamp(_srNTPTimestamp);
+		block.delaySinceLastSR = (UInt32) ((now - _srArrival) * 65536 / Timespan::SECONDS);
+	}
+	else
+	{
+		block.lastSR           = 0;
+		block.delaySinceLastSR = 0;
+	}
+	return block;
+}
+
+
+bool RTPSource::wallClock(UInt32 rtpTimestamp, Timestamp& time) const
+{
+	if (!_hasSenderReport) return false;
+
+	Int64 ticks = (Int32) (rtpTimestamp - _srRTPTimestamp);
+	time = NTPTime::getTimestamp(_srNTPTimestamp) + ticks * Timespan::SECONDS / _clockRate;
+	return true;
+}
+
+
+void RTPSource::setCName(const std::string& cname)
+{
+	_cname = cname;
+}
+
+
+} // namespace RTP
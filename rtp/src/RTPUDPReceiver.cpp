@@ -0,0 +1,492 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP UDP Receiver Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPUDPReceiver.h"
+#include "Poco/Exception.h"
+#include "Poco/ScopedUnlock.h"
+#include "Poco/Timespan.h"
+#include <cstring>
+
+#if defined(__linux__)
+	#include <sys/epoll.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <ctime>
+
+	#define RTP_HAVE_RECVMMSG
+#endif
+
+
+using Poco::UInt8;
+using Poco::Mutex;
+using Poco::Timestamp;
+using Poco::Timespan;
+using Poco::Net::Socket;
+using Poco::Net::DatagramSocket;
+
+
+namespace RTP {
+
+
+namespace
+{
+	const int WAIT_TIMEOUT = 100;  // milliseconds between checks for stop
+}
+
+
+RTPUDPReceiver::Consumer::~Consumer()
+{
+}
+
+
+#if defined(RTP_HAVE_RECVMMSG)
+
+
+struct RTPUDPReceiver::Batch
+	/// The message headers of a recvmmsg() call, set up once
+	/// to point into the receiver's buffer.
+{
+	std::vector<struct mmsghdr> messages;
+	std::vector<struct iovec>   vectors;
+	std::vector<char>           control;
+	std::size_t                 controlSize;
+};
+
+
+RTPUDPReceiver::RTPUDPReceiver(std::size_t batchSize, std::size_t datagramSize, bool timestamping, RTPPacketPool* pPool):
+	_batchSize(batchSize),
+	_datagramSize(datagramSize),
+	_timestamping(timestamping),
+	_pPool(pPool),
+	_pBatch(0),
+	_queue(-1),
+	_stop(false)
+{
+	init();
+
+	_pBatch = new Batch;
+	_pBatch->controlSize = CMSG_SPACE(sizeof(struct timespec));
+	_pBatch->messages.resize(batchSize);
+	_pBatch->vectors.resize(batchSize);
+	_pBatch->control.resize(batchSize * _pBatch->controlSize);
+	std::memset(&_pBatch->messages[0], 0, batchSize * sizeof(struct mmsghdr));
+	for (std::size_t i = 0; i < batchSize; ++i)
+	{
+		_pBatch->vectors[i].iov_len = datagramSize;
+		_pBatch->messages[i].msg_hdr.msg_iov    = &_pBatch->vectors[i];
+		_pBatch->messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	_queue = ::epoll_create1(EPOLL_CLOEXEC);
+	if (_queue < 0)
+	{
+		delete _pBatch;
+		throw Poco::SystemException("cannot create epoll queue", std::strerror(errno));
+	}
+
+	_thread.setName("RTPUDPReceiver");
+	_thread.start(*this);
+}
+
+
+RTPUDPReceiver::~RTPUDPReceiver()
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+		_stop = true;
+	}
+	_thread.join();
+
+	poco_assert_dbg (_entries.empty());
+
+	::close(_queue);
+	delete _pBatch;
+}
+
+
+void RTPUDPReceiver::add(const DatagramSocket& socket, Consumer& consumer)
+{
+	DatagramSocket s(socket);
+	s.setBlocking(false);
+	if (_timestamping)
+	{
+		// not all socket types support it; the batch time is used then
+		int on = 1;
+		::setsockopt(s.impl()->sockfd(), SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+	}
+
+	Mutex::ScopedLock lock(_mutex);
+
+	poco_socket_t fd = s.impl()->sockfd();
+	if (_entries.find(fd) == _entries.end())
+	{
+		struct epoll_event event;
+		std::memset(&event, 0, sizeof(event));
+		event.events  = EPOLLIN;
+		event.data.fd = fd;
+		if (::epoll_ctl(_queue, EPOLL_CTL_ADD, fd, &event) != 0)
+			throw Poco::SystemException("cannot add socket to epoll queue", std::strerror(errno));
+	}
+	Entry entry = { s, &consumer };
+	_entries[fd] = entry;
+}
+
+
+void RTPUDPReceiver::remove(const DatagramSocket& socket)
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		poco_socket_t fd = socket.impl()->sockfd();
+		if (_entries.erase(fd))
+		{
+			::epoll_ctl(_queue, EPOLL_CTL_DEL, fd, 0);
+		}
+	}
+	awaitDelivery();
+}
+
+
+void RTPUDPReceiver::run()
+{
+	struct epoll_event events[MAX_BATCH_SIZE];
+	for (;;)
+	{
+		int count = ::epoll_wait(_queue, events, MAX_BATCH_SIZE, WAIT_TIMEOUT);
+
+		Mutex::ScopedLock delivery(_deliveryMutex);
+		Mutex::ScopedLock lock(_mutex);
+
+		if (_stop) break;
+		++_statistics.wakeups;
+		for (int i = 0; i < count; ++i)
+		{
+			dispatch(events[i].data.fd);
+		}
+	}
+}
+
+
+std::size_t RTPUDPReceiver::receive(Entry& entry)
+{
+	Batch& batch = *_pBatch;
+	for (std::size_t i = 0; i < _batchSize; ++i)
+	{
+		// pool buffers kept by a consumer have been replaced
+		batch.vectors[i].iov_base = slot(i);
+
+		struct msghdr& header = batch.messages[i].msg_hdr;
+		header.msg_control    = _timestamping ? &batch.control[i * batch.controlSize] : 0;
+		header.msg_controllen = _timestamping ? batch.controlSize : 0;
+		header.msg_flags      = 0;
+	}
+
+	int count;
+	do
+	{
+		count = ::recvmmsg(entry.socket.impl()->sockfd(), &batch.messages[0], (unsigned) _batchSize, MSG_DONTWAIT, 0);
+	}
+	while (count < 0 && errno == EINTR);
+
+	// EAGAIN, or a pending ICMP error that has now been consumed
+	if (count <= 0) return 0;
+
+	Timestamp now;
+	std::size_t received = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		struct msghdr& header = batch.messages[i].msg_hdr;
+		if (header.msg_flags & MSG_TRUNC)
+		{
+			++_statistics.truncated;
+			continue;
+		}
+
+		Datagram& datagram = _datagrams[received++];
+		datagram.data            = slot(i);
+		datagram.size            = batch.messages[i].msg_len;
+		datagram.arrival         = now;
+		datagram.kernelTimestamp = false;
+		datagram.pBuffer         = _pPool ? _slots[i].get() : 0;
+		if (datagram.pBuffer) datagram.pBuffer->setSize(datagram.size);
+		if (_timestamping)
+		{
+			for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&header); pCmsg != NULL; pCmsg = CMSG_NXTHDR(&header, pCmsg))
+			{
+				if (pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_TIMESTAMPNS)
+				{
+					struct timespec ts;
+					std::memcpy(&ts, CMSG_DATA(pCmsg), sizeof(ts));
+					datagram.arrival         = Timestamp((Timestamp::TimeVal) ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+					datagram.kernelTimestamp = true;
+				}
+			}
+		}
+	}
+	return received;
+}
+
+
+#else // RTP_HAVE_RECVMMSG
+
+
+struct RTPUDPReceiver::Batch
+{
+};
+
+
+RTPUDPReceiver::RTPUDPReceiver(std::size_t batchSize, std::size_t datagramSize, bool timestamping, RTPPacketPool* pPool):
+	_batchSize(batchSize),
+	_datagramSize(datagramSize),
+	_timestamping(timestamping),
+	_pPool(pPool),
+	_pBatch(0),
+	_queue(-1),
+	_stop(false)
+{
+	init();
+
+	_thread.setName("RTPUDPReceiver");
+	_thread.start(*this);
+}
+
+
+RTPUDPReceiver::~RTPUDPReceiver()
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+		_stop = true;
+	}
+	_thread.join();
+
+	poco_assert_dbg (_entries.empty());
+}
+
+
+void RTPUDPReceiver::add(const DatagramSocket& socket, Consumer& consumer)
+{
+	DatagramSocket s(socket);
+	s.setBlocking(false);
+
+	Mutex::ScopedLock lock(_mutex);
+
+	Entry entry = { s, &consumer };
+	_entries[s.impl()->sockfd()] = entry;
+}
+
+
+void RTPUDPReceiver::remove(const DatagramSocket& socket)
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		_entries.erase(socket.impl()->sockfd());
+	}
+	awaitDelivery();
+}
+
+
+void RTPUDPReceiver::run()
+{
+	for (;;)
+	{
+		Socket::SocketList readList;
+		{
+			Mutex::ScopedLock lock(_mutex);
+
+			if (_stop) break;
+			for (EntryMap::const_iterator it = _entries.begin(); it != _entries.end(); ++it)
+			{
+				readList.push_back(it->second.socket);
+			}
+		}
+
+		if (readList.empty())
+		{
+			Poco::Thread::sleep(WAIT_TIMEOUT);
+			continue;
+		}
+
+		Socket::SocketList writeList;
+		Socket::SocketList exceptList;
+		Socket::select(readList, writeList, exceptList, Timespan(WAIT_TIMEOUT * 1000));
+
+		Mutex::ScopedLock delivery(_deliveryMutex);
+		Mutex::ScopedLock lock(_mutex);
+
+		++_statistics.wakeups;
+		for (Socket::SocketList::const_iterator it = readList.begin(); it != readList.end(); ++it)
+		{
+			dispatch(it->impl()->sockfd());
+		}
+	}
+}
+
+
+std::size_t RTPUDPReceiver::receive(Entry& entry)
+{
+	Timestamp now;
+	std::size_t received = 0;
+	try
+	{
+		while (received < _batchSize && entry.socket.available() > 0)
+		{
+			Datagram& datagram = _datagrams[received];
+			UInt8* pData = slot(received);
+			int size = entry.socket.receiveBytes(pData, (int) _datagramSize);
+			if (size <= 0) break;
+
+			datagram.data            = pData;
+			datagram.size            = size;
+			datagram.arrival         = now;
+			datagram.kernelTimestamp = false;
+			datagram.pBuffer         = _pPool ? _slots[received].get() : 0;
+			if (datagram.pBuffer) datagram.pBuffer->setSize(size);
+			++received;
+		}
+	}
+	catch (Poco::Exception&)
+	{
+		// datagrams too large for the buffer and ICMP errors
+		++_statistics.truncated;
+	}
+	return received;
+}
+
+
+#endif // RTP_HAVE_RECVMMSG
+
+
+void RTPUDPReceiver::init()
+{
+	if (_batchSize == 0 || _batchSize > MAX_BATCH_SIZE) throw Poco::InvalidArgumentException("invalid batch size");
+	if (_datagramSize == 0) throw Poco::InvalidArgumentException("invalid datagram size");
+
+	std::memset(&_statistics, 0, sizeof(_statistics));
+	if (_pPool)
+	{
+		_slots.resize(_batchSize);
+		for (std::size_t i = 0; i < _batchSize; ++i)
+		{
+			_slots[i] = _pPool->allocate(_datagramSize);
+		}
+	}
+	else
+	{
+		_buffer.resize(_batchSize * _datagramSize);
+	}
+	_datagrams.resize(_batchSize);
+}
+
+
+UInt8* RTPUDPReceiver::slot(std::size_t index)
+{
+	return _pPool ? _slots[index]->data() : &_buffer[index * _datagramSize];
+}
+
+
+std::size_t RTPUDPReceiver::size() const
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	return _entries.size();
+}
+
+
+RTPUDPReceiver::Statistics RTPUDPReceiver::statistics() const
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	return _statistics;
+}
+
+
+void RTPUDPReceiver::awaitDelivery()
+{
+	// wait for a consumer being called on the receiver thread; if
+	// this is the receiver thread, the lock is held already and
+	// dispatch() does not find the entry any more
+	Mutex::ScopedLock delivery(_deliveryMutex);
+}
+
+
+void RTPUDPReceiver::dispatch(poco_socket_t fd)
+{
+	// called with _deliveryMutex and _mutex held
+	// the entry may have been removed since the socket was polled
+	EntryMap::iterator it = _entries.find(fd);
+	if (it == _entries.end()) return;
+
+	std::size_t count = receive(it->second);
+	if (count == 0) return;
+
+	++_statistics.batches;
+	_statistics.datagrams += count;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		_statistics.bytes += _datagrams[i].size;
+	}
+
+	// the consumer is called without _mutex, so that it can add and
+	// remove sockets, its own included; remove() on another thread
+	// waits for the delivery lock until it has returned
+	DatagramSocket socket(it->second.socket);
+	Consumer* pConsumer = it->second.pConsumer;
+	{
+		Poco::ScopedUnlock<Mutex> unlock(_mutex);
+		pConsumer->onDatagrams(socket, &_datagrams[0], count);
+	}
+
+	if (_pPool)
+	{
+		// replace the buffers the consumer has kept; truncated
+		// datagrams leave gaps, so all slots are checked
+		for (std::size_t i = 0; i < _batchSize; ++i)
+		{
+			if (_slots[i]->referenceCount() > 1)
+			{
+				_slots[i] = _pPool->allocate(_datagramSize);
+			}
+		}
+	}
+}
+
+
+} // namespace RTP
@@ -0,0 +1,406 @@
+/*****************************************************************************
+//	RTP Library
+//
+//	RTP UDP Sender Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPUDPSender.h"
+#include "Poco/Exception.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <netinet/udp.h>
+	#include <cerrno>
+
+	#ifndef UDP_SEGMENT
+		#define UDP_SEGMENT 103
+	#endif
+
+	#define RTP_HAVE_SENDMMSG
+#endif
+
+
+using Poco::UInt8;
+using Poco::UInt16;
+using Poco::Net::DatagramSocket;
+using Poco::Net::SocketAddress;
+
+
+namespace RTP {
+
+
+#if defined(RTP_HAVE_SENDMMSG)
+
+
+namespace
+{
+	const std::size_t MAX_GSO_BYTES = 65000;  // below the maximum UDP payload for IPv4 and IPv6
+}
+
+
+struct RTPUDPSender::Batch
+	/// The message headers of the current burst. The packets
+	/// are grouped into runs that can be sent as one message;
+	/// the message for each destination and run refers to the
+	/// same I/O vectors and control data.
+{
+	struct Group
+	{
+		std::size_t first;
+		std::size_t count;
+		std::size_t bytes;
+	};
+
+	std::vector<struct mmsghdr> messages;
+	std::vector<Group>          owners;   /// the packets of each message
+	std::vector<struct iovec>   vectors;
+	std::vector<Group>          groups;
+	std::vector<char>           control;
+	std::size_t                 controlSize;
+
+	void add(std::size_t index, void* name, socklen_t nameLength, const Group& group, void* pControl)
+		/// Sets up message index to send the packets of group to
+		/// the given address, with GSO if pControl is not null.
+	{
+		struct msghdr& header = messages[index].msg_hdr;
+		header.msg_name       = name;
+		header.msg_namelen    = nameLength;
+		header.msg_iov        = &vectors[group.first];
+		header.msg_iovlen     = group.count;
+		header.msg_control    = pControl;
+		header.msg_controllen = pControl ? controlSize : 0;
+		header.msg_flags      = 0;
+		owners[index] = group;
+	}
+
+	Group single(std::size_t packet) const
+		/// Returns the group of one packet.
+	{
+		Group group = { packet, 1, vectors[packet].iov_len };
+		return group;
+	}
+};
+
+
+RTPUDPSender::RTPUDPSender(const DatagramSocket& socket):
+	_socket(socket),
+	_gsoSupported(false),
+	_gso(false),
+	_pBatch(new Batch)
+{
+	std::memset(&_statistics, 0, sizeof(_statistics));
+
+	_pBatch->messages.resize(MAX_MESSAGES);
+	_pBatch->owners.resize(MAX_MESSAGES);
+	_pBatch->controlSize = CMSG_SPACE(sizeof(UInt16));
+	std::memset(&_pBatch->messages[0], 0, MAX_MESSAGES * sizeof(struct mmsghdr));
+
+	// the option can be read if the kernel knows it
+	int segment = 0;
+	socklen_t length = sizeof(segment);
+	_gsoSupported = ::getsockopt(_socket.impl()->sockfd(), SOL_UDP, UDP_SEGMENT, &segment, &length) == 0;
+	_gso = _gsoSupported;
+}
+
+
+RTPUDPSender::~RTPUDPSender()
+{
+	delete _pBatch;
+}
+
+
+void RTPUDPSender::transmit(const SocketAddress* destinations, std::size_t destinationCount, const Packet* packets, std::size_t count)
+{
+	if (count == 0 || destinationCount == 0) return;
+
+	Batch& batch = *_pBatch;
+	if (batch.vectors.size() < count) batch.vectors.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		batch.vectors[i].iov_base = const_cast<UInt8*>(packets[i].data);
+		batch.vectors[i].iov_len  = packets[i].size;
+	}
+
+	// runs of equal-sized packets, of which the last may be
+	// shorter, are sent as one message with GSO
+	batch.groups.clear();
+	for (std::size_t i = 0; i < count; )
+	{
+		Batch::Group group = { i, 1, packets[i].size };
+		std::size_t segment = packets[i].size;
+		++i;
+		while (_gso && i < count && group.count < MAX_SEGMENTS && group.bytes + packets[i].size <= MAX_GSO_BYTES && packets[i].size <= segment)
+		{
+			++group.count;
+			group.bytes += packets[i].size;
+			if (packets[i++].size < segment) break;
+		}
+		batch.groups.push_back(group);
+	}
+
+	if (batch.control.size() < batch.groups.size() * batch.controlSize) batch.control.resize(batch.groups.size() * batch.controlSize);
+	for (std::size_t g = 0; g < batch.groups.size(); ++g)
+	{
+		const Batch::Group& group = batch.groups[g];
+		if (group.count > 1)
+		{
+			struct cmsghdr* pCmsg = reinterpret_cast<struct cmsghdr*>(&batch.control[g * batch.controlSize]);
+			pCmsg->cmsg_level = SOL_UDP;
+			pCmsg->cmsg_type  = UDP_SEGMENT;
+			pCmsg->cmsg_len   = CMSG_LEN(sizeof(UInt16));
+			UInt16 segment = (UInt16) packets[group.first].size;
+			std::memcpy(CMSG_DATA(pCmsg), &segment, sizeof(segment));
+		}
+	}
+
+	std::size_t pending = 0;
+	for (std::size_t d = 0; d < destinationCount; ++d)
+	{
+		void* name = (void*) destinations[d].addr();
+		socklen_t nameLength = destinations[d].length();
+		for (std::size_t g = 0; g < batch.groups.size(); ++g)
+		{
+			const Batch::Group& group = batch.groups[g];
+			if (group.count > 1 && !_gso)
+			{
+				// GSO has been given up during this burst
+				for (std::size_t i = group.first; i < group.first + group.count; ++i)
+				{
+					batch.add(pending, name, nameLength, batch.single(i), 0);
+					if (++pending == MAX_MESSAGES)
+					{
+						flush(pending);
+						pending = 0;
+					}
+				}
+				continue;
+			}
+
+			batch.add(pending, name, nameLength, group, group.count > 1 ? &batch.control[g * batch.controlSize] : 0);
+			if (++pending == MAX_MESSAGES)
+			{
+				flush(pending);
+				pending = 0;
+			}
+		}
+	}
+	if (pending > 0) flush(pending);
+}
+
+
+void RTPUDPSender::flush(std::size_t count)
+{
+	Batch& batch = *_pBatch;
+	std::size_t sent = 0;
+	while (sent < count)
+	{
+		int rc = ::sendmmsg(_socket.impl()->sockfd(), &batch.messages[sent], (unsigned) (count - sent), 0);
+		++_statistics.calls;
+		if (rc == 0)
+		{
+			// nothing sent and no error set: the first message is
+			// sent on its own, which either goes or tells why not
+			rc = ::sendmsg(_socket.impl()->sockfd(), &batch.messages[sent].msg_hdr, 0) < 0 ? -1 : 1;
+			++_statistics.calls;
+		}
+		if (rc > 0)
+		{
+			for (std::size_t i = sent; i < sent + rc; ++i)
+			{
+				++_statistics.messages;
+				_statistics.packets += batch.owners[i].count;
+				_statistics.bytes   += batch.owners[i].bytes;
+			}
+			sent += rc;
+			continue;
+		}
+
+		// errno is only set when the call failed
+		poco_assert_dbg (rc == -1);
+		int error = errno;
+		if (error == EINTR) continue;
+
+		if (error == EAGAIN || error == EWOULDBLOCK)
+		{
+			// the socket buffer is full: the rest of the burst is dropped
+			for (std::size_t i = sent; i < count; ++i)
+			{
+				_statistics.errors += batch.owners[i].count;
+			}
+			break;
+		}
+
+		// the first message failed. GSO is given up if the device
+		// cannot do it, and the packets still queued are sent as
+		// plain datagrams; otherwise the packets of the message
+		// are lost
+		const Batch::Group& group = batch.owners[sent];
+		if (group.count > 1 && (error == EIO || error == EINVAL))
+		{
+			_gsoSupported = false;
+			_gso = false;
+			resend(sent, count);
+			return;
+		}
+		_statistics.errors += group.count;
+		++sent;
+	}
+}
+
+
+void RTPUDPSender::resend(std::size_t first, std::size_t count)
+{
+	Batch& batch = *_pBatch;
+
+	// the queued messages are overwritten while they are split up
+	std::vector<struct mmsghdr> messages(batch.messages.begin() + first, batch.messages.begin() + count);
+	std::vector<Batch::Group> owners(batch.owners.begin() + first, batch.owners.begin() + count);
+
+	std::size_t pending = 0;
+	for (std::size_t m = 0; m < messages.size(); ++m)
+	{
+		const Batch::Group& group = owners[m];
+		for (std::size_t i = group.first; i < group.first + group.count; ++i)
+		{
+			batch.add(pending, messages[m].msg_hdr.msg_name, messages[m].msg_hdr.msg_namelen, batch.single(i), 0);
+			if (++pending == MAX_MESSAGES)
+			{
+				flush(pending);
+				pending = 0;
+			}
+		}
+	}
+	if (pending > 0) flush(pending);
+}
+
+
+#else // RTP_HAVE_SENDMMSG
+
+
+struct RTPUDPSender::Batch
+{
+};
+
+
+RTPUDPSender::RTPUDPSender(const DatagramSocket& socket):
+	_socket(socket),
+	_gsoSupported(false),
+	_gso(false),
+	_pBatch(0)
+{
+	std::memset(&_statistics, 0, sizeof(_statistics));
+}
+
+
+RTPUDPSender::~RTPUDPSender()
+{
+}
+
+
+void RTPUDPSender::transmit(const SocketAddress* destinations, std::size_t destinationCount, const Packet* packets, std::size_t count)
+{
+	for (std::size_t d = 0; d < destinationCount; ++d)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			++_statistics.calls;
+			try
+			{
+				_socket.sendTo(packets[i].data, (int) packets[i].size, destinations[d]);
+				++_statistics.messages;
+				++_statistics.packets;
+				_statistics.bytes += packets[i].size;
+			}
+			catch (Poco::Exception&)
+			{
+				++_statistics.errors;
+			}
+		}
+	}
+}
+
+
+void RTPUDPSender::flush(std::size_t count)
+{
+}
+
+
+void RTPUDPSender::resend(std::size_t first, std::size_t count)
+{
+}
+
+
+#endif // RTP_HAVE_SENDMMSG
+
+
+void RTPUDPSender::addDestination(const SocketAddress& destination)
+{
+	if (std::find(_destinations.begin(), _destinations.end(), destination) == _destinations.end())
+	{
+		_destinations.push_back(destination);
+	}
+}
+
+
+void RTPUDPSender::removeDestination(const SocketAddress& destination)
+{
+	std::vector<SocketAddress>::iterator it = std::find(_destinations.begin(), _destinations.end(), destination);
+	if (it != _destinations.end()) _destinations.erase(it);
+}
+
+
+void RTPUDPSender::send(const Packet* packets, std::size_t count)
+{
+	if (!_destinations.empty()) transmit(&_destinations[0], _destinations.size(), packets, count);
+}
+
+
+void RTPUDPSender::sendTo(const SocketAddress& destination, const Packet* packets, std::size_t count)
+{
+	transmit(&destination, 1, packets, count);
+}
+
+
+void RTPUDPSender::setGSO(bool enable)
+{
+	_gso = enable && _gsoSupported;
+}
+
+
+} // namespace RTP
@@ -0,0 +1,93 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	Access Unit Collector
+//
+//	description:
+//		keeps copies of the access units of a depacketizer
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "AccessUnitCollector.h"
+
+
+using RTP::RTPDepacketizer;
+
+
+AccessUnitCollector::AccessUnitCollector()
+{
+}
+
+
+AccessUnitCollector::~AccessUnitCollector()
+{
+}
+
+
+void AccessUnitCollector::onAccessUnit(const RTPDepacketizer::AccessUnit& unit)
+{
+	Unit copy;
+	copy.sliceCount = unit.sliceCount;
+	copy.timestamp  = unit.timestamp;
+	copy.keyFrame   = unit.keyFrame;
+	copy.complete   = unit.complete;
+	for (std::size_t i = 0; i < unit.sliceCount; ++i)
+	{
+		copy.data.append(reinterpret_cast<const char*>(unit.slices[i].data), unit.slices[i].size);
+	}
+	poco_assert (copy.data.size() == unit.size);
+
+	_units.push_back(copy);
+}
+
+
+std::size_t AccessUnitCollector::count() const
+{
+	return _units.size();
+}
+
+
+const AccessUnitCollector::Unit& AccessUnitCollector::operator [] (std::size_t index) const
+{
+	poco_assert (index < _units.size());
+
+	return _units[index];
+}
+
+
+void AccessUnitCollector::clear()
+{
+	_units.clear();
+}
@@ -0,0 +1,92 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	Access Unit Collector
+//
+//	description:
+//		keeps copies of the access units of a depacketizer
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __ACCESS_UNIT_COLLECTOR__H__
+#define __ACCESS_UNIT_COLLECTOR__H__
+
+
+#include "Poco/Foundation.h"
+#include <string>
+#include <vector>
+
+#include "RTPDepacketizer.h"
+
+
+class AccessUnitCollector: public RTP::RTPDepacketizer::Handler
+	/// AccessUnitCollector copies the slices of every access unit
+	/// it receives into a string, for comparison with the
+	/// expected bitstream.
+{
+public:
+	struct Unit
+	{
+		std::string  data;
+		std::size_t  sliceCount;
+		Poco::UInt32 timestamp;
+		bool         keyFrame;
+		bool         complete;
+	};
+
+	AccessUnitCollector();
+		/// Creates an empty AccessUnitCollector.
+
+	~AccessUnitCollector();
+		/// Destroys the AccessUnitCollector.
+
+	void onAccessUnit(const RTP::RTPDepacketizer::AccessUnit& unit);
+		/// Appends a copy of unit.
+
+	std::size_t count() const;
+		/// Returns the number of units received.
+
+	const Unit& operator [] (std::size_t index) const;
+		/// Returns the unit with the given index.
+
+	void clear();
+		/// Forgets the units received so far.
+
+private:
+	std::vector<Unit> _units;
+};
+
+
+#endif // __ACCESS_UNIT_COLLECTOR__H__
@@ -0,0 +1,97 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	Packet Builder
+//
+//	description:
+//		builds the RTP packets of test streams
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "PacketBuilder.h"
+
+
+using Poco::UInt16;
+using Poco::UInt32;
+
+using RTP::RTPPacket;
+
+
+PacketBuilder::PacketBuilder(int payloadType, UInt32 ssrc, UInt16 sequenceNumber):
+	_payloadType(payloadType),
+	_ssrc(ssrc),
+	_sequenceNumber(sequenceNumber)
+{
+}
+
+
+PacketBuilder::~PacketBuilder()
+{
+}
+
+
+RTPPacket PacketBuilder::packet(UInt32 timestamp, bool marker, const std::string& payload)
+{
+	std::string buffer(RTPPacket::FIXED_HEADER_SIZE, '\0');
+	buffer[0]  = (char) 0x80;
+	buffer[1]  = (char) ((marker ? 0x80 : 0) | _payloadType);
+	buffer[2]  = (char) (_sequenceNumber >> 8);
+	buffer[3]  = (char) _sequenceNumber;
+	buffer[4]  = (char) (timestamp >> 24);
+	buffer[5]  = (char) (timestamp >> 16);
+	buffer[6]  = (char) (timestamp >> 8);
+	buffer[7]  = (char) timestamp;
+	buffer[8]  = (char) (_ssrc >> 24);
+	buffer[9]  = (char) (_ssrc >> 16);
+	buffer[10] = (char) (_ssrc >> 8);
+	buffer[11] = (char) _ssrc;
+	buffer += payload;
+	++_sequenceNumber;
+
+	_buffers.push_back(buffer);
+	return RTPPacket(_buffers.back().data(), _buffers.back().size());
+}
+
+
+void PacketBuilder::skip(int count)
+{
+	_sequenceNumber = (UInt16) (_sequenceNumber + count);
+}
+
+
+UInt16 PacketBuilder::sequenceNumber() const
+{
+	return _sequenceNumber;
+}
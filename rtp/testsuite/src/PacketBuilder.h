@@ -0,0 +1,85 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	Packet Builder
+//
+//	description:
+//		builds the RTP packets of test streams
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __PACKET_BUILDER__H__
+#define __PACKET_BUILDER__H__
+
+
+#include "Poco/Foundation.h"
+#include <deque>
+#include <string>
+
+#include "RTPPacket.h"
+
+
+class PacketBuilder
+	/// PacketBuilder builds the RTP packets of a test stream with
+	/// consecutive sequence numbers, starting a few packets before
+	/// the sequence number wraps around. The packets are views of
+	/// buffers that are kept until the PacketBuilder is destroyed,
+	/// as depacketizers require.
+{
+public:
+	PacketBuilder(int payloadType = 96, Poco::UInt32 ssrc = 0x12345678, Poco::UInt16 sequenceNumber = 0xfff0);
+		/// Creates a PacketBuilder.
+
+	~PacketBuilder();
+		/// Destroys the PacketBuilder and its buffers.
+
+	RTP::RTPPacket packet(Poco::UInt32 timestamp, bool marker, const std::string& payload);
+		/// Returns the next packet of the stream.
+
+	void skip(int count = 1);
+		/// Skips count sequence numbers, as if the packets were lost.
+
+	Poco::UInt16 sequenceNumber() const;
+		/// Returns the sequence number of the next packet.
+
+private:
+	int                     _payloadType;
+	Poco::UInt32            _ssrc;
+	Poco::UInt16            _sequenceNumber;
+	std::deque<std::string> _buffers;
+};
+
+
+#endif // __PACKET_BUILDER__H__
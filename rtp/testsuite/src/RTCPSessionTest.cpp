@@ -0,0 +1,382 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTCP Session Test
+//
+//	description:
+//		unit tests of RTCPSession
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTCPSessionTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+
+#include "RTCPPacket.h"
+#include "RTCPScheduler.h"
+#include "RTCPSession.h"
+#include "RTPSource.h"
+
+#include "PacketBuilder.h"
+
+#include <vector>
+
+
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::UInt8;
+using Poco::UInt32;
+
+using RTP::RTCPPacket;
+using RTP::RTCPScheduler;
+using RTP::RTCPSession;
+
+
+namespace
+{
+	// the shortest and longest randomized intervals for the
+	// minimum deterministic interval of 5 seconds (RFC 3550, A.7)
+	const Timestamp::TimeDiff MIN_INTERVAL = (Timestamp::TimeDiff) (5.0 * 0.5 / 1.21828 * Timespan::SECONDS);
+	const Timestamp::TimeDiff MAX_INTERVAL = (Timestamp::TimeDiff) (5.0 * 1.5 / 1.21828 * Timespan::SECONDS) + 1;
+
+	const UInt32 LOCAL_SSRC = 0xcafe0001;
+
+	class ReportCollector: public RTCPSession::Transport
+		/// Keeps the compound packets sent by a session.
+	{
+	public:
+		void sendRTCP(const UInt8* data, std::size_t length)
+		{
+			_reports.push_back(std::string(reinterpret_cast<const char*>(data), length));
+		}
+
+		std::size_t count() const
+		{
+			return _reports.size();
+		}
+
+		RTCPPacket packet(std::size_t report, int index) const
+			/// Returns the index-th packet of a compound packet.
+		{
+			const std::string& data = _reports[report];
+			RTCPPacket packet;
+			std::size_t offset = 0;
+			for (int i = 0; packet.parse(data.data() + offset, data.size() - offset); ++i)
+			{
+				if (i == index) return packet;
+				offset += packet.size();
+			}
+			return RTCPPacket();
+		}
+
+	private:
+		std::vector<std::string> _reports;
+	};
+
+	void receive(RTCPSession& session, UInt32 ssrc, int first, int count, const Timestamp& arrival)
+		/// Feeds the session with the packets of the given source
+		/// with the sequence numbers [first, first + count).
+	{
+		PacketBuilder builder(96, ssrc, (Poco::UInt16) first);
+		for (int i = first; i < first + count; ++i)
+		{
+			session.onRTP(builder.packet(i * 3000, true, "data"), arrival);
+		}
+	}
+}
+
+
+RTCPSessionTest::RTCPSessionTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+RTCPSessionTest::~RTCPSessionTest()
+{
+}
+
+
+void RTCPSessionTest::testFirstReport()
+{
+	RTCPScheduler scheduler;
+	ReportCollector collector;
+	RTCPSession session(collector, LOCAL_SSRC, "user@host", 90000, 0, scheduler);
+	assert (session.members() == 1);
+	assert (session.senders() == 0);
+
+	// without start(), the first report is due at once
+	Timestamp now;
+	Timestamp next;
+	assert (session.onTimer(now, next));
+	assert (collector.count() == 1);
+
+	RTCPPacket rr = collector.packet(0, 0);
+	assert (rr.valid());
+	assert (rr.type() == RTCPPacket::RTCP_RR);
+	assert (rr.ssrc() == LOCAL_SSRC);
+	assert (rr.count() == 0);
+
+	RTCPPacket sdes = collector.packet(0, 1);
+	assert (sdes.type() == RTCPPacket::RTCP_SDES);
+	RTCPPacket::SDESItem item;
+	assert (sdes.sdesItems(&item, 1) == 1);
+	assert (item.ssrc == LOCAL_SSRC);
+	assert (item.type == RTCPPacket::SDES_CNAME);
+	assert (std::string(item.text, item.length) == "user@host");
+	assert (!collector.packet(0, 2).valid());
+
+	// without a session bandwidth, the minimum interval applies
+	assert (next - now >= MIN_INTERVAL && next - now <= MAX_INTERVAL);
+}
+
+
+void RTCPSessionTest::testReconsideration()
+{
+	RTCPScheduler scheduler;
+	ReportCollector collector;
+	RTCPSession session(collector, LOCAL_SSRC, "user@host", 90000, 0, scheduler);
+
+	Timestamp now;
+	Timestamp next;
+	session.onTimer(now, next);
+	assert (collector.count() == 1);
+
+	// a timer that fires before the recomputed interval
+	// has elapsed is deferred without a report
+	Timestamp early = now + Timespan::SECONDS;
+	assert (session.onTimer(early, next));
+	assert (collector.count() == 1);
+	assert (next - now >= MIN_INTERVAL && next - now <= MAX_INTERVAL);
+
+	Timestamp late = now + 7 * Timespan::SECONDS;
+	assert (session.onTimer(late, next));
+	assert (collector.count() == 2);
+	assert (next - late >= MIN_INTERVAL && next - late <= MAX_INTERVAL);
+}
+
+
+void RTCPSessionTest::testBandwidthScaling()
+{
+	RTCPScheduler scheduler;
+	ReportCollector collector;
+	RTCPSession session(collector, LOCAL_SSRC, "user@host", 90000, 64000, scheduler);
+
+	// 200 members that only send receiver reports
+	Timestamp now;
+	UInt8 buffer[RTCPSession::MAX_PACKET_SIZE];
+	for (UInt32 ssrc = 1; ssrc <= 200; ++ssrc)
+	{
+		std::size_t size = RTCPPacket::writeReceiverReport(buffer, sizeof(buffer), ssrc, 0, 0);
+		assert (session.onRTCP(buffer, size, now));
+	}
+	assert (session.members() == 201);
+	assert (!session.onRTCP(buffer, 2, now));
+
+	// 5% of 64 kbit/s shared by 201 members sending between 36
+	// and 89 bytes per report make 18 to 45 seconds, randomized
+	Timestamp next;
+	session.onTimer(now, next);
+	assert (collector.count() == 1);
+	assert (next - now > MAX_INTERVAL);
+	assert (next - now < 56 * Timespan::SECONDS);
+}
+
+
+void RTCPSessionTest::testSenderReport()
+{
+	RTCPScheduler scheduler;
+	ReportCollector collector;
+	RTCPSession session(collector, LOCAL_SSRC, "user@host", 90000, 0, scheduler);
+
+	Timestamp now;
+	Timestamp next;
+	session.onTimer(now, next);
+
+	// a sender report once the local source has sent, with the
+	// RTP timestamp extrapolated to the time of the report
+	PacketBuilder builder(96, LOCAL_SSRC);
+	session.onSentRTP(builder.packet(90000, true, "12345"), now);
+	session.onSentRTP(builder.packet(93000, true, "1234567890"), now + 5 * Timespan::SECONDS);
+	receive(session, 0x1000, 0, 3, now + 5 * Timespan::SECONDS);
+	assert (session.senders() == 2);
+
+	session.onTimer(now + 7 * Timespan::SECONDS, next);
+	assert (collector.count() == 2);
+	RTCPPacket sr = collector.packet(1, 0);
+	assert (sr.type() == RTCPPacket::RTCP_SR);
+	assert (sr.ssrc() == LOCAL_SSRC);
+	RTCPPacket::SenderInfo info = sr.senderInfo();
+	assert (info.packetCount == 2);
+	assert (info.octetCount == 15);
+	assert (info.rtpTimestamp == 93000 + 2 * 90000);
+
+	// with a report block about the remote source
+	assert (sr.count() == 1);
+	RTCPPacket::ReportBlock block = sr.reportBlock(0);
+	assert (block.ssrc == 0x1000);
+	assert (block.cumulativeLost == 0);
+	assert (block.lastSR == 0);
+}
+
+
+void RTCPSessionTest::testRoundRobin()
+{
+	RTCPScheduler scheduler;
+	ReportCollector collector;
+	RTCPSession session(collector, LOCAL_SSRC, "user@host", 90000, 0, scheduler);
+
+	// more senders than a report has room for
+	const int SENDERS = 40;
+	Timestamp now;
+	for (int i = 0; i < SENDERS; ++i)
+	{
+		receive(session, 0x1000 + i, 0, 2, now);
+	}
+	assert (session.members() == SENDERS + 1);
+
+	Timestamp next;
+	session.onTimer(now, next);
+	RTCPPacket rr = collector.packet(0, 0);
+	assert (rr.count() == RTCPPacket::MAX_REPORT_BLOCKS);
+	assert (rr.reportBlock(0).ssrc == 0x1000);
+	assert (rr.reportBlock(30).ssrc == 0x1000 + 30);
+
+	// the next report starts with the sources left out,
+	// and wraps around to the others
+	for (int i = 0; i < SENDERS; ++i)
+	{
+		receive(session, 0x1000 + i, 2, 3, now + 10 * Timespan::SECONDS);
+	}
+	session.onTimer(now + 10 * Timespan::SECONDS, next);
+	rr = collector.packet(1, 0);
+	assert (rr.count() == RTCPPacket::MAX_REPORT_BLOCKS);
+	assert (rr.reportBlock(0).ssrc == 0x1000 + 31);
+	assert (rr.reportBlock(8).ssrc == 0x1000 + 39);
+	assert (rr.reportBlock(9).ssrc == 0x1000);
+	assert (rr.reportBlock(30).ssrc == 0x1000 + 21);
+
+	// sources get no block when they have not sent
+	// since their last one
+	session.onTimer(now + 20 * Timespan::SECONDS, next);
+	rr = collector.packet(2, 0);
+	assert (rr.count() == 9);
+	assert (rr.reportBlock(0).ssrc == 0x1000 + 22);
+	assert (rr.reportBlock(8).ssrc == 0x1000 + 30);
+}
+
+
+void RTCPSessionTest::testTimeout()
+{
+	RTCPScheduler scheduler;
+	ReportCollector collector;
+	RTCPSession session(collector, LOCAL_SSRC, "user@host", 90000, 0, scheduler);
+
+	Timestamp now;
+	receive(session, 0x1000, 0, 2, now);
+	receive(session, 0x2000, 0, 2, now + 20 * Timespan::SECONDS);
+	assert (session.members() == 3);
+
+	// members time out after five intervals of at least 5 seconds
+	Timestamp next;
+	session.onTimer(now + 24 * Timespan::SECONDS, next);
+	assert (session.members() == 3);
+	session.onTimer(now + 31 * Timespan::SECONDS, next);
+	assert (session.members() == 2);
+
+	RTP::RTPSource source(0, 90000);
+	assert (!session.source(0x1000, source));
+	assert (session.source(0x2000, source));
+	assert (source.ssrc() == 0x2000);
+	assert (source.valid());
+}
+
+
+void RTCPSessionTest::testBye()
+{
+	RTCPScheduler scheduler;
+	ReportCollector collector;
+	RTCPSession session(collector, LOCAL_SSRC, "user@host", 90000, 0, scheduler);
+
+	Timestamp now;
+	receive(session, 0x1000, 0, 2, now);
+	receive(session, 0x2000, 0, 2, now);
+	assert (session.members() == 3);
+
+	// a received BYE removes the source
+	UInt8 buffer[RTCPSession::MAX_PACKET_SIZE];
+	std::size_t size = RTCPPacket::writeReceiverReport(buffer, sizeof(buffer), 0x1000, 0, 0);
+	size += RTCPPacket::writeBye(buffer + size, sizeof(buffer) - size, 0x1000);
+	assert (session.onRTCP(buffer, size, now));
+	assert (session.members() == 2);
+
+	// stop() sends a final report with a BYE
+	session.stop("done");
+	assert (collector.count() == 1);
+	assert (collector.packet(0, 0).type() == RTCPPacket::RTCP_RR);
+	assert (collector.packet(0, 1).type() == RTCPPacket::RTCP_SDES);
+	RTCPPacket bye = collector.packet(0, 2);
+	assert (bye.type() == RTCPPacket::RTCP_BYE);
+	assert (bye.count() == 1);
+	assert (bye.byeSource(0) == LOCAL_SSRC);
+}
+
+
+void RTCPSessionTest::setUp()
+{
+}
+
+
+void RTCPSessionTest::tearDown()
+{
+}
+
+
+CppUnit::Test* RTCPSessionTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTCPSessionTest");
+
+	CppUnit_addTest(pSuite, RTCPSessionTest, testFirstReport);
+	CppUnit_addTest(pSuite, RTCPSessionTest, testReconsideration);
+	CppUnit_addTest(pSuite, RTCPSessionTest, testBandwidthScaling);
+	CppUnit_addTest(pSuite, RTCPSessionTest, testSenderReport);
+	CppUnit_addTest(pSuite, RTCPSessionTest, testRoundRobin);
+	CppUnit_addTest(pSuite, RTCPSessionTest, testTimeout);
+	CppUnit_addTest(pSuite, RTCPSessionTest, testBye);
+
+	return pSuite;
+}
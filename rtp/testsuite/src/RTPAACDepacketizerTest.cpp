@@ -0,0 +1,308 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTP AAC Depacketizer Test
+//
+//	description:
+//		unit tests of RTPAACDepacketizer
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPAACDepacketizerTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+#include "Poco/Exception.h"
+
+#include "RTPAACDepacketizer.h"
+#include "RTPPayloadFormat.h"
+
+#include "AccessUnitCollector.h"
+#include "PacketBuilder.h"
+
+
+using Poco::UInt8;
+
+using RTP::RTPAACDepacketizer;
+using RTP::RTPPayloadFormat;
+
+
+namespace
+{
+	// AAC LC, 48 kHz, stereo: the AudioSpecificConfig for
+	// mpeg4-generic and the StreamMuxConfig for MP4A-LATM
+	const std::string HBR_PARAMETERS("streamtype=5; profile-level-id=1; mode=AAC-hbr; config=1190; sizeLength=13; indexLength=3; indexDeltaLength=3");
+	const std::string LATM_PARAMETERS("cpresent=0; config=400023203fc0");
+
+	std::string frame(std::size_t size, char fill)
+	{
+		return std::string(size, fill);
+	}
+
+	std::string auHeaders(std::size_t first, std::size_t second = 0, std::size_t third = 0)
+		/// Returns the AU header section of AAC-hbr for up to three
+		/// access units: a 13-bit size and a zero index (delta) each.
+	{
+		std::size_t sizes[3] = { first, second, third };
+		std::string headers(2, '\0');
+		for (int i = 0; i < 3 && sizes[i] > 0; ++i)
+		{
+			headers += (char) (sizes[i] >> 5);
+			headers += (char) (sizes[i] << 3);
+		}
+		headers[1] = (char) (8 * (headers.size() - 2));
+		return headers;
+	}
+}
+
+
+RTPAACDepacketizerTest::RTPAACDepacketizerTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+RTPAACDepacketizerTest::~RTPAACDepacketizerTest()
+{
+}
+
+
+void RTPAACDepacketizerTest::testConfig()
+{
+	AccessUnitCollector collector;
+	RTPAACDepacketizer generic(collector, RTPPayloadFormat(97, "mpeg4-generic", 48000, 2, HBR_PARAMETERS));
+	assert (generic.mode() == RTPAACDepacketizer::MODE_GENERIC);
+	assert (generic.format() == RTPAACDepacketizer::FORMAT_RAW);
+	assert (generic.config() == std::string("\x11\x90", 2));
+	assert (generic.objectType() == 2);
+	assert (generic.sampleRate() == 48000);
+	assert (generic.channelConfiguration() == 2);
+	assert (generic.frameDuration() == 1024);
+
+	RTPAACDepacketizer latm(collector, RTPPayloadFormat(97, "MP4A-LATM", 48000, 2, LATM_PARAMETERS));
+	assert (latm.mode() == RTPAACDepacketizer::MODE_LATM);
+	assert (latm.objectType() == 2);
+	assert (latm.sampleRate() == 48000);
+	assert (latm.channelConfiguration() == 2);
+
+	// a frame lasts 1024 samples, in units of the RTP clock
+	RTPAACDepacketizer video(collector, RTPPayloadFormat(97, "mpeg4-generic", 90000, 2, HBR_PARAMETERS));
+	assert (video.frameDuration() == 1920);
+
+	try
+	{
+		RTPAACDepacketizer pcmu(collector, RTPPayloadFormat(0, "PCMU", 8000));
+		fail ("not an AAC payload format");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+
+	try
+	{
+		RTPAACDepacketizer bad(collector, RTPPayloadFormat(97, "mpeg4-generic", 48000, 2, "mode=AAC-hbr; config=11g0"));
+		fail ("invalid config");
+	}
+	catch (Poco::DataFormatException&)
+	{
+	}
+
+	try
+	{
+		RTPAACDepacketizer inband(collector, RTPPayloadFormat(97, "MP4A-LATM", 48000, 2, "config=400023203fc0"));
+		fail ("in-band StreamMuxConfig is not supported");
+	}
+	catch (Poco::NotImplementedException&)
+	{
+	}
+}
+
+
+void RTPAACDepacketizerTest::testAUHeaders()
+{
+	PacketBuilder builder(97);
+	AccessUnitCollector collector;
+	RTPAACDepacketizer depacketizer(collector, RTPPayloadFormat(97, "mpeg4-generic", 48000, 2, HBR_PARAMETERS));
+
+	// the access units of a packet follow each other by one frame
+	depacketizer.push(builder.packet(48000, true, auHeaders(10, 20, 300) + frame(10, 'a') + frame(20, 'b') + frame(300, 'c')));
+	depacketizer.push(builder.packet(48000 + 3 * 1024, true, auHeaders(5) + frame(5, 'd')));
+
+	assert (collector.count() == 4);
+	assert (collector[0].data == frame(10, 'a'));
+	assert (collector[0].timestamp == 48000);
+	assert (collector[1].data == frame(20, 'b'));
+	assert (collector[1].timestamp == 48000 + 1024);
+	assert (collector[2].data == frame(300, 'c'));
+	assert (collector[2].timestamp == 48000 + 2048);
+	assert (collector[3].data == frame(5, 'd'));
+	assert (collector[3].timestamp == 48000 + 3072);
+	for (std::size_t i = 0; i < collector.count(); ++i)
+	{
+		assert (collector[i].keyFrame);
+		assert (collector[i].complete);
+	}
+
+	// an access unit exceeding the packet that is not its first
+	depacketizer.push(builder.packet(60000, true, auHeaders(10, 20) + frame(10, 'e') + frame(5, 'f')));
+	assert (collector.count() == 5);
+	assert (depacketizer.statistics().droppedPackets == 1);
+}
+
+
+void RTPAACDepacketizerTest::testFragmentedAU()
+{
+	PacketBuilder builder(97);
+	AccessUnitCollector collector;
+	RTPAACDepacketizer depacketizer(collector, RTPPayloadFormat(97, "mpeg4-generic", 48000, 2, HBR_PARAMETERS));
+
+	// each fragment repeats the AU header with the size of the whole unit
+	std::string data = frame(600, 'a') + frame(400, 'b');
+	depacketizer.push(builder.packet(1024, false, auHeaders(1000) + data.substr(0, 600)));
+	assert (collector.count() == 0);
+	depacketizer.push(builder.packet(1024, true, auHeaders(1000) + data.substr(600)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == data);
+	assert (collector[0].sliceCount == 2);
+	assert (collector[0].timestamp == 1024);
+	assert (collector[0].complete);
+}
+
+
+void RTPAACDepacketizerTest::testADTS()
+{
+	PacketBuilder builder(97);
+	AccessUnitCollector collector;
+	RTPAACDepacketizer depacketizer(collector, RTPPayloadFormat(97, "mpeg4-generic", 48000, 2, HBR_PARAMETERS), RTPAACDepacketizer::FORMAT_ADTS);
+
+	// profile LC, 48 kHz, two channels, 17 bytes with the header
+	const std::string header("\xff\xf1\x4c\x80\x02\x3f\xfc", 7);
+	UInt8 written[RTPAACDepacketizer::ADTS_HEADER_SIZE];
+	RTPAACDepacketizer::writeADTSHeader(written, 2, 3, 2, 10);
+	assert (std::string(reinterpret_cast<const char*>(written), sizeof(written)) == header);
+
+	depacketizer.push(builder.packet(0, true, auHeaders(10, 10) + frame(10, 'a') + frame(10, 'b')));
+	assert (collector.count() == 2);
+	assert (collector[0].data == header + frame(10, 'a'));
+	assert (collector[1].data == header + frame(10, 'b'));
+
+	// the header of a fragmented unit describes the whole unit
+	std::string data = frame(2000, 'c');
+	depacketizer.push(builder.packet(1024, false, auHeaders(2000) + data.substr(0, 1000)));
+	depacketizer.push(builder.packet(1024, true, auHeaders(2000) + data.substr(1000)));
+	assert (collector.count() == 3);
+	assert (collector[2].data.size() == 2007);
+	assert ((UInt8) collector[2].data[3] == 0x80 && (UInt8) collector[2].data[4] == (2007 >> 3));
+	assert (collector[2].data.substr(7) == data);
+
+	// units too long for an ADTS header are discarded
+	depacketizer.push(builder.packet(2048, false, auHeaders(8190) + frame(1000, 'd')));
+	depacketizer.push(builder.packet(2048, true, auHeaders(8190) + frame(7190, 'd')));
+	depacketizer.push(builder.packet(3072, true, auHeaders(10) + frame(10, 'e')));
+	assert (collector.count() == 4);
+	assert (collector[3].data == header + frame(10, 'e'));
+}
+
+
+void RTPAACDepacketizerTest::testLostFragment()
+{
+	PacketBuilder builder(97);
+	AccessUnitCollector collector;
+	RTPAACDepacketizer depacketizer(collector, RTPPayloadFormat(97, "mpeg4-generic", 48000, 2, HBR_PARAMETERS));
+
+	// a partial unit cannot be decoded, and is not delivered
+	depacketizer.push(builder.packet(0, false, auHeaders(1000) + frame(600, 'a')));
+	builder.skip();
+	depacketizer.push(builder.packet(1024, true, auHeaders(10) + frame(10, 'b')));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == frame(10, 'b'));
+	assert (collector[0].complete);
+
+	// nor is a unit whose first fragment was lost
+	builder.skip();
+	depacketizer.push(builder.packet(2048, true, auHeaders(1000) + frame(400, 'c')));
+	depacketizer.push(builder.packet(3072, true, auHeaders(10) + frame(10, 'd')));
+	assert (collector.count() == 2);
+	assert (collector[1].data == frame(10, 'd'));
+	assert (depacketizer.statistics().droppedPackets == 1);
+}
+
+
+void RTPAACDepacketizerTest::testLATM()
+{
+	PacketBuilder builder(97);
+	AccessUnitCollector collector;
+	RTPAACDepacketizer depacketizer(collector, RTPPayloadFormat(97, "MP4A-LATM", 48000, 2, LATM_PARAMETERS));
+
+	// PayloadLengthInfo: bytes of 255 and the remainder
+	depacketizer.push(builder.packet(0, true, std::string("\xff\x2d", 2) + frame(300, 'a')));
+	assert (collector.count() == 1);
+	assert (collector[0].data == frame(300, 'a'));
+	assert (collector[0].timestamp == 0);
+
+	// an audioMuxElement fragmented over two packets
+	depacketizer.push(builder.packet(1024, false, std::string("\xff\x91", 2) + frame(200, 'b')));
+	depacketizer.push(builder.packet(1024, true, frame(200, 'c')));
+	assert (collector.count() == 2);
+	assert (collector[1].data == frame(200, 'b') + frame(200, 'c'));
+	assert (collector[1].timestamp == 1024);
+	assert (collector[1].complete);
+}
+
+
+void RTPAACDepacketizerTest::setUp()
+{
+}
+
+
+void RTPAACDepacketizerTest::tearDown()
+{
+}
+
+
+CppUnit::Test* RTPAACDepacketizerTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTPAACDepacketizerTest");
+
+	CppUnit_addTest(pSuite, RTPAACDepacketizerTest, testConfig);
+	CppUnit_addTest(pSuite, RTPAACDepacketizerTest, testAUHeaders);
+	CppUnit_addTest(pSuite, RTPAACDepacketizerTest, testFragmentedAU);
+	CppUnit_addTest(pSuite, RTPAACDepacketizerTest, testADTS);
+	CppUnit_addTest(pSuite, RTPAACDepacketizerTest, testLostFragment);
+	CppUnit_addTest(pSuite, RTPAACDepacketizerTest, testLATM);
+
+	return pSuite;
+}
@@ -0,0 +1,348 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTP Crypto Context Test
+//
+//	description:
+//		unit tests of RTPCryptoContext
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPCryptoContextTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+#include "Poco/Exception.h"
+
+#include "RTCPPacket.h"
+#include "RTPCryptoContext.h"
+
+
+using Poco::UInt8;
+
+using RTP::RTCPPacket;
+using RTP::RTPCryptoContext;
+
+
+namespace
+{
+	std::string fromHex(const std::string& hex)
+	{
+		std::string bytes;
+		for (std::size_t i = 0; i + 1 < hex.size(); i += 2)
+		{
+			bytes += (char) std::stoi(hex.substr(i, 2), 0, 16);
+		}
+		return bytes;
+	}
+
+	UInt8* bytes(std::string& s)
+	{
+		return reinterpret_cast<UInt8*>(&s[0]);
+	}
+
+	// the master key and salt of RFC 3711, appendix B.3, and the
+	// packet of the AES_CM_128_HMAC_SHA1_80 test of libsrtp
+	const std::string CM_KEY(fromHex("e1f97a0d3e018be0d64fa32c06de4139"));
+	const std::string CM_SALT(fromHex("0ec675ad498afeebb6960b3aabe6"));
+	const std::string CM_RTP(fromHex("800f1234decafbadcafebabeabababababababababababababababab"));
+	const std::string CM_SRTP(fromHex("800f1234decafbadcafebabe4e55dc4ce79978d88ca4d215949d2402b78d6acc99ea179b8dbb"));
+
+	// the key, salt and packet of RFC 7714, section 16.1.1
+	const std::string GCM_KEY(fromHex("000102030405060708090a0b0c0d0e0f"));
+	const std::string GCM_SALT(fromHex("517569642070726f2071756f"));
+	const std::string GCM_RTP(fromHex("8040f17b8041f8d35501a0b247616c6c696120657374206f6d6e69732064697669736120696e207061727465732074726573"));
+
+	std::string compoundRTCP()
+	{
+		UInt8 buffer[256];
+		std::size_t size = RTCPPacket::writeReceiverReport(buffer, sizeof(buffer), 0x12345678, 0, 0);
+		size += RTCPPacket::writeSDES(buffer + size, sizeof(buffer) - size, 0x12345678, "user@host");
+		return std::string(reinterpret_cast<const char*>(buffer), size);
+	}
+
+	std::string protectRTP(RTPCryptoContext& context, const std::string& packet)
+	{
+		std::string buffer(packet);
+		buffer.resize(packet.size() + context.rtpOverhead());
+		buffer.resize(context.protectRTP(bytes(buffer), packet.size(), buffer.size()));
+		return buffer;
+	}
+
+	bool unprotectRTP(RTPCryptoContext& context, std::string& packet)
+	{
+		std::size_t size = packet.size();
+		bool ok = context.unprotectRTP(bytes(packet), size);
+		packet.resize(size);
+		return ok;
+	}
+}
+
+
+RTPCryptoContextTest::RTPCryptoContextTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+RTPCryptoContextTest::~RTPCryptoContextTest()
+{
+}
+
+
+void RTPCryptoContextTest::testAESCMVector()
+{
+	RTPCryptoContext sender(RTPCryptoContext::AES_CM_128_HMAC_SHA1_80, CM_KEY, CM_SALT);
+	assert (sender.rtpOverhead() == 10);
+
+	std::string srtp = protectRTP(sender, CM_RTP);
+	assert (srtp == CM_SRTP);
+	assert (sender.statistics().encrypted == 1);
+
+	RTPCryptoContext receiver(RTPCryptoContext::AES_CM_128_HMAC_SHA1_80, CM_KEY, CM_SALT);
+	assert (unprotectRTP(receiver, srtp));
+	assert (srtp == CM_RTP);
+	assert (receiver.statistics().decrypted == 1);
+}
+
+
+void RTPCryptoContextTest::testGCMVector()
+{
+	// RTPCryptoContext takes master keys: the key and salt of RFC 7714
+	// are used as such, the session keys are derived as in RFC 3711,
+	// section 4.3, and the packet is then sealed as in RFC 7714, 16.1.1
+	const std::string expected(fromHex("8040f17b8041f8d35501a0b292cb0ecff0a0db188f7bff6b523933aacef8ae9585ed378a627836cb2d6a731d6c3490d925387db18c0661762d59e50ad553d241535a"));
+
+	RTPCryptoContext sender(RTPCryptoContext::AEAD_AES_128_GCM, GCM_KEY, GCM_SALT);
+	assert (sender.rtpOverhead() == 16);
+
+	std::string srtp = protectRTP(sender, GCM_RTP);
+	assert (srtp == expected);
+
+	RTPCryptoContext receiver(RTPCryptoContext::AEAD_AES_128_GCM, GCM_KEY, GCM_SALT);
+	assert (unprotectRTP(receiver, srtp));
+	assert (srtp == GCM_RTP);
+}
+
+
+void RTPCryptoContextTest::testShortTag()
+{
+	RTPCryptoContext sender(RTPCryptoContext::AES_CM_128_HMAC_SHA1_32, CM_KEY, CM_SALT);
+	assert (sender.rtpOverhead() == 4);
+	assert (sender.rtcpOverhead() == 14);
+
+	// the keystream does not depend on the tag length
+	std::string srtp = protectRTP(sender, CM_RTP);
+	assert (srtp.size() == CM_RTP.size() + 4);
+	assert (srtp.substr(0, CM_RTP.size()) == CM_SRTP.substr(0, CM_RTP.size()));
+
+	RTPCryptoContext receiver(RTPCryptoContext::AES_CM_128_HMAC_SHA1_32, CM_KEY, CM_SALT);
+	assert (unprotectRTP(receiver, srtp));
+	assert (srtp == CM_RTP);
+}
+
+
+void RTPCryptoContextTest::testRTCP()
+{
+	RTPCryptoContext::Suite suites[] = { RTPCryptoContext::AES_CM_128_HMAC_SHA1_80, RTPCryptoContext::AEAD_AES_128_GCM };
+	const std::string* salts[] = { &CM_SALT, &GCM_SALT };
+	for (int i = 0; i < 2; ++i)
+	{
+		RTPCryptoContext sender(suites[i], CM_KEY, *salts[i]);
+		RTPCryptoContext receiver(suites[i], CM_KEY, *salts[i]);
+		for (int n = 0; n < 3; ++n)
+		{
+			// the header and the sender SSRC stay in the clear
+			std::string rtcp = compoundRTCP();
+			std::string srtcp(rtcp);
+			srtcp.resize(rtcp.size() + sender.rtcpOverhead());
+			std::size_t size = sender.protectRTCP(bytes(srtcp), rtcp.size(), srtcp.size());
+			assert (size == rtcp.size() + sender.rtcpOverhead());
+			assert (srtcp.substr(0, 8) == rtcp.substr(0, 8));
+			assert (srtcp.substr(8, rtcp.size() - 8) != rtcp.substr(8));
+
+			// the E flag and the SRTCP index, starting at zero, come
+			// before the tag with AES-CM and after it with AES-GCM
+			std::size_t trailer = suites[i] == RTPCryptoContext::AEAD_AES_128_GCM ? size - 4 : rtcp.size();
+			assert ((UInt8) srtcp[trailer] == 0x80);
+			assert ((UInt8) srtcp[trailer + 3] == n);
+
+			assert (receiver.unprotectRTCP(bytes(srtcp), size));
+			assert (size == rtcp.size());
+			assert (srtcp.substr(0, size) == rtcp);
+		}
+	}
+}
+
+
+void RTPCryptoContextTest::testReplay()
+{
+	RTPCryptoContext sender(RTPCryptoContext::AES_CM_128_HMAC_SHA1_80, CM_KEY, CM_SALT);
+	RTPCryptoContext receiver(RTPCryptoContext::AES_CM_128_HMAC_SHA1_80, CM_KEY, CM_SALT);
+
+	std::string first = protectRTP(sender, CM_RTP);
+	std::string copy(first);
+	assert (unprotectRTP(receiver, first));
+	assert (!unprotectRTP(receiver, copy));
+	assert (receiver.statistics().replayed == 1);
+
+	// packets within the window are accepted once, out of order
+	std::string packets[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		std::string rtp(CM_RTP);
+		rtp[3] = (char) (0x35 + i);
+		packets[i] = protectRTP(sender, rtp);
+	}
+	assert (unprotectRTP(receiver, packets[2]));
+	assert (unprotectRTP(receiver, packets[0]));
+	assert (unprotectRTP(receiver, packets[1]));
+	assert (receiver.statistics().decrypted == 4);
+	assert (receiver.statistics().replayed == 1);
+}
+
+
+void RTPCryptoContextTest::testAuthentication()
+{
+	RTPCryptoContext::Suite suites[] = { RTPCryptoContext::AES_CM_128_HMAC_SHA1_80, RTPCryptoContext::AEAD_AES_128_GCM };
+	const std::string* salts[] = { &CM_SALT, &GCM_SALT };
+	for (int i = 0; i < 2; ++i)
+	{
+		RTPCryptoContext sender(suites[i], CM_KEY, *salts[i]);
+		RTPCryptoContext receiver(suites[i], CM_KEY, *salts[i]);
+
+		std::string srtp = protectRTP(sender, CM_RTP);
+		std::string tampered(srtp);
+		tampered[20] ^= 1;
+		assert (!unprotectRTP(receiver, tampered));
+		assert (receiver.statistics().authFailures == 1);
+
+		// a rejected packet does not advance the replay window
+		assert (unprotectRTP(receiver, srtp));
+		assert (srtp == CM_RTP);
+
+		std::string truncated(CM_RTP.substr(0, 4));
+		assert (!unprotectRTP(receiver, truncated));
+		assert (receiver.statistics().malformed == 1);
+	}
+}
+
+
+void RTPCryptoContextTest::testKeyLength()
+{
+	try
+	{
+		RTPCryptoContext context(RTPCryptoContext::AES_CM_128_HMAC_SHA1_80, CM_KEY.substr(0, 15), CM_SALT);
+		fail ("key too short");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+
+	try
+	{
+		RTPCryptoContext context(RTPCryptoContext::AEAD_AES_256_GCM, CM_KEY, GCM_SALT);
+		fail ("AES-256 needs a 32 byte key");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+
+	try
+	{
+		RTPCryptoContext context(RTPCryptoContext::AEAD_AES_128_GCM, GCM_KEY, CM_SALT);
+		fail ("AES-GCM takes a 12 byte salt");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+
+	RTPCryptoContext context(RTPCryptoContext::AEAD_AES_256_GCM, CM_KEY + CM_KEY, GCM_SALT);
+	std::string buffer(CM_RTP);
+	try
+	{
+		context.protectRTP(bytes(buffer), buffer.size(), buffer.size());
+		fail ("no room for the tag");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+}
+
+
+void RTPCryptoContextTest::testSuiteNames()
+{
+	assert (RTPCryptoContext::parseSuite("AES_CM_128_HMAC_SHA1_80") == RTPCryptoContext::AES_CM_128_HMAC_SHA1_80);
+	assert (RTPCryptoContext::parseSuite("AES_CM_128_HMAC_SHA1_32") == RTPCryptoContext::AES_CM_128_HMAC_SHA1_32);
+	assert (RTPCryptoContext::parseSuite("AEAD_AES_128_GCM") == RTPCryptoContext::AEAD_AES_128_GCM);
+	assert (RTPCryptoContext::parseSuite("AEAD_AES_256_GCM") == RTPCryptoContext::AEAD_AES_256_GCM);
+	assert (RTPCryptoContext::suiteName(RTPCryptoContext::AEAD_AES_256_GCM) == "AEAD_AES_256_GCM");
+	assert (RTPCryptoContext::suiteName(RTPCryptoContext::AES_CM_128_HMAC_SHA1_32) == "AES_CM_128_HMAC_SHA1_32");
+
+	try
+	{
+		RTPCryptoContext::parseSuite("F8_128_HMAC_SHA1_80");
+		fail ("unsupported suite");
+	}
+	catch (Poco::NotImplementedException&)
+	{
+	}
+}
+
+
+void RTPCryptoContextTest::setUp()
+{
+}
+
+
+void RTPCryptoContextTest::tearDown()
+{
+}
+
+
+CppUnit::Test* RTPCryptoContextTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTPCryptoContextTest");
+
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testAESCMVector);
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testGCMVector);
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testShortTag);
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testRTCP);
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testReplay);
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testAuthentication);
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testKeyLength);
+	CppUnit_addTest(pSuite, RTPCryptoContextTest, testSuiteNames);
+
+	return pSuite;
+}
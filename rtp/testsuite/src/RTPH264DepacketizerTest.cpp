@@ -0,0 +1,373 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTP H.264 Depacketizer Test
+//
+//	description:
+//		unit tests of RTPH264Depacketizer
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPH264DepacketizerTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+#include "Poco/Exception.h"
+
+#include "RTPH264Depacketizer.h"
+#include "RTPPayloadFormat.h"
+
+#include "AccessUnitCollector.h"
+#include "PacketBuilder.h"
+
+
+using RTP::RTPH264Depacketizer;
+using RTP::RTPPayloadFormat;
+
+
+namespace
+{
+	// the parameter sets of RFC 6184, 8.2.1, and the start of an
+	// IDR slice and of two non-IDR slices, one with first_mb_in_slice 0
+	const std::string SPS("\x67\x42\x00\x0a\x96\x53\x05\x89\x88", 9);
+	const std::string PPS("\x68\xc9\x63\x88", 4);
+	const std::string IDR("\x65\x88\x84\x21\x33", 5);
+	const std::string SLICE("\x41\x9a\x02\x03", 4);
+	const std::string SLICE_CONT("\x41\x1a\x02\x03", 4);
+
+	const std::string SPROP("Z0IACpZTBYmI,aMljiA==");
+
+	std::string annexB(const std::string& nal)
+	{
+		return std::string("\0\0\0\1", 4) + nal;
+	}
+
+	std::string avcc(const std::string& nal)
+	{
+		std::string length(4, '\0');
+		length[2] = (char) (nal.size() >> 8);
+		length[3] = (char) nal.size();
+		return length + nal;
+	}
+
+	std::string stapA(const std::string& first, const std::string& second)
+	{
+		std::string payload("\x18", 1);
+		payload += (char) (first.size() >> 8);
+		payload += (char) first.size();
+		payload += first;
+		payload += (char) (second.size() >> 8);
+		payload += (char) second.size();
+		payload += second;
+		return payload;
+	}
+
+	std::string fuA(const std::string& nal, std::size_t begin, std::size_t end)
+		/// Returns the FU-A packet of the bytes [begin, end) of the
+		/// payload of nal, after its header.
+	{
+		std::string payload;
+		payload += (char) ((nal[0] & 0xe0) | RTPH264Depacketizer::NAL_FU_A);
+		payload += (char) ((begin == 0 ? 0x80 : 0) | (end == nal.size() - 1 ? 0x40 : 0) | (nal[0] & 0x1f));
+		payload += nal.substr(1 + begin, end - begin);
+		return payload;
+	}
+}
+
+
+RTPH264DepacketizerTest::RTPH264DepacketizerTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+RTPH264DepacketizerTest::~RTPH264DepacketizerTest()
+{
+}
+
+
+void RTPH264DepacketizerTest::testSingleNALUnits()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector);
+	assert (depacketizer.format() == RTPH264Depacketizer::FORMAT_ANNEXB);
+
+	depacketizer.push(builder.packet(3000, false, SPS));
+	depacketizer.push(builder.packet(3000, false, PPS));
+	assert (collector.count() == 0);
+	depacketizer.push(builder.packet(3000, true, IDR));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == annexB(SPS) + annexB(PPS) + annexB(IDR));
+	assert (collector[0].sliceCount == 6);
+	assert (collector[0].timestamp == 3000);
+	assert (collector[0].keyFrame);
+	assert (collector[0].complete);
+	assert (depacketizer.sps() == SPS);
+	assert (depacketizer.pps() == PPS);
+
+	depacketizer.push(builder.packet(6000, true, SLICE));
+	assert (collector.count() == 2);
+	assert (collector[1].data == annexB(SLICE));
+	assert (!collector[1].keyFrame);
+	assert (depacketizer.statistics().packets == 4);
+	assert (depacketizer.statistics().accessUnits == 2);
+}
+
+
+void RTPH264DepacketizerTest::testAggregationAndFragmentation()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector);
+
+	depacketizer.push(builder.packet(0, false, stapA(SPS, PPS)));
+	depacketizer.push(builder.packet(0, false, fuA(IDR, 0, 2)));
+	depacketizer.push(builder.packet(0, false, fuA(IDR, 2, 3)));
+	depacketizer.push(builder.packet(0, true, fuA(IDR, 3, 4)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == annexB(SPS) + annexB(PPS) + annexB(IDR));
+	assert (collector[0].keyFrame);
+	assert (collector[0].complete);
+	assert (depacketizer.statistics().droppedPackets == 0);
+}
+
+
+void RTPH264DepacketizerTest::testAVCC()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector, RTPH264Depacketizer::FORMAT_AVCC);
+
+	// the length of a fragmented NAL unit is only known at its end
+	depacketizer.push(builder.packet(0, false, stapA(SPS, PPS)));
+	depacketizer.push(builder.packet(0, false, fuA(IDR, 0, 1)));
+	depacketizer.push(builder.packet(0, true, fuA(IDR, 1, 4)));
+	depacketizer.push(builder.packet(3000, true, SLICE));
+
+	assert (collector.count() == 2);
+	assert (collector[0].data == avcc(SPS) + avcc(PPS) + avcc(IDR));
+	assert (collector[1].data == avcc(SLICE));
+}
+
+
+void RTPH264DepacketizerTest::testParameterSetInsertion()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector, RTPPayloadFormat(96, "H264", 90000, 1, "packetization-mode=1; sprop-parameter-sets=" + SPROP));
+	assert (depacketizer.sps() == SPS);
+	assert (depacketizer.pps() == PPS);
+	assert (depacketizer.getInsertParameterSets());
+
+	// only IDR access units without parameter sets get them
+	depacketizer.push(builder.packet(0, true, IDR));
+	depacketizer.push(builder.packet(3000, true, SLICE));
+	assert (collector.count() == 2);
+	assert (collector[0].data == annexB(SPS) + annexB(PPS) + annexB(IDR));
+	assert (collector[0].keyFrame);
+	assert (collector[1].data == annexB(SLICE));
+
+	depacketizer.setInsertParameterSets(false);
+	depacketizer.push(builder.packet(6000, true, IDR));
+	assert (collector[2].data == annexB(IDR));
+
+	// parameter sets in the stream replace those of the SDP
+	std::string sps = SPS + '\x01';
+	depacketizer.setInsertParameterSets(true);
+	depacketizer.push(builder.packet(9000, false, stapA(sps, PPS)));
+	depacketizer.push(builder.packet(9000, true, IDR));
+	depacketizer.push(builder.packet(12000, true, IDR));
+	assert (depacketizer.sps() == sps);
+	assert (collector[3].data == annexB(sps) + annexB(PPS) + annexB(IDR));
+	assert (collector[4].data == annexB(sps) + annexB(PPS) + annexB(IDR));
+
+	try
+	{
+		RTPH264Depacketizer interleaved(collector, RTPPayloadFormat(96, "H264", 90000, 1, "packetization-mode=2"));
+		fail ("the interleaved mode must be refused");
+	}
+	catch (Poco::NotImplementedException&)
+	{
+	}
+}
+
+
+void RTPH264DepacketizerTest::testLostFragment()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector);
+
+	// the middle of the second NAL unit is lost, so only
+	// the first one is left of the access unit
+	std::string slice = SLICE + "\x04\x05\x06";
+	depacketizer.push(builder.packet(0, false, SLICE));
+	depacketizer.push(builder.packet(0, false, fuA(slice, 0, 2)));
+	builder.skip();
+	depacketizer.push(builder.packet(0, true, fuA(slice, 4, 6)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == annexB(SLICE));
+	assert (!collector[0].complete);
+	assert (depacketizer.statistics().droppedPackets == 1);
+	assert (depacketizer.statistics().incompleteUnits == 1);
+
+	// a fragment that does not end before the next NAL unit is dropped
+	depacketizer.push(builder.packet(3000, false, fuA(slice, 0, 2)));
+	depacketizer.push(builder.packet(3000, true, SLICE));
+	assert (collector.count() == 2);
+	assert (collector[1].data == annexB(SLICE));
+	assert (!collector[1].complete);
+}
+
+
+void RTPH264DepacketizerTest::testLossBeforeUnit()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector);
+
+	// the loss may have taken the end of the first unit, but not
+	// the start of the second, which begins with the first macroblock
+	depacketizer.push(builder.packet(0, false, SLICE));
+	builder.skip();
+	depacketizer.push(builder.packet(3000, true, SLICE));
+	assert (collector.count() == 2);
+	assert (!collector[0].complete);
+	assert (collector[1].complete);
+
+	// a slice that does not start the picture
+	builder.skip();
+	depacketizer.push(builder.packet(6000, true, SLICE_CONT));
+	assert (collector.count() == 3);
+	assert (!collector[2].complete);
+
+	// a STAP-A starting with a SPS, and the first fragment of an IDR
+	builder.skip(2);
+	depacketizer.push(builder.packet(9000, true, stapA(SPS, PPS)));
+	builder.skip();
+	depacketizer.push(builder.packet(12000, false, fuA(IDR, 0, 2)));
+	depacketizer.push(builder.packet(12000, true, fuA(IDR, 2, 4)));
+	assert (collector.count() == 5);
+	assert (collector[3].complete);
+	assert (collector[4].complete);
+	assert (collector[4].data == annexB(SPS) + annexB(PPS) + annexB(IDR));
+}
+
+
+void RTPH264DepacketizerTest::testTimestampChange()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector);
+
+	// without marker bits, a new timestamp ends the unit; the
+	// sequence numbers wrap around on the way
+	for (Poco::UInt32 i = 0; i < 40; ++i)
+	{
+		depacketizer.push(builder.packet(i * 3000, false, SLICE));
+	}
+	assert (collector.count() == 39);
+	depacketizer.flush();
+	assert (collector.count() == 40);
+	for (std::size_t i = 0; i < collector.count(); ++i)
+	{
+		assert (collector[i].timestamp == i * 3000);
+		assert (collector[i].complete);
+	}
+	assert (depacketizer.statistics().incompleteUnits == 0);
+
+	depacketizer.flush();
+	assert (collector.count() == 40);
+
+	// reset() forgets the sequence number
+	depacketizer.push(builder.packet(200000, false, SLICE));
+	depacketizer.reset();
+	builder.skip(100);
+	depacketizer.push(builder.packet(203000, true, SLICE_CONT));
+	assert (collector.count() == 41);
+	assert (collector[40].complete);
+	assert (collector[40].timestamp == 203000);
+}
+
+
+void RTPH264DepacketizerTest::testMalformed()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH264Depacketizer depacketizer(collector);
+
+	// an empty payload, a STAP-A whose second unit exceeds the
+	// packet, and STAP-B, which needs the interleaved mode
+	std::string stap = stapA(SPS, PPS);
+	stap[stap.size() - PPS.size() - 1] = (char) (PPS.size() + 1);
+	depacketizer.push(builder.packet(0, false, ""));
+	depacketizer.push(builder.packet(0, false, stap));
+	depacketizer.push(builder.packet(0, true, std::string("\x19\x00\x01\x02\x00\x01\x41", 7)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == annexB(SPS));
+	assert (!collector[0].complete);
+	assert (depacketizer.statistics().droppedPackets == 3);
+}
+
+
+void RTPH264DepacketizerTest::setUp()
+{
+}
+
+
+void RTPH264DepacketizerTest::tearDown()
+{
+}
+
+
+CppUnit::Test* RTPH264DepacketizerTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTPH264DepacketizerTest");
+
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testSingleNALUnits);
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testAggregationAndFragmentation);
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testAVCC);
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testParameterSetInsertion);
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testLostFragment);
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testLossBeforeUnit);
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testTimestampChange);
+	CppUnit_addTest(pSuite, RTPH264DepacketizerTest, testMalformed);
+
+	return pSuite;
+}
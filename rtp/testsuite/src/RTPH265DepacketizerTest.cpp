@@ -0,0 +1,276 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTP H.265 Depacketizer Test
+//
+//	description:
+//		unit tests of RTPH265Depacketizer
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPH265DepacketizerTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+#include "RTPH265Depacketizer.h"
+#include "RTPPayloadFormat.h"
+
+#include "AccessUnitCollector.h"
+#include "PacketBuilder.h"
+
+
+using RTP::RTPH265Depacketizer;
+using RTP::RTPPayloadFormat;
+
+
+namespace
+{
+	// NAL units with two byte headers (RFC 7798, 1.1.4): parameter
+	// sets, an IDR_W_RADL slice and two TRAIL_R slices, the first
+	// with first_slice_segment_in_pic_flag set
+	const std::string VPS("\x40\x01\x0c\x01\xff\xff", 6);
+	const std::string SPS("\x42\x01\x01\x01", 4);
+	const std::string PPS("\x44\x01\xc0", 3);
+	const std::string IDR("\x26\x01\xaf\x08\x40\x5a", 6);
+	const std::string TRAIL("\x02\x01\xd0\x11", 4);
+	const std::string TRAIL_CONT("\x02\x01\x50\x11", 4);
+
+	std::string annexB(const std::string& nal)
+	{
+		return std::string("\0\0\0\1", 4) + nal;
+	}
+
+	std::string hvcc(const std::string& nal)
+	{
+		std::string length(4, '\0');
+		length[3] = (char) nal.size();
+		return length + nal;
+	}
+
+	std::string size16(const std::string& nal)
+	{
+		std::string size(1, (char) (nal.size() >> 8));
+		return size + (char) nal.size();
+	}
+
+	std::string ap(const std::string& first, const std::string& second, const std::string& third)
+	{
+		return std::string("\x60\x01", 2) + size16(first) + first + size16(second) + second + size16(third) + third;
+	}
+
+	std::string fu(const std::string& nal, std::size_t begin, std::size_t end, const std::string& donl = "")
+		/// Returns the FU packet of the bytes [begin, end) of the
+		/// payload of nal, after its header.
+	{
+		std::string payload;
+		payload += (char) ((nal[0] & 0x81) | (RTPH265Depacketizer::NAL_FU << 1));
+		payload += nal[1];
+		payload += (char) ((begin == 0 ? 0x80 : 0) | (end == nal.size() - 2 ? 0x40 : 0) | ((nal[0] >> 1) & 0x3f));
+		if (begin == 0) payload += donl;
+		payload += nal.substr(2 + begin, end - begin);
+		return payload;
+	}
+}
+
+
+RTPH265DepacketizerTest::RTPH265DepacketizerTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+RTPH265DepacketizerTest::~RTPH265DepacketizerTest()
+{
+}
+
+
+void RTPH265DepacketizerTest::testAggregationPacket()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH265Depacketizer depacketizer(collector);
+	assert (!depacketizer.donl());
+
+	depacketizer.push(builder.packet(0, false, ap(VPS, SPS, PPS)));
+	depacketizer.push(builder.packet(0, true, IDR));
+	depacketizer.push(builder.packet(3000, true, TRAIL));
+
+	assert (collector.count() == 2);
+	assert (collector[0].data == annexB(VPS) + annexB(SPS) + annexB(PPS) + annexB(IDR));
+	assert (collector[0].keyFrame);
+	assert (collector[0].complete);
+	assert (collector[1].data == annexB(TRAIL));
+	assert (!collector[1].keyFrame);
+	assert (depacketizer.vps() == VPS);
+	assert (depacketizer.sps() == SPS);
+	assert (depacketizer.pps() == PPS);
+}
+
+
+void RTPH265DepacketizerTest::testFragmentationUnit()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH265Depacketizer depacketizer(collector, RTPH265Depacketizer::FORMAT_HVCC);
+
+	depacketizer.push(builder.packet(0, false, ap(VPS, SPS, PPS)));
+	depacketizer.push(builder.packet(0, false, fu(IDR, 0, 1)));
+	depacketizer.push(builder.packet(0, false, fu(IDR, 1, 3)));
+	depacketizer.push(builder.packet(0, true, fu(IDR, 3, 4)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == hvcc(VPS) + hvcc(SPS) + hvcc(PPS) + hvcc(IDR));
+	assert (collector[0].keyFrame);
+	assert (collector[0].complete);
+	assert (depacketizer.statistics().droppedPackets == 0);
+}
+
+
+void RTPH265DepacketizerTest::testParameterSetInsertion()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH265Depacketizer depacketizer(collector, RTPPayloadFormat(96, "H265", 90000, 1, "sprop-vps=QAEMAf//; sprop-sps=QgEBAQ==; sprop-pps=RAHA"));
+	assert (depacketizer.vps() == VPS);
+	assert (depacketizer.sps() == SPS);
+	assert (depacketizer.pps() == PPS);
+
+	depacketizer.push(builder.packet(0, true, IDR));
+	depacketizer.push(builder.packet(3000, true, TRAIL));
+	depacketizer.setInsertParameterSets(false);
+	depacketizer.push(builder.packet(6000, true, IDR));
+
+	assert (collector.count() == 3);
+	assert (collector[0].data == annexB(VPS) + annexB(SPS) + annexB(PPS) + annexB(IDR));
+	assert (collector[1].data == annexB(TRAIL));
+	assert (collector[2].data == annexB(IDR));
+}
+
+
+void RTPH265DepacketizerTest::testDONL()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH265Depacketizer depacketizer(collector, RTPPayloadFormat(96, "H265", 90000, 1, "sprop-max-don-diff=2"));
+	assert (depacketizer.donl());
+
+	// the DONL of a single NAL unit packet and of a first fragment
+	// sits between the header and the payload; in an AP, the first
+	// unit has a DONL and the others a DOND
+	std::string donl("\x00\x07", 2);
+	std::string payload = PPS.substr(0, 2) + donl + PPS.substr(2);
+	depacketizer.push(builder.packet(0, false, std::string("\x60\x01", 2) + donl + size16(VPS) + VPS + '\x00' + size16(SPS) + SPS));
+	depacketizer.push(builder.packet(0, false, payload));
+	depacketizer.push(builder.packet(0, false, fu(IDR, 0, 2, donl)));
+	depacketizer.push(builder.packet(0, true, fu(IDR, 2, 4)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == annexB(VPS) + annexB(SPS) + annexB(PPS) + annexB(IDR));
+	assert (collector[0].keyFrame);
+	assert (collector[0].complete);
+	assert (depacketizer.pps() == PPS);
+}
+
+
+void RTPH265DepacketizerTest::testLostFragment()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH265Depacketizer depacketizer(collector);
+
+	std::string trail = TRAIL + "\x12\x13\x14";
+	depacketizer.push(builder.packet(0, false, TRAIL));
+	depacketizer.push(builder.packet(0, false, fu(trail, 0, 2)));
+	builder.skip();
+	depacketizer.push(builder.packet(0, true, fu(trail, 4, 5)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == annexB(TRAIL));
+	assert (!collector[0].complete);
+	assert (depacketizer.statistics().droppedPackets == 1);
+
+	// after a loss, a unit is complete if it starts with the first slice
+	builder.skip();
+	depacketizer.push(builder.packet(3000, true, trail));
+	builder.skip();
+	depacketizer.push(builder.packet(6000, true, TRAIL_CONT));
+	assert (collector.count() == 3);
+	assert (collector[1].data == annexB(trail));
+	assert (collector[1].complete);
+	assert (!collector[2].complete);
+}
+
+
+void RTPH265DepacketizerTest::testMalformed()
+{
+	PacketBuilder builder;
+	AccessUnitCollector collector;
+	RTPH265Depacketizer depacketizer(collector);
+
+	// a payload header alone, a PACI packet, and an AP whose
+	// last unit is shorter than a NAL unit header
+	depacketizer.push(builder.packet(0, false, std::string("\x02\x01", 2)));
+	depacketizer.push(builder.packet(0, false, std::string("\x64\x01\x00\x00", 4) + TRAIL));
+	depacketizer.push(builder.packet(0, true, std::string("\x60\x01", 2) + size16(TRAIL) + TRAIL + std::string("\x00\x01\x02", 3)));
+
+	assert (collector.count() == 1);
+	assert (collector[0].data == annexB(TRAIL));
+	assert (!collector[0].complete);
+	assert (depacketizer.statistics().droppedPackets == 3);
+}
+
+
+void RTPH265DepacketizerTest::setUp()
+{
+}
+
+
+void RTPH265DepacketizerTest::tearDown()
+{
+}
+
+
+CppUnit::Test* RTPH265DepacketizerTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTPH265DepacketizerTest");
+
+	CppUnit_addTest(pSuite, RTPH265DepacketizerTest, testAggregationPacket);
+	CppUnit_addTest(pSuite, RTPH265DepacketizerTest, testFragmentationUnit);
+	CppUnit_addTest(pSuite, RTPH265DepacketizerTest, testParameterSetInsertion);
+	CppUnit_addTest(pSuite, RTPH265DepacketizerTest, testDONL);
+	CppUnit_addTest(pSuite, RTPH265DepacketizerTest, testLostFragment);
+	CppUnit_addTest(pSuite, RTPH265DepacketizerTest, testMalformed);
+
+	return pSuite;
+}
@@ -0,0 +1,276 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTP Packet Test
+//
+//	description:
+//		unit tests of RTPPacket parsing and validation
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPPacketTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+#include <cstring>
+
+#include "RTPPacket.h"
+
+
+using Poco::UInt8;
+
+using RTP::RTPPacket;
+
+
+namespace
+{
+	const UInt8 FIXED_HEADER[] =
+	{
+		0x80, 0xe0, 0x12, 0x34,  // V=2, M=1, PT=96, sequence number
+		0xde, 0xca, 0xfb, 0xad,  // timestamp
+		0xca, 0xfe, 0xba, 0xbe   // SSRC
+	};
+}
+
+
+RTPPacketTest::RTPPacketTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+RTPPacketTest::~RTPPacketTest()
+{
+}
+
+
+void RTPPacketTest::testFixedHeader()
+{
+	UInt8 buffer[16];
+	std::memcpy(buffer, FIXED_HEADER, sizeof(FIXED_HEADER));
+	std::memcpy(buffer + 12, "\x01\x02\x03\x04", 4);
+
+	RTPPacket packet;
+	assert (!packet.valid());
+	assert (packet.parse(buffer, sizeof(buffer)));
+	assert (packet.valid());
+	assert (packet.data() == buffer);
+	assert (packet.size() == sizeof(buffer));
+	assert (packet.version() == 2);
+	assert (!packet.padding());
+	assert (!packet.extension());
+	assert (packet.csrcCount() == 0);
+	assert (packet.marker());
+	assert (packet.payloadType() == 96);
+	assert (packet.sequenceNumber() == 0x1234);
+	assert (packet.timestamp() == 0xdecafbad);
+	assert (packet.ssrc() == 0xcafebabe);
+	assert (packet.extensionSize() == 0);
+	assert (packet.payload() == buffer + 12);
+	assert (packet.payloadSize() == 4);
+	assert (packet.paddingSize() == 0);
+
+	// a packet without payload is valid
+	RTPPacket empty(buffer, 12);
+	assert (empty.valid());
+	assert (empty.payloadSize() == 0);
+}
+
+
+void RTPPacketTest::testCSRCAndExtension()
+{
+	UInt8 buffer[12 + 8 + 8 + 3];
+	std::memcpy(buffer, FIXED_HEADER, sizeof(FIXED_HEADER));
+	buffer[0] = 0x92;  // X=1, CC=2
+	buffer[1] = 0x08;  // M=0, PT=8
+	std::memcpy(buffer + 12, "\x00\x00\x00\x01\xff\xff\xff\xfe", 8);
+	std::memcpy(buffer + 20, "\xbe\xde\x00\x01\x10\xaa\x00\x00", 8);
+	std::memcpy(buffer + 28, "abc", 3);
+
+	RTPPacket packet(buffer, sizeof(buffer));
+	assert (packet.valid());
+	assert (!packet.marker());
+	assert (packet.payloadType() == 8);
+	assert (packet.csrcCount() == 2);
+	assert (packet.csrc(0) == 1);
+	assert (packet.csrc(1) == 0xfffffffe);
+	assert (packet.extension());
+	assert (packet.extensionProfile() == 0xbede);
+	assert (packet.extensionSize() == 4);
+	assert (packet.extensionData() == buffer + 24);
+	assert (packet.extensionData()[1] == 0xaa);
+	assert (packet.payload() == buffer + 28);
+	assert (packet.payloadSize() == 3);
+}
+
+
+void RTPPacketTest::testPadding()
+{
+	UInt8 buffer[12 + 5 + 3];
+	std::memcpy(buffer, FIXED_HEADER, sizeof(FIXED_HEADER));
+	buffer[0] |= 0x20;
+	std::memcpy(buffer + 12, "hello\x00\x00\x03", 8);
+
+	RTPPacket packet(buffer, sizeof(buffer));
+	assert (packet.valid());
+	assert (packet.padding());
+	assert (packet.payloadSize() == 5);
+	assert (packet.paddingSize() == 3);
+
+	// the padding may take up the whole payload
+	buffer[sizeof(buffer) - 1] = 8;
+	assert (packet.parse(buffer, sizeof(buffer)));
+	assert (packet.payloadSize() == 0);
+	assert (packet.paddingSize() == 8);
+}
+
+
+void RTPPacketTest::testValidate()
+{
+	UInt8 buffer[64];
+	std::memset(buffer, 0, sizeof(buffer));
+	std::memcpy(buffer, FIXED_HEADER, sizeof(FIXED_HEADER));
+	assert (RTPPacket::validate(buffer, 12) == RTPPacket::RTP_VALID);
+	assert (RTPPacket::validate(buffer, 11) == RTPPacket::RTP_TRUNCATED_HEADER);
+	assert (RTPPacket::validate(buffer, 0) == RTPPacket::RTP_TRUNCATED_HEADER);
+
+	buffer[0] = 0x40;
+	assert (RTPPacket::validate(buffer, 16) == RTPPacket::RTP_BAD_VERSION);
+	buffer[0] = 0xc0;
+	assert (RTPPacket::validate(buffer, 16) == RTPPacket::RTP_BAD_VERSION);
+
+	buffer[0] = 0x8f;  // 15 CSRCs need 72 bytes
+	assert (RTPPacket::validate(buffer, 64) == RTPPacket::RTP_TRUNCATED_CSRC);
+	buffer[0] = 0x81;
+	assert (RTPPacket::validate(buffer, 15) == RTPPacket::RTP_TRUNCATED_CSRC);
+	assert (RTPPacket::validate(buffer, 16) == RTPPacket::RTP_VALID);
+
+	// the extension header, then its length in words
+	buffer[0] = 0x90;
+	assert (RTPPacket::validate(buffer, 15) == RTPPacket::RTP_TRUNCATED_EXTENSION);
+	buffer[14] = 0;
+	buffer[15] = 2;
+	assert (RTPPacket::validate(buffer, 23) == RTPPacket::RTP_TRUNCATED_EXTENSION);
+	assert (RTPPacket::validate(buffer, 24) == RTPPacket::RTP_VALID);
+
+	// a zero padding count, and one exceeding the payload
+	buffer[0] = 0xa0;
+	buffer[19] = 0;
+	assert (RTPPacket::validate(buffer, 20) == RTPPacket::RTP_BAD_PADDING);
+	buffer[19] = 9;
+	assert (RTPPacket::validate(buffer, 20) == RTPPacket::RTP_BAD_PADDING);
+	buffer[19] = 8;
+	assert (RTPPacket::validate(buffer, 20) == RTPPacket::RTP_VALID);
+
+	buffer[19] = 0;
+	RTPPacket packet(buffer, 20);
+	assert (!packet.valid());
+	assert (packet.payloadSize() == 0);
+	assert (packet.paddingSize() == 0);
+}
+
+
+void RTPPacketTest::testParseMatchesValidate()
+{
+	// parse() folds the checks of validate() into a few
+	// branches, so both must agree on any buffer
+	UInt8 buffer[48];
+	Poco::UInt32 state = 12345;
+	for (int i = 0; i < 20000; ++i)
+	{
+		for (std::size_t j = 0; j < sizeof(buffer); ++j)
+		{
+			state = state * 1103515245 + 12345;
+			buffer[j] = (UInt8) (state >> 16);
+		}
+		// mostly version 2, with short extensions, so that the
+		// later checks are reached
+		if (i % 8) buffer[0] = (UInt8) (0x80 | (buffer[0] & 0x3f));
+		if (i % 4) buffer[(12 + 4 * (buffer[0] & 0x0f) + 2) % sizeof(buffer)] = 0;
+
+		std::size_t length = (state >> 8) % (sizeof(buffer) + 1);
+		RTPPacket packet;
+		bool valid = packet.parse(buffer, length);
+		assert (valid == (RTPPacket::validate(buffer, length) == RTPPacket::RTP_VALID));
+		if (valid)
+		{
+			assert (packet.payload() + packet.payloadSize() + packet.paddingSize() == buffer + length);
+		}
+	}
+}
+
+
+void RTPPacketTest::testParseBatch()
+{
+	UInt8 good[12];
+	UInt8 bad[12];
+	std::memcpy(good, FIXED_HEADER, sizeof(FIXED_HEADER));
+	std::memcpy(bad, FIXED_HEADER, sizeof(FIXED_HEADER));
+	bad[0] = 0x00;
+
+	const void* buffers[4] = { good, bad, good, good };
+	std::size_t lengths[4] = { 12, 12, 11, 12 };
+	RTPPacket packets[4];
+	assert (RTPPacket::parseBatch(buffers, lengths, 4, packets) == 2);
+	assert (packets[0].valid());
+	assert (!packets[1].valid());
+	assert (!packets[2].valid());
+	assert (packets[3].valid());
+	assert (packets[3].ssrc() == 0xcafebabe);
+}
+
+
+void RTPPacketTest::setUp()
+{
+}
+
+
+void RTPPacketTest::tearDown()
+{
+}
+
+
+CppUnit::Test* RTPPacketTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTPPacketTest");
+
+	CppUnit_addTest(pSuite, RTPPacketTest, testFixedHeader);
+	CppUnit_addTest(pSuite, RTPPacketTest, testCSRCAndExtension);
+	CppUnit_addTest(pSuite, RTPPacketTest, testPadding);
+	CppUnit_addTest(pSuite, RTPPacketTest, testValidate);
+	CppUnit_addTest(pSuite, RTPPacketTest, testParseMatchesValidate);
+	CppUnit_addTest(pSuite, RTPPacketTest, testParseBatch);
+
+	return pSuite;
+}
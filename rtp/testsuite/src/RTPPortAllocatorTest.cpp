@@ -0,0 +1,307 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTP Port Allocator Test
+//
+//	description:
+//		unit tests of RTPPortAllocator
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPPortAllocatorTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+#include "Poco/Exception.h"
+#include "Poco/Net/DatagramSocket.h"
+#include "Poco/Net/IPAddress.h"
+#include "Poco/Net/SocketAddress.h"
+
+#include "PortRange.h"
+
+#include "RTPPortAllocator.h"
+
+#include <vector>
+
+
+using Poco::Net::DatagramSocket;
+using Poco::Net::IPAddress;
+using Poco::Net::SocketAddress;
+
+using SDP::PortRange;
+
+using RTP::RTPPortAllocator;
+
+
+namespace
+{
+	// below the ephemeral ports, so that other sockets
+	// of the system do not take the ports of the tests
+	const unsigned short FIRST_PORT = 29000;
+
+	const IPAddress LOOPBACK("127.0.0.1");
+}
+
+
+RTPPortAllocatorTest::RTPPortAllocatorTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+RTPPortAllocatorTest::~RTPPortAllocatorTest()
+{
+}
+
+
+void RTPPortAllocatorTest::testRange()
+{
+	RTPPortAllocator allocator(PortRange(FIRST_PORT, 64), 0, LOOPBACK);
+	assert (allocator.firstPort() == FIRST_PORT);
+	assert (allocator.capacity() == 32);
+	assert (allocator.available() == 32);
+	assert (allocator.reserved() == 0);
+
+	// the first port is rounded up to an even number
+	RTPPortAllocator odd(PortRange(FIRST_PORT + 1, 6), 0, LOOPBACK);
+	assert (odd.firstPort() == FIRST_PORT + 2);
+	assert (odd.capacity() == 2);
+
+	try
+	{
+		RTPPortAllocator none(PortRange(FIRST_PORT + 1, 2), 0, LOOPBACK);
+		fail ("no pair in the range");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+}
+
+
+void RTPPortAllocatorTest::testAcquire()
+{
+	RTPPortAllocator allocator(PortRange(FIRST_PORT, 8), 0, LOOPBACK);
+
+	RTPPortAllocator::Pair first = allocator.acquire();
+	assert (first.rtpPort == FIRST_PORT);
+	assert (first.rtp.address().port() == FIRST_PORT);
+	assert (first.rtcp.address().port() == FIRST_PORT + 1);
+
+	RTPPortAllocator::Pair second = allocator.acquire();
+	assert (second.rtpPort == FIRST_PORT + 2);
+	assert (second.rtp.address().port() == FIRST_PORT + 2);
+	assert (second.rtcp.address().port() == FIRST_PORT + 3);
+	assert (allocator.available() == 2);
+
+	// the ports of an acquired pair are bound
+	try
+	{
+		DatagramSocket socket(SocketAddress(LOOPBACK, FIRST_PORT + 1));
+		fail ("the RTCP port is bound");
+	}
+	catch (Poco::IOException&)
+	{
+	}
+
+	allocator.acquire();
+	allocator.acquire();
+	assert (allocator.available() == 0);
+	try
+	{
+		allocator.acquire();
+		fail ("all pairs are acquired");
+	}
+	catch (Poco::NotFoundException&)
+	{
+	}
+
+	allocator.release(first);
+	allocator.release(second);
+	assert (allocator.available() == 2);
+}
+
+
+void RTPPortAllocatorTest::testReleaseOrder()
+{
+	RTPPortAllocator allocator(PortRange(FIRST_PORT, 16), 0, LOOPBACK);
+
+	// a released pair is handed out again only after
+	// the search has gone round the rest of the range
+	RTPPortAllocator::Pair first = allocator.acquire();
+	allocator.acquire();
+	allocator.release(first);
+	assert (allocator.available() == 7);
+
+	std::vector<RTPPortAllocator::Pair> pairs;
+	for (int i = 2; i < 8; ++i)
+	{
+		pairs.push_back(allocator.acquire());
+		assert (pairs.back().rtpPort == FIRST_PORT + 2 * i);
+	}
+	RTPPortAllocator::Pair again = allocator.acquire();
+	assert (again.rtpPort == FIRST_PORT);
+	assert (allocator.available() == 0);
+}
+
+
+void RTPPortAllocatorTest::testInvalidRelease()
+{
+	RTPPortAllocator allocator(PortRange(FIRST_PORT, 8), 1, LOOPBACK);
+
+	RTPPortAllocator::Pair pair = allocator.acquire();
+	allocator.release(pair);
+	try
+	{
+		allocator.release(pair);
+		fail ("released twice");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+
+	RTPPortAllocator::Pair foreign;
+	foreign.rtpPort = FIRST_PORT + 8;
+	try
+	{
+		allocator.release(foreign);
+		fail ("beyond the range");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+
+	foreign.rtpPort = FIRST_PORT + 3;
+	try
+	{
+		allocator.release(foreign);
+		fail ("an odd port");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+
+	// nor can a pair bound in advance be released
+	foreign.rtpPort = FIRST_PORT + 2;
+	try
+	{
+		allocator.release(foreign);
+		fail ("not acquired");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+	assert (allocator.available() == 4);
+	assert (allocator.reserved() == 1);
+}
+
+
+void RTPPortAllocatorTest::testReserve()
+{
+	RTPPortAllocator allocator(PortRange(FIRST_PORT, 16), 2, LOOPBACK);
+	assert (allocator.reserve() == 2);
+	assert (allocator.reserved() == 2);
+	assert (allocator.available() == 8);
+
+	// pairs are taken from the reserve, which is topped
+	// up by refill(), or when a pair is released
+	RTPPortAllocator::Pair first = allocator.acquire();
+	assert (first.rtpPort == FIRST_PORT);
+	RTPPortAllocator::Pair second = allocator.acquire();
+	assert (second.rtpPort == FIRST_PORT + 2);
+	assert (allocator.reserved() == 0);
+	assert (allocator.available() == 6);
+
+	allocator.refill();
+	assert (allocator.reserved() == 2);
+	assert (allocator.available() == 6);
+
+	allocator.release(first);
+	allocator.release(second);
+	assert (allocator.reserved() == 2);
+	assert (allocator.available() == 8);
+
+	RTPPortAllocator::Pair third = allocator.acquire();
+	assert (third.rtpPort == FIRST_PORT + 4);
+
+	// the reserve cannot exceed the range
+	RTPPortAllocator small(PortRange(FIRST_PORT + 100, 4), 10, LOOPBACK);
+	assert (small.reserve() == 2);
+	assert (small.reserved() == 2);
+}
+
+
+void RTPPortAllocatorTest::testBusyPort()
+{
+	// another socket holds the RTCP port of the second pair
+	DatagramSocket busy(SocketAddress(LOOPBACK, FIRST_PORT + 3));
+
+	RTPPortAllocator allocator(PortRange(FIRST_PORT, 8), 0, LOOPBACK);
+	RTPPortAllocator::Pair first = allocator.acquire();
+	assert (first.rtpPort == FIRST_PORT);
+	RTPPortAllocator::Pair next = allocator.acquire();
+	assert (next.rtpPort == FIRST_PORT + 4);
+
+	// the skipped pair stays free, and is tried again
+	// when the search comes round to it
+	assert (allocator.available() == 2);
+	busy.close();
+	allocator.acquire();
+	RTPPortAllocator::Pair skipped = allocator.acquire();
+	assert (skipped.rtpPort == FIRST_PORT + 2);
+}
+
+
+void RTPPortAllocatorTest::setUp()
+{
+}
+
+
+void RTPPortAllocatorTest::tearDown()
+{
+}
+
+
+CppUnit::Test* RTPPortAllocatorTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTPPortAllocatorTest");
+
+	CppUnit_addTest(pSuite, RTPPortAllocatorTest, testRange);
+	CppUnit_addTest(pSuite, RTPPortAllocatorTest, testAcquire);
+	CppUnit_addTest(pSuite, RTPPortAllocatorTest, testReleaseOrder);
+	CppUnit_addTest(pSuite, RTPPortAllocatorTest, testInvalidRelease);
+	CppUnit_addTest(pSuite, RTPPortAllocatorTest, testReserve);
+	CppUnit_addTest(pSuite, RTPPortAllocatorTest, testBusyPort);
+
+	return pSuite;
+}
@@ -0,0 +1,66 @@
+/*****************************************************************************
+//	RTP Library Test Suite
+//
+//	RTP Test Suite
+//
+//	description:
+//		the test suite of the RTP library
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTPTestSuite.h"
+#include "RTPPacketTest.h"
+#include "RTPH264DepacketizerTest.h"
+#include "RTPH265DepacketizerTest.h"
+#include "RTPAACDepacketizerTest.h"
+#include "RTCPSessionTest.h"
+#include "RTPCryptoContextTest.h"
+#include "RTPPortAllocatorTest.h"
+
+
+CppUnit::Test* RTPTestSuite::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("RTPTestSuite");
+
+	pSuite->addTest(RTPPacketTest::suite());
+	pSuite->addTest(RTPH264DepacketizerTest::suite());
+	pSuite->addTest(RTPH265DepacketizerTest::suite());
+	pSuite->addTest(RTPAACDepacketizerTest::suite());
+	pSuite->addTest(RTCPSessionTest::suite());
+	pSuite->addTest(RTPCryptoContextTest::suite());
+	pSuite->addTest(RTPPortAllocatorTest::suite());
+
+	return pSuite;
+}
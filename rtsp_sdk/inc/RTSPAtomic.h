@@ -0,0 +1,318 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Atomic Class
+//
+//	description:
+//		integers and pointers shared between threads, portable to
+//		compilers without <atomic>
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_ATOMIC__H__
+#define __RTSP_ATOMIC__H__
+
+
+#include "Poco/Foundation.h"
+
+#include "rtsp_sdk.h"
+
+#if defined(RTSP_SDK_HAVE_CXX11)
+	#include <atomic>
+#else
+	#include "Poco/Mutex.h"
+#endif
+
+
+namespace RTSP {
+
+
+template <class T>
+class RTSPAtomic
+	/// RTSPAtomic holds an integer or a pointer that is read and
+	/// modified by any number of threads.
+	///
+	/// value(), set(), add(), raise() and lower() only guarantee
+	/// that each access is atomic, for counters and statistics
+	/// that order nothing else. load(), store(), increment(),
+	/// decrement() and compareExchange() are sequentially
+	/// consistent, for publishing data and for reference and
+	/// reader counts.
+	///
+	/// With a C++11 compiler, RTSPAtomic is a std::atomic. Older
+	/// compilers, like Visual C++ 2005, have no atomics in their
+	/// library; every operation takes a mutex there.
+{
+public:
+	explicit RTSPAtomic(T value = T());
+		/// Creates the RTSPAtomic holding value.
+
+	T value() const;
+		/// Returns the value.
+
+	void set(T value);
+		/// Replaces the value.
+
+	T add(T n);
+		/// Adds n to the value and returns the previous value.
+
+	void raise(T value);
+		/// Replaces the value by value if it is greater.
+
+	void lower(T value);
+		/// Replaces the value by value if it is smaller.
+
+	T load() const;
+		/// Returns the value.
+
+	void store(T value);
+		/// Replaces the value.
+
+	T increment();
+		/// Adds one to the value and returns the new value.
+
+	T decrement();
+		/// Subtracts one from the value and returns the new value.
+
+	bool compareExchange(T& expected, T desired);
+		/// Replaces the value by desired if it equals expected and
+		/// returns true. Otherwise stores the value into expected
+		/// and returns false.
+
+private:
+	RTSPAtomic(const RTSPAtomic&);
+	RTSPAtomic& operator = (const RTSPAtomic&);
+
+#if defined(RTSP_SDK_HAVE_CXX11)
+	std::atomic<T>          _value;
+#else
+	T                       _value;
+	mutable Poco::FastMutex _mutex;
+#endif
+};
+
+
+//
+// inlines
+//
+#if defined(RTSP_SDK_HAVE_CXX11)
+
+
+template <class T>
+inline RTSPAtomic<T>::RTSPAtomic(T value):
+	_value(value)
+{
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::value() const
+{
+	return _value.load(std::memory_order_relaxed);
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::set(T value)
+{
+	_value.store(value, std::memory_order_relaxed);
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::add(T n)
+{
+	return _value.fetch_add(n, std::memory_order_relaxed);
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::raise(T value)
+{
+	T current = _value.load(std::memory_order_relaxed);
+	while (value > current && !_value.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::lower(T value)
+{
+	T current = _value.load(std::memory_order_relaxed);
+	while (value < current && !_value.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::load() const
+{
+	return _value.load();
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::store(T value)
+{
+	_value.store(value);
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::increment()
+{
+	return ++_value;
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::decrement()
+{
+	return --_value;
+}
+
+
+template <class T>
+inline bool RTSPAtomic<T>::compareExchange(T& expected, T desired)
+{
+	return _value.compare_exchange_strong(expected, desired);
+}
+
+
+#else // RTSP_SDK_HAVE_CXX11
+
+
+template <class T>
+inline RTSPAtomic<T>::RTSPAtomic(T value):
+	_value(value)
+{
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::value() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return _value;
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::set(T value)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_value = value;
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::add(T n)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	T previous = _value;
+	_value += n;
+	return previous;
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::raise(T value)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	if (value > _value) _value = value;
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::lower(T value)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	if (value < _value) _value = value;
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::load() const
+{
+	return value();
+}
+
+
+template <class T>
+inline void RTSPAtomic<T>::store(T value)
+{
+	set(value);
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::increment()
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return ++_value;
+}
+
+
+template <class T>
+inline T RTSPAtomic<T>::decrement()
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return --_value;
+}
+
+
+template <class T>
+inline bool RTSPAtomic<T>::compareExchange(T& expected, T desired)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	if (_value == expected)
+	{
+		_value = desired;
+		return true;
+	}
+	expected = _value;
+	return false;
+}
+
+
+#endif // RTSP_SDK_HAVE_CXX11
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_ATOMIC__H__
@@ -46,11 +46,13 @@
 
 #include "Poco/Net/Net.h"
 #include "Poco/Net/SocketAddress.h"
+#include "Poco/Clock.h"
 #include <istream>
 #include <ostream>
 
 #include "rtsp_sdk.h"
 #include "RTSPSession.h"
+#include "RTSPLatencyRecorder.h"
 
 namespace RTSP {
 
@@ -120,13 +122,13 @@ public:
 	Poco::UInt16 getPort() const;
 		/// Returns the port number of the target RTSP server.
 
-	void setProxy(const std::string& host, Poco::UInt16 port = RTSPSession::RTSP_PORT);
+	virtual void setProxy(const std::string& host, Poco::UInt16 port = RTSPSession::RTSP_PORT);
 		/// Sets the proxy host name and port number.
 		
-	void setProxyHost(const std::string& host);
+	virtual void setProxyHost(const std::string& host);
 		/// Sets the host name of the proxy server.
 		
-	void setProxyPort(Poco::UInt16 port);
+	virtual void setProxyPort(Poco::UInt16 port);
 		/// Sets the port number of the proxy server.
 		
 	const std::string& getProxyHost() const;
@@ -141,6 +143,14 @@ public:
 	const Poco::Timespan& getKeepAliveTimeout() const;
 		/// Returns the connection timeout for HTTP connections.
 */		
+	void open();
+		/// Connects to the server, or the proxy if one is set,
+		/// unless the session is already connected.
+		///
+		/// sendRequest() connects implicitly; calling open() first
+		/// allows connection errors and the time taken to connect
+		/// to be told apart from those of the request.
+
 	virtual std::ostream& sendRequest(RTSPRequest& request);
 		/// Sends the header for the given RTSP request to
 		/// the server.
@@ -158,11 +168,27 @@ public:
 		/// the response body. The stream is valid until
 		/// sendRequest() is called or the session is
 		/// destroyed.
+		///
+		/// The time from sendRequest() until the response header
+		/// has been read, less the time taken to connect, is
+		/// recorded in the session's RTSPLatencyRecorder. An
+		/// exchange that fails is counted there instead.
+
+	void setLatencyRecorder(RTSPLatencyRecorder* pRecorder);
+		/// Sets the recorder for the request latencies of the
+		/// session, which defaults to
+		/// RTSPLatencyRecorder::defaultRecorder(). NULL disables
+		/// latency recording. The recorder is not owned by the
+		/// session.
+
+	RTSPLatencyRecorder* getLatencyRecorder() const;
+		/// Returns the recorder for request latencies, or NULL.
 	
 protected:
 	
 	void reconnect();
-		/// Connects the underlying socket to the RTSP server.
+		/// Connects the underlying socket to the RTSP server, and
+		/// records the time taken as connect time.
 
 	int write(const char* buffer, std::streamsize length);
 		/// Writes the specified buffer.
@@ -192,6 +218,8 @@ protected:
 		/// Sets _reconnect.
 
 private:
+	void recordFailure(const Poco::Exception& exc);
+
 	std::string     _host;
 	Poco::UInt16    _port;
 	std::string     _proxyHost;
@@ -202,6 +230,9 @@ private:
 	bool            _mustReconnect;
 	std::ostream*   _pRequestStream;
 	std::istream*   _pResponseStream;
+	Poco::Clock     _requestStarted;  /// on the session clock, for the request latency
+	RTSPSessionMetrics::Method _requestMethod;
+	RTSPLatencyRecorder* _pLatencyRecorder;
 	
 	RTSPClientSession(const RTSPClientSession&);
 	RTSPClientSession& operator = (const RTSPClientSession&);
@@ -253,6 +284,18 @@ inline void RTSPClientSession::setReconnect(bool recon)
 }
 
 
+inline void RTSPClientSession::setLatencyRecorder(RTSPLatencyRecorder* pRecorder)
+{
+	_pLatencyRecorder = pRecorder;
+}
+
+
+inline RTSPLatencyRecorder* RTSPClientSession::getLatencyRecorder() const
+{
+	return _pLatencyRecorder;
+}
+
+
 /* NB!
 inline const Poco::Timespan& RTSPClientSession::getKeepAliveTimeout() const
 {
@@ -0,0 +1,194 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP io_uring I/O Engine Class
+//
+//	description:
+//		shared io_uring based socket I/O for many RTSP sessions
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_IO_URING__H__
+#define __RTSP_IO_URING__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/SocketDefs.h"
+#include "Poco/Net/HTTPBufferAllocator.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Timespan.h"
+#include <set>
+#include <vector>
+
+#include "rtsp_sdk.h"
+
+
+struct io_uring;
+struct io_uring_buf_ring;
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPIOUring: public Poco::Runnable
+	/// RTSPIOUring performs the socket I/O of any number of
+	/// RTSPSession objects through a single Linux io_uring instance.
+	///
+	/// Instead of one blocking recv()/send() system call per
+	/// RTSPSession::receive()/write() call, every attached socket
+	/// has a multishot receive armed, which keeps filling buffers
+	/// from a shared provided-buffer ring until the session is
+	/// detached. So that an idle or slow session cannot take all
+	/// buffers from the others, the receive of a session holding
+	/// MAX_CHANNEL_BUFFERS unread buffers (at most a quarter of
+	/// all buffers) is cancelled, and armed again once the session
+	/// has read them. Sends copy the data into one of a set of buffers
+	/// registered with the kernel and are submitted as fixed-buffer
+	/// writes with a linked timeout.
+	///
+	/// Submissions from all sessions are queued into the submission
+	/// ring and handed to the kernel in batches by the engine thread,
+	/// which also reaps completions for all sessions at once. Session
+	/// threads only block on a condition until their data or
+	/// completion has arrived, at most for the session timeout.
+	/// Should the engine thread fail, every waiting session is woken
+	/// with the error and all further I/O fails with it.
+	///
+	/// A session is attached with RTSPSession::setIOUring(); its
+	/// read/write interface does not change. All sessions must be
+	/// detached before the engine is destroyed.
+	///
+	/// The engine is only available if the SDK was built with
+	/// RTSP_SDK_HAVE_IO_URING defined (scons io_uring=1) and linked
+	/// with liburing; it requires Linux 6.0 or later for multishot
+	/// receive. Otherwise the constructor throws a
+	/// Poco::NotImplementedException.
+{
+public:
+	class Channel;
+		/// The per-socket state of an attached session.
+
+	enum
+	{
+		DEFAULT_ENTRIES      = 4096,
+		DEFAULT_BUFFER_COUNT = 4096,
+		DEFAULT_BUFFER_SIZE  = Poco::Net::HTTPBufferAllocator::BUFFER_SIZE,
+		MAX_CHANNEL_BUFFERS  = 16
+	};
+
+	RTSPIOUring(unsigned entries = DEFAULT_ENTRIES, unsigned bufferCount = DEFAULT_BUFFER_COUNT, unsigned bufferSize = DEFAULT_BUFFER_SIZE);
+		/// Creates the io_uring instance with the given number of
+		/// submission queue entries, bufferCount receive buffers and
+		/// bufferCount registered send buffers of bufferSize bytes
+		/// each, and starts the engine thread.
+		///
+		/// bufferCount must be a power of two not greater than 32768.
+
+	~RTSPIOUring();
+		/// Stops the engine thread and releases the io_uring instance
+		/// and all buffers.
+
+	Channel* attach(poco_socket_t sockfd);
+		/// Attaches the given connected socket to the engine.
+
+	void detach(Channel* pChannel);
+		/// Cancels the outstanding receive of the channel, waits for
+		/// the kernel to release its buffers and destroys the channel.
+
+	int receive(Channel* pChannel, char* buffer, int length, const Poco::Timespan& timeout);
+		/// Copies up to length bytes received on the channel to buffer.
+		/// Blocks until data is available, the peer has closed the
+		/// connection (0 is returned) or the timeout expires
+		/// (a Poco::TimeoutException is thrown).
+
+	int send(Channel* pChannel, const char* buffer, int length, const Poco::Timespan& timeout);
+		/// Sends length bytes over the channel and returns after the
+		/// kernel has accepted all of them. Throws a
+		/// Poco::TimeoutException if that takes longer than timeout,
+		/// including the wait for a free send buffer.
+
+	void run();
+		/// The engine thread. Do not call directly.
+
+	static bool available();
+		/// Returns true if the engine has been compiled in and the
+		/// running kernel supports it, including provided buffer
+		/// rings and multishot receive.
+
+private:
+	struct Op;
+
+	struct io_uring_sqe* getSQE(unsigned count = 1);
+	void wakeup();
+	void armWakeup();
+	void armReceive(Channel* pChannel);
+	void recycle(unsigned short bufferId);
+	void complete(struct io_uring_cqe* pCqe);
+	void fail(int error);
+
+	RTSPIOUring(const RTSPIOUring&);
+	RTSPIOUring& operator = (const RTSPIOUring&);
+
+	struct io_uring*          _pRing;
+	struct io_uring_buf_ring* _pBufRing;
+	char*                     _pRecvBuffers;
+	char*                     _pSendBuffers;
+	unsigned                  _bufferCount;
+	unsigned                  _bufferSize;
+	unsigned                  _freeRecvBuffers;
+	unsigned                  _channelBuffers;  /// unread receive buffers a channel may hold
+	std::vector<int>          _freeSendBuffers;
+	std::set<Channel*>        _channels;
+	int                       _wakeFd;
+	Op*                       _pWakeOp;
+	Op*                       _pIgnoreOp;
+	int                       _failure;  /// error that stopped the engine thread, or 0
+	unsigned                  _queued;
+	bool                      _stop;
+	Poco::Thread              _thread;
+	Poco::Mutex               _mutex;
+	Poco::Condition           _bufferCond;
+};
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_IO_URING__H__
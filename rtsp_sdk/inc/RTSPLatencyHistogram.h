@@ -0,0 +1,162 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Latency Histogram Class
+//
+//	description:
+//		lock-free log-linear latency histogram
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_LATENCY_HISTOGRAM__H__
+#define __RTSP_LATENCY_HISTOGRAM__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Timestamp.h"
+
+#include "rtsp_sdk.h"
+#include "RTSPAtomic.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPLatencyHistogram
+	/// RTSPLatencyHistogram records latencies in microseconds into
+	/// log-linear buckets in the style of HdrHistogram: every power
+	/// of two is split into 32 linear sub-buckets, which keeps the
+	/// relative error of any reported value below 3.2% over the whole
+	/// range from 1 microsecond to more than an hour.
+	///
+	/// Recording is lock-free and wait-free apart from the min/max
+	/// updates; all counters are updated with relaxed atomic
+	/// operations, so any number of threads can record into the same
+	/// histogram. Histograms with the same layout can be merged,
+	/// which is how per-session or per-thread histograms are combined
+	/// into fleet-wide ones.
+	///
+	/// Copying a histogram takes a snapshot of its counters.
+{
+public:
+	enum
+	{
+		SUB_BUCKET_BITS  = 5,
+		SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+		MAX_EXPONENT     = 26,
+		BUCKET_COUNT     = (MAX_EXPONENT + 2) * SUB_BUCKET_COUNT
+	};
+
+	RTSPLatencyHistogram();
+		/// Creates an empty histogram.
+
+	RTSPLatencyHistogram(const RTSPLatencyHistogram& other);
+		/// Creates a snapshot of the other histogram.
+
+	RTSPLatencyHistogram& operator = (const RTSPLatencyHistogram& other);
+		/// Replaces the counters with a snapshot of the other histogram.
+
+	~RTSPLatencyHistogram();
+		/// Destroys the histogram.
+
+	void record(Poco::Timestamp::TimeDiff value);
+		/// Records a value in microseconds. Negative values are
+		/// recorded as 0, values above highestTrackableValue()
+		/// are clamped to it.
+
+	void merge(const RTSPLatencyHistogram& other);
+		/// Adds all values recorded in other to this histogram.
+
+	void reset();
+		/// Removes all recorded values.
+
+	Poco::UInt64 count() const;
+		/// Returns the number of recorded values.
+
+	Poco::UInt64 sum() const;
+		/// Returns the sum of all recorded values.
+
+	Poco::Timestamp::TimeDiff min() const;
+		/// Returns the smallest recorded value, or 0
+		/// if the histogram is empty.
+
+	Poco::Timestamp::TimeDiff max() const;
+		/// Returns the largest recorded value, or 0
+		/// if the histogram is empty.
+
+	double mean() const;
+		/// Returns the mean of all recorded values.
+
+	Poco::Timestamp::TimeDiff valueAtPercentile(double percentile) const;
+		/// Returns the value below or at which the given percentage
+		/// (0.0 - 100.0) of the recorded values lie, rounded up to
+		/// the largest value of its bucket. Returns 0 if the
+		/// histogram is empty.
+
+	static Poco::Timestamp::TimeDiff highestTrackableValue();
+		/// Returns the largest value that can be recorded exactly.
+
+private:
+	static int bucketOf(Poco::UInt64 value);
+	static Poco::UInt64 highestValueOf(int bucket);
+
+	RTSPAtomic<Poco::UInt64> _buckets[BUCKET_COUNT];
+	RTSPAtomic<Poco::UInt64> _count;
+	RTSPAtomic<Poco::UInt64> _sum;
+	RTSPAtomic<Poco::UInt64> _min;
+	RTSPAtomic<Poco::UInt64> _max;
+};
+
+
+//
+// inlines
+//
+
+inline Poco::UInt64 RTSPLatencyHistogram::count() const
+{
+	return _count.value();
+}
+
+
+inline Poco::UInt64 RTSPLatencyHistogram::sum() const
+{
+	return _sum.value();
+}
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_LATENCY_HISTOGRAM__H__
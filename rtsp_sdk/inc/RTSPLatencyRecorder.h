@@ -0,0 +1,162 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Latency Recorder Class
+//
+//	description:
+//		request latency histograms keyed by method and status class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_LATENCY_RECORDER__H__
+#define __RTSP_LATENCY_RECORDER__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Timestamp.h"
+#include <ostream>
+
+#include "rtsp_sdk.h"
+#include "RTSPAtomic.h"
+#include "RTSPLatencyHistogram.h"
+#include "RTSPSessionMetrics.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPLatencyRecorder
+	/// RTSPLatencyRecorder keeps one RTSPLatencyHistogram for every
+	/// combination of request method and response status class.
+	///
+	/// RTSPClientSession records the time from sendRequest() until
+	/// the response header has been read in receiveResponse() into
+	/// defaultRecorder(), so the histograms cover all sessions of
+	/// the process. Histograms are created on first use without
+	/// locking; recording never blocks.
+	///
+	/// The time taken to connect, including the TLS handshake of
+	/// rtsps sessions, is not part of the latency of the exchange
+	/// that caused it but is recorded in a histogram of its own.
+	/// Exchanges that end without a response header are counted
+	/// per method, timeouts apart from other failures.
+	///
+	/// dump() writes all non-empty histograms in the Prometheus text
+	/// exposition format as summaries with the 0.5, 0.9, 0.99 and
+	/// 0.999 quantiles, and the failures as counters, ready to be
+	/// served to a scraper.
+{
+public:
+	enum StatusClass
+	{
+		STATUS_OTHER = 0,
+		STATUS_1XX,
+		STATUS_2XX,
+		STATUS_3XX,
+		STATUS_4XX,
+		STATUS_5XX,
+		STATUS_CLASS_COUNT
+	};
+
+	RTSPLatencyRecorder();
+		/// Creates a RTSPLatencyRecorder without any histograms.
+
+	~RTSPLatencyRecorder();
+		/// Destroys the RTSPLatencyRecorder and all histograms.
+
+	void record(const std::string& method, int status, Poco::Timestamp::TimeDiff latency);
+		/// Records the latency in microseconds of an exchange with
+		/// the given request method and response status code.
+
+	void record(RTSPSessionMetrics::Method method, StatusClass statusClass, Poco::Timestamp::TimeDiff latency);
+		/// Records the latency in microseconds of an exchange.
+
+	void recordConnect(Poco::Timestamp::TimeDiff duration);
+		/// Records the time in microseconds taken to connect.
+
+	void recordFailure(RTSPSessionMetrics::Method method, bool timedOut);
+		/// Counts an exchange that ended without a response header,
+		/// as a timeout if timedOut is true and as a failure
+		/// otherwise.
+
+	RTSPLatencyHistogram histogram(RTSPSessionMetrics::Method method, StatusClass statusClass) const;
+		/// Returns a snapshot of the histogram for the given method
+		/// and status class. The snapshot is empty if nothing has
+		/// been recorded for it.
+
+	RTSPLatencyHistogram histogram(RTSPSessionMetrics::Method method) const;
+		/// Returns the merged histograms of all status classes
+		/// of the given method.
+
+	RTSPLatencyHistogram connectHistogram() const;
+		/// Returns a snapshot of the histogram of connect times.
+
+	Poco::UInt64 timeouts(RTSPSessionMetrics::Method method) const;
+		/// Returns the number of exchanges of the given method
+		/// that timed out.
+
+	Poco::UInt64 failures(RTSPSessionMetrics::Method method) const;
+		/// Returns the number of exchanges of the given method
+		/// that failed for any other reason.
+
+	void dump(std::ostream& ostr) const;
+		/// Writes all non-empty histograms to the given stream in
+		/// the Prometheus text exposition format.
+
+	void reset();
+		/// Removes all recorded values.
+
+	static StatusClass statusClassOf(int status);
+		/// Returns the status class of the given status code.
+
+	static RTSPLatencyRecorder& defaultRecorder();
+		/// Returns the process-wide RTSPLatencyRecorder
+		/// used by RTSPClientSession.
+
+private:
+	RTSPLatencyRecorder(const RTSPLatencyRecorder&);
+	RTSPLatencyRecorder& operator = (const RTSPLatencyRecorder&);
+
+	RTSPAtomic<RTSPLatencyHistogram*> _histograms[RTSPSessionMetrics::METHOD_COUNT][STATUS_CLASS_COUNT];
+	RTSPLatencyHistogram              _connectHistogram;
+	RTSPAtomic<Poco::UInt64>          _timeouts[RTSPSessionMetrics::METHOD_COUNT];
+	RTSPAtomic<Poco::UInt64>          _failures[RTSPSessionMetrics::METHOD_COUNT];
+};
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_LATENCY_RECORDER__H__
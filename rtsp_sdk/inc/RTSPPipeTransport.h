@@ -0,0 +1,160 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Pipe Transport Class
+//
+//	description:
+//		in-memory duplex pipe transport
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_PIPE_TRANSPORT__H__
+#define __RTSP_PIPE_TRANSPORT__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/AutoPtr.h"
+
+#include "rtsp_sdk.h"
+#include "RTSPTransport.h"
+#include "RTSPVirtualClock.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPPipeTransport: public RTSPTransport
+	/// RTSPPipeTransport is one end of an in-memory duplex pipe.
+	/// Bytes sent on one end are received on the other, so a
+	/// RTSPClientSession can talk to an in-process peer without
+	/// sockets, system calls or a network stack.
+	///
+	/// The peer is either driven by its own thread, which blocks
+	/// in receiveBytes() like it would on a socket, or by a Handler
+	/// that is called synchronously whenever data arrives on its
+	/// end. With a handler answering the requests, complete RTSP
+	/// exchanges run on a single thread, and the results are the
+	/// same on every run.
+	///
+	/// If the pipe has a RTSPVirtualClock, receiveBytes() never
+	/// waits: when no data is available, it advances the clock by
+	/// the timeout and throws a Poco::TimeoutException at once.
+	/// Otherwise it waits up to the timeout in real time.
+	///
+	/// Buffers are reused once drained, so a steady request and
+	/// response flow does not allocate memory.
+{
+public:
+	typedef Poco::AutoPtr<RTSPPipeTransport> Ptr;
+
+	class RTSP_SDK_API Handler
+		/// A Handler is notified when data has arrived on the
+		/// end it is installed on.
+	{
+	public:
+		virtual ~Handler();
+			/// Destroys the Handler.
+
+		virtual void onReceive(RTSPPipeTransport& transport) = 0;
+			/// Called on the sending thread after data has been
+			/// sent to transport. The handler should receive all
+			/// available() data and may send replies, which can in
+			/// turn trigger the handler of the other end. Calls for
+			/// the same end are never nested: data that arrives
+			/// while the handler runs is left for it to pick up.
+	};
+
+	static void createPair(Ptr& pFirst, Ptr& pSecond, RTSPVirtualClock* pClock = NULL);
+		/// Creates both ends of a connected pipe. If pClock is
+		/// given, timeouts are taken on the virtual clock, which
+		/// must outlive the pipe.
+
+	void setHandler(Handler* pHandler);
+		/// Installs the handler called when data arrives on this
+		/// end, or removes it if pHandler is NULL. The handler is
+		/// not owned by the transport.
+
+	int available() const;
+		/// Returns the number of bytes that can be
+		/// received without waiting.
+
+	RTSPVirtualClock* clock() const;
+		/// Returns the virtual clock of the pipe, or NULL.
+
+	void connect(const Poco::Net::SocketAddress& address, const Poco::Timespan& timeout);
+		/// Does nothing, since the pipe is connected on creation.
+		/// Throws a Poco::Net::ConnectionRefusedException if this
+		/// end has been closed.
+
+	bool connected() const;
+		/// Returns true until this end is closed.
+
+	int sendBytes(const char* buffer, int length, const Poco::Timespan& timeout);
+		/// Appends the bytes to the other end and calls its handler.
+		/// Never blocks. Throws a Poco::Net::ConnectionResetException
+		/// if the other end has been closed.
+
+	int receiveBytes(char* buffer, int length, const Poco::Timespan& timeout);
+		/// Receives up to length bytes sent by the other end.
+		/// Returns 0 once either end has been shut down
+		/// and all data has been received.
+
+	void shutdown();
+		/// Signals the end of the stream to both ends.
+
+	void close();
+		/// Shuts down and closes this end, discarding any data
+		/// that has not been received.
+
+protected:
+	~RTSPPipeTransport();
+		/// Closes this end and destroys the RTSPPipeTransport.
+
+private:
+	struct Pipe;
+
+	RTSPPipeTransport(Pipe* pPipe, int side);
+
+	void dispatch(int side);
+
+	Pipe* _pPipe;
+	int   _side;
+};
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_PIPE_TRANSPORT__H__
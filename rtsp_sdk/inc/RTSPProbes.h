@@ -0,0 +1,121 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Static Tracepoints
+//
+//	description:
+//		USDT probes on the session and message hot paths
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_PROBES__H__
+#define __RTSP_PROBES__H__
+
+
+//
+// Statically defined tracepoints of the "rtsp_sdk" provider.
+//
+// The probes are compiled in only if RTSP_SDK_HAVE_USDT is defined
+// (scons usdt=1) and <sys/sdt.h> from SystemTap is available. Each
+// probe is a single nop plus an ELF note, so a probe costs nothing
+// until a tracer such as bpftrace or perf attaches to it:
+//
+//     bpftrace -e 'usdt:./lib/librtsp.so:rtsp_sdk:request_send
+//         { printf("%s %d\n", str(arg1), arg2); }'
+//
+// Every probe has a semaphore that the tracer increments while it
+// is attached; RTSP_PROBE_ENABLED() tests it, so probe arguments
+// that are not free to compute can be skipped altogether.
+//
+// Probes and their arguments:
+//
+//     refill               (session, bytes received)
+//     read                 (session, bytes requested, bytes returned)
+//     write                (session, bytes requested, bytes sent)
+//     connect              (session, socket descriptor)
+//     reconnect            (session, port)
+//     request_send         (session, method, CSeq)
+//     response_read_start  (response)
+//     response_read_done   (response, status, CSeq, content length)
+//
+#define RTSP_PROBE_LIST(PROBE) \
+	PROBE(refill)              \
+	PROBE(read)                \
+	PROBE(write)               \
+	PROBE(connect)             \
+	PROBE(reconnect)           \
+	PROBE(request_send)        \
+	PROBE(response_read_start) \
+	PROBE(response_read_done)
+
+
+#if defined(RTSP_SDK_HAVE_USDT)
+
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+
+#define RTSP_PROBE_SEMAPHORE(name) rtsp_sdk_##name##_semaphore
+#define RTSP_PROBE_DECLARE_SEMAPHORE(name) extern volatile unsigned short RTSP_PROBE_SEMAPHORE(name);
+
+
+extern "C"
+{
+	RTSP_PROBE_LIST(RTSP_PROBE_DECLARE_SEMAPHORE)
+}
+
+
+#define RTSP_PROBE_ENABLED(name) (RTSP_PROBE_SEMAPHORE(name) != 0)
+#define RTSP_PROBE1(name, a1) DTRACE_PROBE1(rtsp_sdk, name, a1)
+#define RTSP_PROBE2(name, a1, a2) DTRACE_PROBE2(rtsp_sdk, name, a1, a2)
+#define RTSP_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(rtsp_sdk, name, a1, a2, a3)
+#define RTSP_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(rtsp_sdk, name, a1, a2, a3, a4)
+
+
+#else
+
+
+#define RTSP_PROBE_ENABLED(name) false
+#define RTSP_PROBE1(name, a1)
+#define RTSP_PROBE2(name, a1, a2)
+#define RTSP_PROBE3(name, a1, a2, a3)
+#define RTSP_PROBE4(name, a1, a2, a3, a4)
+
+
+#endif // RTSP_SDK_HAVE_USDT
+
+
+#endif // __RTSP_PROBES__H__
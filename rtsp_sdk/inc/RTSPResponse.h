@@ -164,12 +164,42 @@ public:
 		///
 		/// The reason phrase is set according to the status code.
 
+	void setDate();
+		/// Sets the Date header to the current time.
+
 	void setDate(const Poco::Timestamp& dateTime);
 		/// Sets the Date header to the given date/time value.
+		///
+		/// The formatted date of the last second is cached per
+		/// thread, so that a server stamping every response only
+		/// formats the date once a second.
 		
 	Poco::Timestamp getDate() const;
 		/// Returns the value of the Date header.
 
+	void setTimestamps(const Poco::Timestamp& transmitted, const Poco::Timestamp& received);
+		/// Sets the kernel timestamps of the exchange: the time the
+		/// last byte of the request was handed to the network device
+		/// and the time the first segment of the response arrived.
+		///
+		/// Set by RTSPClientSession::receiveResponse() if kernel
+		/// timestamps are enabled for the session
+		/// (see RTSPSession::setTimestamping()).
+
+	bool hasTimestamps() const;
+		/// Returns true if kernel timestamps have been set.
+
+	const Poco::Timestamp& getTransmitted() const;
+		/// Returns the kernel transmit timestamp of the request.
+
+	const Poco::Timestamp& getReceived() const;
+		/// Returns the kernel receive timestamp of the response.
+
+	Poco::Timestamp::TimeDiff getRoundTripTime() const;
+		/// Returns the time between the transmit and the receive
+		/// timestamp in microseconds, or -1 if no timestamps
+		/// have been set.
+
 	void write(std::ostream& ostr) const;
 		/// Writes the RTSP response to the given
 		/// output stream.
@@ -184,6 +214,14 @@ public:
 		/// Returns an appropriate reason phrase
 		/// for the given status code.
 
+	static const std::string& getStatusLine(RTSPStatus status);
+		/// Returns the preformatted "RTSP/1.0 <status> <reason>\r\n"
+		/// line for the given status code, or an empty string if
+		/// there is no reason phrase for the code.
+		///
+		/// write() uses it for RTSP/1.0 responses that have the
+		/// standard reason phrase.
+
 	static const std::string RTSP_REASON_CONTINUE;
 
 	static const std::string RTSP_REASON_OK;
@@ -243,8 +281,11 @@ private:
 		MAX_REASON_LENGTH  = 512
 	};
 	
-	RTSPStatus  _status;
-	std::string _reason;
+	RTSPStatus      _status;
+	std::string     _reason;
+	bool            _stamped;
+	Poco::Timestamp _transmitted;
+	Poco::Timestamp _received;
 	
 	RTSPResponse(const RTSPResponse&);
 	RTSPResponse& operator = (const RTSPResponse&);
@@ -266,6 +307,30 @@ inline const std::string& RTSPResponse::getReason() const
 }
 
 
+inline bool RTSPResponse::hasTimestamps() const
+{
+	return _stamped;
+}
+
+
+inline const Poco::Timestamp& RTSPResponse::getTransmitted() const
+{
+	return _transmitted;
+}
+
+
+inline const Poco::Timestamp& RTSPResponse::getReceived() const
+{
+	return _received;
+}
+
+
+inline Poco::Timestamp::TimeDiff RTSPResponse::getRoundTripTime() const
+{
+	return _stamped ? _received - _transmitted : -1;
+}
+
+
 } // namespace RTSP
 
 
@@ -0,0 +1,175 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Secure Client Session Class
+//
+//	description:
+//		represents client-side RTSP session over TLS (rtsps)
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSPS_CLIENT_SESSION__H__
+#define __RTSPS_CLIENT_SESSION__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/Context.h"
+
+#include "rtsp_sdk.h"
+#include "RTSPClientSession.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPSClientSession: public RTSPClientSession
+	/// This class implements the client-side of
+	/// a RTSP session over a TLS connection (rtsps).
+	///
+	/// RTSPSClientSession is used exactly like RTSPClientSession.
+	/// The only difference is that the underlying socket is a
+	/// Poco::Net::SecureStreamSocket, which is kept behind the
+	/// same RTSPSession buffering.
+	///
+	/// Whenever the session (re)connects, a TLS session previously
+	/// negotiated with the same server is taken from the
+	/// RTSPTLSSessionCache and offered for resumption. After a full
+	/// handshake, the negotiated session is stored into the cache
+	/// after connecting and again after the first response has been
+	/// received, since TLS 1.3 session tickets are only sent by the
+	/// server after the handshake has completed. A cached session is
+	/// dropped if the TLS handshake fails.
+	///
+	/// Proxies are not supported; the connection is always made
+	/// directly to the server, and setting a proxy throws.
+{
+public:
+	explicit RTSPSClientSession(Poco::Net::Context::Ptr pContext);
+		/// Creates an unconnected RTSPSClientSession using
+		/// the given TLS context.
+
+	RTSPSClientSession(const std::string& host, Poco::UInt16 port = RTSPSession::RTSPS_PORT);
+		/// Creates a RTSPSClientSession using the given host and port
+		/// and the default client context of the Poco::Net::SSLManager.
+
+	RTSPSClientSession(const std::string& host, Poco::UInt16 port, Poco::Net::Context::Ptr pContext);
+		/// Creates a RTSPSClientSession using the given host, port
+		/// and TLS context.
+
+	virtual ~RTSPSClientSession();
+		/// Destroys the RTSPSClientSession and closes
+		/// the underlying socket.
+
+	virtual std::istream& receiveResponse(RTSPResponse& response);
+		/// Receives the header for the response to the previous
+		/// RTSP request.
+		///
+		/// See RTSPClientSession::receiveResponse().
+
+	void setIOUring(RTSPIOUring* pIOUring);
+		/// Throws a Poco::NotImplementedException if pIOUring is
+		/// not NULL, since the TLS layer performs its own socket I/O.
+
+	void setZeroCopy(bool enable);
+		/// Throws a Poco::NotImplementedException if enable is true,
+		/// since the TLS layer has to encrypt the data anyway.
+
+	void setTransport(RTSPTransport::Ptr pTransport);
+		/// Throws a Poco::NotImplementedException if pTransport is
+		/// not NULL, since the TLS layer runs on the socket.
+
+	void setTimestamping(bool enable);
+		/// Throws a Poco::NotImplementedException if enable is true,
+		/// since the timestamped receive would bypass the TLS layer.
+
+	void setProxy(const std::string& host, Poco::UInt16 port = RTSPSession::RTSP_PORT);
+		/// Throws a Poco::NotImplementedException if host is not
+		/// empty, since the session does not tunnel through proxies.
+
+	void setProxyHost(const std::string& host);
+		/// Throws a Poco::NotImplementedException if host is not
+		/// empty, since the session does not tunnel through proxies.
+
+	void setProxyPort(Poco::UInt16 port);
+		/// Throws a Poco::NotImplementedException, since the session
+		/// does not tunnel through proxies.
+
+	Poco::Net::Context::Ptr context() const;
+		/// Returns the TLS context used by the session.
+
+	bool sessionWasReused() const;
+		/// Returns true if the last handshake resumed a cached
+		/// TLS session rather than performing a full handshake.
+
+protected:
+	void connect(const SocketAddress& address);
+		/// Connects the underlying secure socket to the given address,
+		/// offering a cached TLS session for resumption, and
+		/// performs the TLS handshake.
+
+	std::string getHostInfo() const;
+		/// Returns the target host and port number for requests.
+
+private:
+	void cacheSession();
+
+	Poco::Net::Context::Ptr _pContext;
+	bool                    _sessionReused;
+	bool                    _mustCacheSession;
+
+	RTSPSClientSession(const RTSPSClientSession&);
+	RTSPSClientSession& operator = (const RTSPSClientSession&);
+};
+
+
+//
+// inlines
+//
+inline Poco::Net::Context::Ptr RTSPSClientSession::context() const
+{
+	return _pContext;
+}
+
+
+inline bool RTSPSClientSession::sessionWasReused() const
+{
+	return _sessionReused;
+}
+
+
+} // namespace RTSP
+
+
+#endif // __RTSPS_CLIENT_SESSION__H__
@@ -0,0 +1,112 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Secure Session Instantiator Class
+//
+//	description:
+//		creates RTSPSClientSession objects for rtsps:// URIs
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSPS_SESSION_INSTANTIATOR__H__
+#define __RTSPS_SESSION_INSTANTIATOR__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/Context.h"
+#include "Poco/URI.h"
+
+#include "rtsp_sdk.h"
+#include "RTSPSessionInstantiator.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPSSessionInstantiator: public RTSPSessionInstantiator
+	/// A factory for RTSPSClientSession objects.
+	///
+	/// Creates a RTSPSClientSession for a given rtsps URI.
+	/// A RTSPSSessionInstantiator is not used directly.
+	/// Instances are registered with a RTSPSessionFactory,
+	/// and used through it.
+{
+public:
+	RTSPSSessionInstantiator();
+		/// Creates the RTSPSSessionInstantiator using the
+		/// default client context of the Poco::Net::SSLManager.
+		///
+		/// Throws a Poco::IllegalStateException if the SSLManager
+		/// has no default client context.
+
+	explicit RTSPSSessionInstantiator(Poco::Net::Context::Ptr pContext);
+		/// Creates the RTSPSSessionInstantiator using the
+		/// given TLS context.
+		///
+		/// Client-side session caching is enabled on the context,
+		/// so that sessions can be resumed through the
+		/// RTSPTLSSessionCache.
+
+	~RTSPSSessionInstantiator();
+		/// Destroys the RTSPSSessionInstantiator.
+
+	RTSPClientSession* createClientSession(const Poco::URI& uri);
+		/// Creates a RTSPSClientSession for the given URI.
+
+	RTSPClientSession* createClientSession(const Poco::URI& uri, const std::string& proxyHost, Poco::UInt16 proxyPort) const;
+		/// Creates a RTSPSClientSession for the given URI.
+		///
+		/// Throws a Poco::NotImplementedException if proxyHost is
+		/// not empty, since RTSPS sessions always connect directly.
+
+	static void registerInstantiator();
+		/// Registers the instantiator with the global RTSPSessionFactory.
+
+	static void registerInstantiator(Poco::Net::Context::Ptr pContext);
+		/// Registers the instantiator with the global RTSPSessionFactory,
+		/// using the given TLS context for all sessions.
+
+	static void unregisterInstantiator();
+		/// Unregisters the factory with the global RTSPSessionFactory.
+
+private:
+	Poco::Net::Context::Ptr _pContext;
+};
+
+
+} // namespace RTSP
+
+
+#endif // __RTSPS_SESSION_INSTANTIATOR__H__
@@ -46,11 +46,17 @@
 
 #include "Poco/Net/Net.h"
 #include "Poco/Net/StreamSocket.h"
+#include "Poco/Clock.h"
 #include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
 #include "Poco/Exception.h"
 #include <ios>
 
 #include "rtsp_sdk.h"
+#include "RTSPIOUring.h"
+#include "RTSPZeroCopySender.h"
+#include "RTSPSessionMetrics.h"
+#include "RTSPTransport.h"
 
 using Poco::Net::StreamSocket;
 using Poco::Net::SocketAddress;
@@ -81,7 +87,8 @@ public:
 		/// Returns the timeout for the RTSP session.
 
 	bool connected() const;
-		/// Returns true if the underlying socket is connected.
+		/// Returns true if the underlying socket, or the
+		/// transport if one is set, is connected.
 
 	void abort();
 		/// Aborts a session in progress by shutting down
@@ -115,9 +122,95 @@ public:
 	Poco::UInt16 getCSeq() const;
 		/// Returns the sequence counter for the session.
 
+	virtual void setIOUring(RTSPIOUring* pIOUring);
+		/// Routes the socket I/O of the session through the given
+		/// io_uring engine, or back to blocking socket calls if
+		/// pIOUring is NULL. A connected socket is attached at once,
+		/// otherwise it is attached by connect().
+		///
+		/// The engine is not owned by the session and must
+		/// outlive it.
+
+	RTSPIOUring* getIOUring() const;
+		/// Returns the io_uring engine used by the session, or NULL.
+
+	virtual void setZeroCopy(bool enable);
+		/// Enables or disables zero-copy sends (MSG_ZEROCOPY) for
+		/// the session. If enabled, writes of buffers obtained with
+		/// allocateSendBuffer() are sent by a RTSPZeroCopySender
+		/// once the session is connected.
+		///
+		/// Any other write is copied by the kernel as usual, since
+		/// the caller may reuse the buffer right away. This includes
+		/// everything written through the request and response
+		/// streams, which flush their own buffers. To send a large
+		/// body or interleaved media without a copy, build it in
+		/// send buffers, flush the message stream and pass the
+		/// buffers to write().
+
+	bool getZeroCopy() const;
+		/// Returns true if zero-copy sends are enabled.
+
+	char* allocateSendBuffer();
+		/// Returns a buffer of sendBufferSize() bytes from the
+		/// zero-copy send buffer pool of the connected session.
+		///
+		/// Passing the buffer to write() hands it back to the
+		/// session, which returns it to the pool once the kernel
+		/// has completed the send, so the caller must not touch it
+		/// afterwards. A buffer that is not written must be given
+		/// back with releaseSendBuffer().
+		///
+		/// Throws a Poco::IllegalStateException if zero-copy sends
+		/// are not enabled or the session is not connected.
+
+	void releaseSendBuffer(char* pBuffer);
+		/// Returns an unused buffer obtained with
+		/// allocateSendBuffer() to the pool.
+
+	int sendBufferSize() const;
+		/// Returns the size of the buffers returned
+		/// by allocateSendBuffer().
+
+	virtual void setTimestamping(bool enable);
+		/// Enables or disables kernel TX/RX timestamps
+		/// (SO_TIMESTAMPING) on the session socket, see
+		/// RTSPSocketTimestamps. If enabled, RTSPClientSession
+		/// stores the time the request left and the time the
+		/// response arrived on every RTSPResponse.
+		///
+		/// Timestamps are not taken while the io_uring engine
+		/// is used. Since transmit timestamps and zero-copy
+		/// completions share the socket's error queue, the two
+		/// modes cannot be combined; a Poco::IllegalStateException
+		/// is thrown if zero-copy sends are enabled.
+
+	bool getTimestamping() const;
+		/// Returns true if kernel timestamps are enabled.
+
+	virtual void setTransport(RTSPTransport::Ptr pTransport);
+		/// Makes the session send and receive through the given
+		/// transport instead of its socket, or through the socket
+		/// again if pTransport is NULL. Data buffered from the
+		/// previous transport is discarded.
+		///
+		/// The io_uring engine, zero-copy sends and kernel timestamps
+		/// work on the socket only; a Poco::IllegalStateException is
+		/// thrown if any of them is enabled, and enabling them fails
+		/// while a transport is set.
+
+	RTSPTransport::Ptr getTransport() const;
+		/// Returns the transport of the session, or NULL
+		/// if the socket is used.
+
+	RTSPSessionMetrics::Ptr metrics() const;
+		/// Returns the metrics of the session. Use
+		/// RTSPSessionMetrics::snapshot() to read them.
+
 	enum
 	{
-		RTSP_PORT = 554
+		RTSP_PORT  = 554,
+		RTSPS_PORT = 322
 	};
 
 protected:
@@ -150,8 +243,12 @@ protected:
 		/// Connects the underlying socket to the given address
 		/// and sets the socket's receive timeout.	
 		
-	void close();
+	void close(bool graceful = true);
 		/// Closes the underlying socket.
+		///
+		/// If graceful, first waits up to one second for the kernel
+		/// to complete outstanding zero-copy sends. Otherwise they
+		/// are dropped at once, as after a failed send or an abort.
 		
 	void setException(const Poco::Exception& exc);
 		/// Stores a clone of the exception.
@@ -159,11 +256,29 @@ protected:
 	void setCSeq(const Poco::UInt16& cSeq);
 		/// Sets the sequence counter for the session.
 
+	void startTimestamps();
+		/// Discards the timestamps of the previous exchange.
+		/// The next received data is stamped as the start
+		/// of the response.
+
+	bool getTimestamps(Poco::Timestamp& transmitted, Poco::Timestamp& received);
+		/// Returns the kernel timestamps of the last data sent and
+		/// the first data received since startTimestamps().
+		/// Returns false if timestamps are disabled or either
+		/// of them is not available.
+
+	Poco::Clock now() const;
+		/// Returns the time all durations of the session are
+		/// measured on: the virtual clock of the transport, if it
+		/// has one, or the monotonic system clock.
+
 private:
 	enum
 	{
 		RTSP_DEFAULT_TIMEOUT = 60000000
 	};
+
+	void releaseZeroCopy(bool drain);
 	
 	RTSPSession(const RTSPSession&);
 	RTSPSession& operator = (const RTSPSession&);
@@ -175,6 +290,16 @@ private:
 	Poco::Timespan   _timeout;
 	Poco::Exception* _pException;
 	Poco::UInt16	_cSeq;
+	RTSPIOUring*     _pIOUring;
+	RTSPIOUring::Channel* _pChannel;
+	bool             _zeroCopy;
+	RTSPZeroCopySender* _pZeroCopy;
+	bool             _timestamping;
+	bool             _awaitingReceive;
+	bool             _received;
+	Poco::Timestamp  _receivedAt;
+	RTSPSessionMetrics::Ptr _pMetrics;
+	RTSPTransport::Ptr _pTransport;
 };
 
 
@@ -204,6 +329,36 @@ inline Poco::UInt16 RTSPSession::getCSeq() const
 	return _cSeq;
 }
 
+
+inline RTSPIOUring* RTSPSession::getIOUring() const
+{
+	return _pIOUring;
+}
+
+
+inline bool RTSPSession::getZeroCopy() const
+{
+	return _zeroCopy;
+}
+
+
+inline bool RTSPSession::getTimestamping() const
+{
+	return _timestamping;
+}
+
+
+inline RTSPTransport::Ptr RTSPSession::getTransport() const
+{
+	return _pTransport;
+}
+
+
+inline RTSPSessionMetrics::Ptr RTSPSession::metrics() const
+{
+	return _pMetrics;
+}
+
 } // namespace RTSP
 
 #endif // __RTSP_SESSION__H__
@@ -50,8 +50,11 @@
 #include "Poco/SingletonHolder.h"
 #include "Poco/SharedPtr.h"
 #include <map>
+#include <vector>
 
 #include "rtsp_sdk.h"
+#include "RTSPAtomic.h"
+#include "RTSPSessionMetrics.h"
 
 namespace RTSP {
 
@@ -71,6 +74,26 @@ class RTSP_SDK_API RTSPSessionFactory
 	/// The actual work of creating the session is done by
 	/// RTSPSessionInstantiator objects that must be registered
 	/// with a RTSPSessionFactory.
+	///
+	/// Looking up the instantiator does not take a lock. The
+	/// registered instantiators and the proxy settings form an
+	/// immutable snapshot that createClientSession() reads with a
+	/// single atomic load, and that registerProtocol(),
+	/// unregisterProtocol() and setProxy() replace as a whole.
+	///
+	/// Replaced snapshots and unregistered instantiators are
+	/// reclaimed by epochs. A reader is counted, in one of
+	/// READER_SHARDS shards picked by its thread, under the epoch
+	/// in effect when it started. The epoch advances once no reader
+	/// of the one before it is left, and whatever was retired is
+	/// destroyed two epochs later, when no reader can still hold
+	/// it. Readers never wait; a replacement, or the first session
+	/// created after it, advances the epoch and reclaims.
+	///
+	/// The metrics of a new session are registered under one of
+	/// METRICS_SHARDS mutexes, picked by the creating thread, so
+	/// that threads creating sessions concurrently rarely contend
+	/// on the same lock.
 {
 public:
 	RTSPSessionFactory();
@@ -102,8 +125,12 @@ public:
 
 	RTSPClientSession* createClientSession(const Poco::URI& uri);
 		/// Creates a client session for the given uri scheme. Throws exception if no factory is registered for the given scheme
+		///
+		/// The session is configured with the proxy settings in
+		/// effect when the call started. May be called from any
+		/// number of threads concurrently.
 
-	const std::string& proxyHost() const;
+	std::string proxyHost() const;
 		/// Returns the proxy host, if one has been set, or an empty string otherwise.
 		
 	Poco::UInt16 proxyPort() const;
@@ -112,6 +139,10 @@ public:
 	void setProxy(const std::string& proxyHost, Poco::UInt16 proxyPort);
 		/// Sets the proxy host and port number.
 
+	RTSPSessionMetrics::Snapshot metrics();
+		/// Returns the sum of the metrics of all sessions created
+		/// by the factory, including those already destroyed.
+
 	static RTSPSessionFactory& defaultFactory();
 		/// Returns the default RTSPSessionFactory.
 
@@ -124,15 +155,85 @@ private:
 			// no destructor!!! this is by purpose, don't add one!
 	};
 
+	typedef std::map<std::string, InstantiatorInfo> Instantiators;
+	typedef std::vector<RTSPSessionMetrics::Ptr> SessionMetrics;
+
+	struct Registry
+		/// An immutable snapshot of the factory configuration.
+	{
+		Registry(const std::string& host, Poco::UInt16 port);
+
+		Instantiators instantiators;
+		std::string   proxyHost;
+		Poco::UInt16  proxyPort;
+	};
+
+	typedef std::vector<std::pair<unsigned, const Registry*> > RetiredRegistries;
+	typedef std::vector<std::pair<unsigned, RTSPSessionInstantiator*> > RetiredInstantiators;
+
+	enum
+	{
+		METRICS_SHARDS  = 16,
+		READER_SHARDS   = 16,
+		PRUNE_THRESHOLD = 64
+	};
+
+	enum
+	{
+		CACHE_LINE_SIZE = 64
+	};
+
+	struct ReaderShard
+	{
+		RTSPAtomic<int> readers[2];  /// active readers that started in an even and in an odd epoch
+		char            pad[CACHE_LINE_SIZE];  /// keeps the next shard off this cache line
+	};
+
+	struct MetricsShard
+	{
+		MetricsShard();
+
+		Poco::FastMutex              mutex;
+		SessionMetrics               sessionMetrics;
+		RTSPSessionMetrics::Snapshot retiredMetrics;
+		std::size_t                  pruneAt;  /// list size at which destroyed sessions are folded in
+		char                         pad[CACHE_LINE_SIZE];  /// keeps the next shard off this cache line
+	};
+
+	class Reader
+		/// Marks a thread as using the current snapshot
+		/// for its lifetime.
+	{
+	public:
+		Reader(const RTSPSessionFactory& factory);
+		~Reader();
+
+		const Registry* registry() const;
+
+	private:
+		const RTSPSessionFactory& _factory;
+		RTSPAtomic<int>*          _pReaders;
+		const Registry*           _pRegistry;
+	};
 
 	RTSPSessionFactory(const RTSPSessionFactory&);
 	RTSPSessionFactory& operator = (const RTSPSessionFactory&);
-	
-	typedef std::map<std::string, InstantiatorInfo> Instantiators;
 
-	Instantiators _instantiators;
-	std::string   _proxyHost;
-	Poco::UInt16  _proxyPort;
+	const Registry* registry() const;
+	void publish(Registry* pRegistry);
+	void reclaim();
+	bool quiescent(unsigned epoch) const;
+	void addMetrics(const RTSPSessionMetrics::Ptr& pMetrics);
+	static void prune(MetricsShard& shard, RTSPSessionMetrics::Snapshot* pLive);
+	static std::size_t threadShard();
+
+	RTSPAtomic<const Registry*> _pRegistry;
+	RTSPAtomic<unsigned> _epoch;
+	RTSPAtomic<bool> _retiring;  /// set while retired objects wait to be reclaimed
+	RetiredRegistries _retiredRegistries;
+	RetiredInstantiators _retiredInstantiators;
+	mutable ReaderShard _readerShards[READER_SHARDS];
+	MetricsShard _metricsShards[METRICS_SHARDS];
 
 	mutable Poco::FastMutex _mutex;
 };
@@ -141,15 +242,35 @@ private:
 //
 // inlines
 //
-inline const std::string& RTSPSessionFactory::proxyHost() const
+inline const RTSPSessionFactory::Registry* RTSPSessionFactory::registry() const
 {
-	return _proxyHost;
+	return _pRegistry.load();
+}
+
+
+inline std::string RTSPSessionFactory::proxyHost() const
+{
+	Reader reader(*this);
+	return reader.registry()->proxyHost;
 }
 
 
 inline Poco::UInt16 RTSPSessionFactory::proxyPort() const
 {
-	return _proxyPort;
+	Reader reader(*this);
+	return reader.registry()->proxyPort;
+}
+
+
+inline RTSPSessionFactory::Reader::~Reader()
+{
+	_pReaders->decrement();
+}
+
+
+inline const RTSPSessionFactory::Registry* RTSPSessionFactory::Reader::registry() const
+{
+	return _pRegistry;
 }
 
 } // namespace RTSP
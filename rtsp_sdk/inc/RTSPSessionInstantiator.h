@@ -64,6 +64,11 @@ class RTSP_SDK_API RTSPSessionInstantiator
 	/// A RTSPSessionInstantiator is not used directly.
 	/// Instances are registered with a RTSPSessionFactory,
 	/// and used through it.
+	///
+	/// Once registered, an instantiator is shared by all threads
+	/// creating sessions through the factory, without locking.
+	/// Subclasses therefore create sessions from the arguments
+	/// and their construction-time configuration only.
 {
 public:
 	RTSPSessionInstantiator();
@@ -73,7 +78,23 @@ public:
 		/// Destroys the RTSPSessionInstantiator.
 
 	virtual RTSPClientSession* createClientSession(const Poco::URI& uri);
-		/// Creates a RTSPClientSession for the given URI.
+		/// Creates a RTSPClientSession for the given URI, using
+		/// the proxy set with setProxy().
+		///
+		/// Subclasses written before the proxy was passed with every
+		/// call override this form; they are still used by the
+		/// factory, through the default implementation of the
+		/// other overload. New subclasses should override both.
+
+	virtual RTSPClientSession* createClientSession(const Poco::URI& uri, const std::string& proxyHost, Poco::UInt16 proxyPort) const;
+		/// Creates a RTSPClientSession for the given URI that
+		/// connects through the given proxy, or directly if
+		/// proxyHost is empty. Called by RTSPSessionFactory,
+		/// possibly from several threads at once.
+		///
+		/// The default implementation creates the session with
+		/// createClientSession(uri) and then sets the given proxy
+		/// on it.
 
 	static void registerInstantiator();
 		/// Registers the instantiator with the global HTTPSessionFactory.
@@ -82,8 +103,9 @@ public:
 		/// Unregisters the factory with the global HTTPSessionFactory.
 
 	void setProxy(const std::string& host, Poco::UInt16 port);
-		/// Sets the proxy host and port.
-		/// Called by RTSPSessionFactory.
+		/// Sets the proxy host and port used by
+		/// createClientSession(uri). RTSPSessionFactory
+		/// passes its proxy settings with every call instead.
 
 protected:
 
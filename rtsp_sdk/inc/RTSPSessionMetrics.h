@@ -0,0 +1,232 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Session Metrics Class
+//
+//	description:
+//		per-session I/O and request counters
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_SESSION_METRICS__H__
+#define __RTSP_SESSION_METRICS__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/Timestamp.h"
+#include <string>
+
+#include "rtsp_sdk.h"
+#include "RTSPAtomic.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPSessionMetrics: public Poco::RefCountedObject
+	/// RTSPSessionMetrics holds the counters of a single RTSPSession:
+	/// bytes and I/O calls in both directions, buffer refills,
+	/// requests per method, responses, network errors and the time
+	/// spent blocked in socket calls.
+	///
+	/// The counters are updated on the I/O path with relaxed atomic
+	/// increments, so they are always on and can be read from any
+	/// thread with snapshot() while the session is in use. A snapshot
+	/// is not an atomic cut across all counters, but every single
+	/// counter in it is exact.
+	///
+	/// The object is reference counted and shared between the session
+	/// and the RTSPSessionFactory that created it, so the factory can
+	/// still account for the session after it has been destroyed.
+{
+public:
+	typedef Poco::AutoPtr<RTSPSessionMetrics> Ptr;
+
+	enum Method
+	{
+		METHOD_DESCRIBE = 0,
+		METHOD_ANNOUNCE,
+		METHOD_GET_PARAMETER,
+		METHOD_OPTIONS,
+		METHOD_PAUSE,
+		METHOD_PLAY,
+		METHOD_RECORD,
+		METHOD_REDIRECT,
+		METHOD_SETUP,
+		METHOD_SET_PARAMETER,
+		METHOD_TEARDOWN,
+		METHOD_OTHER,
+		METHOD_COUNT
+	};
+
+	struct RTSP_SDK_API Snapshot
+		/// A plain copy of the counters of one or more sessions.
+	{
+		Snapshot();
+			/// Creates an all-zero snapshot.
+
+		Snapshot& operator += (const Snapshot& other);
+			/// Adds the counters of other to this snapshot.
+
+		Poco::UInt64 totalRequests() const;
+			/// Returns the number of requests of all methods.
+
+		Poco::UInt64 sessions;
+		Poco::UInt64 bytesReceived;
+		Poco::UInt64 bytesSent;
+		Poco::UInt64 receiveCalls;
+		Poco::UInt64 sendCalls;
+		Poco::UInt64 refills;
+		Poco::UInt64 requests[METHOD_COUNT];
+		Poco::UInt64 responses;
+		Poco::UInt64 errors;
+		Poco::UInt64 receiveBlockedMicroseconds;
+		Poco::UInt64 sendBlockedMicroseconds;
+	};
+
+	RTSPSessionMetrics();
+		/// Creates all-zero session metrics.
+
+	void received(int bytes, Poco::Timestamp::TimeDiff blocked);
+		/// Counts a receive call that returned bytes
+		/// after blocking for the given time. A negative
+		/// time is counted as zero.
+
+	void sent(int bytes, Poco::Timestamp::TimeDiff blocked);
+		/// Counts a send call that sent bytes after
+		/// blocking for the given time. A negative
+		/// time is counted as zero.
+
+	void refilled();
+		/// Counts a refill of the session buffer.
+
+	void requested(const std::string& method);
+		/// Counts a request with the given method.
+
+	void requested(Method method);
+		/// Counts a request with the given method index.
+
+	void responded();
+		/// Counts a received response header.
+
+	void failed();
+		/// Counts a network error.
+
+	Snapshot snapshot() const;
+		/// Returns the current values of the counters.
+
+	static Method methodOf(const std::string& method);
+		/// Returns the counter index for the given method name.
+
+	static const std::string& methodName(Method method);
+		/// Returns the method name for the given counter index,
+		/// or an empty string for METHOD_OTHER.
+
+protected:
+	~RTSPSessionMetrics();
+
+private:
+	RTSPSessionMetrics(const RTSPSessionMetrics&);
+	RTSPSessionMetrics& operator = (const RTSPSessionMetrics&);
+
+	RTSPAtomic<Poco::UInt64> _bytesReceived;
+	RTSPAtomic<Poco::UInt64> _bytesSent;
+	RTSPAtomic<Poco::UInt64> _receiveCalls;
+	RTSPAtomic<Poco::UInt64> _sendCalls;
+	RTSPAtomic<Poco::UInt64> _refills;
+	RTSPAtomic<Poco::UInt64> _requests[METHOD_COUNT];
+	RTSPAtomic<Poco::UInt64> _responses;
+	RTSPAtomic<Poco::UInt64> _errors;
+	RTSPAtomic<Poco::UInt64> _receiveBlocked;
+	RTSPAtomic<Poco::UInt64> _sendBlocked;
+};
+
+
+//
+// inlines
+//
+
+inline void RTSPSessionMetrics::received(int bytes, Poco::Timestamp::TimeDiff blocked)
+{
+	_receiveCalls.add(1);
+	_bytesReceived.add(bytes);
+	_receiveBlocked.add(blocked > 0 ? blocked : 0);
+}
+
+
+inline void RTSPSessionMetrics::sent(int bytes, Poco::Timestamp::TimeDiff blocked)
+{
+	_sendCalls.add(1);
+	_bytesSent.add(bytes);
+	_sendBlocked.add(blocked > 0 ? blocked : 0);
+}
+
+
+inline void RTSPSessionMetrics::refilled()
+{
+	_refills.add(1);
+}
+
+
+inline void RTSPSessionMetrics::requested(const std::string& method)
+{
+	_requests[methodOf(method)].add(1);
+}
+
+
+inline void RTSPSessionMetrics::requested(Method method)
+{
+	_requests[method].add(1);
+}
+
+
+inline void RTSPSessionMetrics::responded()
+{
+	_responses.add(1);
+}
+
+
+inline void RTSPSessionMetrics::failed()
+{
+	_errors.add(1);
+}
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_SESSION_METRICS__H__
@@ -0,0 +1,108 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Socket Timestamps Class
+//
+//	description:
+//		kernel TX/RX timestamps (SO_TIMESTAMPING) for RTSP sessions
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_SOCKET_TIMESTAMPS__H__
+#define __RTSP_SOCKET_TIMESTAMPS__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Timestamp.h"
+
+#include "rtsp_sdk.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPSocketTimestamps
+	/// RTSPSocketTimestamps provides the socket operations needed
+	/// to obtain software timestamps taken by the kernel when
+	/// data leaves for and arrives from the network device
+	/// (Linux SO_TIMESTAMPING).
+	///
+	/// Unlike timestamps taken around send() and recv() calls,
+	/// these do not include scheduling delays of the process, so
+	/// their difference is the round trip time of the link and the
+	/// peer's processing time.
+	///
+	/// Receive timestamps are delivered as ancillary data of
+	/// recvmsg(), transmit timestamps are read from the socket's
+	/// error queue.
+	///
+	/// This class is used by RTSPSession, see
+	/// RTSPSession::setTimestamping().
+{
+public:
+	static bool available();
+		/// Returns true if kernel timestamps are supported
+		/// on this platform.
+
+	static void enable(Poco::Net::StreamSocket& socket, bool enable);
+		/// Enables or disables software TX and RX timestamping
+		/// on the given socket.
+		///
+		/// Throws a Poco::NotImplementedException if the platform
+		/// does not support kernel timestamps.
+
+	static int receive(Poco::Net::StreamSocket& socket, char* buffer, int length, Poco::Timestamp& received, bool& stamped);
+		/// Receives up to length bytes like
+		/// StreamSocket::receiveBytes(). If the kernel supplied
+		/// a receive timestamp, it is stored in received and
+		/// stamped is set to true.
+
+	static bool readTransmitted(Poco::Net::StreamSocket& socket, Poco::Timestamp& transmitted);
+		/// Reads all transmit timestamps queued on the socket.
+		/// Returns true and stores the most recent one in
+		/// transmitted if there were any.
+
+private:
+	RTSPSocketTimestamps();
+	RTSPSocketTimestamps(const RTSPSocketTimestamps&);
+	RTSPSocketTimestamps& operator = (const RTSPSocketTimestamps&);
+};
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_SOCKET_TIMESTAMPS__H__
@@ -0,0 +1,146 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP TLS Session Cache Class
+//
+//	description:
+//		caches TLS sessions for rtsps:// connections
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_TLS_SESSION_CACHE__H__
+#define __RTSP_TLS_SESSION_CACHE__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/Session.h"
+#include "Poco/Mutex.h"
+#include <map>
+
+#include "rtsp_sdk.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPTLSSessionCache
+	/// A cache of TLS sessions for RTSPSClientSession objects,
+	/// keyed by server host and port.
+	///
+	/// When a RTSPSClientSession connects to a server it looks up
+	/// a previously negotiated TLS session (session ID or session ticket)
+	/// for that server and offers it to the server. If the server accepts
+	/// it, the abbreviated handshake is performed, which saves a full
+	/// key exchange and certificate verification on every reconnect.
+	///
+	/// Session caching must also be enabled on the client Context
+	/// (see Poco::Net::Context::enableSessionCache()) and on the server.
+	///
+	/// The cache holds at most a fixed number of entries. When it is
+	/// full, the least recently used entry is evicted.
+	///
+	/// All methods are thread-safe.
+{
+public:
+	enum
+	{
+		DEFAULT_CAPACITY = 1024
+	};
+
+	RTSPTLSSessionCache(std::size_t capacity = DEFAULT_CAPACITY);
+		/// Creates the RTSPTLSSessionCache holding up to
+		/// capacity sessions.
+
+	~RTSPTLSSessionCache();
+		/// Destroys the RTSPTLSSessionCache.
+
+	Poco::Net::Session::Ptr get(const std::string& host, Poco::UInt16 port);
+		/// Returns the cached session for the given server,
+		/// or a null pointer if there is none.
+
+	void put(const std::string& host, Poco::UInt16 port, Poco::Net::Session::Ptr pSession);
+		/// Stores the session for the given server, replacing
+		/// any previously cached one. A null session removes
+		/// the entry.
+
+	void remove(const std::string& host, Poco::UInt16 port);
+		/// Removes the cached session for the given server.
+
+	void clear();
+		/// Removes all cached sessions.
+
+	std::size_t size() const;
+		/// Returns the number of cached sessions.
+
+	std::size_t capacity() const;
+		/// Returns the maximum number of cached sessions.
+
+	static RTSPTLSSessionCache& defaultCache();
+		/// Returns the process-wide RTSPTLSSessionCache
+		/// used by RTSPSClientSession.
+
+private:
+	struct Entry
+	{
+		Poco::Net::Session::Ptr pSession;
+		Poco::UInt64            lastUsed;
+	};
+
+	typedef std::map<std::string, Entry> Sessions;
+
+	static std::string makeKey(const std::string& host, Poco::UInt16 port);
+	void evict();
+
+	RTSPTLSSessionCache(const RTSPTLSSessionCache&);
+	RTSPTLSSessionCache& operator = (const RTSPTLSSessionCache&);
+
+	Sessions     _sessions;
+	std::size_t  _capacity;
+	Poco::UInt64 _clock;
+
+	mutable Poco::FastMutex _mutex;
+};
+
+
+inline std::size_t RTSPTLSSessionCache::capacity() const
+{
+	return _capacity;
+}
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_TLS_SESSION_CACHE__H__
@@ -0,0 +1,125 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Transport Class
+//
+//	description:
+//		byte stream interface underneath RTSPSession
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_TRANSPORT__H__
+#define __RTSP_TRANSPORT__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/Timespan.h"
+
+#include "rtsp_sdk.h"
+
+
+namespace RTSP {
+
+
+class RTSPVirtualClock;
+
+
+class RTSP_SDK_API RTSPTransport: public Poco::RefCountedObject
+	/// RTSPTransport is the byte stream a RTSPSession reads from
+	/// and writes to in place of its StreamSocket, once it has
+	/// been installed with RTSPSession::setTransport().
+	///
+	/// The session keeps doing all buffering, message parsing and
+	/// sequence numbering, so a transport only has to move bytes.
+	/// Implementations follow the semantics of StreamSocket:
+	/// receiveBytes() returns 0 at the end of the stream and
+	/// throws a Poco::TimeoutException if no data arrives in time,
+	/// and failures are reported as Poco::Net::NetException.
+	///
+	/// See RTSPPipeTransport for an in-memory implementation.
+{
+public:
+	typedef Poco::AutoPtr<RTSPTransport> Ptr;
+
+	virtual void connect(const Poco::Net::SocketAddress& address, const Poco::Timespan& timeout) = 0;
+		/// Establishes the connection to the given address. Called
+		/// by RTSPSession::connect() in place of connecting the
+		/// session socket.
+
+	virtual bool connected() const = 0;
+		/// Returns true if the transport is connected.
+
+	virtual int sendBytes(const char* buffer, int length, const Poco::Timespan& timeout) = 0;
+		/// Sends up to length bytes and returns the number
+		/// of bytes sent.
+
+	virtual int receiveBytes(char* buffer, int length, const Poco::Timespan& timeout) = 0;
+		/// Receives up to length bytes, waiting at most timeout
+		/// for data to arrive. Returns the number of bytes
+		/// received, or 0 at the end of the stream.
+
+	virtual void shutdown() = 0;
+		/// Shuts down both directions of the connection.
+
+	virtual void close() = 0;
+		/// Closes the connection.
+
+	virtual RTSPVirtualClock* clock() const;
+		/// Returns the virtual clock the transport takes its time
+		/// from, or NULL if it runs in real time. The session then
+		/// measures its latencies and blocked times on that clock.
+		///
+		/// The default implementation returns NULL.
+
+protected:
+	RTSPTransport();
+		/// Creates the RTSPTransport.
+
+	virtual ~RTSPTransport();
+		/// Destroys the RTSPTransport.
+
+private:
+	RTSPTransport(const RTSPTransport&);
+	RTSPTransport& operator = (const RTSPTransport&);
+};
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_TRANSPORT__H__
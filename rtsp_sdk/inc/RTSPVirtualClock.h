@@ -0,0 +1,129 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Virtual Clock Class
+//
+//	description:
+//		manually advanced clock for deterministic timeouts
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_VIRTUAL_CLOCK__H__
+#define __RTSP_VIRTUAL_CLOCK__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Timespan.h"
+
+#include "rtsp_sdk.h"
+#include "RTSPAtomic.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPVirtualClock
+	/// RTSPVirtualClock is a clock that only moves when it is
+	/// told to. Transports that are given a virtual clock, like
+	/// RTSPPipeTransport, do not wait in real time: a receive that
+	/// would block advances the clock by the session timeout and
+	/// fails with a Poco::TimeoutException at once. Timeout paths
+	/// can thus be run in-process, instantly and with the same
+	/// result on every run.
+	///
+	/// The clock may be read and advanced from any thread.
+{
+public:
+	RTSPVirtualClock();
+		/// Creates a RTSPVirtualClock starting at the epoch.
+
+	explicit RTSPVirtualClock(const Poco::Timestamp& start);
+		/// Creates a RTSPVirtualClock starting at the given time.
+
+	~RTSPVirtualClock();
+		/// Destroys the RTSPVirtualClock.
+
+	Poco::Timestamp now() const;
+		/// Returns the current time of the clock.
+
+	Poco::Timespan elapsed(const Poco::Timestamp& since) const;
+		/// Returns the time passed on the clock since the given time.
+
+	void advance(const Poco::Timespan& span);
+		/// Moves the clock forward by the given span.
+		/// Negative spans are ignored.
+
+	void advanceTo(const Poco::Timestamp& time);
+		/// Moves the clock forward to the given time. The clock
+		/// never goes backwards; earlier times are ignored.
+
+	Poco::UInt64 timeouts() const;
+		/// Returns the number of timeouts that advanced the clock,
+		/// see timeout().
+
+	void timeout(const Poco::Timespan& span);
+		/// Advances the clock by span on behalf of an operation
+		/// that timed out, and counts the timeout.
+
+private:
+	RTSPVirtualClock(const RTSPVirtualClock&);
+	RTSPVirtualClock& operator = (const RTSPVirtualClock&);
+
+	RTSPAtomic<Poco::Timestamp::TimeVal> _now;
+	RTSPAtomic<Poco::UInt64>             _timeouts;
+};
+
+
+//
+// inlines
+//
+
+inline Poco::Timestamp RTSPVirtualClock::now() const
+{
+	return Poco::Timestamp(_now.value());
+}
+
+
+inline Poco::UInt64 RTSPVirtualClock::timeouts() const
+{
+	return _timeouts.value();
+}
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_VIRTUAL_CLOCK__H__
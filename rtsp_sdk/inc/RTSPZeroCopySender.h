@@ -0,0 +1,194 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Zero-Copy Sender Class
+//
+//	description:
+//		MSG_ZEROCOPY send path with a pool of send buffers
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#ifndef __RTSP_ZERO_COPY_SENDER__H__
+#define __RTSP_ZERO_COPY_SENDER__H__
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Timespan.h"
+#include <deque>
+#include <vector>
+
+#include "rtsp_sdk.h"
+
+
+namespace RTSP {
+
+
+class RTSP_SDK_API RTSPZeroCopySender
+	/// RTSPZeroCopySender sends data over a TCP socket with
+	/// MSG_ZEROCOPY, so that the kernel transmits directly from
+	/// the user pages instead of copying them into socket buffers.
+	///
+	/// Since the kernel keeps referencing the pages until the data
+	/// has been acknowledged, a buffer must not be modified before
+	/// the completion notification for it has been read from the
+	/// socket's error queue. The sender therefore owns a pool of
+	/// send buffers: a buffer obtained with allocate() and passed
+	/// to send() is handed over to the sender and only returns to
+	/// the pool once the kernel has reported the completion of
+	/// every send that referenced it. send() returns as soon as
+	/// the kernel has accepted the data.
+	///
+	/// Any other buffer passed to send() is sent without
+	/// MSG_ZEROCOPY: the caller is free to reuse it once send()
+	/// returns, and waiting for the completion would cost a
+	/// round trip per send.
+	///
+	/// Zero-copy sends are only available on Linux 4.14 and later.
+	/// The kernel silently falls back to copying, for example on
+	/// the loopback interface; copiedSends() reports how often that
+	/// happened.
+	///
+	/// This class is used by RTSPSession, see
+	/// RTSPSession::setZeroCopy(). It is not thread-safe.
+{
+public:
+	enum
+	{
+		DEFAULT_BUFFER_SIZE  = 65536,
+		DEFAULT_BUFFER_COUNT = 32
+	};
+
+	RTSPZeroCopySender(const Poco::Net::StreamSocket& socket, int bufferSize = DEFAULT_BUFFER_SIZE, int bufferCount = DEFAULT_BUFFER_COUNT);
+		/// Enables SO_ZEROCOPY on the given connected socket and
+		/// allocates bufferCount send buffers of bufferSize bytes.
+		///
+		/// Throws a Poco::NotImplementedException if the platform
+		/// does not support zero-copy sends.
+
+	~RTSPZeroCopySender();
+		/// Releases the send buffers without waiting for outstanding
+		/// completions; call flush() first to drain them. If the
+		/// kernel may still reference a buffer, the pool is not
+		/// released.
+
+	char* allocate(const Poco::Timespan& timeout);
+		/// Returns a send buffer of bufferSize() bytes from the pool.
+		/// If all buffers are in use, waits up to timeout for the
+		/// kernel to complete a send and throws a
+		/// Poco::TimeoutException if none completes.
+
+	void release(char* pBuffer);
+		/// Returns a buffer obtained with allocate() to the pool
+		/// without sending it.
+
+	bool owns(const char* pBuffer) const;
+		/// Returns true if pBuffer points into one of the
+		/// pool's send buffers.
+
+	int send(const char* buffer, int length, const Poco::Timespan& timeout);
+		/// Sends length bytes and returns the number of bytes sent,
+		/// which is always length.
+		///
+		/// If buffer points into a buffer obtained with allocate(),
+		/// it is sent with MSG_ZEROCOPY and taken over by the sender,
+		/// and must not be used by the caller any more. Otherwise it
+		/// is copied by the kernel as with a plain send.
+		///
+		/// Throws a Poco::TimeoutException if the socket's option
+		/// memory stays exhausted by outstanding zero-copy sends
+		/// for longer than timeout.
+
+	void flush(const Poco::Timespan& timeout);
+		/// Waits up to timeout until the kernel has completed all
+		/// outstanding sends.
+
+	int bufferSize() const;
+		/// Returns the size of a send buffer.
+
+	Poco::UInt64 copiedSends() const;
+		/// Returns the number of sends for which the kernel
+		/// fell back to copying the data.
+
+	static bool available();
+		/// Returns true if zero-copy sends are supported
+		/// on this platform.
+
+private:
+	struct Pending
+	{
+		Poco::UInt32 seq;
+		char*        pBuffer;
+		bool         done;
+	};
+
+	char* bufferOf(const char* p) const;
+	void reap(const Poco::Timespan& timeout);
+	void collect();
+
+	RTSPZeroCopySender(const RTSPZeroCopySender&);
+	RTSPZeroCopySender& operator = (const RTSPZeroCopySender&);
+
+	Poco::Net::StreamSocket _socket;
+	int                     _bufferSize;
+	char*                   _pPool;
+	int                     _poolSize;
+	std::vector<char*>      _free;
+	std::deque<Pending>     _pending;
+	Poco::UInt32            _nextSeq;
+	Poco::UInt64            _copied;
+};
+
+
+//
+// inlines
+//
+
+inline int RTSPZeroCopySender::bufferSize() const
+{
+	return _bufferSize;
+}
+
+
+inline Poco::UInt64 RTSPZeroCopySender::copiedSends() const
+{
+	return _copied;
+}
+
+
+} // namespace RTSP
+
+
+#endif // __RTSP_ZERO_COPY_SENDER__H__
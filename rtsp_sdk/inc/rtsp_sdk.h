@@ -74,6 +74,16 @@
 #endif
 
 
+//
+// RTSP_SDK_HAVE_CXX11 is defined when the compiler provides <atomic>
+// and thread_local. Visual C++ 2005 does not; code using them keeps
+// a fallback for it.
+//
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+	#define RTSP_SDK_HAVE_CXX11
+#endif
+
+
 //
 // Automatically link RTSP SDK library.
 //
@@ -48,6 +48,7 @@
 #include "RTSPClientSession.h"
 #include "RTSPRequest.h"
 #include "RTSPResponse.h"
+#include "RTSPProbes.h"
 
 using Poco::NumberFormatter;
 using Poco::IllegalStateException;
@@ -65,7 +66,9 @@ RTSPClientSession::RTSPClientSession():
 	_reconnect(false),
 	_mustReconnect(false),
 	_pRequestStream(NULL),
-	_pResponseStream(NULL)
+	_pResponseStream(NULL),
+	_requestMethod(RTSPSessionMetrics::METHOD_OTHER),
+	_pLatencyRecorder(&RTSPLatencyRecorder::defaultRecorder())
 {
 }
 
@@ -78,7 +81,9 @@ RTSPClientSession::RTSPClientSession(const StreamSocket& socket):
 	_reconnect(false),
 	_mustReconnect(false),
 	_pRequestStream(NULL),
-	_pResponseStream(NULL)
+	_pResponseStream(NULL),
+	_requestMethod(RTSPSessionMetrics::METHOD_OTHER),
+	_pLatencyRecorder(&RTSPLatencyRecorder::defaultRecorder())
 {
 }
 
@@ -91,7 +96,9 @@ RTSPClientSession::RTSPClientSession(const SocketAddress& address):
 	_reconnect(false),
 	_mustReconnect(false),
 	_pRequestStream(NULL),
-	_pResponseStream(NULL)
+	_pResponseStream(NULL),
+	_requestMethod(RTSPSessionMetrics::METHOD_OTHER),
+	_pLatencyRecorder(&RTSPLatencyRecorder::defaultRecorder())
 {
 }
 
@@ -104,7 +111,9 @@ RTSPClientSession::RTSPClientSession(const std::string& host, Poco::UInt16 port)
 	_reconnect(false),
 	_mustReconnect(false),
 	_pRequestStream(NULL),
-	_pResponseStream(NULL)
+	_pResponseStream(NULL),
+	_requestMethod(RTSPSessionMetrics::METHOD_OTHER),
+	_pLatencyRecorder(&RTSPLatencyRecorder::defaultRecorder())
 {
 }
 
@@ -188,14 +197,34 @@ void RTSPClientSession::setKeepAliveTimeout(const Poco::Timespan& timeout)
 }
 */
 
+void RTSPClientSession::open()
+{
+	if (!connected())
+	{
+		reconnect();
+	}
+}
+
+
 std::ostream& RTSPClientSession::sendRequest(RTSPRequest& request)
 {
+	_requestStarted = now();
+	_requestMethod = RTSPSessionMetrics::methodOf(request.getMethod());
+
 	delete _pResponseStream;
 	_pResponseStream = NULL;
 	
 	if (!connected())
 	{
-		reconnect();
+		try
+		{
+			reconnect();
+		}
+		catch (Poco::Exception& exc)
+		{
+			recordFailure(exc);
+			throw;
+		}
 	}
 
 	Poco::UInt16 cSeq = getCSeq();
@@ -203,6 +232,13 @@ std::ostream& RTSPClientSession::sendRequest(RTSPRequest& request)
 	++cSeq;
 	setCSeq(cSeq);
 
+	startTimestamps();
+	metrics()->requested(_requestMethod);
+	if (RTSP_PROBE_ENABLED(request_send))
+	{
+		RTSP_PROBE3(request_send, this, request.getMethod().c_str(), (int) cSeq - 1);
+	}
+
 	if (!_proxyHost.empty())
 		request.setURI(getHostInfo() + request.getURI());
 
@@ -229,23 +265,43 @@ std::istream& RTSPClientSession::receiveResponse(RTSPResponse& response)
 	delete _pRequestStream;
 	_pRequestStream = NULL;
 
-	do
+	try
 	{
-		response.clear();
-		RTSPHeaderInputStream his(*this);
-		try
-		{
-			response.read(his);
-		}
-		catch (MessageException&)
+		do
 		{
-			if (networkException())
-				networkException()->rethrow();
-			else
-				throw;
+			response.clear();
+			RTSPHeaderInputStream his(*this);
+			try
+			{
+				response.read(his);
+			}
+			catch (MessageException&)
+			{
+				if (networkException())
+					networkException()->rethrow();
+				else
+					throw;
+			}
 		}
+		while (response.getStatus() == RTSPResponse::RTSP_CONTINUE);
+	}
+	catch (Poco::Exception& exc)
+	{
+		recordFailure(exc);
+		throw;
+	}
+	metrics()->responded();
+	if (NULL != _pLatencyRecorder)
+	{
+		_pLatencyRecorder->record(_requestMethod, RTSPLatencyRecorder::statusClassOf(response.getStatus()), now() - _requestStarted);
+	}
+
+	Poco::Timestamp transmitted;
+	Poco::Timestamp received;
+	if (getTimestamps(transmitted, received))
+	{
+		response.setTimestamps(transmitted, received);
 	}
-	while (response.getStatus() == RTSPResponse::RTSP_CONTINUE);
 
 	if (RTSPMessage::UNKNOWN_CONTENT_LENGTH != response.getContentLength())
 	{
@@ -272,9 +328,12 @@ int RTSPClientSession::write(const char* buffer, std::streamsize length)
 	{
 		if (_reconnect)
 		{
-			close();
+			// buffer may come from the zero-copy pool, which goes
+			// away with the connection, so resend from a copy.
+			std::string data(buffer, (std::size_t) length);
+			close(false);
 			reconnect();
-			int rc = RTSPSession::write(buffer, length);
+			int rc = RTSPSession::write(data.data(), length);
 			_reconnect = false;
 			return rc;
 		}
@@ -285,6 +344,8 @@ int RTSPClientSession::write(const char* buffer, std::streamsize length)
 
 void RTSPClientSession::reconnect()
 {
+	RTSP_PROBE2(reconnect, this, (int) (_proxyHost.empty() ? _port : _proxyPort));
+	Poco::Clock start(now());
 	if (_proxyHost.empty())
 	{
 		SocketAddress addr(_host, _port);
@@ -295,6 +356,24 @@ void RTSPClientSession::reconnect()
 		SocketAddress addr(_proxyHost, _proxyPort);
 		connect(addr);
 	}
+
+	// connecting, and a TLS handshake, is not part of the latency
+	// of the exchange that needed it, but recorded on its own
+	Poco::Clock::ClockDiff connectTime = now() - start;
+	_requestStarted = _requestStarted + connectTime;
+	if (NULL != _pLatencyRecorder)
+	{
+		_pLatencyRecorder->recordConnect(connectTime);
+	}
+}
+
+
+void RTSPClientSession::recordFailure(const Poco::Exception& exc)
+{
+	if (NULL != _pLatencyRecorder)
+	{
+		_pLatencyRecorder->recordFailure(_requestMethod, NULL != dynamic_cast<const Poco::TimeoutException*>(&exc));
+	}
 }
 
 
@@ -0,0 +1,790 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP io_uring I/O Engine Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/Exception.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Clock.h"
+
+#include "RTSPIOUring.h"
+
+#if defined(RTSP_SDK_HAVE_IO_URING)
+	#include <liburing.h>
+	#include <sys/eventfd.h>
+	#include <sys/socket.h>
+	#include <sys/uio.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+	#include <deque>
+#endif
+
+
+using Poco::Mutex;
+using Poco::Timespan;
+using Poco::Clock;
+using Poco::TimeoutException;
+using Poco::NotImplementedException;
+
+
+namespace RTSP {
+
+
+#if defined(RTSP_SDK_HAVE_IO_URING)
+
+
+namespace
+{
+	enum
+	{
+		BUFFER_GROUP = 0
+	};
+
+	void throwError(int error)
+	{
+		switch (error)
+		{
+		case ECONNRESET:
+		case EPIPE:
+			throw Poco::Net::ConnectionResetException(std::strerror(error), error);
+		case ECANCELED:
+		case ETIME:
+			throw TimeoutException();
+		default:
+			throw Poco::Net::NetException(std::strerror(error), error);
+		}
+	}
+
+	long remainingMilliseconds(const Clock& deadline)
+	{
+		Clock now;
+		return now < deadline ? (long) ((deadline - now) / 1000) + 1 : 0;
+	}
+
+	bool receiveIsMultishot(struct io_uring* pRing, struct io_uring_buf_ring* pBufRing)
+		/// Arms a multishot receive on a socket pair with one byte
+		/// waiting. Kernels before 6.0 reject it, later ones keep
+		/// it armed after the first completion.
+	{
+		int fds[2];
+		if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+		{
+			return false;
+		}
+
+		char buffer[16];
+		io_uring_buf_ring_add(pBufRing, buffer, sizeof(buffer), 0, io_uring_buf_ring_mask(1), 0);
+		io_uring_buf_ring_advance(pBufRing, 1);
+
+		bool result = false;
+		struct io_uring_sqe* pSqe = io_uring_get_sqe(pRing);
+		if (NULL != pSqe && ::write(fds[1], "", 1) == 1)
+		{
+			io_uring_prep_recv_multishot(pSqe, fds[0], NULL, 0, 0);
+			io_uring_sqe_set_flags(pSqe, IOSQE_BUFFER_SELECT);
+			pSqe->buf_group = BUFFER_GROUP;
+			struct io_uring_cqe* pCqe = NULL;
+			if (io_uring_submit(pRing) == 1 && io_uring_wait_cqe(pRing, &pCqe) == 0)
+			{
+				result = pCqe->res > 0 && (pCqe->flags & IORING_CQE_F_MORE) != 0;
+				io_uring_cqe_seen(pRing, pCqe);
+			}
+		}
+		::close(fds[0]);
+		::close(fds[1]);
+		return result;
+	}
+}
+
+
+struct RTSPIOUring::Op
+{
+	enum Type
+	{
+		OP_RECEIVE,
+		OP_SEND,
+		OP_WAKEUP,
+		OP_IGNORE
+	};
+
+	Op(Type t, Channel* pCh):
+		type(t),
+		pChannel(pCh),
+		result(0),
+		done(false)
+	{
+	}
+
+	Type     type;
+	Channel* pChannel;
+	int      result;
+	bool     done;
+};
+
+
+class RTSPIOUring::Channel
+{
+public:
+	struct Chunk
+	{
+		unsigned short bufferId;
+		int            offset;
+		int            length;
+	};
+
+	Channel(int sockfd):
+		fd(sockfd),
+		recvOp(Op::OP_RECEIVE, this),
+		sendOp(Op::OP_SEND, this),
+		recvArmed(false),
+		recvCancelled(false),
+		eof(false),
+		error(0),
+		closing(false)
+	{
+		std::memset(&sendTimeout, 0, sizeof(sendTimeout));
+	}
+
+	int                     fd;
+	Op                      recvOp;
+	Op                      sendOp;
+	struct __kernel_timespec sendTimeout;
+	std::deque<Chunk>       chunks;
+	bool                    recvArmed;
+	bool                    recvCancelled;  /// holds too many buffers, waiting for the receive to end
+	bool                    eof;
+	int                     error;
+	bool                    closing;
+	Poco::Condition         cond;
+};
+
+
+RTSPIOUring::RTSPIOUring(unsigned entries, unsigned bufferCount, unsigned bufferSize):
+	_pRing(new struct io_uring),
+	_pBufRing(NULL),
+	_pRecvBuffers(NULL),
+	_pSendBuffers(NULL),
+	_bufferCount(bufferCount),
+	_bufferSize(bufferSize),
+	_freeRecvBuffers(bufferCount),
+	_channelBuffers(bufferCount / 4 < (unsigned) MAX_CHANNEL_BUFFERS ? (bufferCount / 4 > 0 ? bufferCount / 4 : 1) : (unsigned) MAX_CHANNEL_BUFFERS),
+	_wakeFd(-1),
+	_pWakeOp(new Op(Op::OP_WAKEUP, NULL)),
+	_pIgnoreOp(new Op(Op::OP_IGNORE, NULL)),
+	_failure(0),
+	_queued(0),
+	_stop(false)
+{
+	poco_assert(bufferCount > 0 && bufferCount <= 32768 && (bufferCount & (bufferCount - 1)) == 0);
+
+	int rc = io_uring_queue_init(entries, _pRing, 0);
+	if (rc < 0)
+	{
+		delete _pRing;
+		delete _pWakeOp;
+		delete _pIgnoreOp;
+		throw Poco::SystemException("cannot create io_uring", std::strerror(-rc));
+	}
+
+	_pRecvBuffers = new char[bufferCount * bufferSize];
+	_pSendBuffers = new char[bufferCount * bufferSize];
+
+	_pBufRing = io_uring_setup_buf_ring(_pRing, bufferCount, BUFFER_GROUP, 0, &rc);
+	if (NULL != _pBufRing)
+	{
+		int mask = io_uring_buf_ring_mask(bufferCount);
+		for (unsigned i = 0; i < bufferCount; ++i)
+		{
+			io_uring_buf_ring_add(_pBufRing, _pRecvBuffers + i * bufferSize, bufferSize, (unsigned short) i, mask, i);
+		}
+		io_uring_buf_ring_advance(_pBufRing, bufferCount);
+
+		std::vector<struct iovec> iovecs(bufferCount);
+		_freeSendBuffers.reserve(bufferCount);
+		for (unsigned i = 0; i < bufferCount; ++i)
+		{
+			iovecs[i].iov_base = _pSendBuffers + i * bufferSize;
+			iovecs[i].iov_len  = bufferSize;
+			_freeSendBuffers.push_back((int) i);
+		}
+		rc = io_uring_register_buffers(_pRing, &iovecs[0], bufferCount);
+		if (rc == 0)
+		{
+			_wakeFd = eventfd(0, EFD_CLOEXEC);
+		}
+	}
+
+	if (NULL == _pBufRing || rc < 0 || _wakeFd < 0)
+	{
+		std::string reason(std::strerror(NULL == _pBufRing || rc < 0 ? -rc : errno));
+		if (NULL != _pBufRing)
+		{
+			io_uring_free_buf_ring(_pRing, _pBufRing, bufferCount, BUFFER_GROUP);
+		}
+		io_uring_queue_exit(_pRing);
+		delete _pRing;
+		delete [] _pRecvBuffers;
+		delete [] _pSendBuffers;
+		delete _pWakeOp;
+		delete _pIgnoreOp;
+		throw Poco::SystemException("cannot set up io_uring buffers", reason);
+	}
+
+	_thread.setName("RTSPIOUring");
+	_thread.start(*this);
+}
+
+
+RTSPIOUring::~RTSPIOUring()
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+		_stop = true;
+		wakeup();
+	}
+	_thread.join();
+
+	io_uring_unregister_buffers(_pRing);
+	io_uring_free_buf_ring(_pRing, _pBufRing, _bufferCount, BUFFER_GROUP);
+	io_uring_queue_exit(_pRing);
+	::close(_wakeFd);
+
+	delete _pRing;
+	delete [] _pRecvBuffers;
+	delete [] _pSendBuffers;
+	delete _pWakeOp;
+	delete _pIgnoreOp;
+}
+
+
+RTSPIOUring::Channel* RTSPIOUring::attach(poco_socket_t sockfd)
+{
+	Mutex::ScopedLock lock(_mutex);
+	if (0 != _failure)
+	{
+		throwError(_failure);
+	}
+	Channel* pChannel = new Channel(sockfd);
+	_channels.insert(pChannel);
+	armReceive(pChannel);
+	return pChannel;
+}
+
+
+void RTSPIOUring::detach(Channel* pChannel)
+{
+	poco_check_ptr(pChannel);
+
+	Mutex::ScopedLock lock(_mutex);
+	pChannel->closing = true;
+	if (pChannel->recvArmed)
+	{
+		struct io_uring_sqe* pSqe = getSQE();
+		io_uring_prep_cancel(pSqe, &pChannel->recvOp, 0);
+		io_uring_sqe_set_data(pSqe, _pIgnoreOp);
+		wakeup();
+		while (pChannel->recvArmed)
+		{
+			pChannel->cond.wait(_mutex);
+		}
+	}
+	while (!pChannel->chunks.empty())
+	{
+		recycle(pChannel->chunks.front().bufferId);
+		pChannel->chunks.pop_front();
+	}
+	_channels.erase(pChannel);
+	delete pChannel;
+}
+
+
+int RTSPIOUring::receive(Channel* pChannel, char* buffer, int length, const Timespan& timeout)
+{
+	poco_check_ptr(pChannel);
+
+	Clock deadline(Clock() + timeout.totalMicroseconds());
+
+	Mutex::ScopedLock lock(_mutex);
+	while (pChannel->chunks.empty() && !pChannel->eof && 0 == pChannel->error)
+	{
+		if (0 != _failure)
+		{
+			throwError(_failure);
+		}
+		if (!pChannel->recvArmed && _freeRecvBuffers > 0)
+		{
+			armReceive(pChannel);
+		}
+
+		long milliseconds = remainingMilliseconds(deadline);
+		if (0 == milliseconds)
+		{
+			throw TimeoutException();
+		}
+		if (pChannel->recvArmed)
+		{
+			pChannel->cond.tryWait(_mutex, milliseconds);
+		}
+		else
+		{
+			// all receive buffers are held by other sessions
+			_bufferCond.tryWait(_mutex, milliseconds);
+		}
+	}
+
+	if (!pChannel->chunks.empty())
+	{
+		Channel::Chunk& chunk = pChannel->chunks.front();
+		int n = chunk.length < length ? chunk.length : length;
+		std::memcpy(buffer, _pRecvBuffers + chunk.bufferId * _bufferSize + chunk.offset, n);
+		chunk.offset += n;
+		chunk.length -= n;
+		if (0 == chunk.length)
+		{
+			recycle(chunk.bufferId);
+			pChannel->chunks.pop_front();
+		}
+		return n;
+	}
+
+	if (0 != pChannel->error)
+	{
+		int error = pChannel->error;
+		pChannel->error = 0;
+		throwError(error);
+	}
+	return 0;
+}
+
+
+int RTSPIOUring::send(Channel* pChannel, const char* buffer, int length, const Timespan& timeout)
+{
+	poco_check_ptr(pChannel);
+
+	Clock deadline(Clock() + timeout.totalMicroseconds());
+
+	Mutex::ScopedLock lock(_mutex);
+	while (_freeSendBuffers.empty())
+	{
+		if (0 != _failure)
+		{
+			throwError(_failure);
+		}
+		long milliseconds = remainingMilliseconds(deadline);
+		if (0 == milliseconds)
+		{
+			throw TimeoutException("no io_uring send buffer available");
+		}
+		_bufferCond.tryWait(_mutex, milliseconds);
+	}
+	int index = _freeSendBuffers.back();
+	_freeSendBuffers.pop_back();
+	char* pSendBuffer = _pSendBuffers + index * _bufferSize;
+
+	int sent = 0;
+	int error = _failure;
+	while (sent < length && 0 == error)
+	{
+		// every write gets what is left of the timeout
+		Clock::ClockDiff remaining = deadline - Clock();
+		if (remaining <= 0)
+		{
+			error = ETIME;
+			break;
+		}
+		pChannel->sendTimeout.tv_sec  = (long long) (remaining / Timespan::SECONDS);
+		pChannel->sendTimeout.tv_nsec = (long long) (remaining % Timespan::SECONDS) * 1000;
+
+		int n = length - sent;
+		if (n > (int) _bufferSize)
+		{
+			n = (int) _bufferSize;
+		}
+		std::memcpy(pSendBuffer, buffer + sent, n);
+
+		Op& op = pChannel->sendOp;
+		op.done   = false;
+		op.result = 0;
+
+		struct io_uring_sqe* pSqe = getSQE(2);
+		io_uring_prep_write_fixed(pSqe, pChannel->fd, pSendBuffer, n, 0, index);
+		io_uring_sqe_set_flags(pSqe, IOSQE_IO_LINK);
+		io_uring_sqe_set_data(pSqe, &op);
+		pSqe = io_uring_get_sqe(_pRing);
+		io_uring_prep_link_timeout(pSqe, &pChannel->sendTimeout, 0);
+		io_uring_sqe_set_data(pSqe, _pIgnoreOp);
+		wakeup();
+
+		bool cancelled = false;
+		while (!op.done)
+		{
+			long milliseconds = remainingMilliseconds(deadline);
+			if (milliseconds > 0)
+			{
+				pChannel->cond.tryWait(_mutex, milliseconds);
+			}
+			else if (!cancelled)
+			{
+				// the linked timeout should have ended the write by
+				// now; the buffer is only free once it has completed
+				struct io_uring_sqe* pCancel = getSQE();
+				io_uring_prep_cancel(pCancel, &op, 0);
+				io_uring_sqe_set_data(pCancel, _pIgnoreOp);
+				wakeup();
+				cancelled = true;
+			}
+			else
+			{
+				pChannel->cond.tryWait(_mutex, 100);
+			}
+		}
+
+		// a partial write leaves the rest of the chunk to the next round
+		if (op.result > 0)
+			sent += op.result;
+		else if (op.result == 0)
+			error = EPIPE;
+		else
+			error = -op.result;
+	}
+
+	_freeSendBuffers.push_back(index);
+	_bufferCond.broadcast();
+
+	if (0 != error)
+	{
+		throwError(error);
+	}
+	return sent;
+}
+
+
+void RTSPIOUring::run()
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+		armWakeup();
+	}
+
+	for (;;)
+	{
+		{
+			Mutex::ScopedLock lock(_mutex);
+			if (_stop)
+			{
+				break;
+			}
+			io_uring_submit(_pRing);
+			_queued = 0;
+		}
+
+		struct io_uring_cqe* pCqe = NULL;
+		int rc = io_uring_wait_cqe(_pRing, &pCqe);
+		if (rc < 0 && rc != -EINTR && rc != -ETIME)
+		{
+			fail(-rc);
+			break;
+		}
+
+		Mutex::ScopedLock lock(_mutex);
+		unsigned head;
+		unsigned count = 0;
+		io_uring_for_each_cqe(_pRing, head, pCqe)
+		{
+			complete(pCqe);
+			++count;
+		}
+		io_uring_cq_advance(_pRing, count);
+	}
+}
+
+
+bool RTSPIOUring::available()
+{
+	struct io_uring ring;
+	if (io_uring_queue_init(2, &ring, 0) < 0)
+	{
+		return false;
+	}
+
+	bool result = false;
+	struct io_uring_probe* pProbe = io_uring_get_probe_ring(&ring);
+	if (NULL != pProbe)
+	{
+		int rc = 0;
+		struct io_uring_buf_ring* pBufRing = io_uring_setup_buf_ring(&ring, 1, BUFFER_GROUP, 0, &rc);
+		result = io_uring_opcode_supported(pProbe, IORING_OP_RECV) && NULL != pBufRing && receiveIsMultishot(&ring, pBufRing);
+		if (NULL != pBufRing)
+		{
+			io_uring_free_buf_ring(&ring, pBufRing, 1, BUFFER_GROUP);
+		}
+		io_uring_free_probe(pProbe);
+	}
+	io_uring_queue_exit(&ring);
+	return result;
+}
+
+
+struct io_uring_sqe* RTSPIOUring::getSQE(unsigned count)
+{
+	// linked requests must end up in the same submission
+	if (io_uring_sq_space_left(_pRing) < count)
+	{
+		io_uring_submit(_pRing);
+		_queued = 0;
+	}
+	return io_uring_get_sqe(_pRing);
+}
+
+
+void RTSPIOUring::wakeup()
+{
+	// only the first request queued since the last submission wakes the
+	// engine thread; the following ones are submitted in the same batch.
+	if (0 == _queued++)
+	{
+		eventfd_write(_wakeFd, 1);
+	}
+}
+
+
+void RTSPIOUring::armWakeup()
+{
+	struct io_uring_sqe* pSqe = getSQE();
+	io_uring_prep_poll_multishot(pSqe, _wakeFd, POLLIN);
+	io_uring_sqe_set_data(pSqe, _pWakeOp);
+}
+
+
+void RTSPIOUring::armReceive(Channel* pChannel)
+{
+	struct io_uring_sqe* pSqe = getSQE();
+	io_uring_prep_recv_multishot(pSqe, pChannel->fd, NULL, 0, 0);
+	io_uring_sqe_set_flags(pSqe, IOSQE_BUFFER_SELECT);
+	pSqe->buf_group = BUFFER_GROUP;
+	io_uring_sqe_set_data(pSqe, &pChannel->recvOp);
+	pChannel->recvArmed = true;
+	wakeup();
+}
+
+
+void RTSPIOUring::recycle(unsigned short bufferId)
+{
+	io_uring_buf_ring_add(_pBufRing, _pRecvBuffers + bufferId * _bufferSize, _bufferSize, bufferId, io_uring_buf_ring_mask(_bufferCount), 0);
+	io_uring_buf_ring_advance(_pBufRing, 1);
+	if (0 == _freeRecvBuffers++)
+	{
+		_bufferCond.broadcast();
+	}
+}
+
+
+void RTSPIOUring::complete(struct io_uring_cqe* pCqe)
+{
+	Op* pOp = reinterpret_cast<Op*>(io_uring_cqe_get_data(pCqe));
+	if (NULL == pOp)
+	{
+		return;
+	}
+
+	bool more = (pCqe->flags & IORING_CQE_F_MORE) != 0;
+	switch (pOp->type)
+	{
+	case Op::OP_RECEIVE:
+		{
+			Channel* pChannel = pOp->pChannel;
+			if (pCqe->flags & IORING_CQE_F_BUFFER)
+			{
+				unsigned short bufferId = (unsigned short) (pCqe->flags >> IORING_CQE_BUFFER_SHIFT);
+				--_freeRecvBuffers;
+				if (pChannel->closing || pCqe->res <= 0)
+				{
+					recycle(bufferId);
+				}
+				else
+				{
+					Channel::Chunk chunk = { bufferId, 0, pCqe->res };
+					pChannel->chunks.push_back(chunk);
+				}
+			}
+
+			if (more && !pChannel->recvCancelled && pChannel->chunks.size() >= _channelBuffers)
+			{
+				// stop a session that does not read from filling the
+				// ring shared with all others; buffers received until
+				// the cancellation takes effect are still queued
+				struct io_uring_sqe* pSqe = getSQE();
+				io_uring_prep_cancel(pSqe, &pChannel->recvOp, 0);
+				io_uring_sqe_set_data(pSqe, _pIgnoreOp);
+				pChannel->recvCancelled = true;
+			}
+
+			if (0 == pCqe->res)
+			{
+				pChannel->eof = true;
+			}
+			else if (pCqe->res < 0 && pCqe->res != -ENOBUFS && pCqe->res != -ECANCELED)
+			{
+				pChannel->error = -pCqe->res;
+			}
+
+			if (!more)
+			{
+				// re-armed by receive() once the session wants more data
+				pChannel->recvArmed     = false;
+				pChannel->recvCancelled = false;
+			}
+			pChannel->cond.broadcast();
+		}
+		break;
+
+	case Op::OP_SEND:
+		pOp->result = pCqe->res;
+		pOp->done   = true;
+		pOp->pChannel->cond.broadcast();
+		break;
+
+	case Op::OP_WAKEUP:
+		{
+			eventfd_t value;
+			eventfd_read(_wakeFd, &value);
+			if (!more && !_stop)
+			{
+				armWakeup();
+			}
+		}
+		break;
+
+	case Op::OP_IGNORE:
+		break;
+	}
+}
+
+
+void RTSPIOUring::fail(int error)
+{
+	// no completion will be reaped any more, so the requests in
+	// flight are failed here and their sessions woken
+	Mutex::ScopedLock lock(_mutex);
+	_failure = error;
+	for (std::set<Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
+	{
+		Channel* pChannel = *it;
+		pChannel->sendOp.result = -error;
+		pChannel->sendOp.done   = true;
+		pChannel->recvArmed     = false;
+		pChannel->recvCancelled = false;
+		pChannel->cond.broadcast();
+	}
+	_bufferCond.broadcast();
+}
+
+
+#else // RTSP_SDK_HAVE_IO_URING
+
+
+struct RTSPIOUring::Op
+{
+};
+
+
+RTSPIOUring::RTSPIOUring(unsigned entries, unsigned bufferCount, unsigned bufferSize):
+	_pRing(NULL),
+	_pBufRing(NULL),
+	_pRecvBuffers(NULL),
+	_pSendBuffers(NULL),
+	_bufferCount(bufferCount),
+	_bufferSize(bufferSize),
+	_freeRecvBuffers(0),
+	_channelBuffers(0),
+	_wakeFd(-1),
+	_pWakeOp(NULL),
+	_pIgnoreOp(NULL),
+	_failure(0),
+	_queued(0),
+	_stop(true)
+{
+	throw NotImplementedException("RTSP SDK has been built without io_uring support");
+}
+
+
+RTSPIOUring::~RTSPIOUring()
+{
+}
+
+
+RTSPIOUring::Channel* RTSPIOUring::attach(poco_socket_t sockfd)
+{
+	throw NotImplementedException("RTSPIOUring::attach()");
+}
+
+
+void RTSPIOUring::detach(Channel* pChannel)
+{
+	throw NotImplementedException("RTSPIOUring::detach()");
+}
+
+
+int RTSPIOUring::receive(Channel* pChannel, char* buffer, int length, const Timespan& timeout)
+{
+	throw NotImplementedException("RTSPIOUring::receive()");
+}
+
+
+int RTSPIOUring::send(Channel* pChannel, const char* buffer, int length, const Timespan& timeout)
+{
+	throw NotImplementedException("RTSPIOUring::send()");
+}
+
+
+void RTSPIOUring::run()
+{
+}
+
+
+bool RTSPIOUring::available()
+{
+	return false;
+}
+
+
+#endif // RTSP_SDK_HAVE_IO_URING
+
+
+} // namespace RTSP
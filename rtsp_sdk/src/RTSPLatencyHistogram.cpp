@@ -0,0 +1,254 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Latency Histogram Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTSPLatencyHistogram.h"
+
+
+using Poco::Timestamp;
+
+
+namespace RTSP {
+
+
+namespace
+{
+	const Poco::UInt64 NO_MIN = ~(Poco::UInt64) 0;
+
+	int highestBit(Poco::UInt64 value)
+	{
+	#if defined(__GNUC__)
+		return 63 - __builtin_clzll(value);
+	#else
+		int bit = 0;
+		while (value >>= 1)
+		{
+			++bit;
+		}
+		return bit;
+	#endif
+	}
+}
+
+
+RTSPLatencyHistogram::RTSPLatencyHistogram():
+	_count(0),
+	_sum(0),
+	_min(NO_MIN),
+	_max(0)
+{
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		_buckets[i].set(0);
+	}
+}
+
+
+RTSPLatencyHistogram::RTSPLatencyHistogram(const RTSPLatencyHistogram& other):
+	_count(0),
+	_sum(0),
+	_min(NO_MIN),
+	_max(0)
+{
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		_buckets[i].set(0);
+	}
+	merge(other);
+}
+
+
+RTSPLatencyHistogram& RTSPLatencyHistogram::operator = (const RTSPLatencyHistogram& other)
+{
+	if (&other != this)
+	{
+		reset();
+		merge(other);
+	}
+	return *this;
+}
+
+
+RTSPLatencyHistogram::~RTSPLatencyHistogram()
+{
+}
+
+
+void RTSPLatencyHistogram::record(Timestamp::TimeDiff value)
+{
+	Poco::UInt64 v = value < 0 ? 0 : (Poco::UInt64) value;
+	if (v > (Poco::UInt64) highestTrackableValue())
+	{
+		v = (Poco::UInt64) highestTrackableValue();
+	}
+
+	_buckets[bucketOf(v)].add(1);
+	_count.add(1);
+	_sum.add(v);
+
+	_min.lower(v);
+	_max.raise(v);
+}
+
+
+void RTSPLatencyHistogram::merge(const RTSPLatencyHistogram& other)
+{
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		Poco::UInt64 n = other._buckets[i].value();
+		if (n > 0)
+		{
+			_buckets[i].add(n);
+		}
+	}
+	_count.add(other._count.value());
+	_sum.add(other._sum.value());
+
+	_min.lower(other._min.value());
+	_max.raise(other._max.value());
+}
+
+
+void RTSPLatencyHistogram::reset()
+{
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		_buckets[i].set(0);
+	}
+	_count.set(0);
+	_sum.set(0);
+	_min.set(NO_MIN);
+	_max.set(0);
+}
+
+
+Timestamp::TimeDiff RTSPLatencyHistogram::min() const
+{
+	Poco::UInt64 v = _min.value();
+	return v == NO_MIN ? 0 : (Timestamp::TimeDiff) v;
+}
+
+
+Timestamp::TimeDiff RTSPLatencyHistogram::max() const
+{
+	return (Timestamp::TimeDiff) _max.value();
+}
+
+
+double RTSPLatencyHistogram::mean() const
+{
+	Poco::UInt64 n = count();
+	return n > 0 ? (double) sum() / (double) n : 0.0;
+}
+
+
+Timestamp::TimeDiff RTSPLatencyHistogram::valueAtPercentile(double percentile) const
+{
+	// the bucket counters are read once, so a concurrent record()
+	// can make the total differ slightly from count().
+	Poco::UInt64 total = 0;
+	Poco::UInt64 counts[BUCKET_COUNT];
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		counts[i] = _buckets[i].value();
+		total += counts[i];
+	}
+	if (total == 0)
+	{
+		return 0;
+	}
+
+	if (percentile < 0.0)
+		percentile = 0.0;
+	else if (percentile > 100.0)
+		percentile = 100.0;
+
+	Poco::UInt64 wanted = (Poco::UInt64) (percentile / 100.0 * (double) total + 0.5);
+	if (wanted == 0)
+	{
+		wanted = 1;
+	}
+
+	Poco::UInt64 seen = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		seen += counts[i];
+		if (seen >= wanted)
+		{
+			Poco::UInt64 value = highestValueOf(i);
+			Poco::UInt64 largest = _max.value();
+			return (Timestamp::TimeDiff) (value < largest ? value : largest);
+		}
+	}
+	return max();
+}
+
+
+Timestamp::TimeDiff RTSPLatencyHistogram::highestTrackableValue()
+{
+	return ((Timestamp::TimeDiff) 1 << (MAX_EXPONENT + SUB_BUCKET_BITS + 1)) - 1;
+}
+
+
+int RTSPLatencyHistogram::bucketOf(Poco::UInt64 value)
+{
+	// values below 2 * SUB_BUCKET_COUNT are counted exactly; above,
+	// each power of two 2^n is split into SUB_BUCKET_COUNT buckets
+	// of 2^(n - SUB_BUCKET_BITS) values each.
+	if (value < 2 * SUB_BUCKET_COUNT)
+	{
+		return (int) value;
+	}
+	int exponent = highestBit(value) - SUB_BUCKET_BITS;
+	return exponent * SUB_BUCKET_COUNT + (int) (value >> exponent);
+}
+
+
+Poco::UInt64 RTSPLatencyHistogram::highestValueOf(int bucket)
+{
+	if (bucket < 2 * SUB_BUCKET_COUNT)
+	{
+		return (Poco::UInt64) bucket;
+	}
+	int exponent = bucket / SUB_BUCKET_COUNT - 1;
+	Poco::UInt64 mantissa = (Poco::UInt64) (bucket % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT);
+	return ((mantissa + 1) << exponent) - 1;
+}
+
+
+} // namespace RTSP
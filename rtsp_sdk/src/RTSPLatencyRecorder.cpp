@@ -0,0 +1,274 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Latency Recorder Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/SingletonHolder.h"
+#include <sstream>
+
+#include "RTSPLatencyRecorder.h"
+
+
+using Poco::SingletonHolder;
+using Poco::Timestamp;
+
+
+namespace RTSP {
+
+
+namespace
+{
+	const char* const METRIC_NAME         = "rtsp_request_latency_microseconds";
+	const char* const CONNECT_METRIC_NAME = "rtsp_connect_latency_microseconds";
+	const char* const FAILURE_METRIC_NAME = "rtsp_request_failures_total";
+
+	const char* const STATUS_CLASS_NAMES[RTSPLatencyRecorder::STATUS_CLASS_COUNT] =
+	{
+		"other", "1xx", "2xx", "3xx", "4xx", "5xx"
+	};
+
+	const double QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+	void writeLabels(std::ostream& ostr, RTSPSessionMetrics::Method method, RTSPLatencyRecorder::StatusClass statusClass)
+	{
+		const std::string& name = RTSPSessionMetrics::methodName(method);
+		ostr << "{method=\"" << (name.empty() ? "OTHER" : name.c_str())
+		     << "\",status=\"" << STATUS_CLASS_NAMES[statusClass] << "\"";
+	}
+
+	void writeSummary(std::ostream& ostr, const char* name, const std::string& labels, const RTSPLatencyHistogram& histogram)
+		/// Writes the quantiles, sum and count of the histogram;
+		/// labels is empty or a list of labels ending in a comma.
+	{
+		for (std::size_t q = 0; q < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++q)
+		{
+			ostr << name << "{" << labels << "quantile=\"" << QUANTILES[q] << "\"} " << histogram.valueAtPercentile(QUANTILES[q] * 100.0) << "\n";
+		}
+		std::string braced = labels.empty() ? std::string() : "{" + labels.substr(0, labels.size() - 1) + "}";
+		ostr << name << "_sum" << braced << " " << histogram.sum() << "\n";
+		ostr << name << "_count" << braced << " " << histogram.count() << "\n";
+	}
+}
+
+
+RTSPLatencyRecorder::RTSPLatencyRecorder()
+{
+	for (int m = 0; m < RTSPSessionMetrics::METHOD_COUNT; ++m)
+	{
+		for (int s = 0; s < STATUS_CLASS_COUNT; ++s)
+		{
+			_histograms[m][s].set(NULL);
+		}
+		_timeouts[m].set(0);
+		_failures[m].set(0);
+	}
+}
+
+
+RTSPLatencyRecorder::~RTSPLatencyRecorder()
+{
+	for (int m = 0; m < RTSPSessionMetrics::METHOD_COUNT; ++m)
+	{
+		for (int s = 0; s < STATUS_CLASS_COUNT; ++s)
+		{
+			delete _histograms[m][s].load();
+		}
+	}
+}
+
+
+void RTSPLatencyRecorder::record(const std::string& method, int status, Timestamp::TimeDiff latency)
+{
+	record(RTSPSessionMetrics::methodOf(method), statusClassOf(status), latency);
+}
+
+
+void RTSPLatencyRecorder::record(RTSPSessionMetrics::Method method, StatusClass statusClass, Timestamp::TimeDiff latency)
+{
+	RTSPAtomic<RTSPLatencyHistogram*>& slot = _histograms[method][statusClass];
+	RTSPLatencyHistogram* pHistogram = slot.load();
+	if (NULL == pHistogram)
+	{
+		// racing threads may both allocate; the loser deletes its copy
+		RTSPLatencyHistogram* pNew = new RTSPLatencyHistogram;
+		if (slot.compareExchange(pHistogram, pNew))
+		{
+			pHistogram = pNew;
+		}
+		else
+		{
+			delete pNew;
+		}
+	}
+	pHistogram->record(latency);
+}
+
+
+void RTSPLatencyRecorder::recordConnect(Timestamp::TimeDiff duration)
+{
+	_connectHistogram.record(duration);
+}
+
+
+void RTSPLatencyRecorder::recordFailure(RTSPSessionMetrics::Method method, bool timedOut)
+{
+	(timedOut ? _timeouts : _failures)[method].add(1);
+}
+
+
+RTSPLatencyHistogram RTSPLatencyRecorder::histogram(RTSPSessionMetrics::Method method, StatusClass statusClass) const
+{
+	const RTSPLatencyHistogram* pHistogram = _histograms[method][statusClass].load();
+	return NULL != pHistogram ? RTSPLatencyHistogram(*pHistogram) : RTSPLatencyHistogram();
+}
+
+
+RTSPLatencyHistogram RTSPLatencyRecorder::histogram(RTSPSessionMetrics::Method method) const
+{
+	RTSPLatencyHistogram result;
+	for (int s = 0; s < STATUS_CLASS_COUNT; ++s)
+	{
+		const RTSPLatencyHistogram* pHistogram = _histograms[method][s].load();
+		if (NULL != pHistogram)
+		{
+			result.merge(*pHistogram);
+		}
+	}
+	return result;
+}
+
+
+RTSPLatencyHistogram RTSPLatencyRecorder::connectHistogram() const
+{
+	return _connectHistogram;
+}
+
+
+Poco::UInt64 RTSPLatencyRecorder::timeouts(RTSPSessionMetrics::Method method) const
+{
+	return _timeouts[method].value();
+}
+
+
+Poco::UInt64 RTSPLatencyRecorder::failures(RTSPSessionMetrics::Method method) const
+{
+	return _failures[method].value();
+}
+
+
+void RTSPLatencyRecorder::dump(std::ostream& ostr) const
+{
+	ostr << "# HELP " << METRIC_NAME << " Time from sending a RTSP request to receiving the response header.\n";
+	ostr << "# TYPE " << METRIC_NAME << " summary\n";
+	for (int m = 0; m < RTSPSessionMetrics::METHOD_COUNT; ++m)
+	{
+		for (int s = 0; s < STATUS_CLASS_COUNT; ++s)
+		{
+			const RTSPLatencyHistogram* pHistogram = _histograms[m][s].load();
+			if (NULL == pHistogram || pHistogram->count() == 0)
+			{
+				continue;
+			}
+
+			std::ostringstream labels;
+			writeLabels(labels, (RTSPSessionMetrics::Method) m, (StatusClass) s);
+			writeSummary(ostr, METRIC_NAME, labels.str().substr(1) + ",", RTSPLatencyHistogram(*pHistogram));
+		}
+	}
+
+	RTSPLatencyHistogram connect(_connectHistogram);
+	if (connect.count() > 0)
+	{
+		ostr << "# HELP " << CONNECT_METRIC_NAME << " Time taken to connect to the RTSP server, including the TLS handshake.\n";
+		ostr << "# TYPE " << CONNECT_METRIC_NAME << " summary\n";
+		writeSummary(ostr, CONNECT_METRIC_NAME, std::string(), connect);
+	}
+
+	ostr << "# HELP " << FAILURE_METRIC_NAME << " RTSP requests that ended without a response header.\n";
+	ostr << "# TYPE " << FAILURE_METRIC_NAME << " counter\n";
+	for (int m = 0; m < RTSPSessionMetrics::METHOD_COUNT; ++m)
+	{
+		Poco::UInt64 counts[] = { timeouts((RTSPSessionMetrics::Method) m), failures((RTSPSessionMetrics::Method) m) };
+		const char* const reasons[] = { "timeout", "error" };
+		for (int r = 0; r < 2; ++r)
+		{
+			if (counts[r] == 0)
+			{
+				continue;
+			}
+			const std::string& name = RTSPSessionMetrics::methodName((RTSPSessionMetrics::Method) m);
+			ostr << FAILURE_METRIC_NAME << "{method=\"" << (name.empty() ? "OTHER" : name.c_str())
+			     << "\",reason=\"" << reasons[r] << "\"} " << counts[r] << "\n";
+		}
+	}
+}
+
+
+void RTSPLatencyRecorder::reset()
+{
+	for (int m = 0; m < RTSPSessionMetrics::METHOD_COUNT; ++m)
+	{
+		for (int s = 0; s < STATUS_CLASS_COUNT; ++s)
+		{
+			RTSPLatencyHistogram* pHistogram = _histograms[m][s].load();
+			if (NULL != pHistogram)
+			{
+				pHistogram->reset();
+			}
+		}
+		_timeouts[m].set(0);
+		_failures[m].set(0);
+	}
+	_connectHistogram.reset();
+}
+
+
+RTSPLatencyRecorder::StatusClass RTSPLatencyRecorder::statusClassOf(int status)
+{
+	int statusClass = status / 100;
+	return statusClass >= STATUS_1XX && statusClass <= STATUS_5XX ? (StatusClass) statusClass : STATUS_OTHER;
+}
+
+
+RTSPLatencyRecorder& RTSPLatencyRecorder::defaultRecorder()
+{
+	static SingletonHolder<RTSPLatencyRecorder> singleton;
+	return *singleton.get();
+}
+
+
+} // namespace RTSP
@@ -0,0 +1,288 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Pipe Transport Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/Net/NetException.h"
+#include <cstring>
+#include <vector>
+
+#include "RTSPPipeTransport.h"
+
+
+using Poco::Timespan;
+using Poco::Net::SocketAddress;
+using Poco::Net::NetException;
+using Poco::Net::ConnectionRefusedException;
+using Poco::Net::ConnectionResetException;
+
+
+namespace RTSP {
+
+
+struct RTSPPipeTransport::Pipe: public Poco::RefCountedObject
+	/// The state shared by both ends. Everything indexed by side
+	/// belongs to that end; data[side] holds the bytes waiting
+	/// to be received by it, starting at offset[side].
+{
+	explicit Pipe(RTSPVirtualClock* pClock):
+		pClock(pClock)
+	{
+		for (int side = 0; side < 2; ++side)
+		{
+			offset[side]      = 0;
+			shut[side]        = false;
+			closed[side]      = false;
+			dispatching[side] = false;
+			pEnd[side]        = NULL;
+			pHandler[side]    = NULL;
+		}
+	}
+
+	Poco::Mutex          mutex;
+	Poco::Condition      readable;
+	std::vector<char>    data[2];
+	std::size_t          offset[2];
+	bool                 shut[2];
+	bool                 closed[2];
+	bool                 dispatching[2];
+	RTSPPipeTransport*   pEnd[2];
+	Handler*             pHandler[2];
+	RTSPVirtualClock*    pClock;
+};
+
+
+RTSPPipeTransport::Handler::~Handler()
+{
+}
+
+
+RTSPPipeTransport::RTSPPipeTransport(Pipe* pPipe, int side):
+	_pPipe(pPipe),
+	_side(side)
+{
+	_pPipe->pEnd[_side] = this;
+}
+
+
+RTSPPipeTransport::~RTSPPipeTransport()
+{
+	{
+		Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+		_pPipe->pEnd[_side]     = NULL;
+		_pPipe->pHandler[_side] = NULL;
+		_pPipe->shut[_side]     = true;
+		_pPipe->closed[_side]   = true;
+		_pPipe->readable.broadcast();
+	}
+	_pPipe->release();
+}
+
+
+void RTSPPipeTransport::createPair(Ptr& pFirst, Ptr& pSecond, RTSPVirtualClock* pClock)
+{
+	// each end holds one reference to the shared state
+	Pipe* pPipe = new Pipe(pClock);
+	pFirst = new RTSPPipeTransport(pPipe, 0);
+	pPipe->duplicate();
+	pSecond = new RTSPPipeTransport(pPipe, 1);
+}
+
+
+void RTSPPipeTransport::setHandler(Handler* pHandler)
+{
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	_pPipe->pHandler[_side] = pHandler;
+}
+
+
+int RTSPPipeTransport::available() const
+{
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	return (int) (_pPipe->data[_side].size() - _pPipe->offset[_side]);
+}
+
+
+RTSPVirtualClock* RTSPPipeTransport::clock() const
+{
+	return _pPipe->pClock;
+}
+
+
+void RTSPPipeTransport::connect(const SocketAddress& address, const Timespan& timeout)
+{
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	if (_pPipe->closed[_side])
+	{
+		throw ConnectionRefusedException("pipe has been closed");
+	}
+}
+
+
+bool RTSPPipeTransport::connected() const
+{
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	return !_pPipe->closed[_side];
+}
+
+
+int RTSPPipeTransport::sendBytes(const char* buffer, int length, const Timespan& timeout)
+{
+	const int peer = 1 - _side;
+	{
+		Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+		if (_pPipe->shut[_side])
+		{
+			throw NetException("pipe has been shut down");
+		}
+		if (_pPipe->closed[peer])
+		{
+			throw ConnectionResetException("pipe closed by peer");
+		}
+		std::vector<char>& data = _pPipe->data[peer];
+		data.insert(data.end(), buffer, buffer + length);
+		_pPipe->readable.broadcast();
+	}
+	dispatch(peer);
+	return length;
+}
+
+
+int RTSPPipeTransport::receiveBytes(char* buffer, int length, const Timespan& timeout)
+{
+	const int peer = 1 - _side;
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	if (_pPipe->closed[_side])
+	{
+		throw NetException("pipe has been closed");
+	}
+
+	std::vector<char>& data = _pPipe->data[_side];
+	std::size_t& offset = _pPipe->offset[_side];
+	while (offset == data.size())
+	{
+		if (_pPipe->shut[_side] || _pPipe->shut[peer])
+		{
+			return 0;
+		}
+		if (NULL != _pPipe->pClock)
+		{
+			_pPipe->pClock->timeout(timeout);
+			throw Poco::TimeoutException();
+		}
+		if (0 == timeout.totalMicroseconds())
+		{
+			// like a socket without a receive timeout
+			_pPipe->readable.wait(_pPipe->mutex);
+		}
+		else if (!_pPipe->readable.tryWait(_pPipe->mutex, (long) timeout.totalMilliseconds()))
+		{
+			throw Poco::TimeoutException();
+		}
+	}
+
+	int n = (int) (data.size() - offset);
+	if (n > length)
+	{
+		n = length;
+	}
+	std::memcpy(buffer, &data[offset], n);
+	offset += n;
+	if (offset == data.size())
+	{
+		// keeps the capacity for the next message
+		data.clear();
+		offset = 0;
+	}
+	return n;
+}
+
+
+void RTSPPipeTransport::shutdown()
+{
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	_pPipe->shut[_side] = true;
+	_pPipe->readable.broadcast();
+}
+
+
+void RTSPPipeTransport::close()
+{
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	_pPipe->shut[_side]   = true;
+	_pPipe->closed[_side] = true;
+	_pPipe->data[_side].clear();
+	_pPipe->offset[_side] = 0;
+	_pPipe->readable.broadcast();
+}
+
+
+void RTSPPipeTransport::dispatch(int side)
+{
+	Handler* pHandler;
+	RTSPPipeTransport* pEnd;
+	{
+		Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+		pHandler = _pPipe->pHandler[side];
+		pEnd     = _pPipe->pEnd[side];
+		if (NULL == pHandler || NULL == pEnd || _pPipe->dispatching[side])
+		{
+			return;
+		}
+		_pPipe->dispatching[side] = true;
+	}
+
+	try
+	{
+		pHandler->onReceive(*pEnd);
+	}
+	catch (...)
+	{
+		Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+		_pPipe->dispatching[side] = false;
+		throw;
+	}
+
+	Poco::Mutex::ScopedLock lock(_pPipe->mutex);
+	_pPipe->dispatching[side] = false;
+}
+
+
+} // namespace RTSP
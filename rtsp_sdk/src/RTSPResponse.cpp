@@ -47,6 +47,7 @@
 #include "Poco/DateTimeParser.h"
 
 #include "RTSPResponse.h"
+#include "RTSPProbes.h"
 
 
 using Poco::DateTime;
@@ -117,14 +118,16 @@ const std::string RTSPResponse::DATE											= "Date";
 
 RTSPResponse::RTSPResponse():
 	_status(RTSP_OK),
-	_reason(getReasonForStatus(RTSP_OK))
+	_reason(getReasonForStatus(RTSP_OK)),
+	_stamped(false)
 {
 }
 
 	
 RTSPResponse::RTSPResponse(RTSPStatus status, const std::string& reason):
 	_status(status),
-	_reason(reason)
+	_reason(reason),
+	_stamped(false)
 {
 }
 
@@ -133,14 +136,16 @@ RTSPResponse::RTSPResponse(RTSPStatus status, const std::string& reason):
 RTSPResponse::RTSPResponse(const std::string& version, RTSPStatus status, const std::string& reason):
 	RTSPMessage(version),
 	_status(status),
-	_reason(reason)
+	_reason(reason),
+	_stamped(false)
 {
 }
 
 	
 RTSPResponse::RTSPResponse(RTSPStatus status):
 	_status(status),
-	_reason(getReasonForStatus(status))
+	_reason(getReasonForStatus(status)),
+	_stamped(false)
 {
 }
 
@@ -148,7 +153,8 @@ RTSPResponse::RTSPResponse(RTSPStatus status):
 RTSPResponse::RTSPResponse(const std::string& version, RTSPStatus status):
 	RTSPMessage(version),
 	_status(status),
-	_reason(getReasonForStatus(status))
+	_reason(getReasonForStatus(status)),
+	_stamped(false)
 {
 }
 
@@ -189,9 +195,30 @@ void RTSPResponse::setStatusAndReason(RTSPStatus status)
 }
 
 
+void RTSPResponse::setDate()
+{
+	setDate(Poco::Timestamp());
+}
+
+
 void RTSPResponse::setDate(const Poco::Timestamp& dateTime)
 {
+#if defined(RTSP_SDK_HAVE_CXX11)
+	// HTTP_FORMAT has a resolution of one second
+	static thread_local Poco::Timestamp::TimeVal cachedSecond = -1;
+	static thread_local std::string cachedDate;
+
+	Poco::Timestamp::TimeVal time = dateTime.epochMicroseconds();
+	Poco::Timestamp::TimeVal second = (time >= 0 ? time : time - Poco::Timestamp::resolution() + 1) / Poco::Timestamp::resolution();
+	if (second != cachedSecond || cachedDate.empty())
+	{
+		cachedDate   = DateTimeFormatter::format(dateTime, DateTimeFormat::HTTP_FORMAT);
+		cachedSecond = second;
+	}
+	set(DATE, cachedDate);
+#else
 	set(DATE, DateTimeFormatter::format(dateTime, DateTimeFormat::HTTP_FORMAT));
+#endif
 }
 
 	
@@ -203,9 +230,25 @@ Poco::Timestamp RTSPResponse::getDate() const
 }
 
 
+void RTSPResponse::setTimestamps(const Poco::Timestamp& transmitted, const Poco::Timestamp& received)
+{
+	_transmitted = transmitted;
+	_received    = received;
+	_stamped     = true;
+}
+
+
 void RTSPResponse::write(std::ostream& ostr) const
 {
-	ostr << getVersion() << " " << NumberFormatter::format((int) _status) << " " << _reason << "\r\n";
+	const std::string& statusLine = getStatusLine(_status);
+	if (!statusLine.empty() && getVersion() == RTSP_1_0 && _reason == getReasonForStatus(_status))
+	{
+		ostr.write(statusLine.data(), (std::streamsize) statusLine.size());
+	}
+	else
+	{
+		ostr << getVersion() << " " << NumberFormatter::format((int) _status) << " " << _reason << "\r\n";
+	}
 	RTSPMessage::write(ostr);
 	ostr << "\r\n";
 }
@@ -219,6 +262,7 @@ void RTSPResponse::read(std::istream& istr)
 	std::string status;
 	std::string reason;
 	
+	RTSP_PROBE1(response_read_start, this);
 	int ch =  istr.get();
 	if (ch == eof) throw NoMessageException();
 	while (std::isspace(ch)) ch = istr.get();
@@ -239,6 +283,12 @@ void RTSPResponse::read(std::istream& istr)
 	setVersion(version);
 	setStatus(status);
 	setReason(reason);
+	if (RTSP_PROBE_ENABLED(response_read_done))
+	{
+		int cSeq = 0;
+		NumberParser::tryParse(get("CSeq", ""), cSeq);
+		RTSP_PROBE4(response_read_done, this, (int) getStatus(), cSeq, getContentLength());
+	}
 }
 
 
@@ -339,4 +389,38 @@ const std::string& RTSPResponse::getReasonForStatus(RTSPStatus status)
 }
 
 
+const std::string& RTSPResponse::getStatusLine(RTSPStatus status)
+{
+	struct StatusLines
+	{
+		enum
+		{
+			FIRST = 100,
+			LAST  = 599
+		};
+
+		StatusLines()
+		{
+			for (int code = FIRST; code <= LAST; ++code)
+			{
+				const std::string& reason = getReasonForStatus((RTSPStatus) code);
+				if (&reason != &RTSP_REASON_UNKNOWN)
+				{
+					lines[code - FIRST] = RTSP_1_0 + " " + NumberFormatter::format(code) + " " + reason + "\r\n";
+				}
+			}
+		}
+
+		std::string lines[LAST - FIRST + 1];
+		std::string none;
+	};
+	static const StatusLines statusLines;
+
+	int code = (int) status;
+	if (code < StatusLines::FIRST || code > StatusLines::LAST)
+		return statusLines.none;
+	return statusLines.lines[code - StatusLines::FIRST];
+}
+
+
 } // namespace RTSP
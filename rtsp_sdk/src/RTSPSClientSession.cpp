@@ -0,0 +1,222 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Secure Client Session Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/Net/SecureStreamSocket.h"
+#include "Poco/Net/SSLManager.h"
+#include "Poco/Net/SSLException.h"
+#include "Poco/NumberFormatter.h"
+
+#include "RTSPSClientSession.h"
+#include "RTSPTLSSessionCache.h"
+
+
+using Poco::NumberFormatter;
+using Poco::Net::Context;
+using Poco::Net::Session;
+using Poco::Net::SecureStreamSocket;
+using Poco::Net::SSLManager;
+
+
+namespace RTSP {
+
+
+RTSPSClientSession::RTSPSClientSession(Context::Ptr pContext):
+	_pContext(pContext),
+	_sessionReused(false),
+	_mustCacheSession(false)
+{
+	setPort(RTSPSession::RTSPS_PORT);
+}
+
+
+RTSPSClientSession::RTSPSClientSession(const std::string& host, Poco::UInt16 port):
+	RTSPClientSession(host, port),
+	_pContext(SSLManager::instance().defaultClientContext()),
+	_sessionReused(false),
+	_mustCacheSession(false)
+{
+}
+
+
+RTSPSClientSession::RTSPSClientSession(const std::string& host, Poco::UInt16 port, Context::Ptr pContext):
+	RTSPClientSession(host, port),
+	_pContext(pContext),
+	_sessionReused(false),
+	_mustCacheSession(false)
+{
+}
+
+
+RTSPSClientSession::~RTSPSClientSession()
+{
+}
+
+
+std::istream& RTSPSClientSession::receiveResponse(RTSPResponse& response)
+{
+	std::istream& rs = RTSPClientSession::receiveResponse(response);
+	if (_mustCacheSession)
+	{
+		cacheSession();
+		_mustCacheSession = false;
+	}
+	return rs;
+}
+
+
+void RTSPSClientSession::connect(const SocketAddress& address)
+{
+	poco_assert(!_pContext.isNull());
+
+	SecureStreamSocket sslSocket(_pContext);
+	sslSocket.setPeerHostName(getHost());
+
+	Session::Ptr pSession = RTSPTLSSessionCache::defaultCache().get(getHost(), getPort());
+	if (!pSession.isNull())
+	{
+		sslSocket.useSession(pSession);
+	}
+
+	socket() = sslSocket;
+	try
+	{
+		RTSPSession::connect(address);
+	}
+	catch (Poco::Net::SSLException&)
+	{
+		// a rejected or stale session must not be offered again;
+		// a server that cannot be reached says nothing about it
+		RTSPTLSSessionCache::defaultCache().remove(getHost(), getPort());
+		throw;
+	}
+
+	// a resumed session is already in the cache
+	_sessionReused = sslSocket.sessionWasReused();
+	_mustCacheSession = !_sessionReused;
+	if (_mustCacheSession)
+	{
+		cacheSession();
+	}
+}
+
+
+void RTSPSClientSession::setIOUring(RTSPIOUring* pIOUring)
+{
+	if (NULL != pIOUring)
+	{
+		throw Poco::NotImplementedException("io_uring I/O is not available for rtsps sessions");
+	}
+	RTSPClientSession::setIOUring(pIOUring);
+}
+
+
+void RTSPSClientSession::setZeroCopy(bool enable)
+{
+	if (enable)
+	{
+		throw Poco::NotImplementedException("zero-copy sends are not available for rtsps sessions");
+	}
+	RTSPClientSession::setZeroCopy(enable);
+}
+
+
+void RTSPSClientSession::setTransport(RTSPTransport::Ptr pTransport)
+{
+	if (!pTransport.isNull())
+	{
+		throw Poco::NotImplementedException("custom transports are not available for rtsps sessions");
+	}
+	RTSPClientSession::setTransport(pTransport);
+}
+
+
+void RTSPSClientSession::setTimestamping(bool enable)
+{
+	if (enable)
+	{
+		throw Poco::NotImplementedException("kernel timestamps are not available for rtsps sessions");
+	}
+	RTSPClientSession::setTimestamping(enable);
+}
+
+
+void RTSPSClientSession::setProxy(const std::string& host, Poco::UInt16 port)
+{
+	if (!host.empty())
+	{
+		throw Poco::NotImplementedException("proxies are not available for rtsps sessions", host);
+	}
+	RTSPClientSession::setProxy(host, port);
+}
+
+
+void RTSPSClientSession::setProxyHost(const std::string& host)
+{
+	if (!host.empty())
+	{
+		throw Poco::NotImplementedException("proxies are not available for rtsps sessions", host);
+	}
+	RTSPClientSession::setProxyHost(host);
+}
+
+
+void RTSPSClientSession::setProxyPort(Poco::UInt16)
+{
+	throw Poco::NotImplementedException("proxies are not available for rtsps sessions");
+}
+
+
+std::string RTSPSClientSession::getHostInfo() const
+{
+	std::string result("rtsps://");
+	result.append(getHost());
+	result.append(":");
+	result.append(NumberFormatter::format(getPort()));
+	return result;
+}
+
+
+void RTSPSClientSession::cacheSession()
+{
+	SecureStreamSocket sslSocket(socket());
+	RTSPTLSSessionCache::defaultCache().put(getHost(), getPort(), sslSocket.currentSession());
+}
+
+
+} // namespace RTSP
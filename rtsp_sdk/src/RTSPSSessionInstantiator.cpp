@@ -0,0 +1,119 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Secure Session Instantiator Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/Net/SSLManager.h"
+
+#include "RTSPSSessionInstantiator.h"
+#include "RTSPSessionFactory.h"
+#include "RTSPSClientSession.h"
+
+
+using Poco::URI;
+using Poco::Net::Context;
+using Poco::Net::SSLManager;
+
+
+namespace RTSP {
+
+
+RTSPSSessionInstantiator::RTSPSSessionInstantiator():
+	_pContext(SSLManager::instance().defaultClientContext())
+{
+	if (_pContext.isNull())
+	{
+		throw Poco::IllegalStateException("the SSLManager has no default client context for rtsps sessions");
+	}
+	_pContext->enableSessionCache(true);
+}
+
+
+RTSPSSessionInstantiator::RTSPSSessionInstantiator(Context::Ptr pContext):
+	_pContext(pContext)
+{
+	poco_check_ptr(_pContext.get());
+	_pContext->enableSessionCache(true);
+}
+
+
+RTSPSSessionInstantiator::~RTSPSSessionInstantiator()
+{
+}
+
+
+RTSPClientSession* RTSPSSessionInstantiator::createClientSession(const Poco::URI& uri)
+{
+	return createClientSession(uri, proxyHost(), proxyPort());
+}
+
+
+RTSPClientSession* RTSPSSessionInstantiator::createClientSession(const Poco::URI& uri, const std::string& proxyHost, Poco::UInt16) const
+{
+	poco_assert(uri.getScheme() == "rtsps");
+	if (!proxyHost.empty())
+	{
+		throw Poco::NotImplementedException("proxies are not available for rtsps sessions", proxyHost);
+	}
+	Poco::UInt16 port = uri.getPort();
+	if (0 == port)
+	{
+		port = RTSPSession::RTSPS_PORT;
+	}
+	return new RTSPSClientSession(uri.getHost(), port, _pContext);
+}
+
+
+void RTSPSSessionInstantiator::registerInstantiator()
+{
+	RTSPSessionFactory::defaultFactory().registerProtocol("rtsps", new RTSPSSessionInstantiator);
+}
+
+
+void RTSPSSessionInstantiator::registerInstantiator(Context::Ptr pContext)
+{
+	RTSPSessionFactory::defaultFactory().registerProtocol("rtsps", new RTSPSSessionInstantiator(pContext));
+}
+
+
+void RTSPSSessionInstantiator::unregisterInstantiator()
+{
+	RTSPSessionFactory::defaultFactory().unregisterProtocol("rtsps");
+}
+
+
+} // namespace RTSP
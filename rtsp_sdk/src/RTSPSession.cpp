@@ -38,6 +38,9 @@
 
 
 #include "RTSPSession.h"
+#include "RTSPProbes.h"
+#include "RTSPSocketTimestamps.h"
+#include "RTSPVirtualClock.h"
 #include "Poco/Net/HTTPBufferAllocator.h"
 #include "Poco/Net/NetException.h"
 #include <cstring>
@@ -54,7 +57,15 @@ RTSPSession::RTSPSession():
 	_pEnd(NULL),
 	_timeout(RTSP_DEFAULT_TIMEOUT),
 	_pException(NULL),
-	_cSeq(1)
+	_cSeq(1),
+	_pIOUring(NULL),
+	_pChannel(NULL),
+	_zeroCopy(false),
+	_pZeroCopy(NULL),
+	_timestamping(false),
+	_awaitingReceive(false),
+	_received(false),
+	_pMetrics(new RTSPSessionMetrics)
 {
 }
 
@@ -66,7 +77,15 @@ RTSPSession::RTSPSession(const StreamSocket& socket):
 	_pEnd(NULL),
 	_timeout(RTSP_DEFAULT_TIMEOUT),
 	_pException(NULL),
-	_cSeq(1)
+	_cSeq(1),
+	_pIOUring(NULL),
+	_pChannel(NULL),
+	_zeroCopy(false),
+	_pZeroCopy(NULL),
+	_timestamping(false),
+	_awaitingReceive(false),
+	_received(false),
+	_pMetrics(new RTSPSessionMetrics)
 {
 }
 
@@ -133,20 +152,43 @@ int RTSPSession::read(char* buffer, std::streamsize length)
 		}
 		std::memcpy(buffer, _pCurrent, n);
 		_pCurrent += n;
+		RTSP_PROBE3(read, this, length, n);
 		return n;
 	}
 	else 
 	{
-		return receive(buffer, (int) length);
+		int n = receive(buffer, (int) length);
+		RTSP_PROBE3(read, this, length, n);
+		return n;
 	}
 }
 
 
 int RTSPSession::write(const char* buffer, std::streamsize length)
 {
+	Poco::Clock start(now());
 	try
 	{
-		return _socket.sendBytes(buffer, (int) length);
+		int n;
+		if (!_pTransport.isNull())
+		{
+			n = _pTransport->sendBytes(buffer, (int) length, _timeout);
+		}
+		else if (NULL != _pZeroCopy && _pZeroCopy->owns(buffer))
+		{
+			n = _pZeroCopy->send(buffer, (int) length, _timeout);
+		}
+		else if (NULL != _pChannel)
+		{
+			n = _pIOUring->send(_pChannel, buffer, (int) length, _timeout);
+		}
+		else
+		{
+			n = _socket.sendBytes(buffer, (int) length);
+		}
+		_pMetrics->sent(n, now() - start);
+		RTSP_PROBE3(write, this, length, n);
+		return n;
 	}
 	catch (Poco::Exception& exc)
 	{
@@ -158,9 +200,36 @@ int RTSPSession::write(const char* buffer, std::streamsize length)
 
 int RTSPSession::receive(char* buffer, int length)
 {
+	Poco::Clock start(now());
 	try
 	{
-		return _socket.receiveBytes(buffer, length);
+		int n;
+		if (!_pTransport.isNull())
+		{
+			n = _pTransport->receiveBytes(buffer, length, _timeout);
+		}
+		else if (NULL != _pChannel)
+		{
+			n = _pIOUring->receive(_pChannel, buffer, length, _timeout);
+		}
+		else if (_timestamping)
+		{
+			Poco::Timestamp receivedAt;
+			bool stamped = false;
+			n = RTSPSocketTimestamps::receive(_socket, buffer, length, receivedAt, stamped);
+			if (_awaitingReceive && n > 0)
+			{
+				_receivedAt      = receivedAt;
+				_received        = stamped;
+				_awaitingReceive = false;
+			}
+		}
+		else
+		{
+			n = _socket.receiveBytes(buffer, length);
+		}
+		_pMetrics->received(n, now() - start);
+		return n;
 	}
 	catch (Poco::Exception& exc)
 	{
@@ -177,34 +246,72 @@ void RTSPSession::refill()
 		_pBuffer = HTTPBufferAllocator::allocate(HTTPBufferAllocator::BUFFER_SIZE);
 	}
 	_pCurrent = _pEnd = _pBuffer;
+	_pMetrics->refilled();
 	int n = receive(_pBuffer, HTTPBufferAllocator::BUFFER_SIZE);
 	_pEnd += n;
+	RTSP_PROBE2(refill, this, n);
 }
 
 
 bool RTSPSession::connected() const
 {
+	if (!_pTransport.isNull())
+	{
+		return _pTransport->connected();
+	}
 	return _socket.impl()->initialized();
 }
 
 
 void RTSPSession::connect(const SocketAddress& address)
 {
+	if (!_pTransport.isNull())
+	{
+		_pTransport->connect(address, _timeout);
+		RTSP_PROBE2(connect, this, -1);
+		return;
+	}
 	_socket.connect(address, _timeout);
 	_socket.setReceiveTimeout(_timeout);
 	_socket.setNoDelay(true);
+	if (NULL != _pIOUring)
+	{
+		_pChannel = _pIOUring->attach(_socket.impl()->sockfd());
+	}
+	if (_zeroCopy)
+	{
+		_pZeroCopy = new RTSPZeroCopySender(_socket);
+	}
+	if (_timestamping)
+	{
+		RTSPSocketTimestamps::enable(_socket, true);
+	}
+	RTSP_PROBE2(connect, this, (int) _socket.impl()->sockfd());
 }
 
 
 void RTSPSession::abort()
 {
-	_socket.shutdown();
-	close();
+	if (!_pTransport.isNull())
+		_pTransport->shutdown();
+	else
+		_socket.shutdown();
+	close(false);
 }
 
 
-void RTSPSession::close()
+void RTSPSession::close(bool graceful)
 {
+	releaseZeroCopy(graceful);
+	if (NULL != _pChannel)
+	{
+		_pIOUring->detach(_pChannel);
+		_pChannel = NULL;
+	}
+	if (!_pTransport.isNull())
+	{
+		_pTransport->close();
+	}
 	_socket.close();
 }
 
@@ -213,8 +320,170 @@ void RTSPSession::setException(const Poco::Exception& exc)
 {
 	delete _pException;
 	_pException = exc.clone();
+	_pMetrics->failed();
+}
+
+void RTSPSession::setIOUring(RTSPIOUring* pIOUring)
+{
+	if (NULL != pIOUring && !_pTransport.isNull())
+	{
+		throw Poco::IllegalStateException("io_uring I/O is not available over a custom transport");
+	}
+	if (NULL != _pChannel)
+	{
+		_pIOUring->detach(_pChannel);
+		_pChannel = NULL;
+	}
+	_pIOUring = pIOUring;
+	if (NULL != _pIOUring && connected())
+	{
+		_pChannel = _pIOUring->attach(_socket.impl()->sockfd());
+	}
 }
 
+
+void RTSPSession::setZeroCopy(bool enable)
+{
+	if (enable && _timestamping)
+	{
+		throw Poco::IllegalStateException("zero-copy sends cannot be combined with kernel timestamps");
+	}
+	if (enable && !_pTransport.isNull())
+	{
+		throw Poco::IllegalStateException("zero-copy sends are not available over a custom transport");
+	}
+	if (enable && !RTSPZeroCopySender::available())
+	{
+		throw Poco::NotImplementedException("zero-copy sends are not supported on this platform");
+	}
+	if (enable && NULL == _pZeroCopy && connected())
+	{
+		_pZeroCopy = new RTSPZeroCopySender(_socket);
+	}
+	else if (!enable)
+	{
+		releaseZeroCopy(true);
+	}
+	_zeroCopy = enable;
+}
+
+
+void RTSPSession::releaseZeroCopy(bool drain)
+{
+	if (NULL == _pZeroCopy)
+	{
+		return;
+	}
+	if (drain)
+	{
+		try
+		{
+			_pZeroCopy->flush(Poco::Timespan(1, 0));
+		}
+		catch (Poco::Exception&)
+		{
+		}
+	}
+	delete _pZeroCopy;
+	_pZeroCopy = NULL;
+}
+
+
+char* RTSPSession::allocateSendBuffer()
+{
+	if (NULL == _pZeroCopy)
+	{
+		throw Poco::IllegalStateException("zero-copy sends are not active for the session");
+	}
+	return _pZeroCopy->allocate(_timeout);
+}
+
+
+void RTSPSession::releaseSendBuffer(char* pBuffer)
+{
+	poco_check_ptr(_pZeroCopy);
+
+	_pZeroCopy->release(pBuffer);
+}
+
+
+int RTSPSession::sendBufferSize() const
+{
+	return NULL != _pZeroCopy ? _pZeroCopy->bufferSize() : (int) RTSPZeroCopySender::DEFAULT_BUFFER_SIZE;
+}
+
+
+void RTSPSession::setTimestamping(bool enable)
+{
+	if (enable && _zeroCopy)
+	{
+		throw Poco::IllegalStateException("kernel timestamps cannot be combined with zero-copy sends");
+	}
+	if (enable && !_pTransport.isNull())
+	{
+		throw Poco::IllegalStateException("kernel timestamps are not available over a custom transport");
+	}
+	if (enable && !RTSPSocketTimestamps::available())
+	{
+		throw Poco::NotImplementedException("kernel timestamps are not supported on this platform");
+	}
+	if (connected() && _pTransport.isNull())
+	{
+		RTSPSocketTimestamps::enable(_socket, enable);
+	}
+	_timestamping = enable;
+}
+
+
+void RTSPSession::setTransport(RTSPTransport::Ptr pTransport)
+{
+	if (!pTransport.isNull() && (NULL != _pIOUring || _zeroCopy || _timestamping))
+	{
+		throw Poco::IllegalStateException("io_uring, zero-copy sends and kernel timestamps require the session socket");
+	}
+	_pTransport = pTransport;
+	_pCurrent = _pEnd = _pBuffer;
+}
+
+
+void RTSPSession::startTimestamps()
+{
+	if (_timestamping && connected())
+	{
+		Poco::Timestamp stale;
+		RTSPSocketTimestamps::readTransmitted(_socket, stale);
+	}
+	_received        = false;
+	_awaitingReceive = _timestamping;
+}
+
+
+bool RTSPSession::getTimestamps(Poco::Timestamp& transmitted, Poco::Timestamp& received)
+{
+	if (!_timestamping || !_received || NULL != _pChannel)
+	{
+		return false;
+	}
+	if (!RTSPSocketTimestamps::readTransmitted(_socket, transmitted))
+	{
+		return false;
+	}
+	received = _receivedAt;
+	return true;
+}
+
+
+Poco::Clock RTSPSession::now() const
+{
+	RTSPVirtualClock* pClock = _pTransport.isNull() ? NULL : _pTransport->clock();
+	if (NULL != pClock)
+	{
+		return Poco::Clock(pClock->now().epochMicroseconds());
+	}
+	return Poco::Clock();
+}
+
+
 void RTSPSession::setCSeq(const Poco::UInt16& cSeq)
 {
 	poco_assert(cSeq > 0);
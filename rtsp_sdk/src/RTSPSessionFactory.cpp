@@ -40,6 +40,7 @@
 #include "Poco/Exception.h"
 #include "RTSPSessionFactory.h"
 #include "RTSPSessionInstantiator.h"
+#include "RTSPClientSession.h"
 
 
 using Poco::SingletonHolder;
@@ -50,24 +51,39 @@ using Poco::ExistsException;
 namespace RTSP {
 
 RTSPSessionFactory::RTSPSessionFactory():
-	_proxyPort(0)
+	_pRegistry(new Registry(std::string(), 0)),
+	_epoch(0),
+	_retiring(false)
 {
 }
 
 
 RTSPSessionFactory::RTSPSessionFactory(const std::string& proxyHost, Poco::UInt16 proxyPort):
-	_proxyHost(proxyHost),
-	_proxyPort(proxyPort)
+	_pRegistry(new Registry(proxyHost, proxyPort)),
+	_epoch(0),
+	_retiring(false)
 {
 }
 
 
 RTSPSessionFactory::~RTSPSessionFactory()
 {
-	for (Instantiators::iterator it = _instantiators.begin(); it != _instantiators.end(); ++it)
+	const Registry* pRegistry = registry();
+	for (Instantiators::const_iterator it = pRegistry->instantiators.begin(); it != pRegistry->instantiators.end(); ++it)
 	{
 		delete it->second.pIn;
 	}
+	delete pRegistry;
+
+	// no reader is left
+	for (RetiredInstantiators::iterator it = _retiredInstantiators.begin(); it != _retiredInstantiators.end(); ++it)
+	{
+		delete it->second;
+	}
+	for (RetiredRegistries::iterator it = _retiredRegistries.begin(); it != _retiredRegistries.end(); ++it)
+	{
+		delete it->second;
+	}
 }
 
 
@@ -76,12 +92,14 @@ void RTSPSessionFactory::registerProtocol(const std::string& protocol, RTSPSessi
 	poco_assert_dbg(pSessionInstantiator);
 
 	FastMutex::ScopedLock lock(_mutex);
-	std::pair<Instantiators::iterator, bool> tmp = _instantiators.insert(make_pair(protocol, InstantiatorInfo(pSessionInstantiator)));
+	Registry* pRegistry = new Registry(*registry());
+	std::pair<Instantiators::iterator, bool> tmp = pRegistry->instantiators.insert(make_pair(protocol, InstantiatorInfo(pSessionInstantiator)));
 	if (!tmp.second) 
 	{
 		++tmp.first->second.cnt;
 		delete pSessionInstantiator;
 	}
+	publish(pRegistry);
 }
 
 
@@ -89,21 +107,25 @@ void RTSPSessionFactory::unregisterProtocol(const std::string& protocol)
 {
 	FastMutex::ScopedLock lock(_mutex);
 	
-	Instantiators::iterator it = _instantiators.find(protocol);
-	if (it != _instantiators.end())
+	Registry* pRegistry = new Registry(*registry());
+	Instantiators::iterator it = pRegistry->instantiators.find(protocol);
+	if (it != pRegistry->instantiators.end())
 	{
 		if (it->second.cnt == 1)
 		{
-			delete it->second.pIn;
-			_instantiators.erase(it);
+			// may still be in use by a concurrent createClientSession()
+			_retiredInstantiators.push_back(std::make_pair(_epoch.load(), it->second.pIn));
+			pRegistry->instantiators.erase(it);
 		}
 		else
 		{
 			--it->second.cnt;
 		}
+		publish(pRegistry);
 	}
 	else
 	{
+		delete pRegistry;
 		throw NotFoundException("No HTTPSessionInstantiator registered for", protocol);
 	}
 }
@@ -111,29 +133,37 @@ void RTSPSessionFactory::unregisterProtocol(const std::string& protocol)
 
 bool RTSPSessionFactory::supportsProtocol(const std::string& protocol)
 {
-	FastMutex::ScopedLock lock(_mutex);
-	
-	Instantiators::iterator it = _instantiators.find(protocol);
-	return it != _instantiators.end();
+	Reader reader(*this);
+	const Registry* pRegistry = reader.registry();
+	return pRegistry->instantiators.find(protocol) != pRegistry->instantiators.end();
 }
 
 
 RTSPClientSession* RTSPSessionFactory::createClientSession(const Poco::URI& uri)
 {
-	FastMutex::ScopedLock lock(_mutex);
-	
 	if (uri.isRelative()) throw Poco::UnknownURISchemeException("Relative URIs are not supported by RTSPSessionFactory.");
 
-	Instantiators::iterator it = _instantiators.find(uri.getScheme());
-	if (it != _instantiators.end())
+	RTSPClientSession* pSession = 0;
 	{
-		it->second.pIn->setProxy(_proxyHost, _proxyPort);
-		return it->second.pIn->createClientSession(uri);
+		Reader reader(*this);
+		const Registry* pRegistry = reader.registry();
+		Instantiators::const_iterator it = pRegistry->instantiators.find(uri.getScheme());
+		if (it == pRegistry->instantiators.end())
+		{
+			throw Poco::UnknownURISchemeException(uri.getScheme());
+		}
+		pSession = it->second.pIn->createClientSession(uri, pRegistry->proxyHost, pRegistry->proxyPort);
 	}
-	else 
+	addMetrics(pSession->metrics());
+
+	// finish what the last replacement could not reclaim, unless
+	// another thread is already at it
+	if (_retiring.value() && _mutex.tryLock())
 	{
-		throw Poco::UnknownURISchemeException(uri.getScheme());
+		reclaim();
+		_mutex.unlock();
 	}
+	return pSession;
 }
 
 
@@ -141,8 +171,25 @@ void RTSPSessionFactory::setProxy(const std::string& host, Poco::UInt16 port)
 {
 	FastMutex::ScopedLock lock(_mutex);
 
-	_proxyHost = host;
-	_proxyPort = port;
+	Registry* pRegistry = new Registry(*registry());
+	pRegistry->proxyHost = host;
+	pRegistry->proxyPort = port;
+	publish(pRegistry);
+}
+
+
+RTSPSessionMetrics::Snapshot RTSPSessionFactory::metrics()
+{
+	RTSPSessionMetrics::Snapshot result;
+	for (int i = 0; i < METRICS_SHARDS; ++i)
+	{
+		MetricsShard& shard = _metricsShards[i];
+		FastMutex::ScopedLock lock(shard.mutex);
+
+		prune(shard, &result);
+		result += shard.retiredMetrics;
+	}
+	return result;
 }
 
 
@@ -153,6 +200,147 @@ RTSPSessionFactory& RTSPSessionFactory::defaultFactory()
 }
 
 
+void RTSPSessionFactory::publish(Registry* pRegistry)
+{
+	// called with _mutex held
+	_retiredRegistries.push_back(std::make_pair(_epoch.load(), registry()));
+	_pRegistry.store(pRegistry);
+	_retiring.set(true);
+	reclaim();
+}
+
+
+void RTSPSessionFactory::reclaim()
+{
+	// Called with _mutex held. A reader only takes part in the epoch
+	// it found unchanged after being counted, so once epoch e + 1
+	// has begun no reader of e - 1 is left and none can join, and
+	// from e + 2 on nothing retired in e can be reached anymore.
+	unsigned epoch = _epoch.load();
+	for (int i = 0; i < 2 && quiescent(epoch - 1); ++i)
+	{
+		_epoch.store(++epoch);
+	}
+
+	RetiredInstantiators::iterator outInst = _retiredInstantiators.begin();
+	for (RetiredInstantiators::iterator it = _retiredInstantiators.begin(); it != _retiredInstantiators.end(); ++it)
+	{
+		if (epoch - it->first >= 2)
+			delete it->second;
+		else
+			*outInst++ = *it;
+	}
+	_retiredInstantiators.erase(outInst, _retiredInstantiators.end());
+
+	RetiredRegistries::iterator outReg = _retiredRegistries.begin();
+	for (RetiredRegistries::iterator it = _retiredRegistries.begin(); it != _retiredRegistries.end(); ++it)
+	{
+		if (epoch - it->first >= 2)
+			delete it->second;
+		else
+			*outReg++ = *it;
+	}
+	_retiredRegistries.erase(outReg, _retiredRegistries.end());
+
+	_retiring.set(!_retiredInstantiators.empty() || !_retiredRegistries.empty());
+}
+
+
+bool RTSPSessionFactory::quiescent(unsigned epoch) const
+{
+	// sequentially consistent, so that a reader counted after this
+	// check finds the epoch advanced and retries
+	for (int i = 0; i < READER_SHARDS; ++i)
+	{
+		if (_readerShards[i].readers[epoch & 1].load() != 0)
+			return false;
+	}
+	return true;
+}
+
+
+void RTSPSessionFactory::addMetrics(const RTSPSessionMetrics::Ptr& pMetrics)
+{
+	MetricsShard& s = _metricsShards[threadShard() % METRICS_SHARDS];
+	FastMutex::ScopedLock lock(s.mutex);
+
+	// sessions that are gone are folded in once the list has doubled,
+	// so it stays bounded by twice the live sessions even if metrics()
+	// is never called, at a constant amortized cost per session
+	if (s.sessionMetrics.size() >= s.pruneAt)
+	{
+		prune(s, 0);
+		s.pruneAt = s.sessionMetrics.size() * 2 > PRUNE_THRESHOLD ? s.sessionMetrics.size() * 2 : PRUNE_THRESHOLD;
+	}
+	s.sessionMetrics.push_back(pMetrics);
+}
+
+
+void RTSPSessionFactory::prune(MetricsShard& shard, RTSPSessionMetrics::Snapshot* pLive)
+{
+	// called with shard.mutex held
+	SessionMetrics::iterator out = shard.sessionMetrics.begin();
+	for (SessionMetrics::iterator it = shard.sessionMetrics.begin(); it != shard.sessionMetrics.end(); ++it)
+	{
+		// the factory holds the last reference once the session is
+		// gone, so its final counts are folded into the retired sum.
+		if ((*it)->referenceCount() == 1)
+		{
+			shard.retiredMetrics += (*it)->snapshot();
+		}
+		else
+		{
+			if (pLive) *pLive += (*it)->snapshot();
+			if (out != it) *out = *it;
+			++out;
+		}
+	}
+	shard.sessionMetrics.erase(out, shard.sessionMetrics.end());
+}
+
+
+std::size_t RTSPSessionFactory::threadShard()
+{
+	// threads run on stacks of their own, so the address of a local
+	// tells them apart; a thread may change shards between calls,
+	// which only costs the odd extra contention
+	char local;
+	return reinterpret_cast<std::size_t>(&local) >> 16;
+}
+
+
+RTSPSessionFactory::Reader::Reader(const RTSPSessionFactory& factory):
+	_factory(factory)
+{
+	ReaderShard& shard = _factory._readerShards[threadShard() % READER_SHARDS];
+	for (;;)
+	{
+		// sequentially consistent, so that reclaim() either counts
+		// this reader or this reader sees the epoch it advanced to
+		unsigned epoch = _factory._epoch.load();
+		_pReaders = &shard.readers[epoch & 1];
+		_pReaders->increment();
+		if (_factory._epoch.load() == epoch)
+			break;
+		_pReaders->decrement();
+	}
+	_pRegistry = _factory._pRegistry.load();
+}
+
+
+RTSPSessionFactory::MetricsShard::MetricsShard():
+	pruneAt(PRUNE_THRESHOLD)
+{
+}
+
+
+RTSPSessionFactory::Registry::Registry(const std::string& host, Poco::UInt16 port):
+	proxyHost(host),
+	proxyPort(port)
+{
+}
+
+
 RTSPSessionFactory::InstantiatorInfo::InstantiatorInfo(RTSPSessionInstantiator* pInst): pIn(pInst), cnt(1)
 {
 	poco_check_ptr (pIn);
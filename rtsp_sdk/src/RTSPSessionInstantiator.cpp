@@ -68,6 +68,17 @@ RTSPClientSession* RTSPSessionInstantiator::createClientSession(const Poco::URI&
 }
 
 
+RTSPClientSession* RTSPSessionInstantiator::createClientSession(const Poco::URI& uri, const std::string& proxyHost, Poco::UInt16 proxyPort) const
+{
+	// goes through the one-argument form, so that subclasses that
+	// only override it keep working with the factory; the instance
+	// is not changed, the proxy is set on the session instead.
+	RTSPClientSession* pSession = const_cast<RTSPSessionInstantiator*>(this)->createClientSession(uri);
+	pSession->setProxy(proxyHost, proxyPort);
+	return pSession;
+}
+
+
 void RTSPSessionInstantiator::registerInstantiator()
 {
 	RTSPSessionFactory::defaultFactory().registerProtocol("rtsp", new RTSPSessionInstantiator);
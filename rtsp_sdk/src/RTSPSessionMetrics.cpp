@@ -0,0 +1,161 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Session Metrics Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTSPSessionMetrics.h"
+#include "RTSPRequest.h"
+
+
+namespace RTSP {
+
+
+RTSPSessionMetrics::Snapshot::Snapshot():
+	sessions(0),
+	bytesReceived(0),
+	bytesSent(0),
+	receiveCalls(0),
+	sendCalls(0),
+	refills(0),
+	responses(0),
+	errors(0),
+	receiveBlockedMicroseconds(0),
+	sendBlockedMicroseconds(0)
+{
+	for (int i = 0; i < METHOD_COUNT; ++i)
+	{
+		requests[i] = 0;
+	}
+}
+
+
+RTSPSessionMetrics::Snapshot& RTSPSessionMetrics::Snapshot::operator += (const Snapshot& other)
+{
+	sessions                   += other.sessions;
+	bytesReceived              += other.bytesReceived;
+	bytesSent                  += other.bytesSent;
+	receiveCalls               += other.receiveCalls;
+	sendCalls                  += other.sendCalls;
+	refills                    += other.refills;
+	responses                  += other.responses;
+	errors                     += other.errors;
+	receiveBlockedMicroseconds += other.receiveBlockedMicroseconds;
+	sendBlockedMicroseconds    += other.sendBlockedMicroseconds;
+	for (int i = 0; i < METHOD_COUNT; ++i)
+	{
+		requests[i] += other.requests[i];
+	}
+	return *this;
+}
+
+
+Poco::UInt64 RTSPSessionMetrics::Snapshot::totalRequests() const
+{
+	Poco::UInt64 total = 0;
+	for (int i = 0; i < METHOD_COUNT; ++i)
+	{
+		total += requests[i];
+	}
+	return total;
+}
+
+
+RTSPSessionMetrics::RTSPSessionMetrics()
+{
+}
+
+
+RTSPSessionMetrics::~RTSPSessionMetrics()
+{
+}
+
+
+RTSPSessionMetrics::Snapshot RTSPSessionMetrics::snapshot() const
+{
+	Snapshot result;
+	result.sessions                   = 1;
+	result.bytesReceived              = _bytesReceived.value();
+	result.bytesSent                  = _bytesSent.value();
+	result.receiveCalls               = _receiveCalls.value();
+	result.sendCalls                  = _sendCalls.value();
+	result.refills                    = _refills.value();
+	result.responses                  = _responses.value();
+	result.errors                     = _errors.value();
+	result.receiveBlockedMicroseconds = _receiveBlocked.value();
+	result.sendBlockedMicroseconds    = _sendBlocked.value();
+	for (int i = 0; i < METHOD_COUNT; ++i)
+	{
+		result.requests[i] = _requests[i].value();
+	}
+	return result;
+}
+
+
+RTSPSessionMetrics::Method RTSPSessionMetrics::methodOf(const std::string& method)
+{
+	for (int i = 0; i < METHOD_OTHER; ++i)
+	{
+		if (method == methodName((Method) i))
+		{
+			return (Method) i;
+		}
+	}
+	return METHOD_OTHER;
+}
+
+
+const std::string& RTSPSessionMetrics::methodName(Method method)
+{
+	switch (method)
+	{
+	case METHOD_DESCRIBE:      return RTSPRequest::RTSP_DESCRIBE;
+	case METHOD_ANNOUNCE:      return RTSPRequest::RTSP_ANNOUNCE;
+	case METHOD_GET_PARAMETER: return RTSPRequest::RTSP_GET_PARAMETER;
+	case METHOD_OPTIONS:       return RTSPRequest::RTSP_OPTIONS;
+	case METHOD_PAUSE:         return RTSPRequest::RTSP_PAUSE;
+	case METHOD_PLAY:          return RTSPRequest::RTSP_PLAY;
+	case METHOD_RECORD:        return RTSPRequest::RTSP_RECORD;
+	case METHOD_REDIRECT:      return RTSPRequest::RTSP_REDIRECT;
+	case METHOD_SETUP:         return RTSPRequest::RTSP_SETUP;
+	case METHOD_SET_PARAMETER: return RTSPRequest::RTSP_SET_PARAMETER;
+	case METHOD_TEARDOWN:      return RTSPRequest::RTSP_TEARDOWN;
+	default:                   return RTSPRequest::RTSP_NONE;
+	}
+}
+
+
+} // namespace RTSP
@@ -0,0 +1,222 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Socket Timestamps Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/Exception.h"
+#include "Poco/Net/NetException.h"
+
+#include "RTSPSocketTimestamps.h"
+
+#if defined(__linux__)
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <linux/errqueue.h>
+	#include <linux/net_tstamp.h>
+	#include <cerrno>
+	#include <cstring>
+	#include <ctime>
+
+	#define RTSP_SDK_HAVE_TIMESTAMPING
+#endif
+
+
+using Poco::Timestamp;
+using Poco::TimeoutException;
+using Poco::NotImplementedException;
+using Poco::Net::StreamSocket;
+
+
+namespace RTSP {
+
+
+#if defined(RTSP_SDK_HAVE_TIMESTAMPING)
+
+
+namespace
+{
+	Timestamp toTimestamp(const struct timespec& ts)
+	{
+		return Timestamp((Timestamp::TimeVal) ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+	}
+}
+
+
+bool RTSPSocketTimestamps::available()
+{
+	return true;
+}
+
+
+void RTSPSocketTimestamps::enable(StreamSocket& socket, bool enable)
+{
+	// OPT_ID and OPT_TSONLY make the error queue carry bare
+	// timestamps instead of copies of the sent data.
+	int flags = enable ?
+		SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+		SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY : 0;
+	if (::setsockopt(socket.impl()->sockfd(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0)
+	{
+		throw NotImplementedException("kernel timestamping", std::strerror(errno));
+	}
+}
+
+
+int RTSPSocketTimestamps::receive(StreamSocket& socket, char* buffer, int length, Timestamp& received, bool& stamped)
+{
+	char control[CMSG_SPACE(sizeof(struct scm_timestamping))];
+	struct iovec iov;
+	iov.iov_base = buffer;
+	iov.iov_len  = length;
+	struct msghdr msg;
+	std::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = control;
+	msg.msg_controllen = sizeof(control);
+
+	int rc;
+	do
+	{
+		rc = (int) ::recvmsg(socket.impl()->sockfd(), &msg, 0);
+	}
+	while (rc < 0 && errno == EINTR);
+
+	if (rc < 0)
+	{
+		int error = errno;
+		if (error == EAGAIN || error == EWOULDBLOCK)
+			throw TimeoutException();
+		else if (error == ECONNRESET)
+			throw Poco::Net::ConnectionResetException(std::strerror(error), error);
+		else
+			throw Poco::Net::NetException(std::strerror(error), error);
+	}
+
+	stamped = false;
+	for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&msg); pCmsg != NULL; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+	{
+		if (pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_TIMESTAMPING)
+		{
+			const struct scm_timestamping* pStamps = reinterpret_cast<const struct scm_timestamping*>(CMSG_DATA(pCmsg));
+			if (pStamps->ts[0].tv_sec != 0 || pStamps->ts[0].tv_nsec != 0)
+			{
+				received = toTimestamp(pStamps->ts[0]);
+				stamped  = true;
+			}
+		}
+	}
+	return rc;
+}
+
+
+bool RTSPSocketTimestamps::readTransmitted(StreamSocket& socket, Timestamp& transmitted)
+{
+	bool result = false;
+	for (;;)
+	{
+		char control[256];
+		struct msghdr msg;
+		std::memset(&msg, 0, sizeof(msg));
+		msg.msg_control    = control;
+		msg.msg_controllen = sizeof(control);
+
+		if (::recvmsg(socket.impl()->sockfd(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+		{
+			break;
+		}
+
+		const struct scm_timestamping* pStamps = NULL;
+		bool isTimestamp = false;
+		for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&msg); pCmsg != NULL; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+		{
+			if (pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_TIMESTAMPING)
+			{
+				pStamps = reinterpret_cast<const struct scm_timestamping*>(CMSG_DATA(pCmsg));
+			}
+			else if ((pCmsg->cmsg_level == SOL_IP && pCmsg->cmsg_type == IP_RECVERR) ||
+			         (pCmsg->cmsg_level == SOL_IPV6 && pCmsg->cmsg_type == IPV6_RECVERR))
+			{
+				const struct sock_extended_err* pErr = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(pCmsg));
+				isTimestamp = pErr->ee_origin == SO_EE_ORIGIN_TIMESTAMPING;
+			}
+		}
+
+		// stamps are queued in transmit order, so the last one
+		// belongs to the last byte handed to the device.
+		if (isTimestamp && NULL != pStamps)
+		{
+			transmitted = toTimestamp(pStamps->ts[0]);
+			result = true;
+		}
+	}
+	return result;
+}
+
+
+#else // RTSP_SDK_HAVE_TIMESTAMPING
+
+
+bool RTSPSocketTimestamps::available()
+{
+	return false;
+}
+
+
+void RTSPSocketTimestamps::enable(StreamSocket& socket, bool enable)
+{
+	throw NotImplementedException("kernel timestamping is not supported on this platform");
+}
+
+
+int RTSPSocketTimestamps::receive(StreamSocket& socket, char* buffer, int length, Timestamp& received, bool& stamped)
+{
+	stamped = false;
+	return socket.receiveBytes(buffer, length);
+}
+
+
+bool RTSPSocketTimestamps::readTransmitted(StreamSocket& socket, Timestamp& transmitted)
+{
+	return false;
+}
+
+
+#endif // RTSP_SDK_HAVE_TIMESTAMPING
+
+
+} // namespace RTSP
@@ -0,0 +1,166 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP TLS Session Cache Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/NumberFormatter.h"
+#include "Poco/SingletonHolder.h"
+
+#include "RTSPTLSSessionCache.h"
+
+
+using Poco::FastMutex;
+using Poco::NumberFormatter;
+using Poco::SingletonHolder;
+using Poco::Net::Session;
+
+
+namespace RTSP {
+
+
+RTSPTLSSessionCache::RTSPTLSSessionCache(std::size_t capacity):
+	_capacity(capacity),
+	_clock(0)
+{
+	poco_assert(capacity > 0);
+}
+
+
+RTSPTLSSessionCache::~RTSPTLSSessionCache()
+{
+}
+
+
+Session::Ptr RTSPTLSSessionCache::get(const std::string& host, Poco::UInt16 port)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	Sessions::iterator it = _sessions.find(makeKey(host, port));
+	if (it != _sessions.end())
+	{
+		it->second.lastUsed = ++_clock;
+		return it->second.pSession;
+	}
+	return Session::Ptr();
+}
+
+
+void RTSPTLSSessionCache::put(const std::string& host, Poco::UInt16 port, Session::Ptr pSession)
+{
+	if (pSession.isNull())
+	{
+		remove(host, port);
+		return;
+	}
+
+	FastMutex::ScopedLock lock(_mutex);
+
+	std::string key = makeKey(host, port);
+	Sessions::iterator it = _sessions.find(key);
+	if (it == _sessions.end())
+	{
+		if (_sessions.size() >= _capacity)
+		{
+			evict();
+		}
+		it = _sessions.insert(Sessions::value_type(key, Entry())).first;
+	}
+	it->second.pSession = pSession;
+	it->second.lastUsed = ++_clock;
+}
+
+
+void RTSPTLSSessionCache::remove(const std::string& host, Poco::UInt16 port)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_sessions.erase(makeKey(host, port));
+}
+
+
+void RTSPTLSSessionCache::clear()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_sessions.clear();
+}
+
+
+std::size_t RTSPTLSSessionCache::size() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _sessions.size();
+}
+
+
+RTSPTLSSessionCache& RTSPTLSSessionCache::defaultCache()
+{
+	static SingletonHolder<RTSPTLSSessionCache> singleton;
+	return *singleton.get();
+}
+
+
+std::string RTSPTLSSessionCache::makeKey(const std::string& host, Poco::UInt16 port)
+{
+	std::string key(host);
+	key.append(":");
+	NumberFormatter::append(key, (int) port);
+	return key;
+}
+
+
+void RTSPTLSSessionCache::evict()
+{
+	// the cache is only written once per full handshake, so a linear
+	// scan for the oldest entry is cheap compared to the handshake itself.
+	Sessions::iterator oldest = _sessions.begin();
+	for (Sessions::iterator it = _sessions.begin(); it != _sessions.end(); ++it)
+	{
+		if (it->second.lastUsed < oldest->second.lastUsed)
+		{
+			oldest = it;
+		}
+	}
+	if (oldest != _sessions.end())
+	{
+		_sessions.erase(oldest);
+	}
+}
+
+
+} // namespace RTSP
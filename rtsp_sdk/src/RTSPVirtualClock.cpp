@@ -0,0 +1,97 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Virtual Clock Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "RTSPVirtualClock.h"
+
+
+using Poco::Timestamp;
+using Poco::Timespan;
+
+
+namespace RTSP {
+
+
+RTSPVirtualClock::RTSPVirtualClock():
+	_now(0),
+	_timeouts(0)
+{
+}
+
+
+RTSPVirtualClock::RTSPVirtualClock(const Timestamp& start):
+	_now(start.epochMicroseconds()),
+	_timeouts(0)
+{
+}
+
+
+RTSPVirtualClock::~RTSPVirtualClock()
+{
+}
+
+
+Timespan RTSPVirtualClock::elapsed(const Timestamp& since) const
+{
+	return Timespan(now() - since);
+}
+
+
+void RTSPVirtualClock::advance(const Timespan& span)
+{
+	if (span.totalMicroseconds() > 0)
+	{
+		_now.add(span.totalMicroseconds());
+	}
+}
+
+
+void RTSPVirtualClock::advanceTo(const Timestamp& time)
+{
+	_now.raise(time.epochMicroseconds());
+}
+
+
+void RTSPVirtualClock::timeout(const Timespan& span)
+{
+	_timeouts.add(1);
+	advance(span);
+}
+
+
+} // namespace RTSP
@@ -0,0 +1,429 @@
+/*****************************************************************************
+//	RTSP SDK Base Classes
+//
+//	RTSP Zero-Copy Sender Class
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#include "Poco/Exception.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Clock.h"
+
+#include "RTSPZeroCopySender.h"
+
+#if defined(__linux__)
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <linux/errqueue.h>
+	#include <poll.h>
+	#include <cerrno>
+	#include <cstring>
+
+	#ifndef SO_ZEROCOPY
+		#define SO_ZEROCOPY 60
+	#endif
+	#ifndef MSG_ZEROCOPY
+		#define MSG_ZEROCOPY 0x4000000
+	#endif
+	#ifndef SO_EE_ORIGIN_ZEROCOPY
+		#define SO_EE_ORIGIN_ZEROCOPY 5
+	#endif
+	#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+		#define SO_EE_CODE_ZEROCOPY_COPIED 1
+	#endif
+
+	#define RTSP_SDK_HAVE_ZEROCOPY
+#endif
+
+
+using Poco::Timespan;
+using Poco::Clock;
+using Poco::TimeoutException;
+using Poco::NotImplementedException;
+using Poco::Net::StreamSocket;
+
+
+namespace RTSP {
+
+
+#if defined(RTSP_SDK_HAVE_ZEROCOPY)
+
+
+namespace
+{
+	void throwError(int error)
+	{
+		switch (error)
+		{
+		case ECONNRESET:
+		case EPIPE:
+			throw Poco::Net::ConnectionResetException(std::strerror(error), error);
+		case EAGAIN:
+			throw TimeoutException();
+		default:
+			throw Poco::Net::NetException(std::strerror(error), error);
+		}
+	}
+}
+
+
+RTSPZeroCopySender::RTSPZeroCopySender(const StreamSocket& socket, int bufferSize, int bufferCount):
+	_socket(socket),
+	_bufferSize(bufferSize),
+	_pPool(NULL),
+	_poolSize(bufferCount),
+	_nextSeq(0),
+	_copied(0)
+{
+	poco_assert(bufferSize > 0 && bufferCount > 0);
+
+	int one = 1;
+	if (::setsockopt(_socket.impl()->sockfd(), SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) != 0)
+	{
+		throw NotImplementedException("zero-copy send", std::strerror(errno));
+	}
+
+	_pPool = new char[(std::size_t) bufferSize * bufferCount];
+	_free.reserve(bufferCount);
+	for (int i = bufferCount - 1; i >= 0; --i)
+	{
+		_free.push_back(_pPool + (std::size_t) i * bufferSize);
+	}
+}
+
+
+RTSPZeroCopySender::~RTSPZeroCopySender()
+{
+	// pages still referenced by the kernel must not be reused,
+	// so the pool is deliberately leaked in that case.
+	if (_pending.empty())
+	{
+		delete [] _pPool;
+	}
+}
+
+
+char* RTSPZeroCopySender::allocate(const Timespan& timeout)
+{
+	Clock start;
+	while (_free.empty())
+	{
+		Timespan elapsed(start.elapsed());
+		if (!(elapsed < timeout))
+		{
+			throw TimeoutException("no zero-copy send buffer available");
+		}
+		reap(timeout - elapsed);
+	}
+	char* pBuffer = _free.back();
+	_free.pop_back();
+	return pBuffer;
+}
+
+
+void RTSPZeroCopySender::release(char* pBuffer)
+{
+	poco_assert(owns(pBuffer));
+
+	_free.push_back(bufferOf(pBuffer));
+}
+
+
+bool RTSPZeroCopySender::owns(const char* pBuffer) const
+{
+	return pBuffer >= _pPool && pBuffer < _pPool + (std::size_t) _bufferSize * _poolSize;
+}
+
+
+int RTSPZeroCopySender::send(const char* buffer, int length, const Timespan& timeout)
+{
+	poco_socket_t sockfd = _socket.impl()->sockfd();
+
+	// the caller may reuse any other buffer as soon as send() returns,
+	// and waiting for the acknowledgement would cost a round trip, so
+	// the kernel copies it as usual.
+	bool zeroCopy = owns(buffer);
+	bool pending = false;
+	Poco::UInt32 last = 0;
+	Clock start;
+	int sent = 0;
+	while (sent < length)
+	{
+		int rc = (int) ::send(sockfd, buffer + sent, length - sent, zeroCopy ? MSG_ZEROCOPY | MSG_NOSIGNAL : MSG_NOSIGNAL);
+		if (rc < 0)
+		{
+			int error = errno;
+			if (error == EINTR)
+			{
+				continue;
+			}
+			else if (error == ENOBUFS && zeroCopy && !_pending.empty())
+			{
+				// the pinned pages exceed the socket's option memory
+				// limit until some sends are completed.
+				Timespan elapsed(start.elapsed());
+				if (!(elapsed < timeout))
+				{
+					throw TimeoutException("zero-copy send completion");
+				}
+				reap(timeout - elapsed);
+				continue;
+			}
+			else if (error == ENOBUFS && zeroCopy)
+			{
+				zeroCopy = false;
+				continue;
+			}
+			throwError(error);
+		}
+		if (!zeroCopy)
+		{
+			sent += rc;
+			continue;
+		}
+
+		// every successful MSG_ZEROCOPY send consumes one sequence
+		// number, even if it only accepted part of the data.
+		last = _nextSeq++;
+		Pending entry = { last, NULL, false };
+		_pending.push_back(entry);
+		pending = true;
+		sent += rc;
+	}
+
+	if (owns(buffer))
+	{
+		if (pending && !_pending.empty() && _pending.back().seq == last)
+		{
+			_pending.back().pBuffer = bufferOf(buffer);
+		}
+		else
+		{
+			// the kernel copied all of it, or has already completed
+			// the sends while we waited for option memory.
+			_free.push_back(bufferOf(buffer));
+		}
+	}
+	return sent;
+}
+
+
+void RTSPZeroCopySender::flush(const Timespan& timeout)
+{
+	Clock start;
+	while (!_pending.empty())
+	{
+		Timespan elapsed(start.elapsed());
+		if (!(elapsed < timeout))
+		{
+			throw TimeoutException("zero-copy send completion");
+		}
+		reap(timeout - elapsed);
+	}
+}
+
+
+bool RTSPZeroCopySender::available()
+{
+	return true;
+}
+
+
+char* RTSPZeroCopySender::bufferOf(const char* p) const
+{
+	std::size_t index = (std::size_t) (p - _pPool) / _bufferSize;
+	return _pPool + index * _bufferSize;
+}
+
+
+void RTSPZeroCopySender::reap(const Timespan& timeout)
+{
+	poco_socket_t sockfd = _socket.impl()->sockfd();
+
+	struct pollfd pfd;
+	pfd.fd      = sockfd;
+	pfd.events  = 0;
+	pfd.revents = 0;
+	int rc = ::poll(&pfd, 1, (int) timeout.totalMilliseconds());
+	if (rc < 0 && errno != EINTR)
+	{
+		throwError(errno);
+	}
+	if (rc <= 0)
+	{
+		return;
+	}
+
+	bool any = false;
+	for (;;)
+	{
+		char control[128];
+		struct msghdr msg;
+		std::memset(&msg, 0, sizeof(msg));
+		msg.msg_control    = control;
+		msg.msg_controllen = sizeof(control);
+
+		if (::recvmsg(sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+		{
+			break;
+		}
+
+		for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&msg); pCmsg != NULL; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+		{
+			if (!((pCmsg->cmsg_level == SOL_IP && pCmsg->cmsg_type == IP_RECVERR) ||
+			      (pCmsg->cmsg_level == SOL_IPV6 && pCmsg->cmsg_type == IPV6_RECVERR)))
+			{
+				continue;
+			}
+
+			const struct sock_extended_err* pErr = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(pCmsg));
+			if (pErr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || pErr->ee_errno != 0)
+			{
+				continue;
+			}
+
+			// the notification covers the inclusive range [ee_info, ee_data]
+			Poco::UInt32 lo = pErr->ee_info;
+			Poco::UInt32 hi = pErr->ee_data;
+			if (pErr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+			{
+				_copied += hi - lo + 1;
+			}
+			if (!_pending.empty())
+			{
+				Poco::Int32 begin = (Poco::Int32) (lo - _pending.front().seq);
+				Poco::Int32 end   = (Poco::Int32) (hi - _pending.front().seq);
+				if (begin < 0)
+				{
+					begin = 0;
+				}
+				for (Poco::Int32 index = begin; index <= end && index < (Poco::Int32) _pending.size(); ++index)
+				{
+					_pending[index].done = true;
+				}
+			}
+			any = true;
+		}
+	}
+
+	if (any)
+	{
+		collect();
+	}
+	else if (pfd.revents & (POLLERR | POLLHUP))
+	{
+		// nothing on the error queue, so it is a real socket error
+		int error = 0;
+		socklen_t length = sizeof(error);
+		::getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &length);
+		throwError(error != 0 ? error : EPIPE);
+	}
+}
+
+
+void RTSPZeroCopySender::collect()
+{
+	// a buffer is only reused once all sends up to the one that
+	// owns it have completed.
+	while (!_pending.empty() && _pending.front().done)
+	{
+		if (NULL != _pending.front().pBuffer)
+		{
+			_free.push_back(_pending.front().pBuffer);
+		}
+		_pending.pop_front();
+	}
+}
+
+
+#else // RTSP_SDK_HAVE_ZEROCOPY
+
+
+RTSPZeroCopySender::RTSPZeroCopySender(const StreamSocket& socket, int bufferSize, int bufferCount):
+	_socket(socket),
+	_bufferSize(bufferSize),
+	_pPool(NULL),
+	_poolSize(0),
+	_nextSeq(0),
+	_copied(0)
+{
+	throw NotImplementedException("zero-copy send is not supported on this platform");
+}
+
+
+RTSPZeroCopySender::~RTSPZeroCopySender()
+{
+}
+
+
+char* RTSPZeroCopySender::allocate(const Timespan& timeout)
+{
+	throw NotImplementedException("RTSPZeroCopySender::allocate()");
+}
+
+
+void RTSPZeroCopySender::release(char* pBuffer)
+{
+	throw NotImplementedException("RTSPZeroCopySender::release()");
+}
+
+
+bool RTSPZeroCopySender::owns(const char* pBuffer) const
+{
+	return false;
+}
+
+
+int RTSPZeroCopySender::send(const char* buffer, int length, const Timespan& timeout)
+{
+	throw NotImplementedException("RTSPZeroCopySender::send()");
+}
+
+
+void RTSPZeroCopySender::flush(const Timespan& timeout)
+{
+}
+
+
+bool RTSPZeroCopySender::available()
+{
+	return false;
+}
+
+
+#endif // RTSP_SDK_HAVE_ZEROCOPY
+
+
+} // namespace RTSP
@@ -50,6 +50,7 @@
 #include "Poco/Types.h"
 #include "Poco/DateTime.h"
 #include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
 
 #include "sdp_parser.h"
 #include "common.h"
@@ -101,6 +102,18 @@ public:
 	static Poco::Timespan getTimeSpan(Poco::Int64 ntpTime);
 	/// Converts an NTP timestamp to a TimeSpan.
 
+	static Poco::UInt64 getNTPTimestamp(const Poco::Timestamp & time);
+	/// Converts a Timestamp to a 64-bit NTP timestamp as carried by RTCP
+	/// sender reports (RFC 3550, section 4): seconds since January 1, 1900
+	/// in the upper 32 bits and the fraction of a second in the lower 32 bits.
+
+	static Poco::Timestamp getTimestamp(Poco::UInt64 ntpTimestamp);
+	/// Converts a 64-bit NTP timestamp to a Timestamp.
+
+	static Poco::UInt32 getCompactNTPTimestamp(Poco::UInt64 ntpTimestamp);
+	/// Returns the middle 32 bits of a 64-bit NTP timestamp, the format
+	/// of the LSR and DLSR fields of RTCP report blocks.
+
 /*
 	//	TODO: needs NTPClient to be implemented (optional functionality)
 	static Poco::Int64 GetTime();
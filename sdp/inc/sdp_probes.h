@@ -0,0 +1,82 @@
+/*****************************************************************************
+//	SDP Parser Classes
+//
+//	Static tracepoints of the SDP parser
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+#ifndef __SDP_PROBES__H__
+#define __SDP_PROBES__H__
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//	Definitions
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//	USDT probes of the "sdp" provider, compiled in only if SDP_PARSER_HAVE_USDT
+//	is defined (scons usdt=1). A probe is a single nop until a tracer attaches;
+//	SDP_PROBE_ENABLED() tests the semaphore a tracer increments while attached,
+//	so arguments that are not free to compute can be skipped.
+//
+//		parse_start	(description, length)
+//		parse_done	(description, length, media count)
+#define SDP_PROBE_LIST(PROBE)	\
+	PROBE(parse_start)			\
+	PROBE(parse_done)
+
+#if defined(SDP_PARSER_HAVE_USDT)
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define SDP_PROBE_SEMAPHORE(name)			sdp_##name##_semaphore
+#define SDP_PROBE_DECLARE_SEMAPHORE(name)	extern volatile unsigned short SDP_PROBE_SEMAPHORE(name);
+
+extern "C"
+{
+	SDP_PROBE_LIST(SDP_PROBE_DECLARE_SEMAPHORE)
+}
+
+#define SDP_PROBE_ENABLED(name)			(SDP_PROBE_SEMAPHORE(name) != 0)
+#define SDP_PROBE2(name, a1, a2)		DTRACE_PROBE2(sdp, name, a1, a2)
+#define SDP_PROBE3(name, a1, a2, a3)	DTRACE_PROBE3(sdp, name, a1, a2, a3)
+
+#else
+
+#define SDP_PROBE_ENABLED(name)			false
+#define SDP_PROBE2(name, a1, a2)
+#define SDP_PROBE3(name, a1, a2, a3)
+
+#endif // SDP_PARSER_HAVE_USDT
+
+#endif // __SDP_PROBES__H__
@@ -132,21 +132,21 @@ AddressRange & AddressRange :: operator=(const AddressRange & addressRange)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline IPAddress AddressRange :: getAddress() const
+IPAddress AddressRange :: getAddress() const
 {
 	return _address;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline unsigned int AddressRange :: getNumberOfAddresses() const
+unsigned int AddressRange :: getNumberOfAddresses() const
 {
 	return _numberOfAddresses;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline unsigned short AddressRange :: getTTL() const
+unsigned short AddressRange :: getTTL() const
 {
 	return _ttl;
 }
@@ -106,28 +106,28 @@ AttributeField & AttributeField :: operator=(const AttributeField & attributeFie
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string AttributeField :: getName() const
+string AttributeField :: getName() const
 {
 	return _name;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string AttributeField :: getAttributeValue() const
+string AttributeField :: getAttributeValue() const
 {
 	return _attributeValue;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline bool AttributeField :: hasValue() const
+bool AttributeField :: hasValue() const
 {
 	return (!_attributeValue.empty());
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string AttributeField :: getValue() const
+std::string AttributeField :: getValue() const
 {
 	if(hasValue())
 	{
@@ -118,21 +118,21 @@ BandwidthField & BandwidthField :: operator=(const BandwidthField & bandwidthFie
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string BandwidthField :: getModifier() const
+std::string BandwidthField :: getModifier() const
 {
 	return _modifier;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline int BandwidthField :: getBandwidth() const
+int BandwidthField :: getBandwidth() const
 {
 	return _bandwidth;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string BandwidthField :: getValue() const
+std::string BandwidthField :: getValue() const
 {
 	return (_modifier + ":" + NumberFormatter::format(_bandwidth));
 }
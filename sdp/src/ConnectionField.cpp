@@ -131,21 +131,21 @@ ConnectionField & ConnectionField :: operator=(const ConnectionField & connectio
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline AddressRange ConnectionField :: getAddress() const
+AddressRange ConnectionField :: getAddress() const
 {
 	return _address;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string ConnectionField :: getAddressType() const
+string ConnectionField :: getAddressType() const
 {
 	return _addressType;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string ConnectionField :: getNetworkType() const
+string ConnectionField :: getNetworkType() const
 {
 	return _networkType;
 }
@@ -112,35 +112,35 @@ EMailField & EMailField :: operator=(const EMailField & emailField)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string EMailField :: getUserName() const
+string EMailField :: getUserName() const
 {
 	return _userName;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string EMailField :: getDisplayName() const
+string EMailField :: getDisplayName() const
 {
 	return _displayName;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string EMailField :: getHost() const
+string EMailField :: getHost() const
 {
 	return _host;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string EMailField :: getEmailAddress() const
+string EMailField :: getEmailAddress() const
 {
 	return getValue();
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string EMailField :: getValue() const
+string EMailField :: getValue() const
 {
 	string str;
 	if(0 != _userName.size() && 0 != _host.size())
@@ -110,7 +110,7 @@ Field & Field :: operator=(const Field & field)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline char Field :: getType() const
+char Field :: getType() const
 {
 	return _type;
 }
@@ -101,21 +101,21 @@ KeyField & KeyField :: operator=(const KeyField & keyField)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string KeyField :: getMethod() const
+std::string KeyField :: getMethod() const
 {
 	return _method;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string KeyField :: getKey() const
+std::string KeyField :: getKey() const
 {
 	return _key;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline bool KeyField :: hasKey() const
+bool KeyField :: hasKey() const
 {
 	return (!_key.empty());
 }
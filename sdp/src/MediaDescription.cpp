@@ -207,21 +207,21 @@ MediaDescription & MediaDescription :: operator=(const MediaDescription & mediaD
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline MediaField MediaDescription :: getMediaField() const
+MediaField MediaDescription :: getMediaField() const
 {
 	return _mediaField;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline InfoField MediaDescription :: getTitle() const
+InfoField MediaDescription :: getTitle() const
 {
 	return _title;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline void MediaDescription :: setTitle(const InfoField & title)
+void MediaDescription :: setTitle(const InfoField & title)
 {
 	_title = title;
 }
@@ -229,35 +229,35 @@ inline void MediaDescription :: setTitle(const InfoField & title)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline ConnectionField MediaDescription :: getConnectionInfo() const
+ConnectionField MediaDescription :: getConnectionInfo() const
 {
 	return _connectionInfo;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline void MediaDescription :: setConnectionInfo(const ConnectionField & connectionInfo)
+void MediaDescription :: setConnectionInfo(const ConnectionField & connectionInfo)
 {
 	_connectionInfo = connectionInfo;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline BandwidthField MediaDescription :: getBandwidth() const
+BandwidthField MediaDescription :: getBandwidth() const
 {
 	return _bandwidth;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline void MediaDescription :: setBandwidth(const BandwidthField & bandwidth)
+void MediaDescription :: setBandwidth(const BandwidthField & bandwidth)
 {
 	_bandwidth = bandwidth;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline KeyField MediaDescription :: getEncryptionKey() const
+KeyField MediaDescription :: getEncryptionKey() const
 {
 	return _encryptionKey;
 }
@@ -271,14 +271,14 @@ void MediaDescription :: setEncryptionKey(const KeyField & encryptionKey)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline AttributeVec MediaDescription :: getAttributes() const
+AttributeVec MediaDescription :: getAttributes() const
 {
 	return _attributes;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline void MediaDescription :: setAttributes(const AttributeVec & attributes)
+void MediaDescription :: setAttributes(const AttributeVec & attributes)
 {
 	_attributes = attributes;
 }
@@ -139,28 +139,28 @@ MediaField & MediaField :: operator=(const MediaField & mediaField)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string MediaField :: getMediaType() const
+std::string MediaField :: getMediaType() const
 {
 	return _mediaType;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline PortRange MediaField :: getMediaPorts() const
+PortRange MediaField :: getMediaPorts() const
 {
 	return _mediaPorts;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string MediaField :: getProtocol() const
+std::string MediaField :: getProtocol() const
 {
 	return _protocol;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline StringVec MediaField :: getMediaFormats() const
+StringVec MediaField :: getMediaFormats() const
 {
 	return _mediaFormats;
 }
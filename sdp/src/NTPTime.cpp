@@ -58,6 +58,8 @@ using std::string;
 using std::map;
 
 using Poco::Int64;
+using Poco::UInt64;
+using Poco::UInt32;
 using Poco::DateTime;
 using Poco::LocalDateTime;
 using Poco::Timespan;
@@ -165,6 +167,34 @@ Timespan NTPTime :: getTimeSpan(Int64 ntpTime)
 	return Timespan((ntpTime - NTPCONST) * 100);
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+UInt64 NTPTime :: getNTPTimestamp(const Timestamp & time)
+{
+	Timestamp::TimeVal micros = time.epochMicroseconds();
+	UInt64 seconds  = (UInt64) (micros / Timespan::SECONDS) + NTPCONST;
+	UInt64 fraction = ((UInt64) (micros % Timespan::SECONDS) << 32) / Timespan::SECONDS;
+
+	return (seconds << 32) | fraction;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+Timestamp NTPTime :: getTimestamp(UInt64 ntpTimestamp)
+{
+	Int64 seconds = (Int64) (ntpTimestamp >> 32) - (Int64) NTPCONST;
+	Int64 micros  = (Int64) (((ntpTimestamp & 0xFFFFFFFFULL) * Timespan::SECONDS + 0x80000000ULL) >> 32);
+
+	return Timestamp(seconds * Timespan::SECONDS + micros);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+UInt32 NTPTime :: getCompactNTPTimestamp(UInt64 ntpTimestamp)
+{
+	return (UInt32) (ntpTimestamp >> 16);
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 /*
 Int64 NTPTime :: GetTime()
@@ -132,42 +132,42 @@ OriginField & OriginField :: operator=(const OriginField & originField)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string OriginField :: getUsername() const
+string OriginField :: getUsername() const
 {
 	return _userName;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline Int64 OriginField :: getSessionId() const
+Int64 OriginField :: getSessionId() const
 {
 	return _sessionId;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline Int64 OriginField :: getSessionVersion() const
+Int64 OriginField :: getSessionVersion() const
 {
 	return _sessionVersion;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string OriginField :: getAddress() const
+string OriginField :: getAddress() const
 {
 	return _address;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string OriginField :: getNetworkType() const
+string OriginField :: getNetworkType() const
 {
 	return _networkType;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline string OriginField :: getAddressType() const
+string OriginField :: getAddressType() const
 {
 	return _addressType;
 }
@@ -104,7 +104,7 @@ PortRange & PortRange :: operator=(const PortRange & portRange)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline unsigned short PortRange :: getFirstPort() const
+unsigned short PortRange :: getFirstPort() const
 {
 	return _firstPort;
 }
@@ -118,7 +118,7 @@ void PortRange :: setFirstPort(unsigned short firstPort)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline unsigned short PortRange :: getNumberOfPorts() const
+unsigned short PortRange :: getNumberOfPorts() const
 {
 	return _numberOfPorts;
 }
@@ -45,6 +45,7 @@
 
 #include "FieldFactory.h"
 #include "SessionDescription.h"
+#include "sdp_probes.h"
 
 using std::string;
 
@@ -87,6 +88,8 @@ SessionDescription :: SessionDescription(const OriginField & originator,
 
 SessionDescription :: SessionDescription(const string & sessionDescription)
 {
+	SDP_PROBE2(parse_start, this, sessionDescription.size());
+
 	StringVec lines = split(sessionDescription, "\r\n");
 
 	//	last line seem to be empty, 'cause descriptions have to finish with
@@ -216,6 +219,11 @@ SessionDescription :: SessionDescription(const string & sessionDescription)
 
 		FieldFactory::DestroyInstance(pField);
 	}
+
+	if (SDP_PROBE_ENABLED(parse_done))
+	{
+		SDP_PROBE3(parse_done, this, sessionDescription.size(), _media.size());
+	}
 }
 
 
@@ -266,14 +274,14 @@ SessionDescription & SessionDescription :: operator=(const SessionDescription &
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline VersionField SessionDescription :: getVersion() const
+VersionField SessionDescription :: getVersion() const
 {
 	return _version;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline OriginField SessionDescription :: getOriginator() const
+OriginField SessionDescription :: getOriginator() const
 {
 	return _originator;
 }
@@ -287,7 +295,7 @@ void SessionDescription :: setOriginator(const OriginField & originator)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline SessionNameField SessionDescription :: getName() const
+SessionNameField SessionDescription :: getName() const
 {
 	return _name;
 }
@@ -301,7 +309,7 @@ void SessionDescription :: setName(const SessionNameField & name)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline InfoField SessionDescription :: getDescription() const
+InfoField SessionDescription :: getDescription() const
 {
 	return _description;
 }
@@ -315,7 +323,7 @@ void SessionDescription :: setDescription(const InfoField & description)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline URIField SessionDescription :: getURI() const
+URIField SessionDescription :: getURI() const
 {
 	return _uri;
 }
@@ -329,7 +337,7 @@ void SessionDescription :: setURI(const URIField & uri)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline EMailField SessionDescription :: getEMail() const
+EMailField SessionDescription :: getEMail() const
 {
 	return _email;
 }
@@ -343,7 +351,7 @@ void SessionDescription :: setEMail(const EMailField & email)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline PhoneField SessionDescription :: getPhoneNumber() const
+PhoneField SessionDescription :: getPhoneNumber() const
 {
 	return _phone;
 }
@@ -357,7 +365,7 @@ void SessionDescription :: setPhoneNumber(const PhoneField & phone)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline ConnectionField SessionDescription :: getConnectionInfo() const
+ConnectionField SessionDescription :: getConnectionInfo() const
 {
 	return _connectionInfo;
 }
@@ -371,7 +379,7 @@ void SessionDescription :: setConnectionInfo(const ConnectionField & connectionI
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline BandwidthField SessionDescription :: getBandwidth() const
+BandwidthField SessionDescription :: getBandwidth() const
 {
 	return _bandwidth;
 }
@@ -385,7 +393,7 @@ void SessionDescription :: setBandwidth(BandwidthField & bandwidth)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline TimeVec SessionDescription :: getTimes() const
+TimeVec SessionDescription :: getTimes() const
 {
 	return _times;
 }
@@ -399,7 +407,7 @@ void SessionDescription :: setTimes(const TimeVec & times)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline TimeZoneAdjustmentFieldVec SessionDescription :: getTimeZoneAdjustments() const
+TimeZoneAdjustmentFieldVec SessionDescription :: getTimeZoneAdjustments() const
 {
 	return _timeZoneAdjustments;
 }
@@ -413,7 +421,7 @@ void SessionDescription :: setTimeZoneAdjustments(const TimeZoneAdjustmentFieldV
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline KeyField SessionDescription :: getEncryptionKey() const
+KeyField SessionDescription :: getEncryptionKey() const
 {
 	return _encryptionKey;
 }
@@ -427,7 +435,7 @@ void SessionDescription :: setEncryptionKey(const KeyField & encryptionKey)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline AttributeVec SessionDescription :: getAttributes() const
+AttributeVec SessionDescription :: getAttributes() const
 {
 	return _attributes;
 }
@@ -441,7 +449,7 @@ void SessionDescription :: setAttributes(const AttributeVec & attributes)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline MediaVec SessionDescription :: getMedia() const
+MediaVec SessionDescription :: getMedia() const
 {
 	return _media;
 }
@@ -455,7 +463,7 @@ void SessionDescription :: setMedia(const MediaVec & media)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline size_t SessionDescription :: getMediaCount() const
+size_t SessionDescription :: getMediaCount() const
 {
 	return _media.size();
 }
@@ -541,4 +549,4 @@ std::string SessionDescription :: toString() const
 	return str;
 }
 
-} //	namespace SDP
+} //	namespace SDP
@@ -112,21 +112,21 @@ TimeDescription & TimeDescription :: operator=(const TimeDescription & timeDescr
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline TimeField TimeDescription :: getTimeField() const
+TimeField TimeDescription :: getTimeField() const
 {
 	return _timeField;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline TimeRepetitionVec TimeDescription :: getRepetitions() const
+TimeRepetitionVec TimeDescription :: getRepetitions() const
 {
 	return _repetitions;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string TimeDescription :: toString() const
+std::string TimeDescription :: toString() const
 {
 	string str = "t=" + _timeField.toString() + "\r\n";
 	for(size_t i = 0 ; i < _repetitions.size() ; ++i)
@@ -115,14 +115,14 @@ TimeField & TimeField :: operator=(const TimeField & timeField)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline DateTime TimeField :: getStartTime() const
+DateTime TimeField :: getStartTime() const
 {
 	return _start;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline DateTime TimeField :: getStopTime() const
+DateTime TimeField :: getStopTime() const
 {
 	return _stop;
 }
@@ -160,21 +160,21 @@ TimeRepetitionField & TimeRepetitionField :: operator=(const TimeRepetitionField
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline Timespan TimeRepetitionField :: getInterval() const
+Timespan TimeRepetitionField :: getInterval() const
 {
 	return _interval;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline Timespan TimeRepetitionField :: getActiveTime() const
+Timespan TimeRepetitionField :: getActiveTime() const
 {
 	return _activeTime;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline TimespanVec TimeRepetitionField :: getOffsets() const
+TimespanVec TimeRepetitionField :: getOffsets() const
 {
 	return _offsets;
 }
@@ -124,35 +124,35 @@ TimeZoneAdjustment & TimeZoneAdjustment :: operator=(const TimeZoneAdjustment &
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline DateTime TimeZoneAdjustment :: getAdjustmentTime() const
+DateTime TimeZoneAdjustment :: getAdjustmentTime() const
 {
 	return _adjustmentTime;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline void TimeZoneAdjustment :: setAdjustmentTime(const Poco::DateTime & adjTime)
+void TimeZoneAdjustment :: setAdjustmentTime(const Poco::DateTime & adjTime)
 {
 	_adjustmentTime = adjTime;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline Timespan TimeZoneAdjustment :: getOffset() const
+Timespan TimeZoneAdjustment :: getOffset() const
 {
 	return _offset;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline void TimeZoneAdjustment :: setOffset(const Poco::Timespan & offset)
+void TimeZoneAdjustment :: setOffset(const Poco::Timespan & offset)
 {
 	_offset = offset;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline std::string TimeZoneAdjustment :: toString() const
+std::string TimeZoneAdjustment :: toString() const
 {
 	return NumberFormatter::format(NTPTime::getNTPTime(_adjustmentTime)) +
 		   " " + 
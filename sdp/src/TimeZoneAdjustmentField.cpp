@@ -107,7 +107,7 @@ TimeZoneAdjustmentField & TimeZoneAdjustmentField :: operator=
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline TimeZoneAdjustmentVec TimeZoneAdjustmentField :: getZoneAdjustments() const
+TimeZoneAdjustmentVec TimeZoneAdjustmentField :: getZoneAdjustments() const
 {
 	return _zoneAdjustments;
 }
@@ -93,7 +93,7 @@ URIField & URIField :: operator=(const URIField & uriField)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline URI URIField :: getURI() const
+URI URIField :: getURI() const
 {
 	return URI(_value);
 }
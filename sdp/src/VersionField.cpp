@@ -107,7 +107,7 @@ VersionField & VersionField :: operator=(const VersionField & versionField)
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-inline int VersionField :: getVersion() const
+int VersionField :: getVersion() const
 {
 	return _version;
 }
@@ -0,0 +1,1340 @@
+/*****************************************************************************
+//	RTSP SDK Tools
+//
+//	RTSP Camera Simulator
+//
+//	description:
+//		serves thousands of simulated cameras with configurable SDPs
+//		and synthetic RTP over UDP or interleaved TCP
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#if !defined(__linux__)
+	#error "camera_sim serves its connections with epoll and runs on Linux only"
+#endif
+
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Poco/Exception.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
+#include "Poco/Runnable.h"
+#include "Poco/String.h"
+#include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+
+#include "SessionDescription.h"
+#include "MediaDescription.h"
+#include "MediaTypes.h"
+#include "RtpAvpConstants.h"
+
+
+using Poco::NumberFormatter;
+using Poco::NumberParser;
+using Poco::Runnable;
+using Poco::Thread;
+using Poco::Timestamp;
+using Poco::UInt8;
+using Poco::UInt16;
+using Poco::UInt32;
+using Poco::UInt64;
+
+
+namespace {
+
+
+const char USAGE[] =
+	"usage: camera_sim [options]\n"
+	"  --cameras=N         simulated cameras, served as /cam1../camN (100)\n"
+	"  --address=A         address to listen on (127.0.0.1)\n"
+	"  --port=P            RTSP port, 0 for any (8554)\n"
+	"  --threads=T         event loops sharing the port (1)\n"
+	"  --bitrate=KBPS      video bitrate per camera (2000)\n"
+	"  --fps=F             video frame rate (25)\n"
+	"  --gop=G             frames per key frame (50)\n"
+	"  --mtu=BYTES         largest RTP payload (1400)\n"
+	"  --audio             add a PCMU audio track\n"
+	"  --loss=SPEC         none, random:PERCENT, every:N or burst:N,B\n"
+	"  --sdp=PATH          serve this SDP instead of the built-in one\n"
+	"  --duration=S        stop after S seconds, 0 to run until interrupted (0)\n";
+
+
+//
+// Configuration
+//
+
+
+class LossPattern
+	/// Decides which RTP packets a stream drops instead of sending.
+	/// Sequence numbers advance for dropped packets too, so clients
+	/// see the gaps a lossy network would leave.
+	///
+	///   none          nothing is dropped
+	///   random:P      every packet with a probability of P percent
+	///   every:N       every Nth packet
+	///   burst:N,B     B packets in a row out of every N
+{
+public:
+	LossPattern():
+		_kind(NONE),
+		_period(0),
+		_burst(0),
+		_threshold(0)
+	{
+	}
+
+	static LossPattern parse(const std::string& spec)
+	{
+		LossPattern pattern;
+		std::string::size_type colon = spec.find(':');
+		std::string kind(spec, 0, colon);
+		std::string value(colon == std::string::npos ? std::string() : spec.substr(colon + 1));
+		if (kind == "none")
+		{
+			return pattern;
+		}
+		else if (kind == "random")
+		{
+			double percent = NumberParser::parseFloat(value);
+			if (percent < 0 || percent > 100)
+				throw Poco::InvalidArgumentException("loss percentage out of range", spec);
+			pattern._kind      = RANDOM;
+			pattern._threshold = (UInt32) (percent / 100.0 * 4294967295.0);
+		}
+		else if (kind == "every")
+		{
+			pattern._kind   = BURST;
+			pattern._period = NumberParser::parseUnsigned(value);
+			pattern._burst  = 1;
+		}
+		else if (kind == "burst")
+		{
+			std::string::size_type comma = value.find(',');
+			if (comma == std::string::npos)
+				throw Poco::InvalidArgumentException("burst loss needs N,B", spec);
+			pattern._kind   = BURST;
+			pattern._period = NumberParser::parseUnsigned(value.substr(0, comma));
+			pattern._burst  = NumberParser::parseUnsigned(value.substr(comma + 1));
+		}
+		else
+		{
+			throw Poco::InvalidArgumentException("unknown loss pattern", spec);
+		}
+		if (pattern._kind == BURST && (pattern._period == 0 || pattern._burst > pattern._period))
+			throw Poco::InvalidArgumentException("invalid loss period", spec);
+		return pattern;
+	}
+
+	bool drop(UInt32 index, UInt32& state) const
+		/// Returns true if the index-th packet of a stream is to
+		/// be dropped. state is the stream's random generator.
+	{
+		switch (_kind)
+		{
+		case RANDOM:
+			// xorshift32
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state < _threshold;
+		case BURST:
+			return index % _period >= _period - _burst;
+		default:
+			return false;
+		}
+	}
+
+private:
+	enum Kind
+	{
+		NONE,
+		RANDOM,
+		BURST
+	};
+
+	Kind   _kind;
+	UInt32 _period;
+	UInt32 _burst;
+	UInt32 _threshold;
+};
+
+
+struct Options
+{
+	Options():
+		cameras(100),
+		address("127.0.0.1"),
+		port(8554),
+		threads(1),
+		bitrate(2000),
+		fps(25),
+		gop(50),
+		mtu(1400),
+		audio(false),
+		duration(0)
+	{
+	}
+
+	int         cameras;
+	std::string address;
+	int         port;
+	int         threads;
+	int         bitrate;
+	int         fps;
+	int         gop;
+	int         mtu;
+	bool        audio;
+	int         duration;
+	LossPattern loss;
+	std::string sdpFile;
+};
+
+
+void parseOptions(int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg(argv[i]);
+		std::string value;
+		std::string::size_type eq = arg.find('=');
+		if (eq != std::string::npos)
+		{
+			value = arg.substr(eq + 1);
+			arg.erase(eq);
+		}
+
+		if (arg == "--cameras")
+			options.cameras = NumberParser::parse(value);
+		else if (arg == "--address")
+			options.address = value;
+		else if (arg == "--port")
+			options.port = NumberParser::parse(value);
+		else if (arg == "--threads")
+			options.threads = NumberParser::parse(value);
+		else if (arg == "--bitrate")
+			options.bitrate = NumberParser::parse(value);
+		else if (arg == "--fps")
+			options.fps = NumberParser::parse(value);
+		else if (arg == "--gop")
+			options.gop = NumberParser::parse(value);
+		else if (arg == "--mtu")
+			options.mtu = NumberParser::parse(value);
+		else if (arg == "--audio")
+			options.audio = true;
+		else if (arg == "--loss")
+			options.loss = LossPattern::parse(value);
+		else if (arg == "--sdp")
+			options.sdpFile = value;
+		else if (arg == "--duration")
+			options.duration = NumberParser::parse(value);
+		else
+			throw Poco::InvalidArgumentException("unknown option", arg);
+	}
+
+	if (options.cameras < 1 || options.threads < 1 || options.bitrate < 1 || options.fps < 1 || options.gop < 1)
+		throw Poco::InvalidArgumentException("--cameras, --threads, --bitrate, --fps and --gop must be positive");
+	if (options.mtu < 64 || options.mtu > 8192)
+		throw Poco::InvalidArgumentException("--mtu must be between 64 and 8192");
+	if (options.port < 0 || options.port > 65535)
+		throw Poco::InvalidArgumentException("--port out of range");
+}
+
+
+//
+// Camera profile
+//
+
+
+const UInt8 SPS[] = { 0x67, 0x42, 0xe0, 0x1f, 0x95, 0xa8, 0x14, 0x01, 0x6e, 0x40 };
+const UInt8 PPS[] = { 0x68, 0xce, 0x3c, 0x80 };
+
+
+struct Track
+	/// A media stream of the camera profile, as far as the RTP
+	/// generator is concerned.
+{
+	std::string control;
+	std::string encoding;
+	int         payloadType;
+	int         clockRate;
+	bool        video;
+};
+
+
+class CameraProfile
+	/// The media every simulated camera serves. The session is
+	/// described by a SDP::SessionDescription, either built from
+	/// the options or parsed from a template file; the tracks that
+	/// drive RTP generation are then read back from its media
+	/// descriptions, so what is announced is what is sent.
+{
+public:
+	explicit CameraProfile(const Options& options):
+		_sdp(options.sdpFile.empty() ? build(options) : load(options.sdpFile))
+	{
+		SDP::MediaVec media = _sdp.getMedia();
+		for (std::size_t i = 0; i < media.size(); ++i)
+		{
+			SDP::MediaField field = media[i].getMediaField();
+			SDP::StringVec formats = field.getMediaFormats();
+			if (formats.empty())
+				throw Poco::DataFormatException("media without formats", field.toString());
+
+			Track track;
+			track.payloadType = NumberParser::parse(formats[0]);
+			track.video       = field.getMediaType() == SDP::MediaTypes::Video;
+			track.clockRate   = track.video ? 90000 : 8000;
+			if (track.payloadType == 0)
+				track.encoding = "PCMU";
+			else if (track.payloadType == 8)
+				track.encoding = "PCMA";
+
+			SDP::AttributeVec attributes = media[i].getAttributes();
+			for (SDP::AttributeVec::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+			{
+				// the attribute value proper stops at the first ':',
+				// which would cut absolute control URLs
+				std::string value(it->getValue());
+				value.erase(0, value.find(':') + 1);
+				if (it->getName() == SDP::RtpAvpConstants::CONTROL)
+				{
+					track.control = value;
+				}
+				else if (it->getName() == SDP::RtpAvpConstants::RTPMAP && NumberParser::parse(value.substr(0, value.find(' '))) == track.payloadType)
+				{
+					std::string::size_type space = value.find(' ');
+					std::string::size_type slash = value.find('/', space);
+					track.encoding  = Poco::toUpper(value.substr(space + 1, slash - space - 1));
+					track.clockRate = NumberParser::parse(value.substr(slash + 1, value.find('/', slash + 1) - slash - 1));
+				}
+			}
+			if (track.control.empty() || track.control.find("://") != std::string::npos)
+				throw Poco::DataFormatException("media needs a relative a=control attribute", field.toString());
+			_tracks.push_back(track);
+		}
+		if (_tracks.empty())
+			throw Poco::DataFormatException("SDP without media");
+	}
+
+	std::string describe(int camera) const
+		/// Returns the SDP of the given camera.
+	{
+		SDP::SessionDescription sdp(_sdp);
+		sdp.setName(SDP::SessionNameField("Camera " + NumberFormatter::format(camera)));
+		return sdp.toString();
+	}
+
+	const std::vector<Track>& tracks() const
+	{
+		return _tracks;
+	}
+
+private:
+	static SDP::SessionDescription build(const Options& options)
+	{
+		SDP::TimeVec times(1, SDP::TimeDescription(SDP::TimeField("0 0")));
+		SDP::SessionDescription sdp(SDP::OriginField("-", "127.0.0.1", "IN", "IP4"), SDP::SessionNameField("Camera"), times);
+		sdp.setConnectionInfo(SDP::ConnectionField("IN IP4 0.0.0.0"));
+
+		SDP::AttributeVec attributes;
+		attributes.push_back(SDP::AttributeField(SDP::RtpAvpConstants::CONTROL, "*"));
+		attributes.push_back(SDP::AttributeField("range", "npt=now-"));
+		sdp.setAttributes(attributes);
+
+		SDP::MediaVec media;
+
+		SDP::StringVec formats(1, "96");
+		SDP::MediaDescription video(SDP::MediaField(SDP::MediaTypes::Video, SDP::RtpAvpConstants::RTP_AVP, SDP::PortRange(0), formats));
+		video.setBandwidth(SDP::BandwidthField("AS", options.bitrate));
+		attributes.clear();
+		attributes.push_back(SDP::AttributeField(SDP::RtpAvpConstants::RTPMAP, "96 H264/90000"));
+		attributes.push_back(SDP::AttributeField(SDP::RtpAvpConstants::FMTP, "96 packetization-mode=1;profile-level-id=42e01f;sprop-parameter-sets=Z0LgH5WoFAFuQA==,aM48gA=="));
+		attributes.push_back(SDP::AttributeField("framerate", NumberFormatter::format(options.fps)));
+		attributes.push_back(SDP::AttributeField(SDP::RtpAvpConstants::CONTROL, "trackID=1"));
+		video.setAttributes(attributes);
+		media.push_back(video);
+
+		if (options.audio)
+		{
+			formats.assign(1, "0");
+			SDP::MediaDescription audio(SDP::MediaField(SDP::MediaTypes::Audio, SDP::RtpAvpConstants::RTP_AVP, SDP::PortRange(0), formats));
+			attributes.clear();
+			attributes.push_back(SDP::AttributeField(SDP::RtpAvpConstants::RTPMAP, "0 PCMU/8000"));
+			attributes.push_back(SDP::AttributeField(SDP::RtpAvpConstants::CONTROL, "trackID=2"));
+			audio.setAttributes(attributes);
+			media.push_back(audio);
+		}
+
+		sdp.setMedia(media);
+		return sdp;
+	}
+
+	static SDP::SessionDescription load(const std::string& path)
+	{
+		std::ifstream istr(path.c_str());
+		if (!istr)
+			throw Poco::OpenFileException(path);
+
+		// the parser expects CRLF line ends
+		std::string text;
+		std::string line;
+		while (std::getline(istr, line))
+		{
+			if (!line.empty() && line[line.size() - 1] == '\r')
+				line.erase(line.size() - 1);
+			if (!line.empty())
+				text += line + "\r\n";
+		}
+		return SDP::SessionDescription(text);
+	}
+
+	SDP::SessionDescription _sdp;
+	std::vector<Track>      _tracks;
+};
+
+
+//
+// Server
+//
+
+
+struct Statistics
+	/// Shared by all event loops.
+{
+	Statistics():
+		connections(0),
+		streams(0),
+		packets(0),
+		bytes(0),
+		lost(0),
+		overflows(0)
+	{
+	}
+
+	std::atomic<int>    connections;
+	std::atomic<int>    streams;
+	std::atomic<UInt64> packets;
+	std::atomic<UInt64> bytes;
+	std::atomic<UInt64> lost;
+	std::atomic<UInt64> overflows;
+};
+
+
+std::atomic<bool> stopRequested(false);
+
+
+void requestStop(int)
+{
+	stopRequested = true;
+}
+
+
+int openSocket(int type, const std::string& address, int port, bool reusePort)
+{
+	int fd = ::socket(AF_INET, type | SOCK_NONBLOCK, 0);
+	if (fd < 0)
+		throw Poco::IOException("cannot create socket", std::strerror(errno));
+
+	int one = 1;
+	::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	if (reusePort)
+		::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+	struct sockaddr_in sa;
+	std::memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_port   = htons((UInt16) port);
+	if (::inet_pton(AF_INET, address.c_str(), &sa.sin_addr) != 1)
+	{
+		::close(fd);
+		throw Poco::InvalidArgumentException("not an IPv4 address", address);
+	}
+	if (::bind(fd, (struct sockaddr*) &sa, sizeof(sa)) < 0)
+	{
+		int error = errno;
+		::close(fd);
+		throw Poco::IOException("cannot bind " + address + ":" + NumberFormatter::format(port), std::strerror(error));
+	}
+	if (type == SOCK_STREAM && ::listen(fd, 4096) < 0)
+	{
+		int error = errno;
+		::close(fd);
+		throw Poco::IOException("cannot listen", std::strerror(error));
+	}
+	return fd;
+}
+
+
+int localPort(int fd)
+{
+	struct sockaddr_in sa;
+	socklen_t length = sizeof(sa);
+	::getsockname(fd, (struct sockaddr*) &sa, &length);
+	return ntohs(sa.sin_port);
+}
+
+
+class EventLoop: public Runnable
+	/// Serves RTSP and generates RTP for the connections it has
+	/// accepted. Several loops share the RTSP port through
+	/// SO_REUSEPORT and have their own pair of UDP ports; a loop
+	/// never touches another loop's state.
+	///
+	/// RTP packets are produced a whole video frame, or one 20 ms
+	/// audio packet, at a time when a stream is due, and the loop
+	/// sleeps in epoll_wait() until the earliest stream is due.
+{
+public:
+	EventLoop(const Options& options, const CameraProfile& profile, Statistics& statistics, int port):
+		_options(options),
+		_profile(profile),
+		_statistics(statistics),
+		_listenFd(openSocket(SOCK_STREAM, options.address, port, true)),
+		_rtpFd(-1),
+		_rtcpFd(-1),
+		_epollFd(::epoll_create1(0)),
+		_nextSession(0),
+		_generation(0)
+	{
+		// RTP and RTCP on adjacent ports, RTP even
+		for (int attempt = 0; attempt < 64 && _rtcpFd < 0; ++attempt)
+		{
+			_rtpFd = openSocket(SOCK_DGRAM, options.address, 0, false);
+			int rtpPort = localPort(_rtpFd);
+			if (rtpPort % 2 == 0)
+			{
+				try
+				{
+					_rtcpFd = openSocket(SOCK_DGRAM, options.address, rtpPort + 1, false);
+					break;
+				}
+				catch (Poco::IOException&)
+				{
+				}
+			}
+			::close(_rtpFd);
+			_rtpFd = -1;
+		}
+		if (_rtcpFd < 0)
+			throw Poco::IOException("cannot allocate an RTP/RTCP port pair");
+
+		int size = 4 * 1024 * 1024;
+		::setsockopt(_rtpFd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+		_nextSession = ((UInt32) localPort(_rtpFd) << 16) * 2654435761u;
+
+		watch(_listenFd, EPOLLIN);
+	}
+
+	~EventLoop()
+	{
+		for (Connections::iterator it = _connections.begin(); it != _connections.end(); ++it)
+			::close(it->first);
+		::close(_listenFd);
+		::close(_rtpFd);
+		::close(_rtcpFd);
+		::close(_epollFd);
+	}
+
+	int port() const
+	{
+		return localPort(_listenFd);
+	}
+
+	void run()
+	{
+		struct epoll_event events[256];
+		char buffer[16384];
+		while (!stopRequested)
+		{
+			int timeout = 100;
+			if (!_due.empty())
+			{
+				Timestamp::TimeDiff wait = _due.top().time - Timestamp().epochMicroseconds();
+				timeout = (int) std::max<Timestamp::TimeDiff>(0, std::min<Timestamp::TimeDiff>(wait / 1000, 100));
+			}
+
+			int n = ::epoll_wait(_epollFd, events, 256, timeout);
+			for (int i = 0; i < n; ++i)
+			{
+				int fd = events[i].data.fd;
+				if (fd == _listenFd)
+				{
+					accept();
+					continue;
+				}
+
+				Connections::iterator it = _connections.find(fd);
+				if (it == _connections.end())
+					continue;
+				Connection& connection = it->second;
+				if (events[i].events & EPOLLOUT)
+				{
+					flush(connection);
+				}
+				if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				{
+					int rc;
+					while ((rc = (int) ::recv(fd, buffer, sizeof(buffer), 0)) > 0)
+					{
+						connection.in.append(buffer, rc);
+					}
+						if (rc == 0 || (rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+					{
+						close(it);
+						continue;
+					}
+
+					// whatever a client sends only ever
+					// costs its own connection
+					bool keep = false;
+					try
+					{
+						keep = serve(connection);
+					}
+					catch (Poco::Exception&)
+					{
+					}
+					catch (Poco::Exception* pExc)
+					{
+						delete pExc;
+					}
+					catch (std::exception&)
+					{
+					}
+					if (!keep)
+						close(it);
+				}
+			}
+			generate();
+		}
+	}
+
+private:
+	struct Stream
+	{
+		Stream():
+			track(0),
+			interleaved(false),
+			channel(0),
+			ssrc(0),
+			sequence(0),
+			rtpBase(0),
+			index(0),
+			random(0),
+			unit(0),
+			epoch(0),
+			playing(false)
+		{
+			std::memset(&destination, 0, sizeof(destination));
+		}
+
+		std::size_t        track;
+		bool               interleaved;
+		int                channel;
+		struct sockaddr_in destination;
+		UInt32             ssrc;
+		UInt16             sequence;
+		UInt32             rtpBase;
+		UInt32             index;
+		UInt32             random;
+		UInt64             unit;
+		Timestamp::TimeVal epoch;
+		bool               playing;
+	};
+
+	struct Connection
+	{
+		Connection():
+			fd(-1),
+			camera(0),
+			generation(0),
+			writing(false)
+		{
+		}
+
+		int                 fd;
+		struct sockaddr_in  peer;
+		std::string         in;
+		std::string         out;
+		std::string         session;
+		int                 camera;
+		unsigned            generation;
+		bool                writing;
+		std::vector<Stream> streams;
+	};
+
+	struct Due
+	{
+		Timestamp::TimeVal time;
+		int                fd;
+		unsigned           generation;
+		std::size_t        stream;
+
+		bool operator > (const Due& other) const
+		{
+			return time > other.time;
+		}
+	};
+
+	struct Request
+	{
+		std::string method;
+		std::string uri;
+		std::string cseq;
+		std::string session;
+		std::string transport;
+	};
+
+	typedef std::map<int, Connection> Connections;
+	typedef std::priority_queue<Due, std::vector<Due>, std::greater<Due> > DueQueue;
+
+	enum
+	{
+		MAX_PENDING_OUTPUT = 4 * 1024 * 1024
+	};
+
+	void watch(int fd, unsigned events)
+	{
+		struct epoll_event ev;
+		ev.events  = events;
+		ev.data.fd = fd;
+		if (::epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0)
+			::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev);
+	}
+
+	void accept()
+	{
+		struct sockaddr_in peer;
+		socklen_t length = sizeof(peer);
+		int fd;
+		while ((fd = ::accept4(_listenFd, (struct sockaddr*) &peer, &length, SOCK_NONBLOCK)) >= 0)
+		{
+			Connection& connection = _connections[fd];
+			connection.fd         = fd;
+			connection.peer       = peer;
+			connection.generation = ++_generation;
+			watch(fd, EPOLLIN);
+			++_statistics.connections;
+			length = sizeof(peer);
+		}
+	}
+
+	void close(Connections::iterator it)
+	{
+		stopStreams(it->second);
+		::close(it->first);
+		_connections.erase(it);
+		--_statistics.connections;
+	}
+
+	void flush(Connection& connection)
+	{
+		while (!connection.out.empty())
+		{
+			int rc = (int) ::send(connection.fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+			if (rc <= 0)
+				break;
+			connection.out.erase(0, rc);
+		}
+		bool writing = !connection.out.empty();
+		if (writing != connection.writing)
+		{
+			watch(connection.fd, writing ? EPOLLIN | EPOLLOUT : EPOLLIN);
+			connection.writing = writing;
+		}
+	}
+
+	static std::string header(const std::string& message, const std::string& name)
+		/// Returns the value of the named header of message. Header
+		/// names are case-insensitive (RFC 2326, 4.2).
+	{
+		std::string::size_type pos = message.find("\r\n");
+		while (pos != std::string::npos)
+		{
+			pos += 2;
+			std::string::size_type end = message.find("\r\n", pos);
+			std::string::size_type colon = message.find(':', pos);
+			if (colon < end && colon - pos == name.size() && Poco::icompare(message, pos, name.size(), name) == 0)
+				return Poco::trim(message.substr(colon + 1, end - colon - 1));
+			pos = end;
+		}
+		return std::string();
+	}
+
+	bool serve(Connection& connection)
+		/// Answers the complete requests received on the connection.
+		/// Returns false if the connection has to be closed.
+	{
+		std::string& in = connection.in;
+		while (!in.empty())
+		{
+			if (in[0] == '$')
+			{
+				// interleaved RTCP from the client
+				if (in.size() < 4)
+					break;
+				std::size_t length = 4 + ((UInt8) in[2] << 8 | (UInt8) in[3]);
+				if (in.size() < length)
+					break;
+				in.erase(0, length);
+				continue;
+			}
+
+			std::string::size_type end = in.find("\r\n\r\n");
+			if (end == std::string::npos)
+				break;
+			std::size_t length = end + 4;
+			std::string contentLength = header(in.substr(0, end + 2), "Content-Length");
+			unsigned bodyLength = 0;
+			if (!contentLength.empty() && !NumberParser::tryParseUnsigned(contentLength, bodyLength))
+			{
+				// where the message ends is unknown,
+				// so nothing after it can be parsed
+				connection.out.append("RTSP/1.0 400 Bad Request\r\nCSeq: ");
+				connection.out.append(header(in.substr(0, end + 2), "CSeq"));
+				connection.out.append("\r\nServer: camera_sim\r\nConnection: close\r\n\r\n");
+				flush(connection);
+				return false;
+			}
+			length += bodyLength;
+			if (in.size() < length)
+				break;
+
+			std::string message(in, 0, end + 2);
+			in.erase(0, length);
+
+			Request request;
+			std::string::size_type space = message.find(' ');
+			request.method    = message.substr(0, space);
+			request.uri       = message.substr(space + 1, message.find(' ', space + 1) - space - 1);
+			request.cseq      = header(message, "CSeq");
+			request.session   = header(message, "Session");
+			request.transport = header(message, "Transport");
+			respond(connection, request);
+		}
+		flush(connection);
+		return true;
+	}
+
+	bool resolve(const std::string& uri, int& camera, std::string& control) const
+		/// Splits rtsp://host/camN[/control] into the camera
+		/// number and the track control.
+	{
+		std::string::size_type pos = uri.find("://");
+		pos = uri.find('/', pos == std::string::npos ? 0 : pos + 3);
+		if (pos == std::string::npos || uri.compare(pos, 4, "/cam") != 0)
+			return false;
+		pos += 4;
+		std::string::size_type end = uri.find('/', pos);
+		if (!NumberParser::tryParse(uri.substr(pos, end - pos), camera) || camera < 1 || camera > _options.cameras)
+			return false;
+		control = end == std::string::npos ? std::string() : uri.substr(end + 1);
+		return true;
+	}
+
+	void respond(Connection& connection, const Request& request)
+	{
+		std::string headers;
+		std::string body;
+		const char* status = "200 OK";
+
+		int camera;
+		std::string control;
+		if (request.method == "OPTIONS")
+		{
+			headers = "Public: OPTIONS, DESCRIBE, SETUP, PLAY, PAUSE, GET_PARAMETER, TEARDOWN\r\n";
+		}
+		else if (!resolve(request.uri, camera, control) || (connection.camera != 0 && connection.camera != camera))
+		{
+			status = "404 Not Found";
+		}
+		else if (request.method != "DESCRIBE" && request.method != "SETUP" && request.method != "PLAY" &&
+		         request.method != "PAUSE" && request.method != "GET_PARAMETER" && request.method != "TEARDOWN")
+		{
+			status = "501 Not Implemented";
+		}
+		else if (request.method == "DESCRIBE")
+		{
+			body = _profile.describe(camera);
+			headers = "Content-Base: " + request.uri + (request.uri[request.uri.size() - 1] == '/' ? "" : "/") + "\r\n"
+			          "Content-Type: application/sdp\r\n";
+		}
+		else if (!connection.session.empty() && !request.session.empty() &&
+		         request.session.substr(0, request.session.find(';')) != connection.session)
+		{
+			status = "454 Session Not Found";
+		}
+		else if (request.method == "SETUP")
+		{
+			status = setup(connection, camera, control, request.transport, headers);
+		}
+		else if (connection.session.empty())
+		{
+			status = "455 Method Not Valid in This State";
+		}
+		else if (request.method == "PLAY")
+		{
+			play(connection, request.uri, headers);
+		}
+		else if (request.method == "PAUSE")
+		{
+			stopStreams(connection);
+		}
+		else if (request.method == "TEARDOWN")
+		{
+			stopStreams(connection);
+			connection.streams.clear();
+			connection.generation = ++_generation;
+		}
+
+		std::string& out = connection.out;
+		out.append("RTSP/1.0 ");
+		out.append(status);
+		out.append("\r\nCSeq: ");
+		out.append(request.cseq);
+		out.append("\r\nServer: camera_sim\r\n");
+		if (!connection.session.empty() && request.method != "OPTIONS" && request.method != "DESCRIBE")
+		{
+			out.append("Session: ");
+			out.append(connection.session);
+			out.append(";timeout=60\r\n");
+		}
+		out.append(headers);
+		if (!body.empty())
+		{
+			out.append("Content-Length: ");
+			out.append(NumberFormatter::format(body.size()));
+			out.append("\r\n");
+		}
+		out.append("\r\n");
+		out.append(body);
+
+		if (request.method == "TEARDOWN")
+		{
+			connection.session.clear();
+			connection.camera = 0;
+		}
+	}
+
+	const char* setup(Connection& connection, int camera, const std::string& control, const std::string& transport, std::string& headers)
+	{
+		const std::vector<Track>& tracks = _profile.tracks();
+		std::size_t track = 0;
+		while (track < tracks.size() && tracks[track].control != control)
+			++track;
+		if (track == tracks.size())
+			return "404 Not Found";
+
+		Stream stream;
+		stream.track = track;
+		std::string::size_type pos;
+		if (transport.compare(0, 11, "RTP/AVP/TCP") == 0)
+		{
+			stream.interleaved = true;
+			stream.channel     = 2 * (int) connection.streams.size();
+			if ((pos = transport.find("interleaved=")) != std::string::npos)
+				NumberParser::tryParse(transport.substr(pos + 12, transport.find_first_of("-;", pos + 12) - pos - 12), stream.channel);
+			if (stream.channel < 0 || stream.channel > 254)
+				return "461 Unsupported Transport";
+			headers = "Transport: RTP/AVP/TCP;unicast;interleaved=" + NumberFormatter::format(stream.channel) + "-" + NumberFormatter::format(stream.channel + 1);
+		}
+		else if (transport.compare(0, 7, "RTP/AVP") == 0 && (pos = transport.find("client_port=")) != std::string::npos)
+		{
+			int port;
+			if (!NumberParser::tryParse(transport.substr(pos + 12, transport.find_first_of("-;", pos + 12) - pos - 12), port) || port < 1 || port > 65535)
+				return "461 Unsupported Transport";
+			stream.destination          = connection.peer;
+			stream.destination.sin_port = htons((UInt16) port);
+			headers = "Transport: RTP/AVP;unicast;client_port=" + NumberFormatter::format(port) + "-" + NumberFormatter::format(port + 1) +
+			          ";server_port=" + NumberFormatter::format(localPort(_rtpFd)) + "-" + NumberFormatter::format(localPort(_rtcpFd));
+		}
+		else
+		{
+			return "461 Unsupported Transport";
+		}
+
+		if (connection.session.empty())
+		{
+			_nextSession = _nextSession * 1664525u + 1013904223u;
+			connection.session = NumberFormatter::formatHex(_nextSession, 8);
+		}
+		connection.camera = camera;
+
+		stream.ssrc     = (UInt32) (camera * 2654435761u) ^ (UInt32) (track + 1) * 40503u ^ _nextSession;
+		stream.sequence = (UInt16) stream.ssrc;
+		stream.rtpBase  = stream.ssrc * 69069u;
+		stream.random   = stream.ssrc | 1;
+		headers += ";ssrc=" + NumberFormatter::formatHex(stream.ssrc, 8) + "\r\n";
+
+		for (std::size_t i = 0; i < connection.streams.size(); ++i)
+		{
+			if (connection.streams[i].track == track)
+			{
+				if (connection.streams[i].playing)
+					return "455 Method Not Valid in This State";
+				connection.streams[i] = stream;
+				return "200 OK";
+			}
+		}
+		connection.streams.push_back(stream);
+		return "200 OK";
+	}
+
+	void play(Connection& connection, const std::string& uri, std::string& headers)
+	{
+		const std::vector<Track>& tracks = _profile.tracks();
+		std::string base(uri);
+		if (!base.empty() && base[base.size() - 1] == '/')
+			base.erase(base.size() - 1);
+
+		Timestamp::TimeVal now = Timestamp().epochMicroseconds();
+		std::string info;
+		for (std::size_t i = 0; i < connection.streams.size(); ++i)
+		{
+			Stream& stream = connection.streams[i];
+			const Track& track = tracks[stream.track];
+			if (!stream.playing)
+			{
+				// continue the timeline after a PAUSE
+				stream.rtpBase += (UInt32) (stream.unit * ticksPerUnit(track));
+				stream.unit     = 0;
+				stream.epoch    = now;
+				stream.playing  = true;
+				++_statistics.streams;
+				Due due = { now, connection.fd, connection.generation, i };
+				_due.push(due);
+			}
+			if (!info.empty())
+				info += ",";
+			info += "url=" + base + "/" + track.control + ";seq=" + NumberFormatter::format(stream.sequence) + ";rtptime=" + NumberFormatter::format(stream.rtpBase);
+		}
+		headers = "Range: npt=now-\r\nRTP-Info: " + info + "\r\n";
+	}
+
+	void stopStreams(Connection& connection)
+	{
+		for (std::size_t i = 0; i < connection.streams.size(); ++i)
+		{
+			if (connection.streams[i].playing)
+			{
+				connection.streams[i].playing = false;
+				--_statistics.streams;
+			}
+		}
+		// invalidates the queued due times
+		connection.generation = ++_generation;
+	}
+
+	UInt64 ticksPerUnit(const Track& track) const
+		/// A unit is a video frame or a 20 ms audio packet.
+	{
+		return track.video ? track.clockRate / _options.fps : track.clockRate / 50;
+	}
+
+	Timestamp::TimeDiff unitDuration(const Track& track) const
+	{
+		return track.video ? 1000000 / _options.fps : 20000;
+	}
+
+	void generate()
+	{
+		Timestamp::TimeVal now = Timestamp().epochMicroseconds();
+		while (!_due.empty() && _due.top().time <= now)
+		{
+			Due due = _due.top();
+			_due.pop();
+
+			Connections::iterator it = _connections.find(due.fd);
+			if (it == _connections.end() || it->second.generation != due.generation)
+				continue;
+			Connection& connection = it->second;
+			Stream& stream = connection.streams[due.stream];
+			const Track& track = _profile.tracks()[stream.track];
+
+			if (track.video)
+				sendFrame(connection, stream, track);
+			else
+				sendAudio(connection, stream, track);
+			if (stream.interleaved)
+				flush(connection);
+
+			++stream.unit;
+			due.time = stream.epoch + (Timestamp::TimeDiff) stream.unit * unitDuration(track);
+			if (due.time < now - 1000000)
+			{
+				// too far behind, skip ahead rather than burst
+				stream.unit = (now - stream.epoch) / unitDuration(track);
+				due.time    = stream.epoch + (Timestamp::TimeDiff) stream.unit * unitDuration(track);
+			}
+			_due.push(due);
+		}
+	}
+
+	void sendFrame(Connection& connection, Stream& stream, const Track& track)
+	{
+		UInt32 timestamp = stream.rtpBase + (UInt32) (stream.unit * ticksPerUnit(track));
+		std::size_t frameSize = std::max<std::size_t>((std::size_t) _options.bitrate * 1000 / 8 / _options.fps, 16);
+		bool h264 = track.encoding == "H264";
+		bool key = stream.unit % _options.gop == 0;
+		std::size_t mtu = _options.mtu;
+
+		if (!h264)
+		{
+			// opaque payload in MTU sized pieces
+			for (std::size_t offset = 0; offset < frameSize; offset += mtu)
+			{
+				std::size_t size = std::min(mtu, frameSize - offset);
+				UInt8* p = begin(stream, track, offset + size == frameSize, timestamp);
+				std::memset(p, 0x5a, size);
+				send(connection, stream, size);
+			}
+			return;
+		}
+
+		if (key)
+		{
+			UInt8* p = begin(stream, track, false, timestamp);
+			std::memcpy(p, SPS, sizeof(SPS));
+			send(connection, stream, sizeof(SPS));
+			p = begin(stream, track, false, timestamp);
+			std::memcpy(p, PPS, sizeof(PPS));
+			send(connection, stream, sizeof(PPS));
+		}
+
+		// one slice NAL unit, IDR on key frames
+		UInt8 nalHeader = key ? 0x65 : 0x41;
+		if (frameSize + 1 <= mtu)
+		{
+			UInt8* p = begin(stream, track, true, timestamp);
+			p[0] = nalHeader;
+			std::memset(p + 1, 0x5a, frameSize);
+			send(connection, stream, frameSize + 1);
+			return;
+		}
+
+		// FU-A fragments, RFC 6184 section 5.8
+		std::size_t chunk = mtu - 2;
+		for (std::size_t offset = 0; offset < frameSize; offset += chunk)
+		{
+			std::size_t size = std::min(chunk, frameSize - offset);
+			bool last = offset + size == frameSize;
+			UInt8* p = begin(stream, track, last, timestamp);
+			p[0] = (nalHeader & 0xe0) | 28;
+			p[1] = (nalHeader & 0x1f) | (offset == 0 ? 0x80 : 0) | (last ? 0x40 : 0);
+			std::memset(p + 2, 0x5a, size);
+			send(connection, stream, size + 2);
+		}
+	}
+
+	void sendAudio(Connection& connection, Stream& stream, const Track& track)
+	{
+		UInt32 timestamp = stream.rtpBase + (UInt32) (stream.unit * ticksPerUnit(track));
+		std::size_t size = std::min<std::size_t>(ticksPerUnit(track), _options.mtu);
+		UInt8* p = begin(stream, track, false, timestamp);
+		// silence
+		std::memset(p, track.encoding == "PCMA" ? 0xd5 : 0xff, size);
+		send(connection, stream, size);
+	}
+
+	UInt8* begin(Stream& stream, const Track& track, bool marker, UInt32 timestamp)
+		/// Writes the RTP header of the next packet and returns
+		/// where its payload goes. Interleaved packets leave room
+		/// for the '$' framing in front.
+	{
+		UInt8* p = _packet + 4;
+		p[0]  = 0x80;
+		p[1]  = (UInt8) ((marker ? 0x80 : 0) | (track.payloadType & 0x7f));
+		p[2]  = (UInt8) (stream.sequence >> 8);
+		p[3]  = (UInt8) stream.sequence;
+		p[4]  = (UInt8) (timestamp >> 24);
+		p[5]  = (UInt8) (timestamp >> 16);
+		p[6]  = (UInt8) (timestamp >> 8);
+		p[7]  = (UInt8) timestamp;
+		p[8]  = (UInt8) (stream.ssrc >> 24);
+		p[9]  = (UInt8) (stream.ssrc >> 16);
+		p[10] = (UInt8) (stream.ssrc >> 8);
+		p[11] = (UInt8) stream.ssrc;
+		++stream.sequence;
+		return p + 12;
+	}
+
+	void send(Connection& connection, Stream& stream, std::size_t payload)
+	{
+		std::size_t size = 12 + payload;
+		if (_options.loss.drop(stream.index++, stream.random))
+		{
+			++_statistics.lost;
+			return;
+		}
+
+		if (stream.interleaved)
+		{
+			if (connection.out.size() > MAX_PENDING_OUTPUT)
+			{
+				++_statistics.overflows;
+				return;
+			}
+			_packet[0] = '$';
+			_packet[1] = (UInt8) stream.channel;
+			_packet[2] = (UInt8) (size >> 8);
+			_packet[3] = (UInt8) size;
+			connection.out.append(reinterpret_cast<const char*>(_packet), size + 4);
+		}
+		else if (::sendto(_rtpFd, _packet + 4, size, 0, (const struct sockaddr*) &stream.destination, sizeof(stream.destination)) < 0)
+		{
+			++_statistics.overflows;
+			return;
+		}
+		++_statistics.packets;
+		_statistics.bytes += size;
+	}
+
+	const Options&       _options;
+	const CameraProfile& _profile;
+	Statistics&          _statistics;
+	int                  _listenFd;
+	int                  _rtpFd;
+	int                  _rtcpFd;
+	int                  _epollFd;
+	UInt32               _nextSession;
+	unsigned             _generation;
+	Connections          _connections;
+	DueQueue             _due;
+	UInt8                _packet[4 + 12 + 8192];
+};
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		parseOptions(argc, argv, options);
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << "\n\n" << USAGE;
+		return 2;
+	}
+
+	std::signal(SIGINT, requestStop);
+	std::signal(SIGTERM, requestStop);
+
+	std::vector<EventLoop*> loops;
+	std::vector<Thread*> threads;
+	try
+	{
+		CameraProfile profile(options);
+		Statistics statistics;
+
+		int port = options.port;
+		for (int t = 0; t < options.threads; ++t)
+		{
+			loops.push_back(new EventLoop(options, profile, statistics, port));
+			port = loops.back()->port();
+		}
+
+		std::cout << "serving " << options.cameras << " cameras at rtsp://" << options.address << ":" << port
+		          << "/cam1 .. /cam" << options.cameras << ", " << profile.tracks().size() << " tracks each" << std::endl;
+
+		for (int t = 0; t < options.threads; ++t)
+		{
+			threads.push_back(new Thread);
+			threads.back()->start(*loops[t]);
+		}
+
+		Timestamp start;
+		UInt64 lastPackets = 0;
+		UInt64 lastBytes = 0;
+		while (!stopRequested)
+		{
+			Thread::sleep(1000);
+			UInt64 packets = statistics.packets.load();
+			UInt64 bytes = statistics.bytes.load();
+			std::printf("%d connections, %d streams, %lu pkt/s, %.1f Mbit/s, %lu dropped by pattern, %lu overflows\n",
+				statistics.connections.load(), statistics.streams.load(),
+				(unsigned long) (packets - lastPackets), (bytes - lastBytes) * 8 / 1e6,
+				(unsigned long) statistics.lost.load(), (unsigned long) statistics.overflows.load());
+			std::fflush(stdout);
+			lastPackets = packets;
+			lastBytes = bytes;
+			if (options.duration > 0 && start.elapsed() >= (Timestamp::TimeDiff) options.duration * 1000000)
+				stopRequested = true;
+		}
+
+		for (std::size_t t = 0; t < threads.size(); ++t)
+		{
+			threads[t]->join();
+			delete threads[t];
+			delete loops[t];
+		}
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	catch (Poco::Exception* pExc)
+	{
+		// the SDP library throws by pointer
+		std::cerr << pExc->displayText() << std::endl;
+		delete pExc;
+		return 1;
+	}
+	return 0;
+}
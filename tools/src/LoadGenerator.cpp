@@ -0,0 +1,896 @@
+/*****************************************************************************
+//	RTSP SDK Tools
+//
+//	RTSP Load Generator
+//
+//	description:
+//		opens thousands of RTSP sessions with a configurable ramp and
+//		request mix and reports latency distributions and error rates
+//
+//	revision of last commit:
+//		$Rev$
+//	author of last commit:
+//		$Author$
+//	date of last commit:
+//		$Date$
+//
+//	created by Argenet {argenet@sibears.org}
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+******************************************************************************/
+
+
+#if !defined(__linux__)
+	#error "rtsp_loadgen runs its stand-in server with epoll and builds on Linux only"
+#endif
+
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "Poco/Clock.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
+#include "Poco/Runnable.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/String.h"
+#include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+#include "Poco/URI.h"
+
+#include "RTSPClientSession.h"
+#include "RTSPLatencyHistogram.h"
+#include "RTSPLatencyRecorder.h"
+#include "RTSPRequest.h"
+#include "RTSPResponse.h"
+#include "RTSPSessionFactory.h"
+#include "RTSPSessionInstantiator.h"
+
+
+using Poco::Clock;
+using Poco::NumberFormatter;
+using Poco::NumberParser;
+using Poco::Runnable;
+using Poco::SharedPtr;
+using Poco::Thread;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::URI;
+using Poco::Net::ServerSocket;
+using Poco::Net::SocketAddress;
+
+using RTSP::RTSPClientSession;
+using RTSP::RTSPLatencyHistogram;
+using RTSP::RTSPLatencyRecorder;
+using RTSP::RTSPRequest;
+using RTSP::RTSPResponse;
+using RTSP::RTSPSessionFactory;
+using RTSP::RTSPSessionInstantiator;
+using RTSP::RTSPSessionMetrics;
+
+
+namespace {
+
+
+const char USAGE[] =
+	"usage: rtsp_loadgen [options] [uri...]\n"
+	"  --sessions=N        sessions to open (1000)\n"
+	"  --ramp=R            sessions started per second (200)\n"
+	"  --mix=LIST          startup requests, e.g. DESCRIBE,SETUP*2,PLAY\n"
+	"                      (DESCRIBE,SETUP,PLAY)\n"
+	"  --keepalive=MS      GET_PARAMETER interval after PLAY, 0 for none (5000)\n"
+	"  --hold=S            seconds a session stays playing (30)\n"
+	"  --timeout=MS        request timeout (5000)\n"
+	"  --client-port=P     first client_port offered in SETUP (50000); every\n"
+	"                      session takes two ports per SETUP in the mix\n"
+	"  --uri-file=PATH     file with one target URI per line\n"
+	"  --local             start a stand-in server on 127.0.0.1 and load it\n"
+	"Sessions are spread round-robin over all target URIs; each one\n"
+	"runs on its own thread.\n";
+
+
+//
+// Configuration
+//
+
+
+struct Options
+{
+	Options():
+		sessions(1000),
+		ramp(200),
+		keepalive(5000),
+		hold(30),
+		timeout(5000),
+		clientPort(50000),
+		local(false)
+	{
+	}
+
+	int sessions;
+	int ramp;
+	int keepalive;
+	int hold;
+	int timeout;
+	int clientPort;
+	bool local;
+	std::vector<std::string> mix;
+	std::vector<URI> uris;
+};
+
+
+std::vector<std::string> parseMix(const std::string& list)
+	/// Expands "DESCRIBE,SETUP*2,PLAY" into the request sequence.
+{
+	std::vector<std::string> result;
+	std::string::size_type pos = 0;
+	while (pos <= list.size())
+	{
+		std::string::size_type end = list.find(',', pos);
+		if (end == std::string::npos)
+			end = list.size();
+		std::string item = Poco::toUpper(list.substr(pos, end - pos));
+		int count = 1;
+		std::string::size_type star = item.find('*');
+		if (star != std::string::npos)
+		{
+			count = NumberParser::parse(item.substr(star + 1));
+			item.erase(star);
+		}
+		if (item != RTSPRequest::RTSP_DESCRIBE && item != RTSPRequest::RTSP_SETUP &&
+		    item != RTSPRequest::RTSP_PLAY && item != RTSPRequest::RTSP_OPTIONS &&
+		    item != RTSPRequest::RTSP_GET_PARAMETER)
+		{
+			throw Poco::InvalidArgumentException("unsupported method in --mix", item);
+		}
+		for (int i = 0; i < count; ++i)
+			result.push_back(item);
+		pos = end + 1;
+	}
+	return result;
+}
+
+
+void parseOptions(int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg(argv[i]);
+		std::string value;
+		std::string::size_type eq = arg.find('=');
+		if (eq != std::string::npos)
+		{
+			value = arg.substr(eq + 1);
+			arg.erase(eq);
+		}
+
+		if (arg == "--sessions")
+			options.sessions = NumberParser::parse(value);
+		else if (arg == "--ramp")
+			options.ramp = NumberParser::parse(value);
+		else if (arg == "--mix")
+			options.mix = parseMix(value);
+		else if (arg == "--keepalive")
+			options.keepalive = NumberParser::parse(value);
+		else if (arg == "--hold")
+			options.hold = NumberParser::parse(value);
+		else if (arg == "--timeout")
+			options.timeout = NumberParser::parse(value);
+		else if (arg == "--client-port")
+			options.clientPort = NumberParser::parse(value);
+		else if (arg == "--local")
+			options.local = true;
+		else if (arg == "--uri-file")
+		{
+			std::ifstream istr(value.c_str());
+			if (!istr)
+				throw Poco::OpenFileException(value);
+			std::string line;
+			while (std::getline(istr, line))
+			{
+				line = Poco::trim(line);
+				if (!line.empty() && line[0] != '#')
+					options.uris.push_back(URI(line));
+			}
+		}
+		else if (arg.compare(0, 2, "--") != 0)
+			options.uris.push_back(URI(argv[i]));
+		else
+			throw Poco::InvalidArgumentException("unknown option", arg);
+	}
+
+	if (options.mix.empty())
+		options.mix = parseMix("DESCRIBE,SETUP,PLAY");
+	if (options.sessions < 1 || options.ramp < 1 || options.timeout < 1)
+		throw Poco::InvalidArgumentException("--sessions, --ramp and --timeout must be positive");
+
+	// every session gets its own client_port pairs, one per SETUP
+	int setups = (int) std::count(options.mix.begin(), options.mix.end(), std::string(RTSPRequest::RTSP_SETUP));
+	if (options.clientPort < 1 || (Poco::Int64) options.clientPort + 2 * (Poco::Int64) setups * options.sessions > 65536)
+	{
+		throw Poco::InvalidArgumentException("--client-port leaves too few ports for "
+			+ NumberFormatter::format(options.sessions) + " sessions with "
+			+ NumberFormatter::format(setups) + " SETUP requests each");
+	}
+}
+
+
+//
+// Stand-in server
+//
+
+
+void setNonBlocking(int fd)
+{
+	::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+
+class StandInServer: public Runnable
+	/// A minimal RTSP server on the loopback interface, so load
+	/// runs need no camera and no outside network. It answers
+	/// OPTIONS, DESCRIBE, SETUP, PLAY, GET_PARAMETER and TEARDOWN
+	/// with plausible responses from a single epoll thread, but
+	/// sends no media. The thread runs for the lifetime of the
+	/// object.
+{
+public:
+	StandInServer():
+		_socket(SocketAddress("127.0.0.1", 0), 4096),
+		_epollFd(::epoll_create1(0)),
+		_stop(false),
+		_nextSession(0x10000000)
+	{
+		if (_epollFd < 0)
+			throw Poco::IOException("cannot create epoll instance", std::strerror(errno));
+		setNonBlocking(_socket.impl()->sockfd());
+		watch(_socket.impl()->sockfd(), EPOLLIN);
+		_thread.start(*this);
+	}
+
+	~StandInServer()
+	{
+		_stop = true;
+		_thread.join();
+		for (Connections::iterator it = _connections.begin(); it != _connections.end(); ++it)
+			::close(it->first);
+		::close(_epollFd);
+	}
+
+	Poco::UInt16 port() const
+	{
+		return _socket.address().port();
+	}
+
+	void run()
+	{
+		const int listenFd = _socket.impl()->sockfd();
+		struct epoll_event events[256];
+		char buffer[8192];
+		while (!_stop)
+		{
+			int n = ::epoll_wait(_epollFd, events, 256, 100);
+			for (int i = 0; i < n; ++i)
+			{
+				int fd = events[i].data.fd;
+				if (fd == listenFd)
+				{
+					int client;
+					while ((client = ::accept(listenFd, NULL, NULL)) >= 0)
+					{
+						setNonBlocking(client);
+						watch(client, EPOLLIN);
+						_connections[client];
+					}
+					continue;
+				}
+
+				Connection& connection = _connections[fd];
+				if (events[i].events & EPOLLOUT)
+				{
+					flush(fd, connection);
+				}
+				if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				{
+					int rc;
+					while ((rc = (int) ::recv(fd, buffer, sizeof(buffer), 0)) > 0)
+					{
+						connection.in.append(buffer, rc);
+					}
+					if (rc == 0 || (rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+					{
+						::close(fd);
+						_connections.erase(fd);
+						continue;
+					}
+					serve(fd, connection);
+				}
+			}
+		}
+	}
+
+private:
+	struct Connection
+	{
+		std::string in;
+		std::string out;
+		std::string session;
+	};
+
+	typedef std::map<int, Connection> Connections;
+
+	void watch(int fd, unsigned events)
+	{
+		struct epoll_event ev;
+		ev.events  = events;
+		ev.data.fd = fd;
+		if (::epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0)
+			::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev);
+	}
+
+	static std::string header(const std::string& request, const char* name)
+	{
+		std::string key("\r\n");
+		key.append(name);
+		key.append(": ");
+		std::string::size_type pos = request.find(key);
+		if (pos == std::string::npos)
+			return std::string();
+		pos += key.size();
+		return request.substr(pos, request.find("\r\n", pos) - pos);
+	}
+
+	void serve(int fd, Connection& connection)
+	{
+		std::string::size_type end;
+		while ((end = connection.in.find("\r\n\r\n")) != std::string::npos)
+		{
+			std::string request(connection.in, 0, end + 2);
+			std::string::size_type length = end + 4;
+			std::string contentLength = header(request, "Content-Length");
+			if (!contentLength.empty())
+				length += NumberParser::parseUnsigned(contentLength);
+			if (connection.in.size() < length)
+				break;
+			connection.in.erase(0, length);
+			respond(request, connection);
+		}
+		flush(fd, connection);
+	}
+
+	void respond(const std::string& request, Connection& connection)
+	{
+		std::string method(request, 0, request.find(' '));
+		std::string::size_type uriEnd = request.find(' ', method.size() + 1);
+		std::string uri(request, method.size() + 1, uriEnd - method.size() - 1);
+
+		std::string& out = connection.out;
+		std::string body;
+		std::string extra;
+		const char* status = "200 OK";
+		if (method == RTSPRequest::RTSP_OPTIONS)
+		{
+			extra = "Public: OPTIONS, DESCRIBE, SETUP, PLAY, GET_PARAMETER, TEARDOWN\r\n";
+		}
+		else if (method == RTSPRequest::RTSP_DESCRIBE)
+		{
+			body =
+				"v=0\r\n"
+				"o=- 1700000000 1 IN IP4 127.0.0.1\r\n"
+				"s=Stand-in Stream\r\n"
+				"c=IN IP4 0.0.0.0\r\n"
+				"t=0 0\r\n"
+				"a=control:*\r\n"
+				"m=video 0 RTP/AVP 96\r\n"
+				"a=rtpmap:96 H264/90000\r\n"
+				"a=fmtp:96 packetization-mode=1;profile-level-id=42e01f\r\n"
+				"a=control:trackID=1\r\n"
+				"m=audio 0 RTP/AVP 0\r\n"
+				"a=rtpmap:0 PCMU/8000\r\n"
+				"a=control:trackID=2\r\n";
+			extra = "Content-Base: " + uri + "/\r\nContent-Type: application/sdp\r\n";
+		}
+		else if (method == RTSPRequest::RTSP_SETUP)
+		{
+			if (connection.session.empty())
+				connection.session = NumberFormatter::formatHex(_nextSession++);
+			extra = "Session: " + connection.session + ";timeout=60\r\nTransport: " +
+			        header(request, "Transport") + ";server_port=6970-6971;ssrc=1A2B3C4D\r\n";
+		}
+		else if (method == RTSPRequest::RTSP_PLAY)
+		{
+			extra = "Session: " + connection.session + "\r\nRange: npt=now-\r\nRTP-Info: url=" + uri + "/trackID=1;seq=1;rtptime=0\r\n";
+		}
+		else if (method == RTSPRequest::RTSP_GET_PARAMETER || method == RTSPRequest::RTSP_TEARDOWN)
+		{
+			extra = "Session: " + connection.session + "\r\n";
+		}
+		else
+		{
+			status = "501 Not Implemented";
+		}
+
+		out.append("RTSP/1.0 ");
+		out.append(status);
+		out.append("\r\nCSeq: ");
+		out.append(header(request, "CSeq"));
+		out.append("\r\nServer: rtsp_loadgen stand-in\r\n");
+		out.append(extra);
+		if (!body.empty())
+		{
+			out.append("Content-Length: ");
+			out.append(NumberFormatter::format(body.size()));
+			out.append("\r\n");
+		}
+		out.append("\r\n");
+		out.append(body);
+	}
+
+	void flush(int fd, Connection& connection)
+	{
+		while (!connection.out.empty())
+		{
+			int rc = (int) ::send(fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+			if (rc <= 0)
+				break;
+			connection.out.erase(0, rc);
+		}
+		watch(fd, connection.out.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT);
+	}
+
+	ServerSocket      _socket;
+	int               _epollFd;
+	std::atomic<bool> _stop;
+	unsigned          _nextSession;
+	Connections       _connections;
+	Thread            _thread;
+};
+
+
+//
+// Load generation
+//
+
+
+struct Results
+	/// Shared by all workers; everything is lock-free.
+{
+	Results():
+		started(0),
+		established(0),
+		completed(0),
+		connectFailures(0),
+		timeouts(0),
+		statusErrors(0),
+		otherErrors(0),
+		lastEstablished(0)
+	{
+	}
+
+	std::atomic<int>      started;
+	std::atomic<int>      established;
+	std::atomic<int>      completed;
+	std::atomic<int>      connectFailures;
+	std::atomic<int>      timeouts;
+	std::atomic<int>      statusErrors;
+	std::atomic<int>      otherErrors;
+	std::atomic<Timestamp::TimeVal> lastEstablished;
+	RTSPLatencyHistogram  connectLatency;
+	RTSPLatencyRecorder   requestLatency;
+};
+
+
+struct SessionState
+{
+	SessionState():
+		index(0),
+		pSession(NULL),
+		step(0),
+		tracks(0),
+		playing(false)
+	{
+	}
+
+	int                index;
+	URI                uri;
+	RTSPClientSession* pSession;
+	std::size_t        step;
+	int                tracks;
+	bool               playing;
+	Timestamp          due;
+	Timestamp          playedAt;
+	std::string        session;
+};
+
+
+class Worker: public Runnable
+	/// Drives one session on a thread of its own, as every
+	/// exchange blocks the session until the response or the
+	/// timeout. The session is a small state machine walking
+	/// through the startup requests, then the keep-alives and
+	/// finally TEARDOWN.
+{
+public:
+	enum
+	{
+		STACK_SIZE = 256 * 1024
+	};
+
+	Worker(const Options& options, Results& results, int index, const URI& uri, const Timestamp& start):
+		_options(options),
+		_results(results),
+		_setups((int) std::count(options.mix.begin(), options.mix.end(), std::string(RTSPRequest::RTSP_SETUP)))
+	{
+		_state.index = index;
+		_state.uri   = uri;
+		_state.due   = start + (Timestamp::TimeDiff) index * 1000000 / options.ramp;
+		_thread.setStackSize(STACK_SIZE);
+	}
+
+	~Worker()
+	{
+		if (_thread.isRunning())
+			_thread.join();
+		delete _state.pSession;
+	}
+
+	void start()
+	{
+		_thread.start(*this);
+	}
+
+	bool tryJoin(long milliseconds)
+	{
+		return _thread.tryJoin(milliseconds);
+	}
+
+	void run()
+	{
+		for (;;)
+		{
+			Timestamp::TimeDiff wait = _state.due - Timestamp();
+			if (wait > 0)
+			{
+				Thread::sleep((long) (wait / 1000 + 1));
+				continue;
+			}
+			if (!advance(_state))
+				break;
+		}
+	}
+
+private:
+	bool advance(SessionState& state)
+		/// Sends the next request of the session. Returns
+		/// false once the session has ended.
+	{
+		if (NULL == state.pSession)
+		{
+			try
+			{
+				state.pSession = RTSPSessionFactory::defaultFactory().createClientSession(state.uri);
+			}
+			catch (Poco::Exception&)
+			{
+				++_results.otherErrors;
+				++_results.completed;
+				return false;
+			}
+			state.pSession->setTimeout(Timespan((Timestamp::TimeDiff) _options.timeout * 1000));
+			state.pSession->setLatencyRecorder(NULL);
+			++_results.started;
+		}
+
+		std::string method;
+		if (state.step < _options.mix.size())
+			method = _options.mix[state.step];
+		else if (_options.keepalive > 0 && state.playedAt.elapsed() < (Timestamp::TimeDiff) _options.hold * 1000000)
+			method = RTSPRequest::RTSP_GET_PARAMETER;
+		else
+			method = RTSPRequest::RTSP_TEARDOWN;
+
+		if (!exchange(state, method))
+		{
+			finish(state);
+			return false;
+		}
+
+		if (method == RTSPRequest::RTSP_TEARDOWN)
+		{
+			finish(state);
+			return false;
+		}
+
+		++state.step;
+		if (state.step == _options.mix.size())
+		{
+			// startup complete
+			state.playedAt.update();
+			++_results.established;
+			_results.lastEstablished.store(state.playedAt.epochMicroseconds(), std::memory_order_relaxed);
+		}
+
+		state.due.update();
+		if (state.step >= _options.mix.size())
+		{
+			if (_options.keepalive > 0)
+			{
+				Timestamp::TimeDiff interval = (Timestamp::TimeDiff) _options.keepalive * 1000;
+				Timestamp::TimeDiff left = (Timestamp::TimeDiff) _options.hold * 1000000 - state.playedAt.elapsed();
+				state.due += std::max<Timestamp::TimeDiff>(std::min(interval, left), 0);
+			}
+			else
+			{
+				state.due += (Timestamp::TimeDiff) _options.hold * 1000000;
+			}
+		}
+		return true;
+	}
+
+	bool exchange(SessionState& state, const std::string& method)
+		/// Performs one request/response exchange and records
+		/// its latency. The first exchange of a session is
+		/// preceded by the connection, whose duration is
+		/// recorded separately.
+	{
+		std::string uri(state.uri.toString());
+		RTSPRequest request(method, uri);
+		request.set("User-Agent", "rtsp_loadgen");
+		if (method == RTSPRequest::RTSP_DESCRIBE)
+		{
+			request.set("Accept", "application/sdp");
+		}
+		else if (method == RTSPRequest::RTSP_SETUP)
+		{
+			int port = _options.clientPort + 2 * (state.index * _setups + state.tracks);
+			++state.tracks;
+			request.setURI(uri + "/trackID=" + NumberFormatter::format(state.tracks));
+			request.set("Transport", "RTP/AVP;unicast;client_port=" + NumberFormatter::format(port) + "-" + NumberFormatter::format(port + 1));
+		}
+		if (!state.session.empty())
+		{
+			request.set("Session", state.session);
+		}
+
+		RTSPSessionMetrics::Method m = RTSPSessionMetrics::methodOf(method);
+		if (!state.pSession->connected())
+		{
+			Clock connectStart;
+			try
+			{
+				state.pSession->open();
+			}
+			catch (Poco::Exception&)
+			{
+				++_results.connectFailures;
+				return false;
+			}
+			_results.connectLatency.record(connectStart.elapsed());
+		}
+
+		Clock start;
+		try
+		{
+			state.pSession->sendRequest(request);
+		}
+		catch (Poco::Exception&)
+		{
+			++_results.otherErrors;
+			return false;
+		}
+
+		try
+		{
+			RTSPResponse response;
+			std::istream& istr = state.pSession->receiveResponse(response);
+			istr.ignore(std::numeric_limits<std::streamsize>::max());
+
+			_results.requestLatency.record(m, RTSPLatencyRecorder::statusClassOf(response.getStatus()), start.elapsed());
+			if (response.getStatus() / 100 != 2)
+			{
+				++_results.statusErrors;
+				return false;
+			}
+			if (response.has("Session"))
+			{
+				const std::string& session = response.get("Session");
+				state.session = session.substr(0, session.find(';'));
+			}
+		}
+		catch (Poco::TimeoutException&)
+		{
+			_results.requestLatency.record(m, RTSPLatencyRecorder::STATUS_OTHER, start.elapsed());
+			++_results.timeouts;
+			return false;
+		}
+		catch (Poco::Exception&)
+		{
+			_results.requestLatency.record(m, RTSPLatencyRecorder::STATUS_OTHER, start.elapsed());
+			++_results.otherErrors;
+			return false;
+		}
+		return true;
+	}
+
+	void finish(SessionState& state)
+	{
+		delete state.pSession;
+		state.pSession = NULL;
+		++_results.completed;
+	}
+
+	const Options&            _options;
+	Results&                  _results;
+	Timestamp                 _start;
+	int                       _setups;  /// SETUP requests per session
+	SessionState              _state;
+	Thread                    _thread;
+};
+
+
+void printHistogram(const char* name, const RTSPLatencyHistogram& histogram)
+{
+	std::printf("  %-14s %9lu %9ld %9ld %9ld %9ld %9ld\n", name,
+		(unsigned long) histogram.count(),
+		(long) histogram.valueAtPercentile(50.0),
+		(long) histogram.valueAtPercentile(90.0),
+		(long) histogram.valueAtPercentile(99.0),
+		(long) histogram.valueAtPercentile(99.9),
+		(long) histogram.max());
+}
+
+
+void report(const Options& options, Results& results, const Timestamp& start)
+{
+	int established = results.established.load();
+	int failed = results.connectFailures.load() + results.timeouts.load() + results.statusErrors.load() + results.otherErrors.load();
+	Timestamp::TimeDiff rampTime = results.lastEstablished.load() - start.epochMicroseconds();
+
+	std::printf("\nsessions: %d started, %d established, %d failed (%.2f%%)\n",
+		results.started.load(), established, failed,
+		100.0 * failed / (double) std::max(results.started.load(), 1));
+	std::printf("errors:   %d connect, %d timeout, %d status, %d other\n",
+		results.connectFailures.load(), results.timeouts.load(), results.statusErrors.load(), results.otherErrors.load());
+	if (established > 0 && rampTime > 0)
+	{
+		std::printf("rate:     %.1f sessions/s established (%d/s requested)\n",
+			established * 1000000.0 / (double) rampTime, options.ramp);
+	}
+
+	std::printf("\nlatency (us)     count       p50       p90       p99     p99.9       max\n");
+	printHistogram("connect", results.connectLatency);
+	for (int m = 0; m < RTSPSessionMetrics::METHOD_COUNT; ++m)
+	{
+		RTSPLatencyHistogram histogram = results.requestLatency.histogram((RTSPSessionMetrics::Method) m);
+		if (histogram.count() > 0)
+		{
+			const std::string& name = RTSPSessionMetrics::methodName((RTSPSessionMetrics::Method) m);
+			printHistogram(name.empty() ? "OTHER" : name.c_str(), histogram);
+		}
+	}
+
+	RTSPSessionMetrics::Snapshot metrics = RTSPSessionFactory::defaultFactory().metrics();
+	std::printf("\ntraffic:  %lu requests, %lu bytes sent, %lu bytes received\n",
+		(unsigned long) metrics.totalRequests(), (unsigned long) metrics.bytesSent, (unsigned long) metrics.bytesReceived);
+}
+
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		parseOptions(argc, argv, options);
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << "\n\n" << USAGE;
+		return 2;
+	}
+
+	try
+	{
+		SharedPtr<StandInServer> pServer;
+		if (options.local)
+		{
+			pServer = new StandInServer;
+			if (options.uris.empty())
+				options.uris.push_back(URI("rtsp://127.0.0.1:" + NumberFormatter::format(pServer->port()) + "/stream"));
+		}
+		if (options.uris.empty())
+		{
+			std::cerr << "no target URI given\n\n" << USAGE;
+			return 2;
+		}
+
+		RTSPSessionInstantiator::registerInstantiator();
+
+		std::cout << options.sessions << " sessions against " << options.uris.size() << " URIs, "
+		          << options.ramp << " sessions/s ramp" << std::endl;
+
+		Results results;
+		Timestamp start;
+		start += 100000;
+
+		// the workers join their threads when destroyed,
+		// so they must go before results and the server
+		std::vector<SharedPtr<Worker> > workers;
+		for (int i = 0; i < options.sessions; ++i)
+		{
+			workers.push_back(new Worker(options, results, i, options.uris[i % options.uris.size()], start));
+		}
+		std::size_t running = 0;
+		try
+		{
+			for (; running < workers.size(); ++running)
+				workers[running]->start();
+		}
+		catch (Poco::Exception& exc)
+		{
+			std::cerr << "only " << running << " sessions could get a thread: " << exc.displayText() << std::endl;
+		}
+
+		for (std::size_t t = 0; t < running; ++t)
+		{
+			while (!workers[t]->tryJoin(1000))
+			{
+				std::printf("\r%d started, %d established, %d completed, %d errors   ",
+					results.started.load(), results.established.load(), results.completed.load(),
+					results.connectFailures.load() + results.timeouts.load() + results.statusErrors.load() + results.otherErrors.load());
+				std::fflush(stdout);
+			}
+		}
+
+		report(options, results, start);
+
+		workers.clear();
+		RTSPSessionInstantiator::unregisterInstantiator();
+	}
+	catch (Poco::Exception& exc)
+	{
+		std::cerr << exc.displayText() << std::endl;
+		return 1;
+	}
+	return 0;
+}